@@ -63,9 +63,29 @@
  *
  * При отключении управления приводом функцией #hyscan_actuator_disable, привод
  * автоматически повернётся в начальное положение (режим парковки).
+ *
+ * Функции управления приводом имеют асинхронные варианты с суффиксом _async,
+ * которые не блокируют вызывающий поток. Результат их выполнения передаётся
+ * в функцию обратного вызова и считывается функцией #hyscan_actuator_finish.
+ * Асинхронные функции драйвера disable_async, scan_async и manual_async
+ * используются, только если драйвер реализует их все, и в этом случае
+ * драйвер сам отвечает за выполнение команд в порядке их вызова. Иначе
+ * все асинхронные команды выполняются синхронными функциями драйвера в
+ * отдельном потоке. Команды одного устройства выполняются по одной в
+ * порядке их вызова.
  */
 
 #include "hyscan-actuator.h"
+#include "hyscan-device-async.h"
+
+typedef struct
+{
+  gchar                       *name;           /* Название привода. */
+  gdouble                      from;           /* Начальный угол сектора обзора. */
+  gdouble                      to;             /* Конечный угол сектора обзора. */
+  gdouble                      speed;          /* Скорость вращения привода. */
+  gdouble                      angle;          /* Угол направления привода. */
+} HyScanActuatorAsync;
 
 G_DEFINE_INTERFACE (HyScanActuator, hyscan_actuator, G_TYPE_OBJECT)
 
@@ -153,3 +173,226 @@ hyscan_actuator_manual (HyScanActuator *actuator,
 
   return FALSE;
 }
+
+/* Функция создаёт параметры асинхронной команды. */
+static HyScanActuatorAsync *
+hyscan_actuator_async_new (const gchar *name)
+{
+  HyScanActuatorAsync *async;
+
+  async = g_slice_new0 (HyScanActuatorAsync);
+  async->name = g_strdup (name);
+
+  return async;
+}
+
+/* Функция освобождает параметры асинхронной команды. */
+static void
+hyscan_actuator_async_free (gpointer data)
+{
+  HyScanActuatorAsync *async = data;
+
+  g_free (async->name);
+  g_slice_free (HyScanActuatorAsync, async);
+}
+
+/* Функция проверяет, реализует ли драйвер все асинхронные команды. Если
+ * реализована только часть команд, смешивать их с очередью устройства
+ * нельзя, так как порядок выполнения команд не сохранится. */
+static gboolean
+hyscan_actuator_async_native (HyScanActuatorInterface *iface)
+{
+  return (iface->disable_async != NULL) && (iface->disable_finish != NULL) &&
+         (iface->scan_async != NULL) && (iface->scan_finish != NULL) &&
+         (iface->manual_async != NULL) && (iface->manual_finish != NULL);
+}
+
+/* Функция отключает привод в очереди устройства. */
+static gboolean
+hyscan_actuator_disable_func (GObject  *actuator,
+                              gpointer  data)
+{
+  HyScanActuatorAsync *async = data;
+
+  return hyscan_actuator_disable (HYSCAN_ACTUATOR (actuator), async->name);
+}
+
+/* Функция включает режим сканирования в очереди устройства. */
+static gboolean
+hyscan_actuator_scan_func (GObject  *actuator,
+                           gpointer  data)
+{
+  HyScanActuatorAsync *async = data;
+
+  return hyscan_actuator_scan (HYSCAN_ACTUATOR (actuator), async->name,
+                               async->from, async->to, async->speed);
+}
+
+/* Функция включает ручной режим в очереди устройства. */
+static gboolean
+hyscan_actuator_manual_func (GObject  *actuator,
+                             gpointer  data)
+{
+  HyScanActuatorAsync *async = data;
+
+  return hyscan_actuator_manual (HYSCAN_ACTUATOR (actuator), async->name, async->angle);
+}
+
+/**
+ * hyscan_actuator_disable_async:
+ * @actuator: указатель на #HyScanActuator
+ * @name: название привода
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно отключает привод. Аналогична функции
+ * #hyscan_actuator_disable. Результат выполнения можно получить функцией
+ * #hyscan_actuator_finish.
+ */
+void
+hyscan_actuator_disable_async (HyScanActuator      *actuator,
+                               const gchar         *name,
+                               GCancellable        *cancellable,
+                               GAsyncReadyCallback  callback,
+                               gpointer             user_data)
+{
+  HyScanActuatorInterface *iface;
+
+  g_return_if_fail (HYSCAN_IS_ACTUATOR (actuator));
+
+  iface = HYSCAN_ACTUATOR_GET_IFACE (actuator);
+  if (hyscan_actuator_async_native (iface))
+    {
+      GTask *task;
+
+      task = hyscan_device_async_native (actuator, (HyScanDeviceAsyncFinish)iface->disable_finish,
+                                         cancellable, callback, user_data, hyscan_actuator_disable_async);
+      (* iface->disable_async) (actuator, name, cancellable, hyscan_device_async_native_ready, task);
+
+      return;
+    }
+
+  hyscan_device_async_run (actuator, hyscan_actuator_disable_func,
+                           hyscan_actuator_async_new (name), hyscan_actuator_async_free,
+                           cancellable, callback, user_data, hyscan_actuator_disable_async);
+}
+
+/**
+ * hyscan_actuator_scan_async:
+ * @actuator: указатель на #HyScanActuator
+ * @name: название привода
+ * @from: начальный угол сектора обзора, десятичный градус
+ * @to: конечный угол сектора обзора, десятичный градус
+ * @speed: скорость вращения привода, десятичный градус/с
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно включает режим сканирования в заданном секторе обзора.
+ * Аналогична функции #hyscan_actuator_scan. Результат выполнения можно
+ * получить функцией #hyscan_actuator_finish.
+ */
+void
+hyscan_actuator_scan_async (HyScanActuator      *actuator,
+                            const gchar         *name,
+                            gdouble              from,
+                            gdouble              to,
+                            gdouble              speed,
+                            GCancellable        *cancellable,
+                            GAsyncReadyCallback  callback,
+                            gpointer             user_data)
+{
+  HyScanActuatorInterface *iface;
+  HyScanActuatorAsync *async;
+
+  g_return_if_fail (HYSCAN_IS_ACTUATOR (actuator));
+
+  iface = HYSCAN_ACTUATOR_GET_IFACE (actuator);
+  if (hyscan_actuator_async_native (iface))
+    {
+      GTask *task;
+
+      task = hyscan_device_async_native (actuator, (HyScanDeviceAsyncFinish)iface->scan_finish,
+                                         cancellable, callback, user_data, hyscan_actuator_scan_async);
+      (* iface->scan_async) (actuator, name, from, to, speed,
+                             cancellable, hyscan_device_async_native_ready, task);
+
+      return;
+    }
+
+  async = hyscan_actuator_async_new (name);
+  async->from = from;
+  async->to = to;
+  async->speed = speed;
+
+  hyscan_device_async_run (actuator, hyscan_actuator_scan_func, async, hyscan_actuator_async_free,
+                           cancellable, callback, user_data, hyscan_actuator_scan_async);
+}
+
+/**
+ * hyscan_actuator_manual_async:
+ * @actuator: указатель на #HyScanActuator
+ * @name: название привода
+ * @angle: угол направления привода, десятичный градус
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно включает режим ручного выбора угла направления привода.
+ * Аналогична функции #hyscan_actuator_manual. Результат выполнения можно
+ * получить функцией #hyscan_actuator_finish.
+ */
+void
+hyscan_actuator_manual_async (HyScanActuator      *actuator,
+                              const gchar         *name,
+                              gdouble              angle,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              gpointer             user_data)
+{
+  HyScanActuatorInterface *iface;
+  HyScanActuatorAsync *async;
+
+  g_return_if_fail (HYSCAN_IS_ACTUATOR (actuator));
+
+  iface = HYSCAN_ACTUATOR_GET_IFACE (actuator);
+  if (hyscan_actuator_async_native (iface))
+    {
+      GTask *task;
+
+      task = hyscan_device_async_native (actuator, (HyScanDeviceAsyncFinish)iface->manual_finish,
+                                         cancellable, callback, user_data, hyscan_actuator_manual_async);
+      (* iface->manual_async) (actuator, name, angle,
+                               cancellable, hyscan_device_async_native_ready, task);
+
+      return;
+    }
+
+  async = hyscan_actuator_async_new (name);
+  async->angle = angle;
+
+  hyscan_device_async_run (actuator, hyscan_actuator_manual_func, async, hyscan_actuator_async_free,
+                           cancellable, callback, user_data, hyscan_actuator_manual_async);
+}
+
+/**
+ * hyscan_actuator_finish:
+ * @actuator: указатель на #HyScanActuator
+ * @result: #GAsyncResult
+ * @error: (nullable): #GError
+ *
+ * Функция возвращает результат выполнения асинхронной команды привода.
+ * Функция должна вызываться из функции обратного вызова.
+ *
+ * Returns: %TRUE если команда выполнена успешно, иначе %FALSE.
+ */
+gboolean
+hyscan_actuator_finish (HyScanActuator  *actuator,
+                        GAsyncResult    *result,
+                        GError         **error)
+{
+  g_return_val_if_fail (HYSCAN_IS_ACTUATOR (actuator), FALSE);
+
+  return hyscan_device_async_finish (actuator, result, error);
+}
@@ -36,6 +36,7 @@
 #define __HYSCAN_ACTUATOR_H__
 
 #include <hyscan-types.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
@@ -79,6 +80,39 @@ struct _HyScanActuatorInterface
   gboolean             (*manual)                       (HyScanActuator        *actuator,
                                                         const gchar           *name,
                                                         gdouble                angle);
+  void                 (*disable_async)                (HyScanActuator        *actuator,
+                                                        const gchar           *name,
+                                                        GCancellable          *cancellable,
+                                                        GAsyncReadyCallback    callback,
+                                                        gpointer               user_data);
+
+  gboolean             (*disable_finish)               (HyScanActuator        *actuator,
+                                                        GAsyncResult          *result,
+                                                        GError               **error);
+
+  void                 (*scan_async)                   (HyScanActuator        *actuator,
+                                                        const gchar           *name,
+                                                        gdouble                from,
+                                                        gdouble                to,
+                                                        gdouble                speed,
+                                                        GCancellable          *cancellable,
+                                                        GAsyncReadyCallback    callback,
+                                                        gpointer               user_data);
+
+  gboolean             (*scan_finish)                  (HyScanActuator        *actuator,
+                                                        GAsyncResult          *result,
+                                                        GError               **error);
+
+  void                 (*manual_async)                 (HyScanActuator        *actuator,
+                                                        const gchar           *name,
+                                                        gdouble                angle,
+                                                        GCancellable          *cancellable,
+                                                        GAsyncReadyCallback    callback,
+                                                        gpointer               user_data);
+
+  gboolean             (*manual_finish)                (HyScanActuator        *actuator,
+                                                        GAsyncResult          *result,
+                                                        GError               **error);
 };
 
 HYSCAN_API
@@ -99,6 +133,35 @@ HYSCAN_API
 gboolean               hyscan_actuator_manual          (HyScanActuator        *actuator,
                                                         const gchar           *name,
                                                         gdouble                angle);
+HYSCAN_API
+void                   hyscan_actuator_disable_async   (HyScanActuator        *actuator,
+                                                        const gchar           *name,
+                                                        GCancellable          *cancellable,
+                                                        GAsyncReadyCallback    callback,
+                                                        gpointer               user_data);
+
+HYSCAN_API
+void                   hyscan_actuator_scan_async      (HyScanActuator        *actuator,
+                                                        const gchar           *name,
+                                                        gdouble                from,
+                                                        gdouble                to,
+                                                        gdouble                speed,
+                                                        GCancellable          *cancellable,
+                                                        GAsyncReadyCallback    callback,
+                                                        gpointer               user_data);
+
+HYSCAN_API
+void                   hyscan_actuator_manual_async    (HyScanActuator        *actuator,
+                                                        const gchar           *name,
+                                                        gdouble                angle,
+                                                        GCancellable          *cancellable,
+                                                        GAsyncReadyCallback    callback,
+                                                        gpointer               user_data);
+
+HYSCAN_API
+gboolean               hyscan_actuator_finish          (HyScanActuator        *actuator,
+                                                        GAsyncResult          *result,
+                                                        GError               **error);
 
 G_END_DECLS
 
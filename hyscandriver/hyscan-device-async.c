@@ -0,0 +1,199 @@
+/* hyscan-device-async.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/* Вспомогательные функции асинхронного выполнения команд управления
+ * устройствами. Команды одного устройства выполняются в отдельной для
+ * этого устройства очереди по одной, в порядке их вызова. Это позволяет
+ * не блокировать вызывающий поток и сохранить порядок изменения параметров.
+ * Очереди разных устройств выполняются параллельно. */
+
+#include "hyscan-device-async.h"
+
+#define HYSCAN_DEVICE_ASYNC_QUEUE      "hyscan-device-async-queue"
+
+typedef struct
+{
+  HyScanDeviceAsyncFunc        func;           /* Функция выполнения команды. */
+  gpointer                     data;           /* Параметры команды. */
+  GDestroyNotify               data_free;      /* Функция освобождения параметров. */
+} HyScanDeviceAsync;
+
+G_LOCK_DEFINE_STATIC (hyscan_device_async_queue);
+
+static void            hyscan_device_async_free                (gpointer               data);
+static void            hyscan_device_async_queue_free          (gpointer               data);
+static void            hyscan_device_async_func                (gpointer               data,
+                                                                gpointer               user_data);
+
+/* Функция освобождает параметры команды. */
+static void
+hyscan_device_async_free (gpointer data)
+{
+  HyScanDeviceAsync *async = data;
+
+  if (async->data_free != NULL)
+    async->data_free (async->data);
+
+  g_slice_free (HyScanDeviceAsync, async);
+}
+
+/* Функция удаляет очередь команд устройства. Очередь удаляется вместе с
+ * устройством, в том числе из потока самой очереди, когда этот поток
+ * освобождает последнюю ссылку на задачу. Поэтому завершения потока не
+ * ожидаем: пул освобождается после выхода потока из функции выполнения.
+ * Невыполненных команд в этот момент нет, так как каждая команда
+ * удерживает ссылку на устройство. */
+static void
+hyscan_device_async_queue_free (gpointer data)
+{
+  g_thread_pool_free (data, FALSE, FALSE);
+}
+
+/* Функция выполнения команды в потоке очереди устройства. */
+static void
+hyscan_device_async_func (gpointer data,
+                          gpointer user_data)
+{
+  GTask *task = data;
+  HyScanDeviceAsync *async = g_task_get_task_data (task);
+  GObject *device = g_task_get_source_object (task);
+
+  if (!g_task_return_error_if_cancelled (task))
+    {
+      if (async->func (device, async->data))
+        {
+          g_task_return_boolean (task, TRUE);
+        }
+      else
+        {
+          g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                   "%s: command failed", G_OBJECT_TYPE_NAME (device));
+        }
+    }
+
+  g_object_unref (task);
+}
+
+/* Функция ставит команду в очередь устройства. Функция func вызывается
+ * в потоке очереди и должна выполнить синхронную команду. */
+void
+hyscan_device_async_run (gpointer               device,
+                         HyScanDeviceAsyncFunc  func,
+                         gpointer               data,
+                         GDestroyNotify         data_free,
+                         GCancellable          *cancellable,
+                         GAsyncReadyCallback    callback,
+                         gpointer               user_data,
+                         gpointer               source_tag)
+{
+  HyScanDeviceAsync *async;
+  GThreadPool *queue;
+  GTask *task;
+
+  async = g_slice_new (HyScanDeviceAsync);
+  async->func = func;
+  async->data = data;
+  async->data_free = data_free;
+
+  task = g_task_new (device, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+  g_task_set_task_data (task, async, hyscan_device_async_free);
+
+  G_LOCK (hyscan_device_async_queue);
+
+  queue = g_object_get_data (device, HYSCAN_DEVICE_ASYNC_QUEUE);
+  if (queue == NULL)
+    {
+      queue = g_thread_pool_new (hyscan_device_async_func, NULL, 1, FALSE, NULL);
+      g_object_set_data_full (device, HYSCAN_DEVICE_ASYNC_QUEUE, queue,
+                              hyscan_device_async_queue_free);
+    }
+
+  g_thread_pool_push (queue, task, NULL);
+
+  G_UNLOCK (hyscan_device_async_queue);
+}
+
+/* Функция создаёт задачу для асинхронной команды, реализованной драйвером.
+ * Задачу необходимо передать в качестве пользовательских данных функции
+ * драйвера вместе с функцией обратного вызова
+ * hyscan_device_async_native_ready. */
+GTask *
+hyscan_device_async_native (gpointer                device,
+                            HyScanDeviceAsyncFinish finish,
+                            GCancellable           *cancellable,
+                            GAsyncReadyCallback     callback,
+                            gpointer                user_data,
+                            gpointer                source_tag)
+{
+  GTask *task;
+
+  task = g_task_new (device, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+  g_task_set_task_data (task, (gpointer)finish, NULL);
+
+  return task;
+}
+
+/* Функция обратного вызова асинхронной команды драйвера. */
+void
+hyscan_device_async_native_ready (GObject      *device,
+                                  GAsyncResult *result,
+                                  gpointer      data)
+{
+  GTask *task = data;
+  HyScanDeviceAsyncFinish finish = (HyScanDeviceAsyncFinish)g_task_get_task_data (task);
+  GError *error = NULL;
+
+  if (finish (device, result, &error))
+    g_task_return_boolean (task, TRUE);
+  else if (error != NULL)
+    g_task_return_error (task, error);
+  else
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                             "%s: command failed", G_OBJECT_TYPE_NAME (device));
+
+  g_object_unref (task);
+}
+
+/* Функция возвращает результат асинхронной команды. */
+gboolean
+hyscan_device_async_finish (gpointer       device,
+                            GAsyncResult  *result,
+                            GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, device), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
@@ -0,0 +1,75 @@
+/* hyscan-device-async.h
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_DEVICE_ASYNC_H__
+#define __HYSCAN_DEVICE_ASYNC_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef gboolean       (*HyScanDeviceAsyncFunc)                (GObject               *device,
+                                                                gpointer               data);
+
+typedef gboolean       (*HyScanDeviceAsyncFinish)              (GObject               *device,
+                                                                GAsyncResult          *result,
+                                                                GError               **error);
+
+void                   hyscan_device_async_run                 (gpointer               device,
+                                                                HyScanDeviceAsyncFunc  func,
+                                                                gpointer               data,
+                                                                GDestroyNotify         data_free,
+                                                                GCancellable          *cancellable,
+                                                                GAsyncReadyCallback    callback,
+                                                                gpointer               user_data,
+                                                                gpointer               source_tag);
+
+GTask *                hyscan_device_async_native              (gpointer               device,
+                                                                HyScanDeviceAsyncFinish finish,
+                                                                GCancellable          *cancellable,
+                                                                GAsyncReadyCallback    callback,
+                                                                gpointer               user_data,
+                                                                gpointer               source_tag);
+
+void                   hyscan_device_async_native_ready        (GObject               *device,
+                                                                GAsyncResult          *result,
+                                                                gpointer               data);
+
+gboolean               hyscan_device_async_finish              (gpointer               device,
+                                                                GAsyncResult          *result,
+                                                                GError               **error);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_DEVICE_ASYNC_H__ */
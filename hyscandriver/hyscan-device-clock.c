@@ -0,0 +1,510 @@
+/* hyscan-device-clock.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-device-clock
+ * @Short_description: модель часов устройства
+ * @Title: HyScanDeviceClock
+ *
+ * Класс оценивает соответствие между часами устройства и часами
+ * компьютера. Драйвер передаёт в объект пары значений: время устройства,
+ * содержащееся в принятых данных, и время приёма этих данных компьютером.
+ * Пары добавляются функцией #hyscan_device_clock_add.
+ *
+ * По последним парам значений (скользящее окно) строится линейная модель
+ * с учётом смещения и ухода частоты часов устройства. Время приёма
+ * содержит случайную задержку передачи, поэтому модель строится
+ * робастной линейной регрессией: после первого приближения методом
+ * наименьших квадратов отбрасываются пары, отклонение которых от модели
+ * превышает три медианных абсолютных отклонения, и модель строится заново
+ * по оставшимся парам.
+ *
+ * Преобразование времени устройства во время компьютера выполняется
+ * функцией #hyscan_device_clock_convert и сводится к одному умножению и
+ * сложению, без обращения к системным часам. Это позволяет согласовать
+ * метки времени гидролокационных данных и данных датчиков без вызова
+ * g_get_real_time для каждого пакета.
+ *
+ * Если время устройства уменьшилось или новая пара отличается от модели
+ * более чем на секунду, пара не используется: одиночный сильно задержанный
+ * или переставленный пакет не должен разрушать модель. Если такие пары
+ * следуют подряд несколько раз, например при перезапуске устройства, модель
+ * строится заново по этим парам. Сбросить модель можно функцией
+ * #hyscan_device_clock_reset.
+ *
+ * Все функции класса потокобезопасны. Время задаётся в микросекундах.
+ */
+
+#include "hyscan-device-clock.h"
+
+#include <stdlib.h>
+
+#define DEFAULT_WINDOW         64              /* Размер окна по умолчанию. */
+#define MIN_WINDOW             2               /* Минимальный размер окна. */
+#define MAX_DRIFT              1e-3            /* Максимальный уход частоты часов. */
+#define MAX_JUMP               1000000         /* Максимальное отклонение от модели, мкс. */
+#define MAX_VIOLATIONS         3               /* Число отклонений подряд для перезапуска модели. */
+#define MAD_SCALE              (3.0 * 1.4826)  /* Порог отбрасывания в медианных отклонениях. */
+
+enum
+{
+  PROP_O,
+  PROP_WINDOW
+};
+
+struct _HyScanDeviceClockPrivate
+{
+  guint                        window;         /* Размер окна. */
+
+  GMutex                       lock;           /* Блокировка. */
+  gint64                      *device_times;   /* Время устройства. */
+  gint64                      *host_times;     /* Время компьютера. */
+  gdouble                     *residuals;      /* Отклонения от модели. */
+  gdouble                     *work;           /* Рабочий массив. */
+  guint                        n_points;       /* Число пар в окне. */
+  guint                        head;           /* Индекс следующей пары. */
+
+  gint64                       pending_device[MAX_VIOLATIONS]; /* Время устройства отклонившихся пар. */
+  gint64                       pending_host[MAX_VIOLATIONS];   /* Время компьютера отклонившихся пар. */
+  guint                        n_pending;      /* Число отклонившихся подряд пар. */
+
+  gboolean                     valid;          /* Признак наличия модели. */
+  gint64                       device_ref;     /* Опорное время устройства. */
+  gint64                       host_ref;       /* Опорное время компьютера. */
+  gdouble                      rate;           /* Отношение частот часов. */
+};
+
+static void            hyscan_device_clock_set_property        (GObject               *object,
+                                                                guint                  prop_id,
+                                                                const GValue          *value,
+                                                                GParamSpec            *pspec);
+static void            hyscan_device_clock_object_constructed  (GObject               *object);
+static void            hyscan_device_clock_object_finalize     (GObject               *object);
+
+static gint            hyscan_device_clock_compare             (gconstpointer          a,
+                                                                gconstpointer          b);
+static gdouble         hyscan_device_clock_median              (gdouble               *values,
+                                                                guint                  n_values);
+static gboolean        hyscan_device_clock_fit                 (HyScanDeviceClockPrivate *priv,
+                                                                gdouble                threshold,
+                                                                gdouble               *intercept,
+                                                                gdouble               *slope);
+static void            hyscan_device_clock_update              (HyScanDeviceClockPrivate *priv);
+static void            hyscan_device_clock_push                (HyScanDeviceClockPrivate *priv,
+                                                                gint64                 device_time,
+                                                                gint64                 host_time);
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanDeviceClock, hyscan_device_clock, G_TYPE_OBJECT)
+
+static void
+hyscan_device_clock_class_init (HyScanDeviceClockClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = hyscan_device_clock_set_property;
+  object_class->constructed = hyscan_device_clock_object_constructed;
+  object_class->finalize = hyscan_device_clock_object_finalize;
+
+  g_object_class_install_property (object_class, PROP_WINDOW,
+    g_param_spec_uint ("window", "Window", "Window size",
+                       0, G_MAXUINT16, 0,
+                       G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+}
+
+static void
+hyscan_device_clock_init (HyScanDeviceClock *clock)
+{
+  clock->priv = hyscan_device_clock_get_instance_private (clock);
+}
+
+static void
+hyscan_device_clock_set_property (GObject      *object,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  HyScanDeviceClock *clock = HYSCAN_DEVICE_CLOCK (object);
+  HyScanDeviceClockPrivate *priv = clock->priv;
+
+  switch (prop_id)
+    {
+    case PROP_WINDOW:
+      priv->window = g_value_get_uint (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+hyscan_device_clock_object_constructed (GObject *object)
+{
+  HyScanDeviceClock *clock = HYSCAN_DEVICE_CLOCK (object);
+  HyScanDeviceClockPrivate *priv = clock->priv;
+
+  if (priv->window == 0)
+    priv->window = DEFAULT_WINDOW;
+  priv->window = MAX (priv->window, MIN_WINDOW);
+
+  g_mutex_init (&priv->lock);
+
+  priv->device_times = g_new0 (gint64, priv->window);
+  priv->host_times = g_new0 (gint64, priv->window);
+  priv->residuals = g_new0 (gdouble, priv->window);
+  priv->work = g_new0 (gdouble, priv->window);
+
+  priv->rate = 1.0;
+}
+
+static void
+hyscan_device_clock_object_finalize (GObject *object)
+{
+  HyScanDeviceClock *clock = HYSCAN_DEVICE_CLOCK (object);
+  HyScanDeviceClockPrivate *priv = clock->priv;
+
+  g_free (priv->device_times);
+  g_free (priv->host_times);
+  g_free (priv->residuals);
+  g_free (priv->work);
+
+  g_mutex_clear (&priv->lock);
+
+  G_OBJECT_CLASS (hyscan_device_clock_parent_class)->finalize (object);
+}
+
+/* Функция сравнения значений для сортировки. */
+static gint
+hyscan_device_clock_compare (gconstpointer a,
+                             gconstpointer b)
+{
+  gdouble value1 = *(const gdouble *)a;
+  gdouble value2 = *(const gdouble *)b;
+
+  return (value1 > value2) - (value1 < value2);
+}
+
+/* Функция возвращает медиану значений. Порядок значений изменяется. */
+static gdouble
+hyscan_device_clock_median (gdouble *values,
+                            guint    n_values)
+{
+  qsort (values, n_values, sizeof (gdouble), hyscan_device_clock_compare);
+
+  if (n_values % 2)
+    return values[n_values / 2];
+
+  return (values[n_values / 2 - 1] + values[n_values / 2]) / 2.0;
+}
+
+/* Функция строит линейную модель методом наименьших квадратов по парам,
+ * отклонение которых от предыдущей модели не превышает порог. Время
+ * отсчитывается от последней добавленной пары. Если порог отрицательный,
+ * используются все пары. */
+static gboolean
+hyscan_device_clock_fit (HyScanDeviceClockPrivate *priv,
+                         gdouble                   threshold,
+                         gdouble                  *intercept,
+                         gdouble                  *slope)
+{
+  guint last = (priv->head + priv->window - 1) % priv->window;
+  gdouble sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+  gdouble mx, my, dxx, dxy;
+  guint n = 0;
+  guint i;
+
+  for (i = 0; i < priv->n_points; i++)
+    {
+      gdouble x, y;
+
+      if ((threshold >= 0.0) && (ABS (priv->residuals[i]) > threshold))
+        continue;
+
+      x = priv->device_times[i] - priv->device_times[last];
+      y = priv->host_times[i] - priv->host_times[last];
+
+      sx += x;
+      sy += y;
+      sxx += x * x;
+      sxy += x * y;
+      n += 1;
+    }
+
+  if (n == 0)
+    return FALSE;
+
+  mx = sx / n;
+  my = sy / n;
+  dxx = sxx - sx * mx;
+  dxy = sxy - sx * my;
+
+  /* Если время устройства не изменялось, уход частоты не определить. */
+  *slope = (dxx > 0.0) ? dxy / dxx : 1.0;
+  *slope = CLAMP (*slope, 1.0 - MAX_DRIFT, 1.0 + MAX_DRIFT);
+  *intercept = my - *slope * mx;
+
+  return TRUE;
+}
+
+/* Функция обновляет модель часов по парам в окне. */
+static void
+hyscan_device_clock_update (HyScanDeviceClockPrivate *priv)
+{
+  guint last = (priv->head + priv->window - 1) % priv->window;
+  gdouble intercept, slope;
+  gdouble median, mad;
+  guint i;
+
+  /* Первое приближение по всем парам. */
+  if (!hyscan_device_clock_fit (priv, -1.0, &intercept, &slope))
+    return;
+
+  /* Отклонения от модели и их медиана. */
+  for (i = 0; i < priv->n_points; i++)
+    {
+      gdouble x = priv->device_times[i] - priv->device_times[last];
+      gdouble y = priv->host_times[i] - priv->host_times[last];
+
+      priv->residuals[i] = y - (intercept + slope * x);
+      priv->work[i] = priv->residuals[i];
+    }
+
+  median = hyscan_device_clock_median (priv->work, priv->n_points);
+
+  for (i = 0; i < priv->n_points; i++)
+    {
+      priv->residuals[i] -= median;
+      priv->work[i] = ABS (priv->residuals[i]);
+    }
+
+  mad = hyscan_device_clock_median (priv->work, priv->n_points);
+
+  /* Повторное приближение без выбросов. Порог не меньше микросекунды,
+   * чтобы при точных данных не отбросить все пары. */
+  hyscan_device_clock_fit (priv, MAX (MAD_SCALE * mad, 1.0), &intercept, &slope);
+
+  priv->device_ref = priv->device_times[last];
+  priv->host_ref = priv->host_times[last] + (gint64)(intercept + ((intercept < 0.0) ? -0.5 : 0.5));
+  priv->rate = slope;
+  priv->valid = TRUE;
+}
+
+/* Функция добавляет пару значений времени в окно. */
+static void
+hyscan_device_clock_push (HyScanDeviceClockPrivate *priv,
+                          gint64                    device_time,
+                          gint64                    host_time)
+{
+  priv->device_times[priv->head] = device_time;
+  priv->host_times[priv->head] = host_time;
+  priv->head = (priv->head + 1) % priv->window;
+  priv->n_points = MIN (priv->n_points + 1, priv->window);
+}
+
+/**
+ * hyscan_device_clock_new:
+ * @window: размер окна или 0 для значения по умолчанию
+ *
+ * Функция создаёт новый объект #HyScanDeviceClock. Модель строится по
+ * последним @window парам значений времени.
+ *
+ * Returns: #HyScanDeviceClock. Для удаления #g_object_unref.
+ */
+HyScanDeviceClock *
+hyscan_device_clock_new (guint window)
+{
+  return g_object_new (HYSCAN_TYPE_DEVICE_CLOCK,
+                       "window", window,
+                       NULL);
+}
+
+/**
+ * hyscan_device_clock_add:
+ * @clock: указатель на #HyScanDeviceClock
+ * @device_time: время устройства, мкс
+ * @host_time: время приёма данных компьютером, мкс
+ *
+ * Функция добавляет пару значений времени и обновляет модель часов.
+ * Пара, сильно отличающаяся от модели, отбрасывается, если только такие
+ * пары не следуют подряд.
+ */
+void
+hyscan_device_clock_add (HyScanDeviceClock *clock,
+                         gint64             device_time,
+                         gint64             host_time)
+{
+  HyScanDeviceClockPrivate *priv;
+  guint i;
+
+  g_return_if_fail (HYSCAN_IS_DEVICE_CLOCK (clock));
+
+  priv = clock->priv;
+
+  g_mutex_lock (&priv->lock);
+
+  /* Пара, не соответствующая модели. Это может быть одиночный выброс или
+   * перезапуск часов устройства. Перезапуском считаем несколько таких пар
+   * подряд с возрастающим временем устройства. */
+  if (priv->n_points > 0)
+    {
+      guint last = (priv->head + priv->window - 1) % priv->window;
+      gint64 predicted;
+
+      predicted = priv->host_ref + (gint64)((device_time - priv->device_ref) * priv->rate);
+
+      if ((device_time < priv->device_times[last]) || (ABS (host_time - predicted) > MAX_JUMP))
+        {
+          if ((priv->n_pending > 0) && (device_time <= priv->pending_device[priv->n_pending - 1]))
+            priv->n_pending = 0;
+
+          priv->pending_device[priv->n_pending] = device_time;
+          priv->pending_host[priv->n_pending] = host_time;
+          priv->n_pending += 1;
+
+          if (priv->n_pending < MAX_VIOLATIONS)
+            {
+              g_mutex_unlock (&priv->lock);
+              return;
+            }
+
+          /* Модель строится заново по отклонившимся парам. Последняя пара
+           * добавляется ниже. */
+          priv->n_points = 0;
+          priv->head = 0;
+          for (i = 0; i < priv->n_pending - 1; i++)
+            hyscan_device_clock_push (priv, priv->pending_device[i], priv->pending_host[i]);
+        }
+
+      priv->n_pending = 0;
+    }
+
+  hyscan_device_clock_push (priv, device_time, host_time);
+  hyscan_device_clock_update (priv);
+
+  g_mutex_unlock (&priv->lock);
+}
+
+/**
+ * hyscan_device_clock_reset:
+ * @clock: указатель на #HyScanDeviceClock
+ *
+ * Функция удаляет все пары значений времени и модель часов.
+ */
+void
+hyscan_device_clock_reset (HyScanDeviceClock *clock)
+{
+  HyScanDeviceClockPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_DEVICE_CLOCK (clock));
+
+  priv = clock->priv;
+
+  g_mutex_lock (&priv->lock);
+
+  priv->n_points = 0;
+  priv->head = 0;
+  priv->n_pending = 0;
+  priv->valid = FALSE;
+  priv->rate = 1.0;
+
+  g_mutex_unlock (&priv->lock);
+}
+
+/**
+ * hyscan_device_clock_convert:
+ * @clock: указатель на #HyScanDeviceClock
+ * @device_time: время устройства, мкс
+ *
+ * Функция преобразовывает время устройства во время компьютера. Если
+ * модель ещё не построена, возвращается время устройства.
+ *
+ * Returns: Время компьютера, мкс.
+ */
+gint64
+hyscan_device_clock_convert (HyScanDeviceClock *clock,
+                             gint64             device_time)
+{
+  HyScanDeviceClockPrivate *priv;
+  gint64 host_time = device_time;
+
+  g_return_val_if_fail (HYSCAN_IS_DEVICE_CLOCK (clock), device_time);
+
+  priv = clock->priv;
+
+  g_mutex_lock (&priv->lock);
+
+  if (priv->valid)
+    host_time = priv->host_ref + (gint64)((device_time - priv->device_ref) * priv->rate);
+
+  g_mutex_unlock (&priv->lock);
+
+  return host_time;
+}
+
+/**
+ * hyscan_device_clock_get_model:
+ * @clock: указатель на #HyScanDeviceClock
+ * @offset: (out) (nullable): смещение часов, мкс
+ * @drift: (out) (nullable): уход частоты часов
+ *
+ * Функция возвращает параметры модели часов: смещение времени компьютера
+ * относительно времени устройства на момент последней пары значений и
+ * относительный уход частоты часов устройства.
+ *
+ * Returns: %TRUE если модель построена, иначе %FALSE.
+ */
+gboolean
+hyscan_device_clock_get_model (HyScanDeviceClock *clock,
+                               gint64            *offset,
+                               gdouble           *drift)
+{
+  HyScanDeviceClockPrivate *priv;
+  gboolean valid;
+
+  g_return_val_if_fail (HYSCAN_IS_DEVICE_CLOCK (clock), FALSE);
+
+  priv = clock->priv;
+
+  g_mutex_lock (&priv->lock);
+
+  valid = priv->valid;
+  if (valid && (offset != NULL))
+    *offset = priv->host_ref - priv->device_ref;
+  if (valid && (drift != NULL))
+    *drift = priv->rate - 1.0;
+
+  g_mutex_unlock (&priv->lock);
+
+  return valid;
+}
@@ -0,0 +1,90 @@
+/* hyscan-device-clock.h
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_DEVICE_CLOCK_H__
+#define __HYSCAN_DEVICE_CLOCK_H__
+
+#include <hyscan-types.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_DEVICE_CLOCK             (hyscan_device_clock_get_type ())
+#define HYSCAN_DEVICE_CLOCK(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_DEVICE_CLOCK, HyScanDeviceClock))
+#define HYSCAN_IS_DEVICE_CLOCK(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_DEVICE_CLOCK))
+#define HYSCAN_DEVICE_CLOCK_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_DEVICE_CLOCK, HyScanDeviceClockClass))
+#define HYSCAN_IS_DEVICE_CLOCK_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_DEVICE_CLOCK))
+#define HYSCAN_DEVICE_CLOCK_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_DEVICE_CLOCK, HyScanDeviceClockClass))
+
+typedef struct _HyScanDeviceClock HyScanDeviceClock;
+typedef struct _HyScanDeviceClockPrivate HyScanDeviceClockPrivate;
+typedef struct _HyScanDeviceClockClass HyScanDeviceClockClass;
+
+struct _HyScanDeviceClock
+{
+  GObject parent_instance;
+
+  HyScanDeviceClockPrivate *priv;
+};
+
+struct _HyScanDeviceClockClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                  hyscan_device_clock_get_type            (void);
+
+HYSCAN_API
+HyScanDeviceClock *    hyscan_device_clock_new                 (guint                  window);
+
+HYSCAN_API
+void                   hyscan_device_clock_add                 (HyScanDeviceClock     *clock,
+                                                                gint64                 device_time,
+                                                                gint64                 host_time);
+
+HYSCAN_API
+void                   hyscan_device_clock_reset               (HyScanDeviceClock     *clock);
+
+HYSCAN_API
+gint64                 hyscan_device_clock_convert             (HyScanDeviceClock     *clock,
+                                                                gint64                 device_time);
+
+HYSCAN_API
+gboolean               hyscan_device_clock_get_model           (HyScanDeviceClock     *clock,
+                                                                gint64                *offset,
+                                                                gdouble               *drift);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_DEVICE_CLOCK_H__ */
@@ -0,0 +1,1322 @@
+/* hyscan-device-group.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-device-group
+ * @Short_description: группа устройств
+ * @Title: HyScanDeviceGroup
+ *
+ * Класс объединяет несколько устройств, например гидролокатор бокового
+ * обзора, профилограф, приёмник GNSS и датчик движения, в одно устройство.
+ * Класс реализует интерфейсы #HyScanParam, #HyScanDevice, #HyScanSonar,
+ * #HyScanSensor и #HyScanActuator. Устройства добавляются в группу функцией
+ * #hyscan_device_group_add.
+ *
+ * Схема группы содержит объединённое описание источников гидролокационных
+ * данных, датчиков и приводов всех устройств, созданное с использованием
+ * #HyScanSonarSchema, #HyScanSensorSchema и #HyScanActuatorSchema. В схему
+ * также включаются ветки "/params", "/system" и "/state" всех устройств.
+ * Идентификаторы источников данных, названия датчиков, приводов и
+ * параметров не должны повторяться в разных устройствах.
+ *
+ * Вызовы функций интерфейсов передаются устройству, которому принадлежит
+ * источник данных, датчик, привод или параметр. Функции #hyscan_sonar_start,
+ * #hyscan_sonar_stop, #hyscan_device_sync, #hyscan_device_set_sound_velocity и
+ * #hyscan_device_disconnect вызываются для всех устройств одновременно, каждое
+ * в своём потоке. Они выполняются успешно, только если успешно выполнены для
+ * всех устройств.
+ *
+ * Запуск и останов гидролокаторов выполняется согласованно. Перед запуском
+ * для каждого устройства вызывается функция #hyscan_device_sync. После
+ * подготовки всех устройств назначается общее время запуска. Команда
+ * передаётся каждому устройству раньше этого времени на половину времени
+ * выполнения #hyscan_device_sync, что компенсирует задержку связи с
+ * устройством. Если подготовка хотя бы одного устройства завершилась
+ * ошибкой, запуск не выполняется. Если ошибкой завершился запуск хотя бы
+ * одного устройства, успешно запущенные устройства останавливаются функцией
+ * #hyscan_sonar_stop, поэтому частичный запуск группы невозможен. Отклонение
+ * фактического времени запуска каждого устройства от общего можно узнать
+ * функцией #hyscan_device_group_get_skew.
+ *
+ * Сигналы всех устройств передаются через объект группы, поэтому для приёма
+ * данных достаточно подключиться к сигналам группы. Сигналы посылаются из
+ * потоков устройств, таким образом обработчики этих сигналов не могут
+ * использовать функции работающие через #GMainLoop, например все функции Gtk.
+ *
+ * Все устройства должны быть добавлены в группу до начала работы с ней.
+ */
+
+#include "hyscan-device-group.h"
+#include "hyscan-sonar-schema.h"
+#include "hyscan-sensor-schema.h"
+#include "hyscan-actuator-schema.h"
+#include "hyscan-sonar-config.h"
+
+#include <hyscan-data-schema-builder.h>
+#include <hyscan-buffer.h>
+#include <hyscan-param.h>
+
+#define HYSCAN_DEVICE_GROUP_RELEASE_DELAY      5000     /* Задержка общего запуска, мкс. */
+#define HYSCAN_DEVICE_GROUP_SPIN_TIME          500      /* Время активного ожидания запуска, мкс. */
+
+typedef gboolean (*HyScanDeviceGroupFunc) (GObject  *device,
+                                           gpointer  data);
+
+typedef struct
+{
+  GMutex                       lock;           /* Блокировка. */
+  GCond                        cond;           /* Сигнализатор готовности. */
+  guint                        n_jobs;         /* Число устройств. */
+  guint                        n_ready;        /* Число готовых устройств. */
+  gboolean                     abort;          /* Признак отмены запуска. */
+  gint64                       latency;        /* Максимальная задержка команды, мкс. */
+  gint64                       release;        /* Общее время запуска. */
+} HyScanDeviceGroupBarrier;
+
+typedef struct
+{
+  HyScanDeviceGroupFunc        prepare;        /* Функция подготовки. */
+  HyScanDeviceGroupFunc        func;           /* Выполняемая функция. */
+  GObject                     *device;         /* Устройство. */
+  gpointer                     data;           /* Аргументы функции. */
+  HyScanDeviceGroupBarrier    *barrier;        /* Барьер общего запуска. */
+  gboolean                     started;        /* Признак вызова функции. */
+  gint64                       skew;           /* Отклонение времени запуска, мкс. */
+  gboolean                     status;         /* Результат выполнения. */
+} HyScanDeviceGroupJob;
+
+typedef struct
+{
+  const gchar                 *project_name;   /* Название проекта. */
+  const gchar                 *track_name;     /* Название галса. */
+  HyScanTrackType              track_type;     /* Тип галса. */
+  const HyScanTrackPlan       *track_plan;     /* План галса. */
+} HyScanDeviceGroupStart;
+
+struct _HyScanDeviceGroupPrivate
+{
+  GPtrArray                   *devices;        /* Устройства группы. */
+  HyScanDataSchema            *schema;         /* Объединённая схема устройств. */
+
+  GHashTable                  *sources;        /* Устройства по источникам данных. */
+  GHashTable                  *sensors;        /* Устройства по названиям датчиков. */
+  GHashTable                  *actuators;      /* Устройства по названиям приводов. */
+  GHashTable                  *params;         /* Устройства по названиям параметров. */
+
+  GMutex                       lock;           /* Блокировка. */
+  GHashTable                  *skews;          /* Отклонения времени запуска устройств. */
+};
+
+static void            hyscan_device_group_param_interface_init    (HyScanParamInterface     *iface);
+static void            hyscan_device_group_device_interface_init   (HyScanDeviceInterface    *iface);
+static void            hyscan_device_group_sonar_interface_init    (HyScanSonarInterface     *iface);
+static void            hyscan_device_group_sensor_interface_init   (HyScanSensorInterface    *iface);
+static void            hyscan_device_group_actuator_interface_init (HyScanActuatorInterface  *iface);
+
+static void            hyscan_device_group_object_constructed      (GObject                  *object);
+static void            hyscan_device_group_object_finalize         (GObject                  *object);
+
+static void            hyscan_device_group_update                  (HyScanDeviceGroup        *group);
+
+static gint64          hyscan_device_group_barrier_wait            (HyScanDeviceGroupBarrier *barrier,
+                                                                    gboolean                  ready,
+                                                                    gint64                    latency);
+static gpointer        hyscan_device_group_job_func                (gpointer                  data);
+static gboolean        hyscan_device_group_run                     (HyScanDeviceGroup        *group,
+                                                                    GType                     type,
+                                                                    HyScanDeviceGroupFunc     prepare,
+                                                                    HyScanDeviceGroupFunc     func,
+                                                                    HyScanDeviceGroupFunc     rollback,
+                                                                    gpointer                  data,
+                                                                    gboolean                  coordinated);
+
+static void            hyscan_device_group_device_state            (HyScanDevice             *device,
+                                                                    const gchar              *dev_id,
+                                                                    HyScanDeviceGroup        *group);
+static void            hyscan_device_group_device_log              (HyScanDevice             *device,
+                                                                    const gchar              *source,
+                                                                    gint64                    time,
+                                                                    gint                      level,
+                                                                    const gchar              *message,
+                                                                    HyScanDeviceGroup        *group);
+static void            hyscan_device_group_sonar_source_info       (HyScanSonar              *sonar,
+                                                                    gint                      source,
+                                                                    guint                     channel,
+                                                                    const gchar              *description,
+                                                                    const gchar              *actuator,
+                                                                    gpointer                  info,
+                                                                    HyScanDeviceGroup        *group);
+static void            hyscan_device_group_sonar_signal            (HyScanSonar              *sonar,
+                                                                    gint                      source,
+                                                                    guint                     channel,
+                                                                    gint64                    time,
+                                                                    HyScanBuffer             *image,
+                                                                    HyScanDeviceGroup        *group);
+static void            hyscan_device_group_sonar_tvg               (HyScanSonar              *sonar,
+                                                                    gint                      source,
+                                                                    guint                     channel,
+                                                                    gint64                    time,
+                                                                    HyScanBuffer             *gains,
+                                                                    HyScanDeviceGroup        *group);
+static void            hyscan_device_group_sonar_acoustic_data     (HyScanSonar              *sonar,
+                                                                    gint                      source,
+                                                                    guint                     channel,
+                                                                    gboolean                  noise,
+                                                                    gint64                    time,
+                                                                    HyScanBuffer             *data,
+                                                                    HyScanDeviceGroup        *group);
+static void            hyscan_device_group_sensor_data             (HyScanSensor             *sensor,
+                                                                    const gchar              *name,
+                                                                    gint                      source,
+                                                                    gint64                    time,
+                                                                    HyScanBuffer             *data,
+                                                                    HyScanDeviceGroup        *group);
+
+G_DEFINE_TYPE_WITH_CODE (HyScanDeviceGroup, hyscan_device_group, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (HyScanDeviceGroup)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_PARAM, hyscan_device_group_param_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_DEVICE, hyscan_device_group_device_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_SONAR, hyscan_device_group_sonar_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_SENSOR, hyscan_device_group_sensor_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_ACTUATOR, hyscan_device_group_actuator_interface_init))
+
+static void
+hyscan_device_group_class_init (HyScanDeviceGroupClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->constructed = hyscan_device_group_object_constructed;
+  object_class->finalize = hyscan_device_group_object_finalize;
+}
+
+static void
+hyscan_device_group_init (HyScanDeviceGroup *group)
+{
+  group->priv = hyscan_device_group_get_instance_private (group);
+}
+
+static void
+hyscan_device_group_object_constructed (GObject *object)
+{
+  HyScanDeviceGroup *group = HYSCAN_DEVICE_GROUP (object);
+  HyScanDeviceGroupPrivate *priv = group->priv;
+
+  priv->devices = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_mutex_init (&priv->lock);
+  priv->skews = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+
+  hyscan_device_group_update (group);
+}
+
+static void
+hyscan_device_group_object_finalize (GObject *object)
+{
+  HyScanDeviceGroup *group = HYSCAN_DEVICE_GROUP (object);
+  HyScanDeviceGroupPrivate *priv = group->priv;
+  guint i;
+
+  for (i = 0; i < priv->devices->len; i++)
+    g_signal_handlers_disconnect_by_data (g_ptr_array_index (priv->devices, i), group);
+
+  g_ptr_array_unref (priv->devices);
+  g_clear_object (&priv->schema);
+
+  g_hash_table_unref (priv->sources);
+  g_hash_table_unref (priv->sensors);
+  g_hash_table_unref (priv->actuators);
+  g_hash_table_unref (priv->params);
+
+  g_hash_table_unref (priv->skews);
+  g_mutex_clear (&priv->lock);
+
+  G_OBJECT_CLASS (hyscan_device_group_parent_class)->finalize (object);
+}
+
+/* Функция создаёт объединённую схему устройств и таблицы соответствия
+ * источников данных, датчиков, приводов и параметров устройствам. */
+static void
+hyscan_device_group_update (HyScanDeviceGroup *group)
+{
+  static const gchar *branches[] = { "/params", "/system", "/state" };
+
+  HyScanDeviceGroupPrivate *priv = group->priv;
+  HyScanDeviceSchema *device_schema;
+  HyScanSonarSchema *sonar_schema;
+  HyScanSensorSchema *sensor_schema;
+  HyScanActuatorSchema *actuator_schema;
+  HyScanDataSchemaBuilder *builder;
+  guint i, j;
+
+  g_clear_object (&priv->schema);
+  g_clear_pointer (&priv->sources, g_hash_table_unref);
+  g_clear_pointer (&priv->sensors, g_hash_table_unref);
+  g_clear_pointer (&priv->actuators, g_hash_table_unref);
+  g_clear_pointer (&priv->params, g_hash_table_unref);
+
+  priv->sources = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->sensors = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  priv->actuators = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  priv->params = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  device_schema = hyscan_device_schema_new (HYSCAN_DEVICE_SCHEMA_VERSION);
+  sonar_schema = hyscan_sonar_schema_new (device_schema);
+  sensor_schema = hyscan_sensor_schema_new (device_schema);
+  actuator_schema = hyscan_actuator_schema_new (device_schema);
+  builder = HYSCAN_DATA_SCHEMA_BUILDER (device_schema);
+
+  for (i = 0; i < priv->devices->len; i++)
+    {
+      GObject *device = g_ptr_array_index (priv->devices, i);
+      HyScanDataSchema *schema;
+      const gchar * const *keys;
+
+      if (!HYSCAN_IS_PARAM (device))
+        continue;
+
+      schema = hyscan_param_schema (HYSCAN_PARAM (device));
+      if (schema == NULL)
+        continue;
+
+      /* Источники гидролокационных данных. */
+      if (HYSCAN_IS_SONAR (device))
+        {
+          HyScanSonarInfo *info = hyscan_sonar_info_new (schema);
+          const HyScanSourceType *sources;
+          guint32 n_sources = 0;
+
+          sources = (info != NULL) ? hyscan_sonar_info_list_sources (info, &n_sources) : NULL;
+          for (j = 0; j < n_sources; j++)
+            {
+              const HyScanSonarInfoSource *source = hyscan_sonar_info_get_source (info, sources[j]);
+
+              if (!hyscan_sonar_schema_source_add_full (sonar_schema, (HyScanSonarInfoSource *)source))
+                {
+                  g_warning ("HyScanDeviceGroup: can't add source %d", sources[j]);
+                  continue;
+                }
+
+              g_hash_table_insert (priv->sources, GINT_TO_POINTER (sources[j]), device);
+            }
+
+          g_clear_object (&info);
+        }
+
+      /* Датчики. */
+      if (HYSCAN_IS_SENSOR (device))
+        {
+          HyScanSensorInfo *info = hyscan_sensor_info_new (schema);
+          const gchar * const *sensors;
+
+          sensors = (info != NULL) ? hyscan_sensor_info_list_sensors (info) : NULL;
+          for (j = 0; (sensors != NULL) && (sensors[j] != NULL); j++)
+            {
+              const HyScanSensorInfoSensor *sensor = hyscan_sensor_info_get_sensor (info, sensors[j]);
+
+              if (!hyscan_sensor_schema_add_full (sensor_schema, (HyScanSensorInfoSensor *)sensor))
+                {
+                  g_warning ("HyScanDeviceGroup: can't add sensor %s", sensors[j]);
+                  continue;
+                }
+
+              g_hash_table_insert (priv->sensors, g_strdup (sensors[j]), device);
+            }
+
+          g_clear_object (&info);
+        }
+
+      /* Приводы. */
+      if (HYSCAN_IS_ACTUATOR (device))
+        {
+          HyScanActuatorInfo *info = hyscan_actuator_info_new (schema);
+          const gchar * const *actuators;
+
+          actuators = (info != NULL) ? hyscan_actuator_info_list_actuators (info) : NULL;
+          for (j = 0; (actuators != NULL) && (actuators[j] != NULL); j++)
+            {
+              const HyScanActuatorInfoActuator *actuator = hyscan_actuator_info_get_actuator (info, actuators[j]);
+
+              if (!hyscan_actuator_schema_add_full (actuator_schema, (HyScanActuatorInfoActuator *)actuator))
+                {
+                  g_warning ("HyScanDeviceGroup: can't add actuator %s", actuators[j]);
+                  continue;
+                }
+
+              g_hash_table_insert (priv->actuators, g_strdup (actuators[j]), device);
+            }
+
+          g_clear_object (&info);
+        }
+
+      /* Параметры и состояние устройства. */
+      for (j = 0; j < G_N_ELEMENTS (branches); j++)
+        hyscan_data_schema_builder_schema_join (builder, branches[j], schema, branches[j]);
+
+      keys = hyscan_data_schema_list_keys (schema);
+      for (j = 0; (keys != NULL) && (keys[j] != NULL); j++)
+        {
+          if (!g_str_has_prefix (keys[j], "/params/") &&
+              !g_str_has_prefix (keys[j], "/system/") &&
+              !g_str_has_prefix (keys[j], "/state/"))
+            {
+              continue;
+            }
+
+          if (g_hash_table_contains (priv->params, keys[j]))
+            {
+              g_warning ("HyScanDeviceGroup: duplicate parameter %s", keys[j]);
+              continue;
+            }
+
+          g_hash_table_insert (priv->params, g_strdup (keys[j]), device);
+        }
+
+      g_object_unref (schema);
+    }
+
+  priv->schema = hyscan_data_schema_builder_get_schema (builder);
+
+  g_object_unref (sonar_schema);
+  g_object_unref (sensor_schema);
+  g_object_unref (actuator_schema);
+  g_object_unref (device_schema);
+}
+
+/* Функция ожидает готовности всех устройств и возвращает общее время
+ * запуска или отрицательное число, если запуск отменён. Время запуска
+ * назначается с запасом на максимальную задержку команды. */
+static gint64
+hyscan_device_group_barrier_wait (HyScanDeviceGroupBarrier *barrier,
+                                  gboolean                  ready,
+                                  gint64                    latency)
+{
+  gint64 release;
+
+  g_mutex_lock (&barrier->lock);
+
+  if (!ready)
+    barrier->abort = TRUE;
+
+  barrier->latency = MAX (barrier->latency, latency);
+
+  barrier->n_ready += 1;
+  if (barrier->n_ready == barrier->n_jobs)
+    {
+      barrier->release = g_get_monotonic_time () + barrier->latency + HYSCAN_DEVICE_GROUP_RELEASE_DELAY;
+      g_cond_broadcast (&barrier->cond);
+    }
+  else
+    {
+      while (barrier->n_ready < barrier->n_jobs)
+        g_cond_wait (&barrier->cond, &barrier->lock);
+    }
+
+  release = barrier->abort ? -1 : barrier->release;
+
+  g_mutex_unlock (&barrier->lock);
+
+  return release;
+}
+
+/* Функция выполнения операции с одним устройством в отдельном потоке. */
+static gpointer
+hyscan_device_group_job_func (gpointer data)
+{
+  HyScanDeviceGroupJob *job = data;
+  gint64 release, issue, delta;
+  gint64 begin, end;
+  gint64 latency = 0;
+  gboolean ready = TRUE;
+
+  if (job->barrier == NULL)
+    {
+      job->status = job->func (job->device, job->data);
+      job->started = TRUE;
+      return NULL;
+    }
+
+  /* Подготовка устройства и ожидание остальных устройств. Половина
+   * времени подготовки используется как оценка задержки команды. */
+  if (job->prepare != NULL)
+    {
+      begin = g_get_monotonic_time ();
+      ready = job->prepare (job->device, NULL);
+      end = g_get_monotonic_time ();
+
+      latency = (end - begin) / 2;
+    }
+
+  release = hyscan_device_group_barrier_wait (job->barrier, ready, latency);
+  if (release < 0)
+    {
+      job->status = FALSE;
+      return NULL;
+    }
+
+  /* Команда передаётся раньше общего времени на величину задержки.
+   * Последние доли миллисекунды ожидаем активно, чтобы не зависеть
+   * от точности планировщика. */
+  issue = release - latency;
+  while ((delta = issue - g_get_monotonic_time ()) > 0)
+    {
+      if (delta > HYSCAN_DEVICE_GROUP_SPIN_TIME)
+        g_usleep (delta - HYSCAN_DEVICE_GROUP_SPIN_TIME);
+    }
+
+  /* Время запуска устройства оцениваем серединой вызова. */
+  begin = g_get_monotonic_time ();
+  job->status = job->func (job->device, job->data);
+  end = g_get_monotonic_time ();
+
+  job->started = TRUE;
+  job->skew = (begin + end) / 2 - release;
+
+  return NULL;
+}
+
+/* Функция выполняет операцию одновременно для всех устройств группы,
+ * реализующих указанный интерфейс. Если задан признак coordinated,
+ * устройства сначала подготавливаются функцией prepare, а затем
+ * операция выполняется для всех устройств в общий момент времени. Если
+ * операция завершилась ошибкой хотя бы для одного устройства, для
+ * устройств, успешно её выполнивших, вызывается функция rollback. */
+static gboolean
+hyscan_device_group_run (HyScanDeviceGroup     *group,
+                         GType                  type,
+                         HyScanDeviceGroupFunc  prepare,
+                         HyScanDeviceGroupFunc  func,
+                         HyScanDeviceGroupFunc  rollback,
+                         gpointer               data,
+                         gboolean               coordinated)
+{
+  HyScanDeviceGroupPrivate *priv = group->priv;
+  HyScanDeviceGroupBarrier barrier;
+  HyScanDeviceGroupJob *jobs;
+  GThread **threads;
+  gboolean status = TRUE;
+  guint n_jobs = 0;
+  guint i;
+
+  jobs = g_new0 (HyScanDeviceGroupJob, priv->devices->len);
+  threads = g_new0 (GThread *, priv->devices->len);
+
+  for (i = 0; i < priv->devices->len; i++)
+    {
+      GObject *device = g_ptr_array_index (priv->devices, i);
+
+      if (!G_TYPE_CHECK_INSTANCE_TYPE (device, type))
+        continue;
+
+      jobs[n_jobs].prepare = prepare;
+      jobs[n_jobs].func = func;
+      jobs[n_jobs].device = device;
+      jobs[n_jobs].data = data;
+      jobs[n_jobs].barrier = coordinated ? &barrier : NULL;
+      n_jobs += 1;
+    }
+
+  g_mutex_init (&barrier.lock);
+  g_cond_init (&barrier.cond);
+  barrier.n_jobs = n_jobs;
+  barrier.n_ready = 0;
+  barrier.abort = FALSE;
+  barrier.latency = 0;
+  barrier.release = 0;
+
+  /* Единственное устройство обрабатывается без создания потока. */
+  if (n_jobs == 1)
+    {
+      hyscan_device_group_job_func (&jobs[0]);
+    }
+  else
+    {
+      for (i = 0; i < n_jobs; i++)
+        threads[i] = g_thread_new ("device-group", hyscan_device_group_job_func, &jobs[i]);
+
+      for (i = 0; i < n_jobs; i++)
+        g_thread_join (threads[i]);
+    }
+
+  for (i = 0; i < n_jobs; i++)
+    status = status && jobs[i].status;
+
+  /* Отменяем операцию для устройств, успешно её выполнивших. */
+  if (!status && (rollback != NULL))
+    {
+      for (i = 0; i < n_jobs; i++)
+        {
+          if (jobs[i].started && jobs[i].status)
+            rollback (jobs[i].device, NULL);
+        }
+    }
+
+  /* Отклонения времени запуска устройств. */
+  if (coordinated)
+    {
+      g_mutex_lock (&priv->lock);
+
+      g_hash_table_remove_all (priv->skews);
+      for (i = 0; i < n_jobs; i++)
+        {
+          gint64 *skew;
+
+          if (!jobs[i].started)
+            continue;
+
+          skew = g_new (gint64, 1);
+          *skew = jobs[i].skew;
+          g_hash_table_insert (priv->skews, jobs[i].device, skew);
+        }
+
+      g_mutex_unlock (&priv->lock);
+    }
+
+  g_cond_clear (&barrier.cond);
+  g_mutex_clear (&barrier.lock);
+
+  g_free (threads);
+  g_free (jobs);
+
+  return status;
+}
+
+/* Обработчик сигнала device-state устройства. */
+static void
+hyscan_device_group_device_state (HyScanDevice      *device,
+                                  const gchar       *dev_id,
+                                  HyScanDeviceGroup *group)
+{
+  g_signal_emit_by_name (group, "device-state", dev_id);
+}
+
+/* Обработчик сигнала device-log устройства. */
+static void
+hyscan_device_group_device_log (HyScanDevice      *device,
+                                const gchar       *source,
+                                gint64             time,
+                                gint               level,
+                                const gchar       *message,
+                                HyScanDeviceGroup *group)
+{
+  g_signal_emit_by_name (group, "device-log", source, time, level, message);
+}
+
+/* Обработчик сигнала sonar-source-info устройства. */
+static void
+hyscan_device_group_sonar_source_info (HyScanSonar       *sonar,
+                                       gint               source,
+                                       guint              channel,
+                                       const gchar       *description,
+                                       const gchar       *actuator,
+                                       gpointer           info,
+                                       HyScanDeviceGroup *group)
+{
+  g_signal_emit_by_name (group, "sonar-source-info", source, channel, description, actuator, info);
+}
+
+/* Обработчик сигнала sonar-signal устройства. */
+static void
+hyscan_device_group_sonar_signal (HyScanSonar       *sonar,
+                                  gint               source,
+                                  guint              channel,
+                                  gint64             time,
+                                  HyScanBuffer      *image,
+                                  HyScanDeviceGroup *group)
+{
+  g_signal_emit_by_name (group, "sonar-signal", source, channel, time, image);
+}
+
+/* Обработчик сигнала sonar-tvg устройства. */
+static void
+hyscan_device_group_sonar_tvg (HyScanSonar       *sonar,
+                               gint               source,
+                               guint              channel,
+                               gint64             time,
+                               HyScanBuffer      *gains,
+                               HyScanDeviceGroup *group)
+{
+  g_signal_emit_by_name (group, "sonar-tvg", source, channel, time, gains);
+}
+
+/* Обработчик сигнала sonar-acoustic-data устройства. */
+static void
+hyscan_device_group_sonar_acoustic_data (HyScanSonar       *sonar,
+                                         gint               source,
+                                         guint              channel,
+                                         gboolean           noise,
+                                         gint64             time,
+                                         HyScanBuffer      *data,
+                                         HyScanDeviceGroup *group)
+{
+  g_signal_emit_by_name (group, "sonar-acoustic-data", source, channel, noise, time, data);
+}
+
+/* Обработчик сигнала sensor-data устройства. */
+static void
+hyscan_device_group_sensor_data (HyScanSensor      *sensor,
+                                 const gchar       *name,
+                                 gint               source,
+                                 gint64             time,
+                                 HyScanBuffer      *data,
+                                 HyScanDeviceGroup *group)
+{
+  g_signal_emit_by_name (group, "sensor-data", name, source, time, data);
+}
+
+static gboolean
+hyscan_device_group_sync_func (GObject  *device,
+                               gpointer  data)
+{
+  return hyscan_device_sync (HYSCAN_DEVICE (device));
+}
+
+static gboolean
+hyscan_device_group_sound_velocity_func (GObject  *device,
+                                         gpointer  data)
+{
+  return hyscan_device_set_sound_velocity (HYSCAN_DEVICE (device), data);
+}
+
+static gboolean
+hyscan_device_group_disconnect_func (GObject  *device,
+                                     gpointer  data)
+{
+  return hyscan_device_disconnect (HYSCAN_DEVICE (device));
+}
+
+static gboolean
+hyscan_device_group_start_func (GObject  *device,
+                                gpointer  data)
+{
+  HyScanDeviceGroupStart *start = data;
+
+  return hyscan_sonar_start (HYSCAN_SONAR (device),
+                             start->project_name, start->track_name,
+                             start->track_type, start->track_plan);
+}
+
+static gboolean
+hyscan_device_group_stop_func (GObject  *device,
+                               gpointer  data)
+{
+  return hyscan_sonar_stop (HYSCAN_SONAR (device));
+}
+
+static gboolean
+hyscan_device_group_configure_func (GObject  *device,
+                                    gpointer  data)
+{
+  HyScanSonarConfig *config = g_hash_table_lookup (data, device);
+
+  if (config == NULL)
+    return TRUE;
+
+  return hyscan_sonar_configure (HYSCAN_SONAR (device), config);
+}
+
+static HyScanDataSchema *
+hyscan_device_group_param_schema (HyScanParam *param)
+{
+  HyScanDeviceGroup *group = HYSCAN_DEVICE_GROUP (param);
+
+  return g_object_ref (group->priv->schema);
+}
+
+/* Функция разделяет список параметров по устройствам и выполняет для
+ * каждого устройства запись или чтение его параметров. */
+static gboolean
+hyscan_device_group_param_io (HyScanDeviceGroup *group,
+                              HyScanParamList   *list,
+                              gboolean           set)
+{
+  HyScanDeviceGroupPrivate *priv = group->priv;
+  const gchar * const *keys;
+  GHashTable *lists;
+  GHashTableIter iter;
+  gpointer device, device_list;
+  gboolean status = TRUE;
+  guint i;
+
+  keys = hyscan_param_list_params (list);
+  if (keys == NULL)
+    return TRUE;
+
+  lists = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_object_unref);
+
+  for (i = 0; keys[i] != NULL; i++)
+    {
+      device = g_hash_table_lookup (priv->params, keys[i]);
+      if (device == NULL)
+        {
+          status = FALSE;
+          goto exit;
+        }
+
+      device_list = g_hash_table_lookup (lists, device);
+      if (device_list == NULL)
+        {
+          device_list = hyscan_param_list_new ();
+          g_hash_table_insert (lists, device, device_list);
+        }
+
+      if (set)
+        {
+          GVariant *value = hyscan_param_list_get (list, keys[i]);
+
+          hyscan_param_list_set (device_list, keys[i], value);
+          g_clear_pointer (&value, g_variant_unref);
+        }
+      else
+        {
+          hyscan_param_list_add (device_list, keys[i]);
+        }
+    }
+
+  g_hash_table_iter_init (&iter, lists);
+  while (status && g_hash_table_iter_next (&iter, &device, &device_list))
+    {
+      if (set)
+        {
+          status = hyscan_param_set (HYSCAN_PARAM (device), device_list);
+          continue;
+        }
+
+      status = hyscan_param_get (HYSCAN_PARAM (device), device_list);
+      if (!status)
+        continue;
+
+      keys = hyscan_param_list_params (device_list);
+      for (i = 0; (keys != NULL) && (keys[i] != NULL); i++)
+        {
+          GVariant *value = hyscan_param_list_get (device_list, keys[i]);
+
+          hyscan_param_list_set (list, keys[i], value);
+          g_clear_pointer (&value, g_variant_unref);
+        }
+    }
+
+exit:
+  g_hash_table_unref (lists);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_group_param_set (HyScanParam     *param,
+                               HyScanParamList *list)
+{
+  return hyscan_device_group_param_io (HYSCAN_DEVICE_GROUP (param), list, TRUE);
+}
+
+static gboolean
+hyscan_device_group_param_get (HyScanParam     *param,
+                               HyScanParamList *list)
+{
+  return hyscan_device_group_param_io (HYSCAN_DEVICE_GROUP (param), list, FALSE);
+}
+
+static gboolean
+hyscan_device_group_device_sync (HyScanDevice *device)
+{
+  return hyscan_device_group_run (HYSCAN_DEVICE_GROUP (device), HYSCAN_TYPE_DEVICE,
+                                  NULL, hyscan_device_group_sync_func, NULL, NULL, FALSE);
+}
+
+static gboolean
+hyscan_device_group_device_set_sound_velocity (HyScanDevice *device,
+                                               GList        *svp)
+{
+  return hyscan_device_group_run (HYSCAN_DEVICE_GROUP (device), HYSCAN_TYPE_DEVICE,
+                                  NULL, hyscan_device_group_sound_velocity_func, NULL, svp, FALSE);
+}
+
+static gboolean
+hyscan_device_group_device_disconnect (HyScanDevice *device)
+{
+  return hyscan_device_group_run (HYSCAN_DEVICE_GROUP (device), HYSCAN_TYPE_DEVICE,
+                                  NULL, hyscan_device_group_disconnect_func, NULL, NULL, FALSE);
+}
+
+/* Функция возвращает гидролокатор, которому принадлежит источник данных. */
+static HyScanSonar *
+hyscan_device_group_get_sonar (HyScanSonar      *sonar,
+                               HyScanSourceType  source)
+{
+  HyScanDeviceGroup *group = HYSCAN_DEVICE_GROUP (sonar);
+
+  return g_hash_table_lookup (group->priv->sources, GINT_TO_POINTER (source));
+}
+
+static gboolean
+hyscan_device_group_sonar_antenna_set_offset (HyScanSonar               *sonar,
+                                              HyScanSourceType           source,
+                                              const HyScanAntennaOffset *offset)
+{
+  HyScanSonar *device = hyscan_device_group_get_sonar (sonar, source);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sonar_antenna_set_offset (device, source, offset);
+}
+
+static gboolean
+hyscan_device_group_sonar_receiver_set_time (HyScanSonar      *sonar,
+                                             HyScanSourceType  source,
+                                             gdouble           receive_time,
+                                             gdouble           wait_time)
+{
+  HyScanSonar *device = hyscan_device_group_get_sonar (sonar, source);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sonar_receiver_set_time (device, source, receive_time, wait_time);
+}
+
+static gboolean
+hyscan_device_group_sonar_receiver_set_auto (HyScanSonar      *sonar,
+                                             HyScanSourceType  source)
+{
+  HyScanSonar *device = hyscan_device_group_get_sonar (sonar, source);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sonar_receiver_set_auto (device, source);
+}
+
+static gboolean
+hyscan_device_group_sonar_receiver_disable (HyScanSonar      *sonar,
+                                            HyScanSourceType  source)
+{
+  HyScanSonar *device = hyscan_device_group_get_sonar (sonar, source);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sonar_receiver_disable (device, source);
+}
+
+static gboolean
+hyscan_device_group_sonar_generator_set_preset (HyScanSonar      *sonar,
+                                                HyScanSourceType  source,
+                                                gint64            preset)
+{
+  HyScanSonar *device = hyscan_device_group_get_sonar (sonar, source);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sonar_generator_set_preset (device, source, preset);
+}
+
+static gboolean
+hyscan_device_group_sonar_generator_disable (HyScanSonar      *sonar,
+                                             HyScanSourceType  source)
+{
+  HyScanSonar *device = hyscan_device_group_get_sonar (sonar, source);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sonar_generator_disable (device, source);
+}
+
+static gboolean
+hyscan_device_group_sonar_tvg_set_auto (HyScanSonar      *sonar,
+                                        HyScanSourceType  source,
+                                        gdouble           level,
+                                        gdouble           sensitivity)
+{
+  HyScanSonar *device = hyscan_device_group_get_sonar (sonar, source);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sonar_tvg_set_auto (device, source, level, sensitivity);
+}
+
+static gboolean
+hyscan_device_group_sonar_tvg_set_constant (HyScanSonar      *sonar,
+                                            HyScanSourceType  source,
+                                            gdouble           gain)
+{
+  HyScanSonar *device = hyscan_device_group_get_sonar (sonar, source);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sonar_tvg_set_constant (device, source, gain);
+}
+
+static gboolean
+hyscan_device_group_sonar_tvg_set_linear_db (HyScanSonar      *sonar,
+                                             HyScanSourceType  source,
+                                             gdouble           gain0,
+                                             gdouble           gain_step)
+{
+  HyScanSonar *device = hyscan_device_group_get_sonar (sonar, source);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sonar_tvg_set_linear_db (device, source, gain0, gain_step);
+}
+
+static gboolean
+hyscan_device_group_sonar_tvg_set_logarithmic (HyScanSonar      *sonar,
+                                               HyScanSourceType  source,
+                                               gdouble           gain0,
+                                               gdouble           beta,
+                                               gdouble           alpha)
+{
+  HyScanSonar *device = hyscan_device_group_get_sonar (sonar, source);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sonar_tvg_set_logarithmic (device, source, gain0, beta, alpha);
+}
+
+static gboolean
+hyscan_device_group_sonar_tvg_disable (HyScanSonar      *sonar,
+                                       HyScanSourceType  source)
+{
+  HyScanSonar *device = hyscan_device_group_get_sonar (sonar, source);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sonar_tvg_disable (device, source);
+}
+
+static gboolean
+hyscan_device_group_sonar_start (HyScanSonar           *sonar,
+                                 const gchar           *project_name,
+                                 const gchar           *track_name,
+                                 HyScanTrackType        track_type,
+                                 const HyScanTrackPlan *track_plan)
+{
+  HyScanDeviceGroupStart start;
+
+  start.project_name = project_name;
+  start.track_name = track_name;
+  start.track_type = track_type;
+  start.track_plan = track_plan;
+
+  return hyscan_device_group_run (HYSCAN_DEVICE_GROUP (sonar), HYSCAN_TYPE_SONAR,
+                                  hyscan_device_group_sync_func,
+                                  hyscan_device_group_start_func,
+                                  hyscan_device_group_stop_func, &start, TRUE);
+}
+
+static gboolean
+hyscan_device_group_sonar_stop (HyScanSonar *sonar)
+{
+  return hyscan_device_group_run (HYSCAN_DEVICE_GROUP (sonar), HYSCAN_TYPE_SONAR,
+                                  NULL, hyscan_device_group_stop_func, NULL, NULL, TRUE);
+}
+
+/* Пакет параметров разделяется по устройствам и применяется для всех
+ * устройств одновременно. */
+static gboolean
+hyscan_device_group_sonar_configure (HyScanSonar       *sonar,
+                                     HyScanSonarConfig *config)
+{
+  HyScanDeviceGroup *group = HYSCAN_DEVICE_GROUP (sonar);
+  const HyScanSourceType *sources;
+  GHashTable *configs;
+  gboolean status = FALSE;
+  guint32 n_sources;
+  guint32 i;
+
+  configs = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_object_unref);
+
+  sources = hyscan_sonar_config_list_sources (config, &n_sources);
+  for (i = 0; i < n_sources; i++)
+    {
+      HyScanSonar *device = hyscan_device_group_get_sonar (sonar, sources[i]);
+      HyScanSonarConfig *device_config;
+
+      if (device == NULL)
+        goto exit;
+
+      device_config = g_hash_table_lookup (configs, device);
+      if (device_config == NULL)
+        {
+          device_config = hyscan_sonar_config_new ();
+          g_hash_table_insert (configs, device, device_config);
+        }
+
+      hyscan_sonar_config_set_source (device_config, hyscan_sonar_config_get_source (config, sources[i]));
+    }
+
+  status = hyscan_device_group_run (group, HYSCAN_TYPE_SONAR,
+                                    NULL, hyscan_device_group_configure_func, NULL, configs, FALSE);
+
+exit:
+  g_hash_table_unref (configs);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_group_sensor_antenna_set_offset (HyScanSensor              *sensor,
+                                               const gchar               *name,
+                                               const HyScanAntennaOffset *offset)
+{
+  HyScanDeviceGroup *group = HYSCAN_DEVICE_GROUP (sensor);
+  HyScanSensor *device = g_hash_table_lookup (group->priv->sensors, name);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sensor_antenna_set_offset (device, name, offset);
+}
+
+static gboolean
+hyscan_device_group_sensor_set_enable (HyScanSensor *sensor,
+                                       const gchar  *name,
+                                       gboolean      enable)
+{
+  HyScanDeviceGroup *group = HYSCAN_DEVICE_GROUP (sensor);
+  HyScanSensor *device = g_hash_table_lookup (group->priv->sensors, name);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_sensor_set_enable (device, name, enable);
+}
+
+static gboolean
+hyscan_device_group_actuator_disable (HyScanActuator *actuator,
+                                      const gchar    *name)
+{
+  HyScanDeviceGroup *group = HYSCAN_DEVICE_GROUP (actuator);
+  HyScanActuator *device = g_hash_table_lookup (group->priv->actuators, name);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_actuator_disable (device, name);
+}
+
+static gboolean
+hyscan_device_group_actuator_scan (HyScanActuator *actuator,
+                                   const gchar    *name,
+                                   gdouble         from,
+                                   gdouble         to,
+                                   gdouble         speed)
+{
+  HyScanDeviceGroup *group = HYSCAN_DEVICE_GROUP (actuator);
+  HyScanActuator *device = g_hash_table_lookup (group->priv->actuators, name);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_actuator_scan (device, name, from, to, speed);
+}
+
+static gboolean
+hyscan_device_group_actuator_manual (HyScanActuator *actuator,
+                                     const gchar    *name,
+                                     gdouble         angle)
+{
+  HyScanDeviceGroup *group = HYSCAN_DEVICE_GROUP (actuator);
+  HyScanActuator *device = g_hash_table_lookup (group->priv->actuators, name);
+
+  if (device == NULL)
+    return FALSE;
+
+  return hyscan_actuator_manual (device, name, angle);
+}
+
+/**
+ * hyscan_device_group_new:
+ *
+ * Функция создаёт новый объект #HyScanDeviceGroup.
+ *
+ * Returns: #HyScanDeviceGroup. Для удаления #g_object_unref.
+ */
+HyScanDeviceGroup *
+hyscan_device_group_new (void)
+{
+  return g_object_new (HYSCAN_TYPE_DEVICE_GROUP, NULL);
+}
+
+/**
+ * hyscan_device_group_add:
+ * @group: указатель на #HyScanDeviceGroup
+ * @device: указатель на #HyScanDevice
+ *
+ * Функция добавляет устройство в группу. Устройство должно реализовывать
+ * интерфейс #HyScanParam. Описание источников данных, датчиков и приводов
+ * устройства добавляется в схему группы, а его сигналы начинают
+ * передаваться через группу.
+ *
+ * Returns: %TRUE если устройство добавлено, иначе %FALSE.
+ */
+gboolean
+hyscan_device_group_add (HyScanDeviceGroup *group,
+                         HyScanDevice      *device)
+{
+  HyScanDeviceGroupPrivate *priv;
+
+  g_return_val_if_fail (HYSCAN_IS_DEVICE_GROUP (group), FALSE);
+  g_return_val_if_fail (HYSCAN_IS_DEVICE (device), FALSE);
+  g_return_val_if_fail ((gpointer)device != (gpointer)group, FALSE);
+
+  priv = group->priv;
+
+  if (!HYSCAN_IS_PARAM (device))
+    {
+      g_warning ("HyScanDeviceGroup: device doesn't implement HyScanParam");
+      return FALSE;
+    }
+
+  g_ptr_array_add (priv->devices, g_object_ref (device));
+  hyscan_device_group_update (group);
+
+  g_signal_connect (device, "device-state",
+                    G_CALLBACK (hyscan_device_group_device_state), group);
+  g_signal_connect (device, "device-log",
+                    G_CALLBACK (hyscan_device_group_device_log), group);
+
+  if (HYSCAN_IS_SONAR (device))
+    {
+      g_signal_connect (device, "sonar-source-info",
+                        G_CALLBACK (hyscan_device_group_sonar_source_info), group);
+      g_signal_connect (device, "sonar-signal",
+                        G_CALLBACK (hyscan_device_group_sonar_signal), group);
+      g_signal_connect (device, "sonar-tvg",
+                        G_CALLBACK (hyscan_device_group_sonar_tvg), group);
+      g_signal_connect (device, "sonar-acoustic-data",
+                        G_CALLBACK (hyscan_device_group_sonar_acoustic_data), group);
+    }
+
+  if (HYSCAN_IS_SENSOR (device))
+    {
+      g_signal_connect (device, "sensor-data",
+                        G_CALLBACK (hyscan_device_group_sensor_data), group);
+    }
+
+  return TRUE;
+}
+
+/**
+ * hyscan_device_group_get_skew:
+ * @group: указатель на #HyScanDeviceGroup
+ * @device: указатель на #HyScanDevice
+ * @skew: (out): отклонение времени запуска, мкс
+ *
+ * Функция возвращает отклонение времени последнего запуска или останова
+ * устройства от общего времени запуска группы. Время запуска устройства
+ * оценивается как середина вызова функции #hyscan_sonar_start или
+ * #hyscan_sonar_stop.
+ *
+ * Returns: %TRUE если отклонение определено, иначе %FALSE.
+ */
+gboolean
+hyscan_device_group_get_skew (HyScanDeviceGroup *group,
+                              HyScanDevice      *device,
+                              gint64            *skew)
+{
+  HyScanDeviceGroupPrivate *priv;
+  gint64 *value;
+
+  g_return_val_if_fail (HYSCAN_IS_DEVICE_GROUP (group), FALSE);
+
+  priv = group->priv;
+
+  g_mutex_lock (&priv->lock);
+
+  value = g_hash_table_lookup (priv->skews, device);
+  if ((value != NULL) && (skew != NULL))
+    *skew = *value;
+
+  g_mutex_unlock (&priv->lock);
+
+  return (value != NULL);
+}
+
+static void
+hyscan_device_group_param_interface_init (HyScanParamInterface *iface)
+{
+  iface->schema = hyscan_device_group_param_schema;
+  iface->set = hyscan_device_group_param_set;
+  iface->get = hyscan_device_group_param_get;
+}
+
+static void
+hyscan_device_group_device_interface_init (HyScanDeviceInterface *iface)
+{
+  iface->sync = hyscan_device_group_device_sync;
+  iface->set_sound_velocity = hyscan_device_group_device_set_sound_velocity;
+  iface->disconnect = hyscan_device_group_device_disconnect;
+}
+
+static void
+hyscan_device_group_sonar_interface_init (HyScanSonarInterface *iface)
+{
+  iface->antenna_set_offset = hyscan_device_group_sonar_antenna_set_offset;
+  iface->receiver_set_time = hyscan_device_group_sonar_receiver_set_time;
+  iface->receiver_set_auto = hyscan_device_group_sonar_receiver_set_auto;
+  iface->receiver_disable = hyscan_device_group_sonar_receiver_disable;
+  iface->generator_set_preset = hyscan_device_group_sonar_generator_set_preset;
+  iface->generator_disable = hyscan_device_group_sonar_generator_disable;
+  iface->tvg_set_auto = hyscan_device_group_sonar_tvg_set_auto;
+  iface->tvg_set_constant = hyscan_device_group_sonar_tvg_set_constant;
+  iface->tvg_set_linear_db = hyscan_device_group_sonar_tvg_set_linear_db;
+  iface->tvg_set_logarithmic = hyscan_device_group_sonar_tvg_set_logarithmic;
+  iface->tvg_disable = hyscan_device_group_sonar_tvg_disable;
+  iface->start = hyscan_device_group_sonar_start;
+  iface->stop = hyscan_device_group_sonar_stop;
+  iface->configure = hyscan_device_group_sonar_configure;
+}
+
+static void
+hyscan_device_group_sensor_interface_init (HyScanSensorInterface *iface)
+{
+  iface->antenna_set_offset = hyscan_device_group_sensor_antenna_set_offset;
+  iface->set_enable = hyscan_device_group_sensor_set_enable;
+}
+
+static void
+hyscan_device_group_actuator_interface_init (HyScanActuatorInterface *iface)
+{
+  iface->disable = hyscan_device_group_actuator_disable;
+  iface->scan = hyscan_device_group_actuator_scan;
+  iface->manual = hyscan_device_group_actuator_manual;
+}
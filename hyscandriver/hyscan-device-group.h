@@ -0,0 +1,82 @@
+/* hyscan-device-group.h
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_DEVICE_GROUP_H__
+#define __HYSCAN_DEVICE_GROUP_H__
+
+#include <hyscan-device.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_DEVICE_GROUP             (hyscan_device_group_get_type ())
+#define HYSCAN_DEVICE_GROUP(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_DEVICE_GROUP, HyScanDeviceGroup))
+#define HYSCAN_IS_DEVICE_GROUP(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_DEVICE_GROUP))
+#define HYSCAN_DEVICE_GROUP_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_DEVICE_GROUP, HyScanDeviceGroupClass))
+#define HYSCAN_IS_DEVICE_GROUP_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_DEVICE_GROUP))
+#define HYSCAN_DEVICE_GROUP_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_DEVICE_GROUP, HyScanDeviceGroupClass))
+
+typedef struct _HyScanDeviceGroup HyScanDeviceGroup;
+typedef struct _HyScanDeviceGroupPrivate HyScanDeviceGroupPrivate;
+typedef struct _HyScanDeviceGroupClass HyScanDeviceGroupClass;
+
+struct _HyScanDeviceGroup
+{
+  GObject parent_instance;
+
+  HyScanDeviceGroupPrivate *priv;
+};
+
+struct _HyScanDeviceGroupClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                  hyscan_device_group_get_type            (void);
+
+HYSCAN_API
+HyScanDeviceGroup *    hyscan_device_group_new                 (void);
+
+HYSCAN_API
+gboolean               hyscan_device_group_add                 (HyScanDeviceGroup     *group,
+                                                                HyScanDevice          *device);
+
+HYSCAN_API
+gboolean               hyscan_device_group_get_skew            (HyScanDeviceGroup     *group,
+                                                                HyScanDevice          *device,
+                                                                gint64                *skew);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_DEVICE_GROUP_H__ */
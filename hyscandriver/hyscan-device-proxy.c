@@ -0,0 +1,1377 @@
+/* hyscan-device-proxy.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-device-proxy
+ * @Short_description: прокси устройства с кэшированием состояния
+ * @Title: HyScanDeviceProxy
+ *
+ * Класс передаёт вызовы функций интерфейсов #HyScanParam, #HyScanDevice,
+ * #HyScanSonar, #HyScanSensor и #HyScanActuator исходному устройству и
+ * запоминает последнее успешно применённое состояние каждого источника
+ * данных, датчика и привода. Объект создаётся функцией
+ * #hyscan_device_proxy_new.
+ *
+ * Команды настройки, не изменяющие текущее состояние, например повторная
+ * установка того же коэффициента усиления или той же преднастройки
+ * генератора, устройству не передаются и сразу завершаются успешно. При
+ * пакетной настройке функцией #hyscan_sonar_configure устройству передаются
+ * только изменившиеся параметры. Функции #hyscan_sonar_start,
+ * #hyscan_sonar_stop и функции интерфейсов #HyScanParam и #HyScanDevice
+ * передаются устройству всегда.
+ *
+ * Запомненное состояние можно получить функциями
+ * #hyscan_device_proxy_get_source, #hyscan_device_proxy_get_sensor_offset,
+ * #hyscan_device_proxy_get_sensor_enable и #hyscan_device_proxy_get_actuator
+ * без обращения к устройству.
+ *
+ * Если команда завершилась ошибкой, состояние соответствующего источника
+ * данных, датчика или привода считается неизвестным и следующая команда
+ * передаётся устройству в любом случае. Если состояние устройства могло
+ * измениться без участия прокси, например при его перезагрузке, запомненное
+ * состояние необходимо сбросить функцией #hyscan_device_proxy_invalidate.
+ * Состояние также сбрасывается при отключении от устройства.
+ *
+ * Сигналы устройства передаются через объект прокси.
+ *
+ * Объект прокси реализует интерфейсы #HyScanSonar, #HyScanSensor и
+ * #HyScanActuator, только если их реализует исходное устройство. Для
+ * этого функция #hyscan_device_proxy_new создаёт объект производного от
+ * #HyScanDeviceProxy типа с нужным набором интерфейсов. Объект, созданный
+ * напрямую через g_object_new с типом #HYSCAN_TYPE_DEVICE_PROXY, реализует
+ * только интерфейсы #HyScanParam и #HyScanDevice.
+ */
+
+#include "hyscan-device-proxy.h"
+
+#include <hyscan-buffer.h>
+#include <hyscan-param.h>
+
+enum
+{
+  PROP_O,
+  PROP_DEVICE
+};
+
+typedef struct
+{
+  HyScanAntennaOffset         *offset;         /* Смещение антенны. */
+  gboolean                     enable_set;     /* Признак известного состояния. */
+  gboolean                     enable;         /* Признак включения датчика. */
+} HyScanDeviceProxySensor;
+
+typedef struct
+{
+  HyScanActuatorModeType       mode;           /* Режим работы привода. */
+  gdouble                      from;           /* Начальный угол сектора обзора. */
+  gdouble                      to;             /* Конечный угол сектора обзора. */
+  gdouble                      speed;          /* Скорость вращения привода. */
+  gdouble                      angle;          /* Угол направления привода. */
+} HyScanDeviceProxyActuator;
+
+struct _HyScanDeviceProxyPrivate
+{
+  HyScanDevice                *device;         /* Исходное устройство. */
+
+  GMutex                       command;        /* Блокировка выполнения команд. */
+  GMutex                       lock;           /* Блокировка доступа к состоянию. */
+  GHashTable                  *sources;        /* Состояние источников данных. */
+  GHashTable                  *sensors;        /* Состояние датчиков. */
+  GHashTable                  *actuators;      /* Состояние приводов. */
+};
+
+static void            hyscan_device_proxy_param_interface_init    (HyScanParamInterface     *iface);
+static void            hyscan_device_proxy_device_interface_init   (HyScanDeviceInterface    *iface);
+static void            hyscan_device_proxy_sonar_interface_init    (HyScanSonarInterface     *iface);
+static void            hyscan_device_proxy_sensor_interface_init   (HyScanSensorInterface    *iface);
+static void            hyscan_device_proxy_actuator_interface_init (HyScanActuatorInterface  *iface);
+
+static void            hyscan_device_proxy_set_property            (GObject                  *object,
+                                                                    guint                     prop_id,
+                                                                    const GValue             *value,
+                                                                    GParamSpec               *pspec);
+static void            hyscan_device_proxy_object_constructed      (GObject                  *object);
+static void            hyscan_device_proxy_object_finalize         (GObject                  *object);
+
+static GType           hyscan_device_proxy_get_proxy_type          (HyScanDevice             *device);
+
+static void            hyscan_device_proxy_sensor_free             (gpointer                  data);
+static void            hyscan_device_proxy_actuator_free           (gpointer                  data);
+
+static gboolean        hyscan_device_proxy_offset_equal            (const HyScanAntennaOffset *offset1,
+                                                                    const HyScanAntennaOffset *offset2);
+static HyScanSonarConfigSource *
+                       hyscan_device_proxy_source_diff             (const HyScanSonarConfigSource *info,
+                                                                    const HyScanSonarConfigSource *state);
+static void            hyscan_device_proxy_source_merge            (HyScanSonarConfigSource  *state,
+                                                                    const HyScanSonarConfigSource *info);
+static gboolean        hyscan_device_proxy_sonar_apply             (HyScanDeviceProxy        *proxy,
+                                                                    HyScanSonarConfig        *config);
+static gboolean        hyscan_device_proxy_actuator_equal          (HyScanDeviceProxyActuator *state,
+                                                                    HyScanDeviceProxyActuator *request);
+static gboolean        hyscan_device_proxy_actuator_apply          (HyScanDeviceProxy        *proxy,
+                                                                    const gchar              *name,
+                                                                    HyScanDeviceProxyActuator *request);
+
+static void            hyscan_device_proxy_device_state            (HyScanDevice             *device,
+                                                                    const gchar              *dev_id,
+                                                                    HyScanDeviceProxy        *proxy);
+static void            hyscan_device_proxy_device_log              (HyScanDevice             *device,
+                                                                    const gchar              *source,
+                                                                    gint64                    time,
+                                                                    gint                      level,
+                                                                    const gchar              *message,
+                                                                    HyScanDeviceProxy        *proxy);
+static void            hyscan_device_proxy_sonar_source_info       (HyScanSonar              *sonar,
+                                                                    gint                      source,
+                                                                    guint                     channel,
+                                                                    const gchar              *description,
+                                                                    const gchar              *actuator,
+                                                                    gpointer                  info,
+                                                                    HyScanDeviceProxy        *proxy);
+static void            hyscan_device_proxy_sonar_signal            (HyScanSonar              *sonar,
+                                                                    gint                      source,
+                                                                    guint                     channel,
+                                                                    gint64                    time,
+                                                                    HyScanBuffer             *image,
+                                                                    HyScanDeviceProxy        *proxy);
+static void            hyscan_device_proxy_sonar_tvg               (HyScanSonar              *sonar,
+                                                                    gint                      source,
+                                                                    guint                     channel,
+                                                                    gint64                    time,
+                                                                    HyScanBuffer             *gains,
+                                                                    HyScanDeviceProxy        *proxy);
+static void            hyscan_device_proxy_sonar_acoustic_data     (HyScanSonar              *sonar,
+                                                                    gint                      source,
+                                                                    guint                     channel,
+                                                                    gboolean                  noise,
+                                                                    gint64                    time,
+                                                                    HyScanBuffer             *data,
+                                                                    HyScanDeviceProxy        *proxy);
+static void            hyscan_device_proxy_sensor_data             (HyScanSensor             *sensor,
+                                                                    const gchar              *name,
+                                                                    gint                      source,
+                                                                    gint64                    time,
+                                                                    HyScanBuffer             *data,
+                                                                    HyScanDeviceProxy        *proxy);
+
+G_DEFINE_TYPE_WITH_CODE (HyScanDeviceProxy, hyscan_device_proxy, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (HyScanDeviceProxy)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_PARAM, hyscan_device_proxy_param_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_DEVICE, hyscan_device_proxy_device_interface_init))
+
+static void
+hyscan_device_proxy_class_init (HyScanDeviceProxyClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = hyscan_device_proxy_set_property;
+
+  object_class->constructed = hyscan_device_proxy_object_constructed;
+  object_class->finalize = hyscan_device_proxy_object_finalize;
+
+  g_object_class_install_property (object_class, PROP_DEVICE,
+    g_param_spec_object ("device", "Device", "Device interface", HYSCAN_TYPE_DEVICE,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+}
+
+static void
+hyscan_device_proxy_init (HyScanDeviceProxy *proxy)
+{
+  proxy->priv = hyscan_device_proxy_get_instance_private (proxy);
+}
+
+static void
+hyscan_device_proxy_set_property (GObject      *object,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (object);
+  HyScanDeviceProxyPrivate *priv = proxy->priv;
+
+  switch (prop_id)
+    {
+    case PROP_DEVICE:
+      priv->device = g_value_dup_object (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+hyscan_device_proxy_object_constructed (GObject *object)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (object);
+  HyScanDeviceProxyPrivate *priv = proxy->priv;
+
+  g_mutex_init (&priv->command);
+  g_mutex_init (&priv->lock);
+
+  priv->sources = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                                         (GDestroyNotify)hyscan_sonar_config_source_free);
+  priv->sensors = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                         hyscan_device_proxy_sensor_free);
+  priv->actuators = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                           hyscan_device_proxy_actuator_free);
+
+  if (priv->device == NULL)
+    return;
+
+  g_signal_connect (priv->device, "device-state",
+                    G_CALLBACK (hyscan_device_proxy_device_state), proxy);
+  g_signal_connect (priv->device, "device-log",
+                    G_CALLBACK (hyscan_device_proxy_device_log), proxy);
+
+  if (HYSCAN_IS_SONAR (priv->device))
+    {
+      g_signal_connect (priv->device, "sonar-source-info",
+                        G_CALLBACK (hyscan_device_proxy_sonar_source_info), proxy);
+      g_signal_connect (priv->device, "sonar-signal",
+                        G_CALLBACK (hyscan_device_proxy_sonar_signal), proxy);
+      g_signal_connect (priv->device, "sonar-tvg",
+                        G_CALLBACK (hyscan_device_proxy_sonar_tvg), proxy);
+      g_signal_connect (priv->device, "sonar-acoustic-data",
+                        G_CALLBACK (hyscan_device_proxy_sonar_acoustic_data), proxy);
+    }
+
+  if (HYSCAN_IS_SENSOR (priv->device))
+    {
+      g_signal_connect (priv->device, "sensor-data",
+                        G_CALLBACK (hyscan_device_proxy_sensor_data), proxy);
+    }
+}
+
+static void
+hyscan_device_proxy_object_finalize (GObject *object)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (object);
+  HyScanDeviceProxyPrivate *priv = proxy->priv;
+
+  if (priv->device != NULL)
+    g_signal_handlers_disconnect_by_data (priv->device, proxy);
+
+  g_clear_object (&priv->device);
+
+  g_hash_table_unref (priv->sources);
+  g_hash_table_unref (priv->sensors);
+  g_hash_table_unref (priv->actuators);
+
+  g_mutex_clear (&priv->command);
+  g_mutex_clear (&priv->lock);
+
+  G_OBJECT_CLASS (hyscan_device_proxy_parent_class)->finalize (object);
+}
+
+/* Функция возвращает тип прокси, реализующий те же интерфейсы управления
+ * #HyScanSonar, #HyScanSensor и #HyScanActuator, что и устройство. Типы
+ * регистрируются при первом использовании. */
+static GType
+hyscan_device_proxy_get_proxy_type (HyScanDevice *device)
+{
+  static GMutex lock;
+  static GType types[8];
+
+  gboolean is_sonar = HYSCAN_IS_SONAR (device);
+  gboolean is_sensor = HYSCAN_IS_SENSOR (device);
+  gboolean is_actuator = HYSCAN_IS_ACTUATOR (device);
+  guint index;
+  GType type;
+
+  index = (is_sonar ? 1 : 0) | (is_sensor ? 2 : 0) | (is_actuator ? 4 : 0);
+  if (index == 0)
+    return HYSCAN_TYPE_DEVICE_PROXY;
+
+  g_mutex_lock (&lock);
+
+  if (types[index] == G_TYPE_INVALID)
+    {
+      GInterfaceInfo sonar_info = { (GInterfaceInitFunc)(void (*)(void))hyscan_device_proxy_sonar_interface_init, NULL, NULL };
+      GInterfaceInfo sensor_info = { (GInterfaceInitFunc)(void (*)(void))hyscan_device_proxy_sensor_interface_init, NULL, NULL };
+      GInterfaceInfo actuator_info = { (GInterfaceInitFunc)(void (*)(void))hyscan_device_proxy_actuator_interface_init, NULL, NULL };
+      GTypeInfo type_info = { 0 };
+      GTypeQuery query;
+      gchar *name;
+
+      g_type_query (HYSCAN_TYPE_DEVICE_PROXY, &query);
+      type_info.class_size = query.class_size;
+      type_info.instance_size = query.instance_size;
+
+      name = g_strdup_printf ("HyScanDeviceProxy%s%s%s",
+                              is_sonar ? "Sonar" : "",
+                              is_sensor ? "Sensor" : "",
+                              is_actuator ? "Actuator" : "");
+
+      type = g_type_register_static (HYSCAN_TYPE_DEVICE_PROXY, name, &type_info, 0);
+
+      if (is_sonar)
+        g_type_add_interface_static (type, HYSCAN_TYPE_SONAR, &sonar_info);
+      if (is_sensor)
+        g_type_add_interface_static (type, HYSCAN_TYPE_SENSOR, &sensor_info);
+      if (is_actuator)
+        g_type_add_interface_static (type, HYSCAN_TYPE_ACTUATOR, &actuator_info);
+
+      types[index] = type;
+      g_free (name);
+    }
+
+  type = types[index];
+
+  g_mutex_unlock (&lock);
+
+  return type;
+}
+
+/* Функция освобождает состояние датчика. */
+static void
+hyscan_device_proxy_sensor_free (gpointer data)
+{
+  HyScanDeviceProxySensor *sensor = data;
+
+  hyscan_antenna_offset_free (sensor->offset);
+  g_slice_free (HyScanDeviceProxySensor, sensor);
+}
+
+/* Функция освобождает состояние привода. */
+static void
+hyscan_device_proxy_actuator_free (gpointer data)
+{
+  g_slice_free (HyScanDeviceProxyActuator, data);
+}
+
+/* Функция сравнивает смещения антенн. */
+static gboolean
+hyscan_device_proxy_offset_equal (const HyScanAntennaOffset *offset1,
+                                  const HyScanAntennaOffset *offset2)
+{
+  if ((offset1 == NULL) || (offset2 == NULL))
+    return FALSE;
+
+  return (offset1->starboard == offset2->starboard) &&
+         (offset1->forward == offset2->forward) &&
+         (offset1->vertical == offset2->vertical) &&
+         (offset1->yaw == offset2->yaw) &&
+         (offset1->pitch == offset2->pitch) &&
+         (offset1->roll == offset2->roll);
+}
+
+/* Функция возвращает параметры источника данных, отличающиеся от текущего
+ * состояния, или NULL, если все параметры совпадают. */
+static HyScanSonarConfigSource *
+hyscan_device_proxy_source_diff (const HyScanSonarConfigSource *info,
+                                 const HyScanSonarConfigSource *state)
+{
+  HyScanSonarConfigSource *diff;
+
+  diff = hyscan_sonar_config_source_copy (info);
+  if (state == NULL)
+    return diff;
+
+  if (hyscan_device_proxy_offset_equal (diff->offset, state->offset))
+    g_clear_pointer (&diff->offset, hyscan_antenna_offset_free);
+
+  if (diff->receiver_set && state->receiver_set &&
+      (diff->receiver_mode == state->receiver_mode))
+    {
+      if ((diff->receiver_mode != HYSCAN_SONAR_RECEIVER_MODE_MANUAL) ||
+          ((diff->receive_time == state->receive_time) && (diff->wait_time == state->wait_time)))
+        {
+          diff->receiver_set = FALSE;
+        }
+    }
+
+  if (diff->generator_set && state->generator_set &&
+      (diff->generator_enable == state->generator_enable))
+    {
+      if (!diff->generator_enable || (diff->generator_preset == state->generator_preset))
+        diff->generator_set = FALSE;
+    }
+
+  if (diff->tvg_set && state->tvg_set && (diff->tvg_mode == state->tvg_mode))
+    {
+      gboolean equal;
+
+      switch (diff->tvg_mode)
+        {
+        case HYSCAN_SONAR_TVG_MODE_AUTO:
+          equal = (diff->tvg_level == state->tvg_level) &&
+                  (diff->tvg_sensitivity == state->tvg_sensitivity);
+          break;
+
+        case HYSCAN_SONAR_TVG_MODE_CONSTANT:
+          equal = (diff->tvg_gain == state->tvg_gain);
+          break;
+
+        case HYSCAN_SONAR_TVG_MODE_LINEAR_DB:
+          equal = (diff->tvg_gain0 == state->tvg_gain0) &&
+                  (diff->tvg_gain_step == state->tvg_gain_step);
+          break;
+
+        case HYSCAN_SONAR_TVG_MODE_LOGARITHMIC:
+          equal = (diff->tvg_gain0 == state->tvg_gain0) &&
+                  (diff->tvg_beta == state->tvg_beta) &&
+                  (diff->tvg_alpha == state->tvg_alpha);
+          break;
+
+        default:
+          equal = TRUE;
+          break;
+        }
+
+      if (equal)
+        diff->tvg_set = FALSE;
+    }
+
+  if ((diff->offset == NULL) && !diff->receiver_set && !diff->generator_set && !diff->tvg_set)
+    g_clear_pointer (&diff, hyscan_sonar_config_source_free);
+
+  return diff;
+}
+
+/* Функция переносит применённые параметры источника данных в текущее
+ * состояние. */
+static void
+hyscan_device_proxy_source_merge (HyScanSonarConfigSource       *state,
+                                  const HyScanSonarConfigSource *info)
+{
+  if (info->offset != NULL)
+    {
+      hyscan_antenna_offset_free (state->offset);
+      state->offset = hyscan_antenna_offset_copy (info->offset);
+    }
+
+  if (info->receiver_set)
+    {
+      state->receiver_set = TRUE;
+      state->receiver_mode = info->receiver_mode;
+      state->receive_time = info->receive_time;
+      state->wait_time = info->wait_time;
+    }
+
+  if (info->generator_set)
+    {
+      state->generator_set = TRUE;
+      state->generator_enable = info->generator_enable;
+      state->generator_preset = info->generator_preset;
+    }
+
+  if (info->tvg_set)
+    {
+      state->tvg_set = TRUE;
+      state->tvg_mode = info->tvg_mode;
+      state->tvg_level = info->tvg_level;
+      state->tvg_sensitivity = info->tvg_sensitivity;
+      state->tvg_gain = info->tvg_gain;
+      state->tvg_gain0 = info->tvg_gain0;
+      state->tvg_gain_step = info->tvg_gain_step;
+      state->tvg_beta = info->tvg_beta;
+      state->tvg_alpha = info->tvg_alpha;
+    }
+}
+
+/* Функция передаёт гидролокатору параметры, отличающиеся от текущего
+ * состояния, и запоминает их при успешном применении. Если параметры
+ * применить не удалось, состояние изменяемых источников данных
+ * сбрасывается. */
+static gboolean
+hyscan_device_proxy_sonar_apply (HyScanDeviceProxy *proxy,
+                                 HyScanSonarConfig *config)
+{
+  HyScanDeviceProxyPrivate *priv = proxy->priv;
+  HyScanSonarConfig *changes;
+  const HyScanSourceType *sources;
+  guint32 n_sources;
+  guint32 n_changes = 0;
+  gboolean status = TRUE;
+  guint32 i;
+
+  if (!HYSCAN_IS_SONAR (priv->device))
+    return FALSE;
+
+  g_mutex_lock (&priv->command);
+
+  changes = hyscan_sonar_config_new ();
+
+  g_mutex_lock (&priv->lock);
+
+  sources = hyscan_sonar_config_list_sources (config, &n_sources);
+  for (i = 0; i < n_sources; i++)
+    {
+      const HyScanSonarConfigSource *info = hyscan_sonar_config_get_source (config, sources[i]);
+      const HyScanSonarConfigSource *state = g_hash_table_lookup (priv->sources, GINT_TO_POINTER (sources[i]));
+      HyScanSonarConfigSource *diff;
+
+      diff = hyscan_device_proxy_source_diff (info, state);
+      if (diff == NULL)
+        continue;
+
+      hyscan_sonar_config_set_source (changes, diff);
+      hyscan_sonar_config_source_free (diff);
+      n_changes += 1;
+    }
+
+  g_mutex_unlock (&priv->lock);
+
+  if (n_changes > 0)
+    status = hyscan_sonar_configure (HYSCAN_SONAR (priv->device), changes);
+
+  g_mutex_lock (&priv->lock);
+
+  sources = hyscan_sonar_config_list_sources (changes, &n_sources);
+  for (i = 0; i < n_sources; i++)
+    {
+      HyScanSonarConfigSource *state;
+
+      if (!status)
+        {
+          g_hash_table_remove (priv->sources, GINT_TO_POINTER (sources[i]));
+          continue;
+        }
+
+      state = g_hash_table_lookup (priv->sources, GINT_TO_POINTER (sources[i]));
+      if (state == NULL)
+        {
+          state = g_slice_new0 (HyScanSonarConfigSource);
+          state->source = sources[i];
+          g_hash_table_insert (priv->sources, GINT_TO_POINTER (sources[i]), state);
+        }
+
+      hyscan_device_proxy_source_merge (state, hyscan_sonar_config_get_source (changes, sources[i]));
+    }
+
+  g_mutex_unlock (&priv->lock);
+
+  g_object_unref (changes);
+
+  g_mutex_unlock (&priv->command);
+
+  return status;
+}
+
+/* Обработчик сигнала device-state устройства. */
+static void
+hyscan_device_proxy_device_state (HyScanDevice      *device,
+                                  const gchar       *dev_id,
+                                  HyScanDeviceProxy *proxy)
+{
+  g_signal_emit_by_name (proxy, "device-state", dev_id);
+}
+
+/* Обработчик сигнала device-log устройства. */
+static void
+hyscan_device_proxy_device_log (HyScanDevice      *device,
+                                const gchar       *source,
+                                gint64             time,
+                                gint               level,
+                                const gchar       *message,
+                                HyScanDeviceProxy *proxy)
+{
+  g_signal_emit_by_name (proxy, "device-log", source, time, level, message);
+}
+
+/* Обработчик сигнала sonar-source-info устройства. */
+static void
+hyscan_device_proxy_sonar_source_info (HyScanSonar       *sonar,
+                                       gint               source,
+                                       guint              channel,
+                                       const gchar       *description,
+                                       const gchar       *actuator,
+                                       gpointer           info,
+                                       HyScanDeviceProxy *proxy)
+{
+  g_signal_emit_by_name (proxy, "sonar-source-info", source, channel, description, actuator, info);
+}
+
+/* Обработчик сигнала sonar-signal устройства. */
+static void
+hyscan_device_proxy_sonar_signal (HyScanSonar       *sonar,
+                                  gint               source,
+                                  guint              channel,
+                                  gint64             time,
+                                  HyScanBuffer      *image,
+                                  HyScanDeviceProxy *proxy)
+{
+  g_signal_emit_by_name (proxy, "sonar-signal", source, channel, time, image);
+}
+
+/* Обработчик сигнала sonar-tvg устройства. */
+static void
+hyscan_device_proxy_sonar_tvg (HyScanSonar       *sonar,
+                               gint               source,
+                               guint              channel,
+                               gint64             time,
+                               HyScanBuffer      *gains,
+                               HyScanDeviceProxy *proxy)
+{
+  g_signal_emit_by_name (proxy, "sonar-tvg", source, channel, time, gains);
+}
+
+/* Обработчик сигнала sonar-acoustic-data устройства. */
+static void
+hyscan_device_proxy_sonar_acoustic_data (HyScanSonar       *sonar,
+                                         gint               source,
+                                         guint              channel,
+                                         gboolean           noise,
+                                         gint64             time,
+                                         HyScanBuffer      *data,
+                                         HyScanDeviceProxy *proxy)
+{
+  g_signal_emit_by_name (proxy, "sonar-acoustic-data", source, channel, noise, time, data);
+}
+
+/* Обработчик сигнала sensor-data устройства. */
+static void
+hyscan_device_proxy_sensor_data (HyScanSensor      *sensor,
+                                 const gchar       *name,
+                                 gint               source,
+                                 gint64             time,
+                                 HyScanBuffer      *data,
+                                 HyScanDeviceProxy *proxy)
+{
+  g_signal_emit_by_name (proxy, "sensor-data", name, source, time, data);
+}
+
+static HyScanDataSchema *
+hyscan_device_proxy_param_schema (HyScanParam *param)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (param);
+
+  if (!HYSCAN_IS_PARAM (proxy->priv->device))
+    return NULL;
+
+  return hyscan_param_schema (HYSCAN_PARAM (proxy->priv->device));
+}
+
+static gboolean
+hyscan_device_proxy_param_set (HyScanParam     *param,
+                               HyScanParamList *list)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (param);
+
+  if (!HYSCAN_IS_PARAM (proxy->priv->device))
+    return FALSE;
+
+  return hyscan_param_set (HYSCAN_PARAM (proxy->priv->device), list);
+}
+
+static gboolean
+hyscan_device_proxy_param_get (HyScanParam     *param,
+                               HyScanParamList *list)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (param);
+
+  if (!HYSCAN_IS_PARAM (proxy->priv->device))
+    return FALSE;
+
+  return hyscan_param_get (HYSCAN_PARAM (proxy->priv->device), list);
+}
+
+static gboolean
+hyscan_device_proxy_device_sync (HyScanDevice *device)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (device);
+
+  if (proxy->priv->device == NULL)
+    return FALSE;
+
+  return hyscan_device_sync (proxy->priv->device);
+}
+
+static gboolean
+hyscan_device_proxy_device_set_sound_velocity (HyScanDevice *device,
+                                               GList        *svp)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (device);
+
+  if (proxy->priv->device == NULL)
+    return FALSE;
+
+  return hyscan_device_set_sound_velocity (proxy->priv->device, svp);
+}
+
+static gboolean
+hyscan_device_proxy_device_disconnect (HyScanDevice *device)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (device);
+
+  if (proxy->priv->device == NULL)
+    return FALSE;
+
+  hyscan_device_proxy_invalidate (proxy);
+
+  return hyscan_device_disconnect (proxy->priv->device);
+}
+
+static gboolean
+hyscan_device_proxy_sonar_antenna_set_offset (HyScanSonar               *sonar,
+                                              HyScanSourceType           source,
+                                              const HyScanAntennaOffset *offset)
+{
+  HyScanSonarConfig *config = hyscan_sonar_config_new ();
+  gboolean status;
+
+  hyscan_sonar_config_antenna_set_offset (config, source, offset);
+  status = hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+  g_object_unref (config);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sonar_receiver_set_time (HyScanSonar      *sonar,
+                                             HyScanSourceType  source,
+                                             gdouble           receive_time,
+                                             gdouble           wait_time)
+{
+  HyScanSonarConfig *config = hyscan_sonar_config_new ();
+  gboolean status;
+
+  hyscan_sonar_config_receiver_set_time (config, source, receive_time, wait_time);
+  status = hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+  g_object_unref (config);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sonar_receiver_set_auto (HyScanSonar      *sonar,
+                                             HyScanSourceType  source)
+{
+  HyScanSonarConfig *config = hyscan_sonar_config_new ();
+  gboolean status;
+
+  hyscan_sonar_config_receiver_set_auto (config, source);
+  status = hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+  g_object_unref (config);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sonar_receiver_disable (HyScanSonar      *sonar,
+                                            HyScanSourceType  source)
+{
+  HyScanSonarConfig *config = hyscan_sonar_config_new ();
+  gboolean status;
+
+  hyscan_sonar_config_receiver_disable (config, source);
+  status = hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+  g_object_unref (config);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sonar_generator_set_preset (HyScanSonar      *sonar,
+                                                HyScanSourceType  source,
+                                                gint64            preset)
+{
+  HyScanSonarConfig *config = hyscan_sonar_config_new ();
+  gboolean status;
+
+  hyscan_sonar_config_generator_set_preset (config, source, preset);
+  status = hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+  g_object_unref (config);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sonar_generator_disable (HyScanSonar      *sonar,
+                                             HyScanSourceType  source)
+{
+  HyScanSonarConfig *config = hyscan_sonar_config_new ();
+  gboolean status;
+
+  hyscan_sonar_config_generator_disable (config, source);
+  status = hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+  g_object_unref (config);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sonar_tvg_set_auto (HyScanSonar      *sonar,
+                                        HyScanSourceType  source,
+                                        gdouble           level,
+                                        gdouble           sensitivity)
+{
+  HyScanSonarConfig *config = hyscan_sonar_config_new ();
+  gboolean status;
+
+  hyscan_sonar_config_tvg_set_auto (config, source, level, sensitivity);
+  status = hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+  g_object_unref (config);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sonar_tvg_set_constant (HyScanSonar      *sonar,
+                                            HyScanSourceType  source,
+                                            gdouble           gain)
+{
+  HyScanSonarConfig *config = hyscan_sonar_config_new ();
+  gboolean status;
+
+  hyscan_sonar_config_tvg_set_constant (config, source, gain);
+  status = hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+  g_object_unref (config);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sonar_tvg_set_linear_db (HyScanSonar      *sonar,
+                                             HyScanSourceType  source,
+                                             gdouble           gain0,
+                                             gdouble           gain_step)
+{
+  HyScanSonarConfig *config = hyscan_sonar_config_new ();
+  gboolean status;
+
+  hyscan_sonar_config_tvg_set_linear_db (config, source, gain0, gain_step);
+  status = hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+  g_object_unref (config);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sonar_tvg_set_logarithmic (HyScanSonar      *sonar,
+                                               HyScanSourceType  source,
+                                               gdouble           gain0,
+                                               gdouble           beta,
+                                               gdouble           alpha)
+{
+  HyScanSonarConfig *config = hyscan_sonar_config_new ();
+  gboolean status;
+
+  hyscan_sonar_config_tvg_set_logarithmic (config, source, gain0, beta, alpha);
+  status = hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+  g_object_unref (config);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sonar_tvg_disable (HyScanSonar      *sonar,
+                                       HyScanSourceType  source)
+{
+  HyScanSonarConfig *config = hyscan_sonar_config_new ();
+  gboolean status;
+
+  hyscan_sonar_config_tvg_disable (config, source);
+  status = hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+  g_object_unref (config);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sonar_start (HyScanSonar           *sonar,
+                                 const gchar           *project_name,
+                                 const gchar           *track_name,
+                                 HyScanTrackType        track_type,
+                                 const HyScanTrackPlan *track_plan)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (sonar);
+
+  if (!HYSCAN_IS_SONAR (proxy->priv->device))
+    return FALSE;
+
+  return hyscan_sonar_start (HYSCAN_SONAR (proxy->priv->device),
+                             project_name, track_name, track_type, track_plan);
+}
+
+static gboolean
+hyscan_device_proxy_sonar_stop (HyScanSonar *sonar)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (sonar);
+
+  if (!HYSCAN_IS_SONAR (proxy->priv->device))
+    return FALSE;
+
+  return hyscan_sonar_stop (HYSCAN_SONAR (proxy->priv->device));
+}
+
+static gboolean
+hyscan_device_proxy_sonar_configure (HyScanSonar       *sonar,
+                                     HyScanSonarConfig *config)
+{
+  return hyscan_device_proxy_sonar_apply (HYSCAN_DEVICE_PROXY (sonar), config);
+}
+
+static gboolean
+hyscan_device_proxy_sensor_antenna_set_offset (HyScanSensor              *sensor,
+                                               const gchar               *name,
+                                               const HyScanAntennaOffset *offset)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (sensor);
+  HyScanDeviceProxyPrivate *priv = proxy->priv;
+  HyScanDeviceProxySensor *state;
+  gboolean status = TRUE;
+
+  if (!HYSCAN_IS_SENSOR (priv->device))
+    return FALSE;
+
+  g_mutex_lock (&priv->command);
+
+  g_mutex_lock (&priv->lock);
+  state = g_hash_table_lookup (priv->sensors, name);
+  if ((state != NULL) && hyscan_device_proxy_offset_equal (state->offset, offset))
+    goto exit;
+  g_mutex_unlock (&priv->lock);
+
+  status = hyscan_sensor_antenna_set_offset (HYSCAN_SENSOR (priv->device), name, offset);
+
+  g_mutex_lock (&priv->lock);
+  state = g_hash_table_lookup (priv->sensors, name);
+  if (state == NULL)
+    {
+      state = g_slice_new0 (HyScanDeviceProxySensor);
+      g_hash_table_insert (priv->sensors, g_strdup (name), state);
+    }
+
+  hyscan_antenna_offset_free (state->offset);
+  state->offset = status ? hyscan_antenna_offset_copy (offset) : NULL;
+
+exit:
+  g_mutex_unlock (&priv->lock);
+  g_mutex_unlock (&priv->command);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_sensor_set_enable (HyScanSensor *sensor,
+                                       const gchar  *name,
+                                       gboolean      enable)
+{
+  HyScanDeviceProxy *proxy = HYSCAN_DEVICE_PROXY (sensor);
+  HyScanDeviceProxyPrivate *priv = proxy->priv;
+  HyScanDeviceProxySensor *state;
+  gboolean status = TRUE;
+
+  if (!HYSCAN_IS_SENSOR (priv->device))
+    return FALSE;
+
+  enable = enable ? TRUE : FALSE;
+
+  g_mutex_lock (&priv->command);
+
+  g_mutex_lock (&priv->lock);
+  state = g_hash_table_lookup (priv->sensors, name);
+  if ((state != NULL) && state->enable_set && (state->enable == enable))
+    goto exit;
+  g_mutex_unlock (&priv->lock);
+
+  status = hyscan_sensor_set_enable (HYSCAN_SENSOR (priv->device), name, enable);
+
+  g_mutex_lock (&priv->lock);
+  state = g_hash_table_lookup (priv->sensors, name);
+  if (state == NULL)
+    {
+      state = g_slice_new0 (HyScanDeviceProxySensor);
+      g_hash_table_insert (priv->sensors, g_strdup (name), state);
+    }
+
+  state->enable_set = status;
+  state->enable = enable;
+
+exit:
+  g_mutex_unlock (&priv->lock);
+  g_mutex_unlock (&priv->command);
+
+  return status;
+}
+
+/* Функция проверяет совпадение режима работы привода с текущим состоянием. */
+static gboolean
+hyscan_device_proxy_actuator_equal (HyScanDeviceProxyActuator *state,
+                                    HyScanDeviceProxyActuator *request)
+{
+  if ((state == NULL) || (state->mode != request->mode))
+    return FALSE;
+
+  if (request->mode == HYSCAN_ACTUATOR_MODE_SCAN)
+    {
+      return (state->from == request->from) &&
+             (state->to == request->to) &&
+             (state->speed == request->speed);
+    }
+
+  if (request->mode == HYSCAN_ACTUATOR_MODE_MANUAL)
+    return (state->angle == request->angle);
+
+  return TRUE;
+}
+
+/* Функция передаёт приводу команду, если она изменяет режим его работы,
+ * и запоминает новый режим при её успешном выполнении. */
+static gboolean
+hyscan_device_proxy_actuator_apply (HyScanDeviceProxy         *proxy,
+                                    const gchar               *name,
+                                    HyScanDeviceProxyActuator *request)
+{
+  HyScanDeviceProxyPrivate *priv = proxy->priv;
+  HyScanActuator *actuator;
+  gboolean status = TRUE;
+
+  if (!HYSCAN_IS_ACTUATOR (priv->device))
+    return FALSE;
+
+  actuator = HYSCAN_ACTUATOR (priv->device);
+
+  g_mutex_lock (&priv->command);
+
+  g_mutex_lock (&priv->lock);
+  if (hyscan_device_proxy_actuator_equal (g_hash_table_lookup (priv->actuators, name), request))
+    goto exit;
+  g_mutex_unlock (&priv->lock);
+
+  if (request->mode == HYSCAN_ACTUATOR_MODE_SCAN)
+    status = hyscan_actuator_scan (actuator, name, request->from, request->to, request->speed);
+  else if (request->mode == HYSCAN_ACTUATOR_MODE_MANUAL)
+    status = hyscan_actuator_manual (actuator, name, request->angle);
+  else
+    status = hyscan_actuator_disable (actuator, name);
+
+  g_mutex_lock (&priv->lock);
+  if (status)
+    {
+      g_hash_table_replace (priv->actuators, g_strdup (name),
+                            g_slice_dup (HyScanDeviceProxyActuator, request));
+    }
+  else
+    {
+      g_hash_table_remove (priv->actuators, name);
+    }
+
+exit:
+  g_mutex_unlock (&priv->lock);
+  g_mutex_unlock (&priv->command);
+
+  return status;
+}
+
+static gboolean
+hyscan_device_proxy_actuator_disable (HyScanActuator *actuator,
+                                      const gchar    *name)
+{
+  HyScanDeviceProxyActuator request = { 0 };
+
+  request.mode = HYSCAN_ACTUATOR_MODE_NONE;
+
+  return hyscan_device_proxy_actuator_apply (HYSCAN_DEVICE_PROXY (actuator), name, &request);
+}
+
+static gboolean
+hyscan_device_proxy_actuator_scan (HyScanActuator *actuator,
+                                   const gchar    *name,
+                                   gdouble         from,
+                                   gdouble         to,
+                                   gdouble         speed)
+{
+  HyScanDeviceProxyActuator request = { 0 };
+
+  request.mode = HYSCAN_ACTUATOR_MODE_SCAN;
+  request.from = from;
+  request.to = to;
+  request.speed = speed;
+
+  return hyscan_device_proxy_actuator_apply (HYSCAN_DEVICE_PROXY (actuator), name, &request);
+}
+
+static gboolean
+hyscan_device_proxy_actuator_manual (HyScanActuator *actuator,
+                                     const gchar    *name,
+                                     gdouble         angle)
+{
+  HyScanDeviceProxyActuator request = { 0 };
+
+  request.mode = HYSCAN_ACTUATOR_MODE_MANUAL;
+  request.angle = angle;
+
+  return hyscan_device_proxy_actuator_apply (HYSCAN_DEVICE_PROXY (actuator), name, &request);
+}
+
+/**
+ * hyscan_device_proxy_new:
+ * @device: указатель на #HyScanDevice
+ *
+ * Функция создаёт новый объект #HyScanDeviceProxy для указанного
+ * устройства. Объект реализует интерфейсы #HyScanSonar, #HyScanSensor и
+ * #HyScanActuator, только если их реализует устройство.
+ *
+ * Returns: #HyScanDeviceProxy. Для удаления #g_object_unref.
+ */
+HyScanDeviceProxy *
+hyscan_device_proxy_new (HyScanDevice *device)
+{
+  g_return_val_if_fail (HYSCAN_IS_DEVICE (device), NULL);
+
+  return g_object_new (hyscan_device_proxy_get_proxy_type (device),
+                       "device", device,
+                       NULL);
+}
+
+/**
+ * hyscan_device_proxy_get_source:
+ * @proxy: указатель на #HyScanDeviceProxy
+ * @source: идентификатор источника данных #HyScanSourceType
+ *
+ * Функция возвращает последние применённые параметры источника данных.
+ * Признаки наличия параметров подсистем установлены только для подсистем
+ * с известным состоянием.
+ *
+ * Returns: (nullable): #HyScanSonarConfigSource или NULL, если состояние
+ * источника данных неизвестно. Для удаления #hyscan_sonar_config_source_free.
+ */
+HyScanSonarConfigSource *
+hyscan_device_proxy_get_source (HyScanDeviceProxy *proxy,
+                                HyScanSourceType   source)
+{
+  HyScanDeviceProxyPrivate *priv;
+  HyScanSonarConfigSource *info;
+
+  g_return_val_if_fail (HYSCAN_IS_DEVICE_PROXY (proxy), NULL);
+
+  priv = proxy->priv;
+
+  g_mutex_lock (&priv->lock);
+  info = hyscan_sonar_config_source_copy (g_hash_table_lookup (priv->sources, GINT_TO_POINTER (source)));
+  g_mutex_unlock (&priv->lock);
+
+  return info;
+}
+
+/**
+ * hyscan_device_proxy_get_sensor_offset:
+ * @proxy: указатель на #HyScanDeviceProxy
+ * @name: название датчика
+ *
+ * Функция возвращает последнее применённое смещение антенны датчика.
+ *
+ * Returns: (nullable): #HyScanAntennaOffset или NULL, если смещение
+ * неизвестно. Для удаления #hyscan_antenna_offset_free.
+ */
+HyScanAntennaOffset *
+hyscan_device_proxy_get_sensor_offset (HyScanDeviceProxy *proxy,
+                                       const gchar       *name)
+{
+  HyScanDeviceProxyPrivate *priv;
+  HyScanDeviceProxySensor *state;
+  HyScanAntennaOffset *offset = NULL;
+
+  g_return_val_if_fail (HYSCAN_IS_DEVICE_PROXY (proxy), NULL);
+
+  priv = proxy->priv;
+
+  g_mutex_lock (&priv->lock);
+  state = g_hash_table_lookup (priv->sensors, name);
+  if (state != NULL)
+    offset = hyscan_antenna_offset_copy (state->offset);
+  g_mutex_unlock (&priv->lock);
+
+  return offset;
+}
+
+/**
+ * hyscan_device_proxy_get_sensor_enable:
+ * @proxy: указатель на #HyScanDeviceProxy
+ * @name: название датчика
+ * @enable: (out): признак включения датчика
+ *
+ * Функция возвращает последнее применённое состояние включения датчика.
+ *
+ * Returns: %TRUE если состояние известно, иначе %FALSE.
+ */
+gboolean
+hyscan_device_proxy_get_sensor_enable (HyScanDeviceProxy *proxy,
+                                       const gchar       *name,
+                                       gboolean          *enable)
+{
+  HyScanDeviceProxyPrivate *priv;
+  HyScanDeviceProxySensor *state;
+  gboolean status = FALSE;
+
+  g_return_val_if_fail (HYSCAN_IS_DEVICE_PROXY (proxy), FALSE);
+
+  priv = proxy->priv;
+
+  g_mutex_lock (&priv->lock);
+  state = g_hash_table_lookup (priv->sensors, name);
+  if ((state != NULL) && state->enable_set)
+    {
+      if (enable != NULL)
+        *enable = state->enable;
+
+      status = TRUE;
+    }
+  g_mutex_unlock (&priv->lock);
+
+  return status;
+}
+
+/**
+ * hyscan_device_proxy_get_actuator:
+ * @proxy: указатель на #HyScanDeviceProxy
+ * @name: название привода
+ * @mode: (out) (optional): режим работы привода
+ * @from: (out) (optional): начальный угол сектора обзора, десятичный градус
+ * @to: (out) (optional): конечный угол сектора обзора, десятичный градус
+ * @speed: (out) (optional): скорость вращения привода, десятичный градус/с
+ * @angle: (out) (optional): угол направления привода, десятичный градус
+ *
+ * Функция возвращает последний применённый режим работы привода. Для
+ * отключенного привода возвращается режим #HYSCAN_ACTUATOR_MODE_NONE.
+ * Параметры сектора обзора имеют смысл только в режиме сканирования,
+ * угол направления только в ручном режиме.
+ *
+ * Returns: %TRUE если режим работы известен, иначе %FALSE.
+ */
+gboolean
+hyscan_device_proxy_get_actuator (HyScanDeviceProxy      *proxy,
+                                  const gchar            *name,
+                                  HyScanActuatorModeType *mode,
+                                  gdouble                *from,
+                                  gdouble                *to,
+                                  gdouble                *speed,
+                                  gdouble                *angle)
+{
+  HyScanDeviceProxyPrivate *priv;
+  HyScanDeviceProxyActuator *state;
+
+  g_return_val_if_fail (HYSCAN_IS_DEVICE_PROXY (proxy), FALSE);
+
+  priv = proxy->priv;
+
+  g_mutex_lock (&priv->lock);
+
+  state = g_hash_table_lookup (priv->actuators, name);
+  if (state != NULL)
+    {
+      if (mode != NULL)
+        *mode = state->mode;
+      if (from != NULL)
+        *from = state->from;
+      if (to != NULL)
+        *to = state->to;
+      if (speed != NULL)
+        *speed = state->speed;
+      if (angle != NULL)
+        *angle = state->angle;
+    }
+
+  g_mutex_unlock (&priv->lock);
+
+  return (state != NULL);
+}
+
+/**
+ * hyscan_device_proxy_invalidate:
+ * @proxy: указатель на #HyScanDeviceProxy
+ *
+ * Функция сбрасывает запомненное состояние всех источников данных, датчиков
+ * и приводов. После этого все команды настройки передаются устройству.
+ */
+void
+hyscan_device_proxy_invalidate (HyScanDeviceProxy *proxy)
+{
+  HyScanDeviceProxyPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_DEVICE_PROXY (proxy));
+
+  priv = proxy->priv;
+
+  g_mutex_lock (&priv->lock);
+  g_hash_table_remove_all (priv->sources);
+  g_hash_table_remove_all (priv->sensors);
+  g_hash_table_remove_all (priv->actuators);
+  g_mutex_unlock (&priv->lock);
+}
+
+static void
+hyscan_device_proxy_param_interface_init (HyScanParamInterface *iface)
+{
+  iface->schema = hyscan_device_proxy_param_schema;
+  iface->set = hyscan_device_proxy_param_set;
+  iface->get = hyscan_device_proxy_param_get;
+}
+
+static void
+hyscan_device_proxy_device_interface_init (HyScanDeviceInterface *iface)
+{
+  iface->sync = hyscan_device_proxy_device_sync;
+  iface->set_sound_velocity = hyscan_device_proxy_device_set_sound_velocity;
+  iface->disconnect = hyscan_device_proxy_device_disconnect;
+}
+
+static void
+hyscan_device_proxy_sonar_interface_init (HyScanSonarInterface *iface)
+{
+  iface->antenna_set_offset = hyscan_device_proxy_sonar_antenna_set_offset;
+  iface->receiver_set_time = hyscan_device_proxy_sonar_receiver_set_time;
+  iface->receiver_set_auto = hyscan_device_proxy_sonar_receiver_set_auto;
+  iface->receiver_disable = hyscan_device_proxy_sonar_receiver_disable;
+  iface->generator_set_preset = hyscan_device_proxy_sonar_generator_set_preset;
+  iface->generator_disable = hyscan_device_proxy_sonar_generator_disable;
+  iface->tvg_set_auto = hyscan_device_proxy_sonar_tvg_set_auto;
+  iface->tvg_set_constant = hyscan_device_proxy_sonar_tvg_set_constant;
+  iface->tvg_set_linear_db = hyscan_device_proxy_sonar_tvg_set_linear_db;
+  iface->tvg_set_logarithmic = hyscan_device_proxy_sonar_tvg_set_logarithmic;
+  iface->tvg_disable = hyscan_device_proxy_sonar_tvg_disable;
+  iface->start = hyscan_device_proxy_sonar_start;
+  iface->stop = hyscan_device_proxy_sonar_stop;
+  iface->configure = hyscan_device_proxy_sonar_configure;
+}
+
+static void
+hyscan_device_proxy_sensor_interface_init (HyScanSensorInterface *iface)
+{
+  iface->antenna_set_offset = hyscan_device_proxy_sensor_antenna_set_offset;
+  iface->set_enable = hyscan_device_proxy_sensor_set_enable;
+}
+
+static void
+hyscan_device_proxy_actuator_interface_init (HyScanActuatorInterface *iface)
+{
+  iface->disable = hyscan_device_proxy_actuator_disable;
+  iface->scan = hyscan_device_proxy_actuator_scan;
+  iface->manual = hyscan_device_proxy_actuator_manual;
+}
@@ -0,0 +1,101 @@
+/* hyscan-device-proxy.h
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_DEVICE_PROXY_H__
+#define __HYSCAN_DEVICE_PROXY_H__
+
+#include <hyscan-device.h>
+#include <hyscan-sonar-config.h>
+#include <hyscan-sensor.h>
+#include <hyscan-actuator.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_DEVICE_PROXY             (hyscan_device_proxy_get_type ())
+#define HYSCAN_DEVICE_PROXY(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_DEVICE_PROXY, HyScanDeviceProxy))
+#define HYSCAN_IS_DEVICE_PROXY(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_DEVICE_PROXY))
+#define HYSCAN_DEVICE_PROXY_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_DEVICE_PROXY, HyScanDeviceProxyClass))
+#define HYSCAN_IS_DEVICE_PROXY_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_DEVICE_PROXY))
+#define HYSCAN_DEVICE_PROXY_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_DEVICE_PROXY, HyScanDeviceProxyClass))
+
+typedef struct _HyScanDeviceProxy HyScanDeviceProxy;
+typedef struct _HyScanDeviceProxyPrivate HyScanDeviceProxyPrivate;
+typedef struct _HyScanDeviceProxyClass HyScanDeviceProxyClass;
+
+struct _HyScanDeviceProxy
+{
+  GObject parent_instance;
+
+  HyScanDeviceProxyPrivate *priv;
+};
+
+struct _HyScanDeviceProxyClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                     hyscan_device_proxy_get_type          (void);
+
+HYSCAN_API
+HyScanDeviceProxy *       hyscan_device_proxy_new               (HyScanDevice            *device);
+
+HYSCAN_API
+HyScanSonarConfigSource * hyscan_device_proxy_get_source        (HyScanDeviceProxy       *proxy,
+                                                                 HyScanSourceType         source);
+
+HYSCAN_API
+HyScanAntennaOffset *     hyscan_device_proxy_get_sensor_offset (HyScanDeviceProxy       *proxy,
+                                                                 const gchar             *name);
+
+HYSCAN_API
+gboolean                  hyscan_device_proxy_get_sensor_enable (HyScanDeviceProxy       *proxy,
+                                                                 const gchar             *name,
+                                                                 gboolean                *enable);
+
+HYSCAN_API
+gboolean                  hyscan_device_proxy_get_actuator      (HyScanDeviceProxy       *proxy,
+                                                                 const gchar             *name,
+                                                                 HyScanActuatorModeType  *mode,
+                                                                 gdouble                 *from,
+                                                                 gdouble                 *to,
+                                                                 gdouble                 *speed,
+                                                                 gdouble                 *angle);
+
+HYSCAN_API
+void                      hyscan_device_proxy_invalidate        (HyScanDeviceProxy       *proxy);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_DEVICE_PROXY_H__ */
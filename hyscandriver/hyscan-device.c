@@ -45,6 +45,12 @@
  * вступили в силу одновременно. Для этих целей предназначена функция
  * #hyscan_device_sync. Она даёт указание устройству применить все изменения.
  *
+ * Метки времени данных, формируемые по часам устройства, драйвер должен
+ * приводить к времени компьютера. Для этого рекомендуется использовать класс
+ * #HyScanDeviceClock, в который передаются время устройства и время приёма
+ * данных. Вызов #hyscan_device_sync может использоваться драйвером как
+ * дополнительный обмен для уточнения модели часов.
+ *
  * Перед началом работы рекомендуется задать профиль скорости звука. Для этого
  * используется функция #hyscan_device_set_sound_velocity. По умолчанию
  * используется фиксированное значение скорости звука, равное 1500 м/с.
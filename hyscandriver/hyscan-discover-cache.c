@@ -0,0 +1,841 @@
+/* hyscan-discover-cache.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-discover-cache
+ * @Short_description: кэш результатов обнаружения устройств
+ * @Title: HyScanDiscoverCache
+ *
+ * Класс сохраняет результаты обнаружения устройств объектом, реализующим
+ * интерфейс #HyScanDiscover, например #HyScanDriver, и сам реализует этот
+ * интерфейс. Объект создаётся функцией #hyscan_discover_cache_new, которой
+ * передаётся исходный объект и название, под которым результаты хранятся
+ * в кэше. Обычно в качестве названия используется название драйвера.
+ *
+ * Функция #hyscan_discover_list сразу после создания объекта возвращает
+ * список устройств, сохранённый в кэше, без выполнения поиска. Одновременно,
+ * в фоновом режиме, для каждого устройства из кэша вызывается функция
+ * #hyscan_discover_check с параметрами по умолчанию из схемы, возвращаемой
+ * функцией #hyscan_discover_config. Если устройство доступно, посылается
+ * сигнал #HyScanDiscover::device-found, иначе устройство удаляется из списка
+ * и посылается сигнал #HyScanDiscover::device-lost. Сигналы посылаются из
+ * фонового потока, только пока объект существует. Если в этот момент
+ * пользователь освобождает последнюю ссылку на объект, объект удаляется
+ * в фоновом потоке.
+ *
+ * При завершении поиска, запущенного функцией #hyscan_discover_start, список
+ * устройств из кэша заменяется найденным списком, который сохраняется в кэше
+ * для следующего запуска. Поиск, прерванный функцией #hyscan_discover_stop,
+ * не изменяет ни список, ни кэш. Если поиск завершился, но не нашёл ни
+ * одного устройства, кэш также не перезаписывается, чтобы временная
+ * недоступность устройств не приводила к потере сохранённого списка.
+ * Устройства, сохранённые в кэше раньше указанного при создании объекта
+ * времени жизни, не используются.
+ *
+ * Остальные функции интерфейса и все сигналы передаются исходному объекту.
+ *
+ * Кэш хранится в каталоге пользователя, определяемом функцией
+ * #g_get_user_cache_dir. Кэш можно отключить, установив переменную
+ * окружения HYSCAN_DISCOVER_CACHE в значение "0".
+ */
+
+#include "hyscan-discover-cache.h"
+
+#include <glib/gstdio.h>
+
+#define HYSCAN_DISCOVER_CACHE_NAME     "hyscan-discover.cache"
+#define HYSCAN_DISCOVER_CACHE_GROUP    "cache"
+#define HYSCAN_DISCOVER_CACHE_VERSION  2
+
+#define MAX_CHECKS                     4       /* Число одновременных проверок устройств. */
+
+enum
+{
+  PROP_O,
+  PROP_DISCOVER,
+  PROP_NAME,
+  PROP_TTL
+};
+
+struct _HyScanDiscoverCachePrivate
+{
+  HyScanDiscover              *discover;       /* Исходный объект. */
+  gchar                       *name;           /* Название в кэше. */
+  gdouble                      ttl;            /* Время жизни записей кэша, с. */
+
+  GMutex                       lock;           /* Блокировка. */
+  GList                       *cached;         /* Устройства из кэша. */
+  guint                        generation;     /* Номер изменения списка из кэша. */
+  gboolean                     scanning;       /* Признак выполнения поиска. */
+
+  GWeakRef                     self;           /* Слабая ссылка на себя для проверок. */
+  GThreadPool                 *pool;           /* Пул потоков проверки устройств. */
+};
+
+/* Задание проверки устройства из кэша. Задание не использует приватные
+ * данные объекта, пока не получит ссылку на него. */
+typedef struct
+{
+  GWeakRef                     cache;          /* Слабая ссылка на объект кэша. */
+  HyScanDiscover              *discover;       /* Исходный объект. */
+  gchar                       *uri;            /* Адрес устройства. */
+} HyScanDiscoverCacheCheck;
+
+static void            hyscan_discover_cache_interface_init    (HyScanDiscoverInterface     *iface);
+static void            hyscan_discover_cache_set_property      (GObject                     *object,
+                                                                guint                        prop_id,
+                                                                const GValue                *value,
+                                                                GParamSpec                  *pspec);
+static void            hyscan_discover_cache_object_constructed (GObject                    *object);
+static void            hyscan_discover_cache_object_finalize   (GObject                     *object);
+
+static gchar *         hyscan_discover_cache_path              (void);
+static gchar *         hyscan_discover_cache_prefix            (const gchar                 *name);
+static GKeyFile *      hyscan_discover_cache_load_file         (void);
+static GList *         hyscan_discover_cache_load              (const gchar                 *name,
+                                                                gdouble                      ttl);
+static void            hyscan_discover_cache_save              (const gchar                 *name,
+                                                                GList                       *devices);
+
+static HyScanParamList *hyscan_discover_cache_defaults         (HyScanDiscover              *discover,
+                                                                const gchar                 *uri);
+static void            hyscan_discover_cache_check_func        (gpointer                     data,
+                                                                gpointer                     user_data);
+
+static void            hyscan_discover_cache_progress          (HyScanDiscover              *discover,
+                                                                gdouble                      progress,
+                                                                HyScanDiscoverCache         *cache);
+static void            hyscan_discover_cache_completed         (HyScanDiscover              *discover,
+                                                                HyScanDiscoverCache         *cache);
+static void            hyscan_discover_cache_device_found      (HyScanDiscover              *discover,
+                                                                HyScanDiscoverInfo          *info,
+                                                                HyScanDiscoverCache         *cache);
+static void            hyscan_discover_cache_device_lost       (HyScanDiscover              *discover,
+                                                                HyScanDiscoverInfo          *info,
+                                                                HyScanDiscoverCache         *cache);
+
+G_LOCK_DEFINE_STATIC (hyscan_discover_cache_file);
+
+G_DEFINE_TYPE_WITH_CODE (HyScanDiscoverCache, hyscan_discover_cache, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (HyScanDiscoverCache)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_DISCOVER, hyscan_discover_cache_interface_init))
+
+static void
+hyscan_discover_cache_class_init (HyScanDiscoverCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = hyscan_discover_cache_set_property;
+
+  object_class->constructed = hyscan_discover_cache_object_constructed;
+  object_class->finalize = hyscan_discover_cache_object_finalize;
+
+  g_object_class_install_property (object_class, PROP_DISCOVER,
+    g_param_spec_object ("discover", "Discover", "Discover interface", HYSCAN_TYPE_DISCOVER,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_class_install_property (object_class, PROP_NAME,
+    g_param_spec_string ("name", "Name", "Cache entry name", NULL,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_class_install_property (object_class, PROP_TTL,
+    g_param_spec_double ("ttl", "TTL", "Cache entry time to live", 0.0, G_MAXDOUBLE, 0.0,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+}
+
+static void
+hyscan_discover_cache_init (HyScanDiscoverCache *cache)
+{
+  cache->priv = hyscan_discover_cache_get_instance_private (cache);
+}
+
+static void
+hyscan_discover_cache_set_property (GObject      *object,
+                                    guint         prop_id,
+                                    const GValue *value,
+                                    GParamSpec   *pspec)
+{
+  HyScanDiscoverCache *cache = HYSCAN_DISCOVER_CACHE (object);
+  HyScanDiscoverCachePrivate *priv = cache->priv;
+
+  switch (prop_id)
+    {
+    case PROP_DISCOVER:
+      priv->discover = g_value_dup_object (value);
+      break;
+
+    case PROP_NAME:
+      priv->name = g_value_dup_string (value);
+      break;
+
+    case PROP_TTL:
+      priv->ttl = g_value_get_double (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+hyscan_discover_cache_object_constructed (GObject *object)
+{
+  HyScanDiscoverCache *cache = HYSCAN_DISCOVER_CACHE (object);
+  HyScanDiscoverCachePrivate *priv = cache->priv;
+  GList *link;
+
+  g_mutex_init (&priv->lock);
+  g_weak_ref_init (&priv->self, cache);
+
+  priv->generation = 1;
+
+  if ((priv->discover == NULL) || (priv->name == NULL))
+    return;
+
+  g_signal_connect (priv->discover, "progress",
+                    G_CALLBACK (hyscan_discover_cache_progress), cache);
+  g_signal_connect (priv->discover, "completed",
+                    G_CALLBACK (hyscan_discover_cache_completed), cache);
+  g_signal_connect (priv->discover, "device-found",
+                    G_CALLBACK (hyscan_discover_cache_device_found), cache);
+  g_signal_connect (priv->discover, "device-lost",
+                    G_CALLBACK (hyscan_discover_cache_device_lost), cache);
+
+  priv->cached = hyscan_discover_cache_load (priv->name, priv->ttl);
+  if (priv->cached == NULL)
+    return;
+
+  /* Фоновая проверка доступности устройств из кэша. */
+  priv->pool = g_thread_pool_new (hyscan_discover_cache_check_func, NULL,
+                                  MAX_CHECKS, FALSE, NULL);
+
+  for (link = priv->cached; link != NULL; link = link->next)
+    {
+      HyScanDiscoverInfo *info = link->data;
+      HyScanDiscoverCacheCheck *check = g_slice_new (HyScanDiscoverCacheCheck);
+
+      g_weak_ref_init (&check->cache, cache);
+      check->discover = g_object_ref (priv->discover);
+      check->uri = g_strdup (info->uri);
+
+      g_thread_pool_push (priv->pool, check, NULL);
+    }
+}
+
+static void
+hyscan_discover_cache_object_finalize (GObject *object)
+{
+  HyScanDiscoverCache *cache = HYSCAN_DISCOVER_CACHE (object);
+  HyScanDiscoverCachePrivate *priv = cache->priv;
+
+  /* Объект может удаляться из потока проверки, поэтому не ждём завершения
+   * проверок. Оставшиеся задания не получат ссылку на объект и завершатся
+   * без обращения к нему. */
+  if (priv->pool != NULL)
+    g_thread_pool_free (priv->pool, FALSE, FALSE);
+
+  if (priv->discover != NULL)
+    {
+      g_signal_handlers_disconnect_by_data (priv->discover, cache);
+      g_object_unref (priv->discover);
+    }
+
+  g_list_free_full (priv->cached, (GDestroyNotify)hyscan_discover_info_free);
+  g_free (priv->name);
+
+  g_weak_ref_clear (&priv->self);
+  g_mutex_clear (&priv->lock);
+
+  G_OBJECT_CLASS (hyscan_discover_cache_parent_class)->finalize (object);
+}
+
+/* Функция возвращает путь к файлу кэша. */
+static gchar *
+hyscan_discover_cache_path (void)
+{
+  return g_build_filename (g_get_user_cache_dir (), "hyscan", HYSCAN_DISCOVER_CACHE_NAME, NULL);
+}
+
+/* Функция возвращает префикс групп кэша для указанного названия. Название
+ * экранируется, чтобы оно не содержало разделитель ':' и символы,
+ * недопустимые в названиях групп. */
+static gchar *
+hyscan_discover_cache_prefix (const gchar *name)
+{
+  gchar *escaped;
+  gchar *prefix;
+
+  escaped = g_uri_escape_string (name, NULL, TRUE);
+  prefix = g_strdup_printf ("%s:", escaped);
+  g_free (escaped);
+
+  return prefix;
+}
+
+/* Функция загружает файл кэша. Если кэш отключён, возвращается NULL. Если
+ * файл кэша отсутствует или имеет другую версию, возвращается пустой кэш. */
+static GKeyFile *
+hyscan_discover_cache_load_file (void)
+{
+  GKeyFile *cache;
+  gchar *cache_path;
+  const gchar *env;
+
+  /* Кэш можно отключить переменной окружения HYSCAN_DISCOVER_CACHE=0. */
+  env = g_getenv ("HYSCAN_DISCOVER_CACHE");
+  if ((env != NULL) && (g_strcmp0 (env, "0") == 0))
+    return NULL;
+
+  cache = g_key_file_new ();
+  cache_path = hyscan_discover_cache_path ();
+
+  if (g_key_file_load_from_file (cache, cache_path, G_KEY_FILE_NONE, NULL))
+    {
+      gint64 version;
+
+      version = g_key_file_get_int64 (cache, HYSCAN_DISCOVER_CACHE_GROUP, "version", NULL);
+      if (version != HYSCAN_DISCOVER_CACHE_VERSION)
+        {
+          g_key_file_free (cache);
+          cache = g_key_file_new ();
+        }
+    }
+
+  g_key_file_set_int64 (cache, HYSCAN_DISCOVER_CACHE_GROUP, "version", HYSCAN_DISCOVER_CACHE_VERSION);
+
+  g_free (cache_path);
+
+  return cache;
+}
+
+/* Функция возвращает список устройств, сохранённый в кэше под указанным
+ * названием. Устройства, сохранённые раньше времени жизни, пропускаются. */
+static GList *
+hyscan_discover_cache_load (const gchar *name,
+                            gdouble      ttl)
+{
+  GKeyFile *cache;
+  GList *devices = NULL;
+  gchar **groups;
+  gchar *prefix;
+  gint64 now;
+  guint i;
+
+  G_LOCK (hyscan_discover_cache_file);
+  cache = hyscan_discover_cache_load_file ();
+  G_UNLOCK (hyscan_discover_cache_file);
+
+  if (cache == NULL)
+    return NULL;
+
+  now = g_get_real_time () / G_USEC_PER_SEC;
+  prefix = hyscan_discover_cache_prefix (name);
+  groups = g_key_file_get_groups (cache, NULL);
+
+  for (i = 0; groups[i] != NULL; i++)
+    {
+      HyScanDataSchema *info = NULL;
+      gchar *device_name;
+      gchar *uri;
+      gchar *schema_id;
+      gchar *schema_data;
+      gboolean multi;
+      gint64 time;
+
+      if (!g_str_has_prefix (groups[i], prefix))
+        continue;
+
+      time = g_key_file_get_int64 (cache, groups[i], "time", NULL);
+      if ((ttl > 0.0) && ((now - time) > ttl))
+        continue;
+
+      device_name = g_key_file_get_string (cache, groups[i], "name", NULL);
+      uri = g_key_file_get_string (cache, groups[i], "uri", NULL);
+      multi = g_key_file_get_boolean (cache, groups[i], "multi", NULL);
+      schema_id = g_key_file_get_string (cache, groups[i], "schema-id", NULL);
+      schema_data = g_key_file_get_string (cache, groups[i], "schema", NULL);
+
+      if ((schema_id != NULL) && (schema_data != NULL))
+        info = hyscan_data_schema_new_from_string (schema_data, schema_id);
+
+      if ((device_name != NULL) && (uri != NULL))
+        devices = g_list_prepend (devices, hyscan_discover_info_new (device_name, info, uri, multi));
+
+      g_clear_object (&info);
+      g_free (device_name);
+      g_free (uri);
+      g_free (schema_id);
+      g_free (schema_data);
+    }
+
+  g_strfreev (groups);
+  g_free (prefix);
+  g_key_file_free (cache);
+
+  return g_list_reverse (devices);
+}
+
+/* Функция сохраняет список устройств в кэше под указанным названием.
+ * Ранее сохранённый под этим названием список удаляется. Ошибка записи
+ * не является критичной, так как кэш только ускоряет получение списка. */
+static void
+hyscan_discover_cache_save (const gchar *name,
+                            GList       *devices)
+{
+  GKeyFile *cache;
+  gchar *cache_path;
+  gchar *cache_dir;
+  gchar *data;
+  gsize size;
+  gchar **groups;
+  gchar *prefix;
+  gint64 now;
+  GError *error = NULL;
+  GList *link;
+  guint i;
+
+  G_LOCK (hyscan_discover_cache_file);
+
+  cache = hyscan_discover_cache_load_file ();
+  if (cache == NULL)
+    {
+      G_UNLOCK (hyscan_discover_cache_file);
+      return;
+    }
+
+  now = g_get_real_time () / G_USEC_PER_SEC;
+  prefix = hyscan_discover_cache_prefix (name);
+
+  groups = g_key_file_get_groups (cache, NULL);
+  for (i = 0; groups[i] != NULL; i++)
+    {
+      if (g_str_has_prefix (groups[i], prefix))
+        g_key_file_remove_group (cache, groups[i], NULL);
+    }
+  g_strfreev (groups);
+
+  for (link = devices, i = 0; link != NULL; link = link->next, i++)
+    {
+      HyScanDiscoverInfo *info = link->data;
+      gchar *group = g_strdup_printf ("%s%u", prefix, i);
+
+      g_key_file_set_int64 (cache, group, "time", now);
+      g_key_file_set_string (cache, group, "name", info->name);
+      g_key_file_set_string (cache, group, "uri", info->uri);
+      g_key_file_set_boolean (cache, group, "multi", info->multi);
+
+      if (info->info != NULL)
+        {
+          gchar *schema_data = hyscan_data_schema_get_data (info->info);
+
+          g_key_file_set_string (cache, group, "schema-id", hyscan_data_schema_get_id (info->info));
+          g_key_file_set_string (cache, group, "schema", schema_data);
+
+          g_free (schema_data);
+        }
+
+      g_free (group);
+    }
+
+  cache_path = hyscan_discover_cache_path ();
+  cache_dir = g_path_get_dirname (cache_path);
+  data = g_key_file_to_data (cache, &size, NULL);
+
+  g_mkdir_with_parents (cache_dir, 0755);
+  if (!g_file_set_contents (cache_path, data, size, &error))
+    {
+      g_debug ("HyScanDiscoverCache: can't save discover cache: %s", error->message);
+      g_error_free (error);
+    }
+
+  G_UNLOCK (hyscan_discover_cache_file);
+
+  g_key_file_free (cache);
+  g_free (cache_path);
+  g_free (cache_dir);
+  g_free (prefix);
+  g_free (data);
+}
+
+/* Функция возвращает параметры подключения к устройству со значениями по
+ * умолчанию. Если у устройства нет параметров подключения, возвращается NULL. */
+static HyScanParamList *
+hyscan_discover_cache_defaults (HyScanDiscover *discover,
+                                const gchar    *uri)
+{
+  HyScanDataSchema *schema;
+  HyScanParamList *params;
+  const gchar * const *keys;
+  guint i;
+
+  schema = hyscan_discover_config (discover, uri);
+  if (schema == NULL)
+    return NULL;
+
+  params = hyscan_param_list_new ();
+  keys = hyscan_data_schema_list_keys (schema);
+
+  for (i = 0; (keys != NULL) && (keys[i] != NULL); i++)
+    {
+      GVariant *value = hyscan_data_schema_key_get_default (schema, keys[i]);
+
+      if (value == NULL)
+        continue;
+
+      hyscan_param_list_set (params, keys[i], value);
+      g_variant_unref (value);
+    }
+
+  g_object_unref (schema);
+
+  return params;
+}
+
+/* Функция проверки доступности устройства из кэша, выполняемая в пуле
+ * потоков. Проверка выполняется без ссылки на объект, чтобы не задерживать
+ * его удаление, а ссылка удерживается только на время изменения списка и
+ * посылки сигналов. Поэтому последняя ссылка может быть освобождена в этом
+ * потоке. */
+static void
+hyscan_discover_cache_check_func (gpointer data,
+                                  gpointer user_data)
+{
+  HyScanDiscoverCacheCheck *check = data;
+  HyScanDiscoverCache *cache;
+  HyScanDiscoverCachePrivate *priv;
+  HyScanDiscoverInfo *found = NULL;
+  HyScanDiscoverInfo *lost = NULL;
+  HyScanParamList *params;
+  gboolean status;
+  GList *link;
+
+  /* Объект уже удалён, проверка не нужна. */
+  cache = g_weak_ref_get (&check->cache);
+  if (cache == NULL)
+    goto exit;
+  g_object_unref (cache);
+
+  params = hyscan_discover_cache_defaults (check->discover, check->uri);
+  status = hyscan_discover_check (check->discover, check->uri, params);
+  g_clear_object (&params);
+
+  cache = g_weak_ref_get (&check->cache);
+  if (cache == NULL)
+    goto exit;
+
+  priv = cache->priv;
+
+  /* Список мог быть заменён результатами поиска во время проверки. */
+  g_mutex_lock (&priv->lock);
+
+  for (link = priv->cached; link != NULL; link = link->next)
+    {
+      HyScanDiscoverInfo *info = link->data;
+
+      if (g_strcmp0 (info->uri, check->uri) != 0)
+        continue;
+
+      if (status)
+        {
+          found = hyscan_discover_info_copy (info);
+        }
+      else
+        {
+          lost = info;
+          priv->cached = g_list_delete_link (priv->cached, link);
+          priv->generation += 1;
+        }
+
+      break;
+    }
+
+  g_mutex_unlock (&priv->lock);
+
+  if (found != NULL)
+    {
+      g_signal_emit_by_name (cache, "device-found", found);
+      hyscan_discover_info_free (found);
+    }
+
+  if (lost != NULL)
+    {
+      g_signal_emit_by_name (cache, "device-lost", lost);
+      hyscan_discover_info_free (lost);
+    }
+
+  g_object_unref (cache);
+
+exit:
+  g_weak_ref_clear (&check->cache);
+  g_object_unref (check->discover);
+  g_free (check->uri);
+  g_slice_free (HyScanDiscoverCacheCheck, check);
+}
+
+/* Обработчик сигнала progress исходного объекта. */
+static void
+hyscan_discover_cache_progress (HyScanDiscover      *discover,
+                                gdouble              progress,
+                                HyScanDiscoverCache *cache)
+{
+  g_signal_emit_by_name (cache, "progress", progress);
+}
+
+/* Обработчик сигнала completed исходного объекта. Если поиск не был прерван,
+ * найденный список устройств заменяет список из кэша и, если он не пустой,
+ * сохраняется в кэше. */
+static void
+hyscan_discover_cache_completed (HyScanDiscover      *discover,
+                                 HyScanDiscoverCache *cache)
+{
+  HyScanDiscoverCachePrivate *priv = cache->priv;
+  GList *devices;
+  GList *cached = NULL;
+  gboolean scanning;
+
+  g_mutex_lock (&priv->lock);
+  scanning = priv->scanning;
+  priv->scanning = FALSE;
+  g_mutex_unlock (&priv->lock);
+
+  if (scanning)
+    {
+      devices = hyscan_discover_list (discover);
+      if (devices != NULL)
+        hyscan_discover_cache_save (priv->name, devices);
+      g_list_free_full (devices, (GDestroyNotify)hyscan_discover_info_free);
+
+      g_mutex_lock (&priv->lock);
+      cached = priv->cached;
+      priv->cached = NULL;
+      if (cached != NULL)
+        priv->generation += 1;
+      g_mutex_unlock (&priv->lock);
+    }
+
+  g_list_free_full (cached, (GDestroyNotify)hyscan_discover_info_free);
+
+  g_signal_emit_by_name (cache, "completed");
+}
+
+/* Обработчик сигнала device-found исходного объекта. */
+static void
+hyscan_discover_cache_device_found (HyScanDiscover      *discover,
+                                    HyScanDiscoverInfo  *info,
+                                    HyScanDiscoverCache *cache)
+{
+  g_signal_emit_by_name (cache, "device-found", info);
+}
+
+/* Обработчик сигнала device-lost исходного объекта. */
+static void
+hyscan_discover_cache_device_lost (HyScanDiscover      *discover,
+                                   HyScanDiscoverInfo  *info,
+                                   HyScanDiscoverCache *cache)
+{
+  g_signal_emit_by_name (cache, "device-lost", info);
+}
+
+static void
+hyscan_discover_cache_start (HyScanDiscover *discover)
+{
+  HyScanDiscoverCache *cache = HYSCAN_DISCOVER_CACHE (discover);
+  HyScanDiscoverCachePrivate *priv = cache->priv;
+
+  if (priv->discover == NULL)
+    return;
+
+  g_mutex_lock (&priv->lock);
+  priv->scanning = TRUE;
+  g_mutex_unlock (&priv->lock);
+
+  hyscan_discover_start (priv->discover);
+}
+
+/* Признак поиска сбрасывается до остановки, так как исходный объект может
+ * послать сигнал completed прерванного поиска внутри hyscan_discover_stop. */
+static void
+hyscan_discover_cache_stop (HyScanDiscover *discover)
+{
+  HyScanDiscoverCache *cache = HYSCAN_DISCOVER_CACHE (discover);
+  HyScanDiscoverCachePrivate *priv = cache->priv;
+
+  if (priv->discover == NULL)
+    return;
+
+  g_mutex_lock (&priv->lock);
+  priv->scanning = FALSE;
+  g_mutex_unlock (&priv->lock);
+
+  hyscan_discover_stop (priv->discover);
+}
+
+static GList *
+hyscan_discover_cache_list (HyScanDiscover *discover)
+{
+  HyScanDiscoverCache *cache = HYSCAN_DISCOVER_CACHE (discover);
+  HyScanDiscoverCachePrivate *priv = cache->priv;
+  GList *devices;
+  GList *link;
+
+  if (priv->discover == NULL)
+    return NULL;
+
+  devices = hyscan_discover_list (priv->discover);
+
+  /* Добавляем устройства из кэша, ещё не найденные исходным объектом. */
+  g_mutex_lock (&priv->lock);
+
+  for (link = priv->cached; link != NULL; link = link->next)
+    {
+      HyScanDiscoverInfo *info = link->data;
+      gboolean found = FALSE;
+      GList *cur;
+
+      for (cur = devices; (cur != NULL) && !found; cur = cur->next)
+        {
+          HyScanDiscoverInfo *device = cur->data;
+
+          if (g_strcmp0 (device->uri, info->uri) == 0)
+            found = TRUE;
+        }
+
+      if (!found)
+        devices = g_list_append (devices, hyscan_discover_info_copy (info));
+    }
+
+  g_mutex_unlock (&priv->lock);
+
+  return devices;
+}
+
+static guint
+hyscan_discover_cache_get_generation (HyScanDiscover *discover)
+{
+  HyScanDiscoverCache *cache = HYSCAN_DISCOVER_CACHE (discover);
+  HyScanDiscoverCachePrivate *priv = cache->priv;
+  guint generation;
+
+  if (priv->discover == NULL)
+    return 0;
+
+  generation = hyscan_discover_get_generation (priv->discover);
+  if (generation == 0)
+    return 0;
+
+  g_mutex_lock (&priv->lock);
+  generation += priv->generation;
+  g_mutex_unlock (&priv->lock);
+
+  return generation;
+}
+
+static HyScanDataSchema *
+hyscan_discover_cache_config (HyScanDiscover *discover,
+                              const gchar    *uri)
+{
+  HyScanDiscoverCache *cache = HYSCAN_DISCOVER_CACHE (discover);
+
+  if (cache->priv->discover == NULL)
+    return NULL;
+
+  return hyscan_discover_config (cache->priv->discover, uri);
+}
+
+static gboolean
+hyscan_discover_cache_check (HyScanDiscover  *discover,
+                             const gchar     *uri,
+                             HyScanParamList *params)
+{
+  HyScanDiscoverCache *cache = HYSCAN_DISCOVER_CACHE (discover);
+
+  if (cache->priv->discover == NULL)
+    return FALSE;
+
+  return hyscan_discover_check (cache->priv->discover, uri, params);
+}
+
+static HyScanDevice *
+hyscan_discover_cache_connect (HyScanDiscover  *discover,
+                               const gchar     *uri,
+                               HyScanParamList *params)
+{
+  HyScanDiscoverCache *cache = HYSCAN_DISCOVER_CACHE (discover);
+
+  if (cache->priv->discover == NULL)
+    return NULL;
+
+  return hyscan_discover_connect (cache->priv->discover, uri, params);
+}
+
+/**
+ * hyscan_discover_cache_new:
+ * @discover: указатель на #HyScanDiscover
+ * @name: название в кэше
+ * @ttl: время жизни записей кэша, с
+ *
+ * Функция создаёт новый объект #HyScanDiscoverCache. Название используется
+ * для разделения в кэше результатов разных объектов, обычно это название
+ * драйвера. Устройства, сохранённые в кэше раньше указанного времени жизни,
+ * не используются. Если время жизни равно нулю, ограничение не используется.
+ *
+ * Returns: #HyScanDiscoverCache. Для удаления #g_object_unref.
+ */
+HyScanDiscoverCache *
+hyscan_discover_cache_new (HyScanDiscover *discover,
+                           const gchar    *name,
+                           gdouble         ttl)
+{
+  g_return_val_if_fail (HYSCAN_IS_DISCOVER (discover), NULL);
+  g_return_val_if_fail (name != NULL, NULL);
+
+  return g_object_new (HYSCAN_TYPE_DISCOVER_CACHE,
+                       "discover", discover,
+                       "name", name,
+                       "ttl", MAX (ttl, 0.0),
+                       NULL);
+}
+
+static void
+hyscan_discover_cache_interface_init (HyScanDiscoverInterface *iface)
+{
+  iface->start = hyscan_discover_cache_start;
+  iface->stop = hyscan_discover_cache_stop;
+  iface->list = hyscan_discover_cache_list;
+  iface->config = hyscan_discover_cache_config;
+  iface->check = hyscan_discover_cache_check;
+  iface->connect = hyscan_discover_cache_connect;
+  iface->get_generation = hyscan_discover_cache_get_generation;
+}
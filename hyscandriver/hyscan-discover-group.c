@@ -0,0 +1,954 @@
+/* hyscan-discover-group.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-discover-group
+ * @Short_description: класс параллельного поиска устройств несколькими драйверами
+ * @Title: HyScanDiscoverGroup
+ *
+ * Класс объединяет несколько объектов, реализующих интерфейс
+ * #HyScanDiscover, например #HyScanDriver, и сам реализует этот интерфейс.
+ * Объекты добавляются в группу функцией #hyscan_discover_group_add.
+ *
+ * Функция #hyscan_discover_start запускает поиск устройств всеми объектами
+ * группы одновременно. Запуск выполняется в пуле потоков, поэтому драйвер,
+ * долго выполняющий запуск поиска, не задерживает остальные. Таким образом,
+ * общее время поиска определяется самым медленным драйвером, а не суммой
+ * времени поиска всех драйверов.
+ *
+ * Во время поиска группа посылает сигнал #HyScanDiscover::progress со
+ * средневзвешенным прогрессом всех объектов. Вес объекта задаётся при его
+ * добавлении в группу. Сигнал #HyScanDiscover::completed посылается один раз,
+ * когда поиск завершат все объекты или истечёт общее время поиска, заданное
+ * функцией #hyscan_discover_group_set_timeout.
+ *
+ * Функция #hyscan_discover_list возвращает объединённый список устройств,
+ * найденных всеми объектами группы. Функции #hyscan_discover_config,
+ * #hyscan_discover_check и #hyscan_discover_connect передаются объекту,
+ * нашедшему устройство с указанным путём.
+ *
+ * Сигналы #HyScanDiscover::device-found и #HyScanDiscover::device-lost
+ * объектов группы передаются через группу. Номер изменения списка устройств
+ * складывается из номеров изменения списков всех объектов группы и
+ * увеличивается при добавлении объекта. Если хотя бы один объект не
+ * поддерживает отслеживание изменений, функция #hyscan_discover_get_generation
+ * возвращает ноль.
+ *
+ * Каждый поиск имеет свой номер. Если объект не завершил предыдущий поиск к
+ * началу нового, например из-за истечения общего времени поиска, он
+ * предварительно останавливается функцией #hyscan_discover_stop. Сигнал
+ * #HyScanDiscover::completed, полученный от объекта до запуска им текущего
+ * поиска, относится к предыдущему поиску и не учитывается.
+ *
+ * Функции #hyscan_discover_list и #hyscan_discover_stop вызываются для всех
+ * объектов группы параллельно, поэтому медленный объект не задерживает
+ * остальные.
+ *
+ * Сигналы группы посылаются из рабочих потоков драйверов или из потока
+ * контроля времени поиска, таким образом обработчики этих сигналов не могут
+ * использовать функции работающие через #GMainLoop, например все функции Gtk.
+ */
+
+#include "hyscan-discover-group.h"
+
+typedef struct
+{
+  volatile gint                ref_count;      /* Число ссылок на объект. */
+  GWeakRef                     group;          /* Группа. */
+  HyScanDiscover              *discover;       /* Интерфейс HyScanDiscover. */
+  gdouble                      weight;         /* Вес объекта при расчёте прогресса. */
+  gdouble                      progress;       /* Прогресс поиска. */
+  gboolean                     completed;      /* Признак завершения поиска. */
+  guint                        scan;           /* Номер поиска, запущенного объектом. */
+} HyScanDiscoverGroupMember;
+
+typedef struct
+{
+  HyScanDiscoverGroupMember   *member;         /* Объект группы. */
+  guint                        scan;           /* Номер поиска. */
+  gboolean                     stop;           /* Признак остановки предыдущего поиска. */
+} HyScanDiscoverGroupTask;
+
+typedef struct
+{
+  HyScanDiscover              *discover;       /* Интерфейс HyScanDiscover. */
+  GList                       *devices;        /* Список устройств. */
+} HyScanDiscoverGroupCall;
+
+struct _HyScanDiscoverGroupPrivate
+{
+  GMutex                       lock;           /* Блокировка. */
+  GCond                        cond;           /* Сигнализатор изменения состояния. */
+
+  GPtrArray                   *members;        /* Объекты группы. */
+  GHashTable                  *uris;           /* Объекты, нашедшие устройства. */
+
+  GThreadPool                 *pool;           /* Пул потоков запуска поиска. */
+  GThread                     *watchdog;       /* Поток контроля времени поиска. */
+  gboolean                    *finalized;      /* Признак удаления группы в потоке контроля. */
+  GWeakRef                     self;           /* Слабая ссылка на группу для потока контроля. */
+  gboolean                     shutdown;       /* Признак завершения работы. */
+
+  gdouble                      timeout;        /* Общее время поиска, с. */
+  gboolean                     active;         /* Признак выполнения поиска. */
+  gint64                       deadline;       /* Время завершения поиска, мкс. */
+  guint                        scan;           /* Номер текущего поиска. */
+
+  guint                        generation;     /* Номер изменения состава группы. */
+};
+
+static void            hyscan_discover_group_interface_init    (HyScanDiscoverInterface     *iface);
+static void            hyscan_discover_group_object_constructed (GObject                    *object);
+static void            hyscan_discover_group_object_finalize   (GObject                     *object);
+
+static HyScanDiscoverGroupMember *
+                       hyscan_discover_group_member_ref        (HyScanDiscoverGroupMember   *member);
+static void            hyscan_discover_group_member_unref      (gpointer                     data);
+static void            hyscan_discover_group_member_notify     (gpointer                     data,
+                                                                GClosure                    *closure);
+static void            hyscan_discover_group_start_func        (gpointer                     data,
+                                                                gpointer                     user_data);
+static gpointer        hyscan_discover_group_watchdog          (gpointer                     data);
+
+static gdouble         hyscan_discover_group_get_progress      (HyScanDiscoverGroupPrivate  *priv);
+static void            hyscan_discover_group_progress          (HyScanDiscover              *discover,
+                                                                gdouble                      progress,
+                                                                HyScanDiscoverGroupMember   *member);
+static void            hyscan_discover_group_completed         (HyScanDiscover              *discover,
+                                                                HyScanDiscoverGroupMember   *member);
+static void            hyscan_discover_group_device_found      (HyScanDiscover              *discover,
+                                                                HyScanDiscoverInfo          *info,
+                                                                HyScanDiscoverGroupMember   *member);
+static void            hyscan_discover_group_device_lost       (HyScanDiscover              *discover,
+                                                                HyScanDiscoverInfo          *info,
+                                                                HyScanDiscoverGroupMember   *member);
+
+static GPtrArray *     hyscan_discover_group_get_members       (HyScanDiscoverGroupPrivate  *priv);
+static void            hyscan_discover_group_call              (GArray                      *calls,
+                                                                GFunc                        func);
+static void            hyscan_discover_group_stop_func         (gpointer                     data,
+                                                                gpointer                     user_data);
+static void            hyscan_discover_group_list_func         (gpointer                     data,
+                                                                gpointer                     user_data);
+
+static HyScanDiscover *hyscan_discover_group_find              (HyScanDiscoverGroup         *group,
+                                                                const gchar                 *uri);
+
+G_DEFINE_TYPE_WITH_CODE (HyScanDiscoverGroup, hyscan_discover_group, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (HyScanDiscoverGroup)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_DISCOVER, hyscan_discover_group_interface_init))
+
+static void
+hyscan_discover_group_class_init (HyScanDiscoverGroupClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->constructed = hyscan_discover_group_object_constructed;
+  object_class->finalize = hyscan_discover_group_object_finalize;
+}
+
+static void
+hyscan_discover_group_init (HyScanDiscoverGroup *group)
+{
+  group->priv = hyscan_discover_group_get_instance_private (group);
+}
+
+static void
+hyscan_discover_group_object_constructed (GObject *object)
+{
+  HyScanDiscoverGroup *group = HYSCAN_DISCOVER_GROUP (object);
+  HyScanDiscoverGroupPrivate *priv = group->priv;
+
+  g_mutex_init (&priv->lock);
+  g_cond_init (&priv->cond);
+  g_weak_ref_init (&priv->self, group);
+
+  priv->members = g_ptr_array_new_with_free_func (hyscan_discover_group_member_unref);
+  priv->uris = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+  priv->generation = 1;
+
+  priv->pool = g_thread_pool_new (hyscan_discover_group_start_func, NULL,
+                                  g_get_num_processors (), FALSE, NULL);
+  priv->watchdog = g_thread_new ("discover-group", hyscan_discover_group_watchdog, group);
+}
+
+static void
+hyscan_discover_group_object_finalize (GObject *object)
+{
+  HyScanDiscoverGroup *group = HYSCAN_DISCOVER_GROUP (object);
+  HyScanDiscoverGroupPrivate *priv = group->priv;
+  guint i;
+
+  /* Отключаемся от сигналов объектов группы. Обработчики, вызванные после
+   * этого, не смогут получить ссылку на группу. */
+  for (i = 0; i < priv->members->len; i++)
+    {
+      HyScanDiscoverGroupMember *member = g_ptr_array_index (priv->members, i);
+
+      g_signal_handlers_disconnect_by_data (member->discover, member);
+    }
+
+  /* Задания запуска поиска, ещё не выполненные пулом, завершатся без
+   * обращения к группе. Группа может удаляться из потока пула. */
+  g_thread_pool_free (priv->pool, FALSE, FALSE);
+
+  g_mutex_lock (&priv->lock);
+  priv->shutdown = TRUE;
+  g_cond_signal (&priv->cond);
+  g_mutex_unlock (&priv->lock);
+
+  /* Если группа удаляется из потока контроля, он завершается сам. */
+  if (g_thread_self () == priv->watchdog)
+    {
+      *priv->finalized = TRUE;
+      g_thread_unref (priv->watchdog);
+    }
+  else
+    {
+      g_thread_join (priv->watchdog);
+    }
+
+  g_ptr_array_unref (priv->members);
+  g_hash_table_unref (priv->uris);
+
+  g_weak_ref_clear (&priv->self);
+  g_mutex_clear (&priv->lock);
+  g_cond_clear (&priv->cond);
+
+  G_OBJECT_CLASS (hyscan_discover_group_parent_class)->finalize (object);
+}
+
+/* Функция увеличивает число ссылок на объект группы. */
+static HyScanDiscoverGroupMember *
+hyscan_discover_group_member_ref (HyScanDiscoverGroupMember *member)
+{
+  g_atomic_int_inc (&member->ref_count);
+
+  return member;
+}
+
+/* Функция уменьшает число ссылок на объект группы и освобождает память,
+ * если ссылок больше нет. */
+static void
+hyscan_discover_group_member_unref (gpointer data)
+{
+  HyScanDiscoverGroupMember *member = data;
+
+  if (!g_atomic_int_dec_and_test (&member->ref_count))
+    return;
+
+  g_weak_ref_clear (&member->group);
+  g_object_unref (member->discover);
+
+  g_slice_free (HyScanDiscoverGroupMember, member);
+}
+
+/* Функция освобождает ссылку на объект группы при отключении обработчика
+ * сигнала. Обработчик, выполняющийся в момент отключения, сохраняет доступ
+ * к объекту до своего завершения. */
+static void
+hyscan_discover_group_member_notify (gpointer  data,
+                                     GClosure *closure)
+{
+  hyscan_discover_group_member_unref (data);
+}
+
+/* Функция запуска поиска объектом группы, выполняемая в пуле потоков. */
+static void
+hyscan_discover_group_start_func (gpointer data,
+                                  gpointer user_data)
+{
+  HyScanDiscoverGroupTask *task = data;
+  HyScanDiscoverGroupMember *member = task->member;
+  HyScanDiscoverGroup *group;
+  gboolean actual = FALSE;
+
+  /* Объект не завершил предыдущий поиск. Сигнал completed, посланный им
+   * при остановке, относится к предыдущему поиску и не учитывается. */
+  if (task->stop)
+    hyscan_discover_stop (member->discover);
+
+  group = g_weak_ref_get (&member->group);
+  if (group != NULL)
+    {
+      HyScanDiscoverGroupPrivate *priv = group->priv;
+
+      g_mutex_lock (&priv->lock);
+
+      actual = priv->active && (priv->scan == task->scan);
+      if (actual)
+        member->scan = task->scan;
+
+      g_mutex_unlock (&priv->lock);
+    }
+
+  if (actual)
+    hyscan_discover_start (member->discover);
+
+  g_clear_object (&group);
+
+  hyscan_discover_group_member_unref (member);
+  g_slice_free (HyScanDiscoverGroupTask, task);
+}
+
+/* Поток контроля времени поиска. Поток не удерживает ссылку на группу и
+ * получает её только на время отправки сигнала. Если при освобождении
+ * ссылки группа удаляется, поток завершается без обращения к ней. */
+static gpointer
+hyscan_discover_group_watchdog (gpointer data)
+{
+  HyScanDiscoverGroup *group = data;
+  HyScanDiscoverGroupPrivate *priv = group->priv;
+
+  g_mutex_lock (&priv->lock);
+
+  while (!priv->shutdown)
+    {
+      HyScanDiscoverGroup *strong;
+      gboolean finalized = FALSE;
+
+      if (!priv->active || (priv->deadline == 0))
+        {
+          g_cond_wait (&priv->cond, &priv->lock);
+          continue;
+        }
+
+      if (g_cond_wait_until (&priv->cond, &priv->lock, priv->deadline))
+        continue;
+
+      /* Время поиска истекло. */
+      if (!priv->active || (g_get_monotonic_time () < priv->deadline))
+        continue;
+
+      priv->active = FALSE;
+
+      /* Группа удаляется. */
+      strong = g_weak_ref_get (&priv->self);
+      if (strong == NULL)
+        continue;
+
+      priv->finalized = &finalized;
+
+      g_mutex_unlock (&priv->lock);
+      g_signal_emit_by_name (strong, "completed");
+      g_object_unref (strong);
+
+      if (finalized)
+        return NULL;
+
+      g_mutex_lock (&priv->lock);
+      priv->finalized = NULL;
+    }
+
+  g_mutex_unlock (&priv->lock);
+
+  return NULL;
+}
+
+/* Функция возвращает средневзвешенный прогресс поиска. Функция должна
+ * вызываться при захваченной блокировке. */
+static gdouble
+hyscan_discover_group_get_progress (HyScanDiscoverGroupPrivate *priv)
+{
+  gdouble progress = 0.0;
+  gdouble weight = 0.0;
+  guint i;
+
+  for (i = 0; i < priv->members->len; i++)
+    {
+      HyScanDiscoverGroupMember *member = g_ptr_array_index (priv->members, i);
+
+      progress += member->weight * member->progress;
+      weight += member->weight;
+    }
+
+  return (weight > 0.0) ? progress / weight : 100.0;
+}
+
+/* Обработчик сигнала progress объекта группы. */
+static void
+hyscan_discover_group_progress (HyScanDiscover            *discover,
+                                gdouble                    progress,
+                                HyScanDiscoverGroupMember *member)
+{
+  HyScanDiscoverGroup *group;
+  HyScanDiscoverGroupPrivate *priv;
+  gboolean actual;
+
+  group = g_weak_ref_get (&member->group);
+  if (group == NULL)
+    return;
+
+  priv = group->priv;
+
+  g_mutex_lock (&priv->lock);
+
+  actual = priv->active && (member->scan == priv->scan) && !member->completed;
+  if (actual)
+    member->progress = CLAMP (progress, 0.0, 100.0);
+
+  progress = hyscan_discover_group_get_progress (priv);
+
+  g_mutex_unlock (&priv->lock);
+
+  if (actual)
+    g_signal_emit_by_name (group, "progress", progress);
+
+  g_object_unref (group);
+}
+
+/* Обработчик сигнала device-found объекта группы. */
+static void
+hyscan_discover_group_device_found (HyScanDiscover            *discover,
+                                    HyScanDiscoverInfo        *info,
+                                    HyScanDiscoverGroupMember *member)
+{
+  HyScanDiscoverGroup *group = g_weak_ref_get (&member->group);
+
+  if (group == NULL)
+    return;
+
+  g_signal_emit_by_name (group, "device-found", info);
+  g_object_unref (group);
+}
+
+/* Обработчик сигнала device-lost объекта группы. */
+static void
+hyscan_discover_group_device_lost (HyScanDiscover            *discover,
+                                   HyScanDiscoverInfo        *info,
+                                   HyScanDiscoverGroupMember *member)
+{
+  HyScanDiscoverGroup *group = g_weak_ref_get (&member->group);
+
+  if (group == NULL)
+    return;
+
+  g_signal_emit_by_name (group, "device-lost", info);
+  g_object_unref (group);
+}
+
+/* Обработчик сигнала completed объекта группы. Сигнал учитывается, только
+ * если объект запустил текущий поиск. */
+static void
+hyscan_discover_group_completed (HyScanDiscover            *discover,
+                                 HyScanDiscoverGroupMember *member)
+{
+  HyScanDiscoverGroup *group;
+  HyScanDiscoverGroupPrivate *priv;
+  gboolean completed = TRUE;
+  gboolean actual;
+  gdouble progress;
+  guint i;
+
+  group = g_weak_ref_get (&member->group);
+  if (group == NULL)
+    return;
+
+  priv = group->priv;
+
+  g_mutex_lock (&priv->lock);
+
+  actual = priv->active && (member->scan == priv->scan) && !member->completed;
+  if (actual)
+    {
+      member->progress = 100.0;
+      member->completed = TRUE;
+
+      for (i = 0; i < priv->members->len; i++)
+        {
+          HyScanDiscoverGroupMember *cur = g_ptr_array_index (priv->members, i);
+
+          if (!cur->completed)
+            completed = FALSE;
+        }
+
+      if (completed)
+        {
+          priv->active = FALSE;
+          g_cond_signal (&priv->cond);
+        }
+    }
+
+  progress = hyscan_discover_group_get_progress (priv);
+
+  g_mutex_unlock (&priv->lock);
+
+  if (actual)
+    {
+      g_signal_emit_by_name (group, "progress", progress);
+
+      if (completed)
+        g_signal_emit_by_name (group, "completed");
+    }
+
+  g_object_unref (group);
+}
+
+/* Функция возвращает список объектов группы. Функция должна вызываться при
+ * захваченной блокировке. */
+static GPtrArray *
+hyscan_discover_group_get_members (HyScanDiscoverGroupPrivate *priv)
+{
+  GPtrArray *members;
+  guint i;
+
+  members = g_ptr_array_new_with_free_func (g_object_unref);
+  for (i = 0; i < priv->members->len; i++)
+    {
+      HyScanDiscoverGroupMember *member = g_ptr_array_index (priv->members, i);
+
+      g_ptr_array_add (members, g_object_ref (member->discover));
+    }
+
+  return members;
+}
+
+/* Функция выполняет вызовы объектов группы параллельно и дожидается их
+ * завершения. Медленный объект не задерживает вызовы остальных. */
+static void
+hyscan_discover_group_call (GArray *calls,
+                            GFunc   func)
+{
+  GThreadPool *pool;
+  guint i;
+
+  if (calls->len == 1)
+    {
+      func (&g_array_index (calls, HyScanDiscoverGroupCall, 0), NULL);
+      return;
+    }
+
+  if (calls->len == 0)
+    return;
+
+  pool = g_thread_pool_new (func, NULL, calls->len, TRUE, NULL);
+
+  for (i = 0; i < calls->len; i++)
+    g_thread_pool_push (pool, &g_array_index (calls, HyScanDiscoverGroupCall, i), NULL);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+}
+
+/* Функция останавливает поиск объектом группы. */
+static void
+hyscan_discover_group_stop_func (gpointer data,
+                                 gpointer user_data)
+{
+  HyScanDiscoverGroupCall *call = data;
+
+  hyscan_discover_stop (call->discover);
+}
+
+/* Функция получает список устройств объекта группы. */
+static void
+hyscan_discover_group_list_func (gpointer data,
+                                 gpointer user_data)
+{
+  HyScanDiscoverGroupCall *call = data;
+
+  call->devices = hyscan_discover_list (call->discover);
+}
+
+/* Функция возвращает объект группы, нашедший устройство. */
+static HyScanDiscover *
+hyscan_discover_group_find (HyScanDiscoverGroup *group,
+                            const gchar         *uri)
+{
+  HyScanDiscoverGroupPrivate *priv = group->priv;
+  HyScanDiscover *discover;
+  GPtrArray *members;
+  guint i;
+
+  g_mutex_lock (&priv->lock);
+
+  discover = g_hash_table_lookup (priv->uris, uri);
+  if (discover != NULL)
+    {
+      g_object_ref (discover);
+      g_mutex_unlock (&priv->lock);
+
+      return discover;
+    }
+
+  members = hyscan_discover_group_get_members (priv);
+
+  g_mutex_unlock (&priv->lock);
+
+  /* Устройство не найдено поиском, например путь задан пользователем.
+   * Выбираем объект, у которого есть схема параметров для этого пути. */
+  for (i = 0; (i < members->len) && (discover == NULL); i++)
+    {
+      HyScanDataSchema *config;
+
+      config = hyscan_discover_config (g_ptr_array_index (members, i), uri);
+      if (config != NULL)
+        discover = g_object_ref (g_ptr_array_index (members, i));
+
+      g_clear_object (&config);
+    }
+
+  g_ptr_array_unref (members);
+
+  return discover;
+}
+
+static void
+hyscan_discover_group_start (HyScanDiscover *discover)
+{
+  HyScanDiscoverGroup *group = HYSCAN_DISCOVER_GROUP (discover);
+  HyScanDiscoverGroupPrivate *priv = group->priv;
+  gboolean completed;
+  guint i;
+
+  g_mutex_lock (&priv->lock);
+
+  if (priv->active)
+    {
+      g_mutex_unlock (&priv->lock);
+      return;
+    }
+
+  completed = (priv->members->len == 0);
+  priv->active = !completed;
+  priv->scan += 1;
+  priv->deadline = 0;
+  if (priv->timeout > 0.0)
+    priv->deadline = g_get_monotonic_time () + priv->timeout * G_USEC_PER_SEC;
+
+  for (i = 0; (i < priv->members->len) && !completed; i++)
+    {
+      HyScanDiscoverGroupMember *member = g_ptr_array_index (priv->members, i);
+      HyScanDiscoverGroupTask *task = g_slice_new (HyScanDiscoverGroupTask);
+
+      task->member = hyscan_discover_group_member_ref (member);
+      task->scan = priv->scan;
+      task->stop = (member->scan != 0) && !member->completed;
+
+      member->progress = 0.0;
+      member->completed = FALSE;
+
+      g_thread_pool_push (priv->pool, task, NULL);
+    }
+
+  g_cond_signal (&priv->cond);
+
+  g_mutex_unlock (&priv->lock);
+
+  if (completed)
+    g_signal_emit_by_name (group, "completed");
+}
+
+static void
+hyscan_discover_group_stop (HyScanDiscover *discover)
+{
+  HyScanDiscoverGroup *group = HYSCAN_DISCOVER_GROUP (discover);
+  HyScanDiscoverGroupPrivate *priv = group->priv;
+  GPtrArray *members;
+  GArray *calls;
+  gboolean active;
+  guint i;
+
+  g_mutex_lock (&priv->lock);
+
+  active = priv->active;
+  priv->active = FALSE;
+  g_cond_signal (&priv->cond);
+
+  members = hyscan_discover_group_get_members (priv);
+
+  g_mutex_unlock (&priv->lock);
+
+  calls = g_array_sized_new (FALSE, TRUE, sizeof (HyScanDiscoverGroupCall), members->len);
+  g_array_set_size (calls, members->len);
+  for (i = 0; i < members->len; i++)
+    g_array_index (calls, HyScanDiscoverGroupCall, i).discover = g_ptr_array_index (members, i);
+
+  hyscan_discover_group_call (calls, hyscan_discover_group_stop_func);
+
+  g_array_unref (calls);
+  g_ptr_array_unref (members);
+
+  if (active)
+    g_signal_emit_by_name (group, "completed");
+}
+
+static GList *
+hyscan_discover_group_list (HyScanDiscover *discover)
+{
+  HyScanDiscoverGroup *group = HYSCAN_DISCOVER_GROUP (discover);
+  HyScanDiscoverGroupPrivate *priv = group->priv;
+  GPtrArray *members;
+  GHashTable *uris;
+  GArray *calls;
+  GList *devices = NULL;
+  guint i;
+
+  g_mutex_lock (&priv->lock);
+  members = hyscan_discover_group_get_members (priv);
+  g_mutex_unlock (&priv->lock);
+
+  calls = g_array_sized_new (FALSE, TRUE, sizeof (HyScanDiscoverGroupCall), members->len);
+  g_array_set_size (calls, members->len);
+  for (i = 0; i < members->len; i++)
+    g_array_index (calls, HyScanDiscoverGroupCall, i).discover = g_ptr_array_index (members, i);
+
+  hyscan_discover_group_call (calls, hyscan_discover_group_list_func);
+
+  /* Объединяем списки в порядке объектов группы и запоминаем, какой объект
+   * нашёл устройство. */
+  uris = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+  for (i = 0; i < calls->len; i++)
+    {
+      HyScanDiscoverGroupCall *call = &g_array_index (calls, HyScanDiscoverGroupCall, i);
+      GList *link;
+
+      for (link = call->devices; link != NULL; link = link->next)
+        {
+          HyScanDiscoverInfo *info = link->data;
+
+          if (!g_hash_table_contains (uris, info->uri))
+            g_hash_table_insert (uris, g_strdup (info->uri), g_object_ref (call->discover));
+        }
+
+      devices = g_list_concat (devices, call->devices);
+    }
+
+  g_array_unref (calls);
+  g_ptr_array_unref (members);
+
+  g_mutex_lock (&priv->lock);
+  g_hash_table_unref (priv->uris);
+  priv->uris = uris;
+  g_mutex_unlock (&priv->lock);
+
+  return devices;
+}
+
+static guint
+hyscan_discover_group_get_generation (HyScanDiscover *discover)
+{
+  HyScanDiscoverGroup *group = HYSCAN_DISCOVER_GROUP (discover);
+  HyScanDiscoverGroupPrivate *priv = group->priv;
+  GPtrArray *members;
+  guint generation;
+  guint i;
+
+  g_mutex_lock (&priv->lock);
+  generation = priv->generation;
+  members = hyscan_discover_group_get_members (priv);
+  g_mutex_unlock (&priv->lock);
+
+  for (i = 0; i < members->len; i++)
+    {
+      guint member_generation;
+
+      member_generation = hyscan_discover_get_generation (g_ptr_array_index (members, i));
+      if (member_generation == 0)
+        {
+          generation = 0;
+          break;
+        }
+
+      generation += member_generation;
+    }
+
+  g_ptr_array_unref (members);
+
+  return generation;
+}
+
+static HyScanDataSchema *
+hyscan_discover_group_config (HyScanDiscover *discover,
+                              const gchar    *uri)
+{
+  HyScanDiscover *member;
+  HyScanDataSchema *config;
+
+  member = hyscan_discover_group_find (HYSCAN_DISCOVER_GROUP (discover), uri);
+  if (member == NULL)
+    return NULL;
+
+  config = hyscan_discover_config (member, uri);
+  g_object_unref (member);
+
+  return config;
+}
+
+static gboolean
+hyscan_discover_group_check (HyScanDiscover  *discover,
+                             const gchar     *uri,
+                             HyScanParamList *params)
+{
+  HyScanDiscover *member;
+  gboolean status;
+
+  member = hyscan_discover_group_find (HYSCAN_DISCOVER_GROUP (discover), uri);
+  if (member == NULL)
+    return FALSE;
+
+  status = hyscan_discover_check (member, uri, params);
+  g_object_unref (member);
+
+  return status;
+}
+
+static HyScanDevice *
+hyscan_discover_group_connect (HyScanDiscover  *discover,
+                               const gchar     *uri,
+                               HyScanParamList *params)
+{
+  HyScanDiscover *member;
+  HyScanDevice *device;
+
+  member = hyscan_discover_group_find (HYSCAN_DISCOVER_GROUP (discover), uri);
+  if (member == NULL)
+    return NULL;
+
+  device = hyscan_discover_connect (member, uri, params);
+  g_object_unref (member);
+
+  return device;
+}
+
+/**
+ * hyscan_discover_group_new:
+ *
+ * Функция создаёт новый объект #HyScanDiscoverGroup.
+ *
+ * Returns: #HyScanDiscoverGroup. Для удаления #g_object_unref.
+ */
+HyScanDiscoverGroup *
+hyscan_discover_group_new (void)
+{
+  return g_object_new (HYSCAN_TYPE_DISCOVER_GROUP, NULL);
+}
+
+/**
+ * hyscan_discover_group_add:
+ * @group: указатель на #HyScanDiscoverGroup
+ * @discover: указатель на #HyScanDiscover
+ * @weight: вес объекта при расчёте прогресса поиска
+ *
+ * Функция добавляет объект в группу. Вес объекта определяет его вклад в
+ * общий прогресс поиска, например, его можно задать пропорционально
+ * ожидаемому времени поиска. Если вес меньше или равен нулю, используется
+ * вес 1. Объекты можно добавлять только при остановленном поиске.
+ */
+void
+hyscan_discover_group_add (HyScanDiscoverGroup *group,
+                           HyScanDiscover      *discover,
+                           gdouble              weight)
+{
+  HyScanDiscoverGroupPrivate *priv;
+  HyScanDiscoverGroupMember *member;
+
+  g_return_if_fail (HYSCAN_IS_DISCOVER_GROUP (group));
+  g_return_if_fail (HYSCAN_IS_DISCOVER (discover));
+  g_return_if_fail ((gpointer)discover != (gpointer)group);
+
+  priv = group->priv;
+
+  member = g_slice_new0 (HyScanDiscoverGroupMember);
+  member->ref_count = 1;
+  g_weak_ref_init (&member->group, group);
+  member->discover = g_object_ref (discover);
+  member->weight = (weight > 0.0) ? weight : 1.0;
+
+  g_mutex_lock (&priv->lock);
+
+  if (priv->active)
+    {
+      g_mutex_unlock (&priv->lock);
+      g_warning ("HyScanDiscoverGroup: discover is active");
+      hyscan_discover_group_member_unref (member);
+      return;
+    }
+
+  /* Каждый обработчик сигнала удерживает ссылку на объект группы. */
+  g_signal_connect_data (discover, "progress",
+                         G_CALLBACK (hyscan_discover_group_progress),
+                         hyscan_discover_group_member_ref (member),
+                         hyscan_discover_group_member_notify, 0);
+  g_signal_connect_data (discover, "completed",
+                         G_CALLBACK (hyscan_discover_group_completed),
+                         hyscan_discover_group_member_ref (member),
+                         hyscan_discover_group_member_notify, 0);
+  g_signal_connect_data (discover, "device-found",
+                         G_CALLBACK (hyscan_discover_group_device_found),
+                         hyscan_discover_group_member_ref (member),
+                         hyscan_discover_group_member_notify, 0);
+  g_signal_connect_data (discover, "device-lost",
+                         G_CALLBACK (hyscan_discover_group_device_lost),
+                         hyscan_discover_group_member_ref (member),
+                         hyscan_discover_group_member_notify, 0);
+
+  g_ptr_array_add (priv->members, member);
+  priv->generation += 1;
+
+  g_mutex_unlock (&priv->lock);
+}
+
+/**
+ * hyscan_discover_group_set_timeout:
+ * @group: указатель на #HyScanDiscoverGroup
+ * @timeout: общее время поиска, с
+ *
+ * Функция задаёт общее время поиска устройств. По истечении этого времени
+ * посылается сигнал #HyScanDiscover::completed, даже если не все объекты
+ * группы завершили поиск. Поиск ими при этом не останавливается и найденные
+ * позже устройства будут включены в список. Если время меньше или равно
+ * нулю, ограничение не используется. По умолчанию ограничение отсутствует.
+ */
+void
+hyscan_discover_group_set_timeout (HyScanDiscoverGroup *group,
+                                   gdouble              timeout)
+{
+  g_return_if_fail (HYSCAN_IS_DISCOVER_GROUP (group));
+
+  g_mutex_lock (&group->priv->lock);
+  group->priv->timeout = timeout;
+  g_mutex_unlock (&group->priv->lock);
+}
+
+static void
+hyscan_discover_group_interface_init (HyScanDiscoverInterface *iface)
+{
+  iface->start = hyscan_discover_group_start;
+  iface->stop = hyscan_discover_group_stop;
+  iface->list = hyscan_discover_group_list;
+  iface->config = hyscan_discover_group_config;
+  iface->check = hyscan_discover_group_check;
+  iface->connect = hyscan_discover_group_connect;
+  iface->get_generation = hyscan_discover_group_get_generation;
+}
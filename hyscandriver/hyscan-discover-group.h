@@ -0,0 +1,82 @@
+/* hyscan-discover-group.h
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_DISCOVER_GROUP_H__
+#define __HYSCAN_DISCOVER_GROUP_H__
+
+#include <hyscan-discover.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_DISCOVER_GROUP             (hyscan_discover_group_get_type ())
+#define HYSCAN_DISCOVER_GROUP(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_DISCOVER_GROUP, HyScanDiscoverGroup))
+#define HYSCAN_IS_DISCOVER_GROUP(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_DISCOVER_GROUP))
+#define HYSCAN_DISCOVER_GROUP_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_DISCOVER_GROUP, HyScanDiscoverGroupClass))
+#define HYSCAN_IS_DISCOVER_GROUP_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_DISCOVER_GROUP))
+#define HYSCAN_DISCOVER_GROUP_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_DISCOVER_GROUP, HyScanDiscoverGroupClass))
+
+typedef struct _HyScanDiscoverGroup HyScanDiscoverGroup;
+typedef struct _HyScanDiscoverGroupPrivate HyScanDiscoverGroupPrivate;
+typedef struct _HyScanDiscoverGroupClass HyScanDiscoverGroupClass;
+
+struct _HyScanDiscoverGroup
+{
+  GObject parent_instance;
+
+  HyScanDiscoverGroupPrivate *priv;
+};
+
+struct _HyScanDiscoverGroupClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                  hyscan_discover_group_get_type          (void);
+
+HYSCAN_API
+HyScanDiscoverGroup *  hyscan_discover_group_new               (void);
+
+HYSCAN_API
+void                   hyscan_discover_group_add               (HyScanDiscoverGroup   *group,
+                                                                HyScanDiscover        *discover,
+                                                                gdouble                weight);
+
+HYSCAN_API
+void                   hyscan_discover_group_set_timeout       (HyScanDiscoverGroup   *group,
+                                                                gdouble                timeout);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_DISCOVER_GROUP_H__ */
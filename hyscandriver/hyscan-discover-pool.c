@@ -0,0 +1,395 @@
+/* hyscan-discover-pool.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-discover-pool
+ * @Short_description: пул подключений к устройствам
+ * @Title: HyScanDiscoverPool
+ *
+ * Класс позволяет нескольким пользователям, например системе управления,
+ * системе записи и диагностике, совместно использовать одно подключение к
+ * устройству. Объект создаётся функцией #hyscan_discover_pool_new, которой
+ * передаётся объект, реализующий интерфейс #HyScanDiscover.
+ *
+ * Функция #hyscan_discover_pool_connect при первом вызове для пути и
+ * параметров драйвера производит подключение к устройству функцией
+ * #hyscan_discover_connect. При последующих вызовах с тем же путём и теми же
+ * значениями параметров возвращается уже созданный объект #HyScanDevice.
+ * Параметры сравниваются по контрольной сумме их значений. Одновременные
+ * вызовы для одного устройства ожидают завершения единственного подключения.
+ *
+ * Каждый объект, полученный функцией #hyscan_discover_pool_connect, должен
+ * быть возвращён функцией #hyscan_discover_pool_release. Отключение от
+ * устройства выполняется, когда его вернёт последний пользователь. При
+ * удалении пула отключение выполняется от всех устройств, поэтому пул
+ * должен существовать, пока используются полученные из него устройства.
+ *
+ * Класс HyScanDiscoverPool поддерживает работу в многопоточном режиме.
+ */
+
+#include "hyscan-discover-pool.h"
+
+#include <stdlib.h>
+
+typedef struct
+{
+  gchar                       *key;            /* Путь и контрольная сумма параметров. */
+  HyScanDevice                *device;         /* Объект управления устройством. */
+  guint                        users;          /* Число пользователей. */
+  gboolean                     connecting;     /* Признак выполнения подключения. */
+} HyScanDiscoverPoolEntry;
+
+enum
+{
+  PROP_O,
+  PROP_DISCOVER
+};
+
+struct _HyScanDiscoverPoolPrivate
+{
+  HyScanDiscover              *discover;       /* Интерфейс HyScanDiscover. */
+
+  GMutex                       lock;           /* Блокировка. */
+  GCond                        cond;           /* Сигнализатор завершения подключения. */
+
+  GHashTable                  *entries;        /* Подключения по пути и параметрам. */
+  GHashTable                  *devices;        /* Подключения по объекту устройства. */
+};
+
+static void            hyscan_discover_pool_set_property       (GObject                     *object,
+                                                                guint                        prop_id,
+                                                                const GValue                *value,
+                                                                GParamSpec                  *pspec);
+static void            hyscan_discover_pool_object_constructed (GObject                     *object);
+static void            hyscan_discover_pool_object_finalize    (GObject                     *object);
+
+static gint            hyscan_discover_pool_compare            (gconstpointer                a,
+                                                                gconstpointer                b);
+static gchar *         hyscan_discover_pool_key                (const gchar                 *uri,
+                                                                HyScanParamList             *params);
+static void            hyscan_discover_pool_entry_free         (HyScanDiscoverPoolEntry     *entry);
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanDiscoverPool, hyscan_discover_pool, G_TYPE_OBJECT)
+
+static void
+hyscan_discover_pool_class_init (HyScanDiscoverPoolClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = hyscan_discover_pool_set_property;
+
+  object_class->constructed = hyscan_discover_pool_object_constructed;
+  object_class->finalize = hyscan_discover_pool_object_finalize;
+
+  g_object_class_install_property (object_class, PROP_DISCOVER,
+    g_param_spec_object ("discover", "Discover", "Discover interface", HYSCAN_TYPE_DISCOVER,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+}
+
+static void
+hyscan_discover_pool_init (HyScanDiscoverPool *pool)
+{
+  pool->priv = hyscan_discover_pool_get_instance_private (pool);
+}
+
+static void
+hyscan_discover_pool_set_property (GObject      *object,
+                                   guint         prop_id,
+                                   const GValue *value,
+                                   GParamSpec   *pspec)
+{
+  HyScanDiscoverPool *pool = HYSCAN_DISCOVER_POOL (object);
+  HyScanDiscoverPoolPrivate *priv = pool->priv;
+
+  switch (prop_id)
+    {
+    case PROP_DISCOVER:
+      priv->discover = g_value_dup_object (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+hyscan_discover_pool_object_constructed (GObject *object)
+{
+  HyScanDiscoverPool *pool = HYSCAN_DISCOVER_POOL (object);
+  HyScanDiscoverPoolPrivate *priv = pool->priv;
+
+  g_mutex_init (&priv->lock);
+  g_cond_init (&priv->cond);
+
+  priv->entries = g_hash_table_new (g_str_hash, g_str_equal);
+  priv->devices = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+static void
+hyscan_discover_pool_object_finalize (GObject *object)
+{
+  HyScanDiscoverPool *pool = HYSCAN_DISCOVER_POOL (object);
+  HyScanDiscoverPoolPrivate *priv = pool->priv;
+  GHashTableIter iter;
+  gpointer entry;
+
+  /* Отключаемся от устройств, которые не были возвращены в пул. */
+  g_hash_table_iter_init (&iter, priv->devices);
+  while (g_hash_table_iter_next (&iter, NULL, &entry))
+    hyscan_discover_pool_entry_free (entry);
+
+  g_hash_table_unref (priv->entries);
+  g_hash_table_unref (priv->devices);
+
+  g_clear_object (&priv->discover);
+
+  g_mutex_clear (&priv->lock);
+  g_cond_clear (&priv->cond);
+
+  G_OBJECT_CLASS (hyscan_discover_pool_parent_class)->finalize (object);
+}
+
+/* Функция сравнения имён параметров. */
+static gint
+hyscan_discover_pool_compare (gconstpointer a,
+                              gconstpointer b)
+{
+  return g_strcmp0 (*(const gchar **)a, *(const gchar **)b);
+}
+
+/* Функция возвращает ключ подключения: путь и контрольную сумму значений
+ * параметров драйвера. Параметры сортируются по имени, поэтому порядок
+ * их добавления в список не имеет значения. */
+static gchar *
+hyscan_discover_pool_key (const gchar     *uri,
+                          HyScanParamList *params)
+{
+  GChecksum *checksum;
+  gchar **names;
+  gchar *key;
+  guint i;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+  names = (params != NULL) ? g_strdupv ((gchar **)hyscan_param_list_params (params)) : NULL;
+  if (names != NULL)
+    {
+      qsort (names, g_strv_length (names), sizeof (gchar *), hyscan_discover_pool_compare);
+      for (i = 0; names[i] != NULL; i++)
+        {
+          GVariant *value = hyscan_param_list_get (params, names[i]);
+          gchar *data = (value != NULL) ? g_variant_print (value, TRUE) : g_strdup ("");
+
+          g_checksum_update (checksum, (const guchar *)names[i], -1);
+          g_checksum_update (checksum, (const guchar *)"=", 1);
+          g_checksum_update (checksum, (const guchar *)data, -1);
+          g_checksum_update (checksum, (const guchar *)"\n", 1);
+
+          g_clear_pointer (&value, g_variant_unref);
+          g_free (data);
+        }
+    }
+
+  key = g_strdup_printf ("%s\n%s", uri, g_checksum_get_string (checksum));
+
+  g_checksum_free (checksum);
+  g_strfreev (names);
+
+  return key;
+}
+
+/* Функция отключается от устройства и освобождает память. */
+static void
+hyscan_discover_pool_entry_free (HyScanDiscoverPoolEntry *entry)
+{
+  if (entry->device != NULL)
+    {
+      hyscan_device_disconnect (entry->device);
+      g_object_unref (entry->device);
+    }
+
+  g_free (entry->key);
+
+  g_slice_free (HyScanDiscoverPoolEntry, entry);
+}
+
+/**
+ * hyscan_discover_pool_new:
+ * @discover: указатель на #HyScanDiscover
+ *
+ * Функция создаёт новый объект #HyScanDiscoverPool.
+ *
+ * Returns: #HyScanDiscoverPool. Для удаления #g_object_unref.
+ */
+HyScanDiscoverPool *
+hyscan_discover_pool_new (HyScanDiscover *discover)
+{
+  g_return_val_if_fail (HYSCAN_IS_DISCOVER (discover), NULL);
+
+  return g_object_new (HYSCAN_TYPE_DISCOVER_POOL,
+                       "discover", discover,
+                       NULL);
+}
+
+/**
+ * hyscan_discover_pool_connect:
+ * @pool: указатель на #HyScanDiscoverPool
+ * @uri: путь для подключения к устройству
+ * @params: (nullable): параметры драйвера
+ *
+ * Функция возвращает объект управления устройством. Если подключение к
+ * устройству с таким же путём и значениями параметров уже выполнено,
+ * возвращается существующий объект, иначе производится подключение.
+ * Полученный объект необходимо вернуть функцией
+ * #hyscan_discover_pool_release.
+ *
+ * Returns: (transfer full): #HyScanDevice или NULL в случае ошибки.
+ */
+HyScanDevice *
+hyscan_discover_pool_connect (HyScanDiscoverPool *pool,
+                              const gchar        *uri,
+                              HyScanParamList    *params)
+{
+  HyScanDiscoverPoolPrivate *priv;
+  HyScanDiscoverPoolEntry *entry;
+  HyScanDevice *device = NULL;
+  gchar *key;
+
+  g_return_val_if_fail (HYSCAN_IS_DISCOVER_POOL (pool), NULL);
+  g_return_val_if_fail (uri != NULL, NULL);
+
+  priv = pool->priv;
+  if (priv->discover == NULL)
+    return NULL;
+
+  key = hyscan_discover_pool_key (uri, params);
+
+  g_mutex_lock (&priv->lock);
+
+  entry = g_hash_table_lookup (priv->entries, key);
+  if (entry == NULL)
+    {
+      entry = g_slice_new0 (HyScanDiscoverPoolEntry);
+      entry->key = key;
+      entry->users = 1;
+      entry->connecting = TRUE;
+      g_hash_table_insert (priv->entries, entry->key, entry);
+
+      /* Подключение выполняется без блокировки, чтобы не задерживать
+       * подключения к другим устройствам. */
+      g_mutex_unlock (&priv->lock);
+      device = hyscan_discover_connect (priv->discover, uri, params);
+      g_mutex_lock (&priv->lock);
+
+      entry->device = device;
+      entry->connecting = FALSE;
+      if (device != NULL)
+        g_hash_table_insert (priv->devices, device, entry);
+      else
+        g_hash_table_remove (priv->entries, entry->key);
+
+      g_cond_broadcast (&priv->cond);
+    }
+  else
+    {
+      g_free (key);
+
+      entry->users += 1;
+      while (entry->connecting)
+        g_cond_wait (&priv->cond, &priv->lock);
+    }
+
+  if (entry->device != NULL)
+    device = g_object_ref (entry->device);
+
+  /* Ошибка подключения. Запись удаляется последним ожидавшим её
+   * пользователем. */
+  if ((device == NULL) && (--entry->users == 0))
+    hyscan_discover_pool_entry_free (entry);
+
+  g_mutex_unlock (&priv->lock);
+
+  return device;
+}
+
+/**
+ * hyscan_discover_pool_release:
+ * @pool: указатель на #HyScanDiscoverPool
+ * @device: указатель на #HyScanDevice
+ *
+ * Функция возвращает в пул объект управления устройством, полученный
+ * функцией #hyscan_discover_pool_connect. Ссылка на объект, полученная
+ * пользователем, при этом освобождается. Если объект возвращён последним
+ * пользователем, выполняется отключение от устройства.
+ */
+void
+hyscan_discover_pool_release (HyScanDiscoverPool *pool,
+                              HyScanDevice       *device)
+{
+  HyScanDiscoverPoolPrivate *priv;
+  HyScanDiscoverPoolEntry *entry;
+
+  g_return_if_fail (HYSCAN_IS_DISCOVER_POOL (pool));
+  g_return_if_fail (HYSCAN_IS_DEVICE (device));
+
+  priv = pool->priv;
+
+  g_mutex_lock (&priv->lock);
+
+  entry = g_hash_table_lookup (priv->devices, device);
+  if (entry == NULL)
+    {
+      g_mutex_unlock (&priv->lock);
+      g_warning ("HyScanDiscoverPool: unknown device");
+      return;
+    }
+
+  entry->users -= 1;
+  if (entry->users > 0)
+    entry = NULL;
+  else
+    {
+      g_hash_table_remove (priv->devices, device);
+      g_hash_table_remove (priv->entries, entry->key);
+    }
+
+  g_mutex_unlock (&priv->lock);
+
+  g_object_unref (device);
+
+  /* Отключение выполняется без блокировки. */
+  if (entry != NULL)
+    hyscan_discover_pool_entry_free (entry);
+}
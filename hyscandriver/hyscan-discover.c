@@ -64,15 +64,316 @@
  * датчиков, интерфейс #HyScanSensor может быть не реализован. Аналогично, при
  * подключении только к датчику, не реализуется интерфейс #HyScanSonar.
  *
+ * Во время поиска, при обнаружении нового устройства или при пропадании
+ * ранее обнаруженного, посылаются сигналы #HyScanDiscover::device-found и
+ * #HyScanDiscover::device-lost с информацией об этом устройстве. Это позволяет
+ * начать подключение к устройству, не дожидаясь завершения поиска и не
+ * запрашивая периодически весь список устройств.
+ *
+ * Функция #hyscan_discover_get_generation возвращает номер изменения списка
+ * устройств. Номер увеличивается при каждом изменении списка, поэтому повторно
+ * запрашивать список функцией #hyscan_discover_list необходимо, только если
+ * этот номер изменился. Если драйвер не поддерживает отслеживание изменений,
+ * функция возвращает ноль.
+ *
  * Функции #hyscan_discover_start, #hyscan_discover_stop и #hyscan_discover_list
  * работают в неблокирующем режиме. Остальные функции могут заблокировать работу
  * до завешения процесса.
+ *
+ * Функции #hyscan_discover_connect_async и #hyscan_discover_check_async
+ * выполняют подключение к устройству и проверку возможности подключения
+ * асинхронно. Операции выполняются в общем для всех объектов пуле потоков с
+ * ограниченным числом потоков, поэтому можно одновременно подключаться ко
+ * всем выбранным устройствам. Для каждой операции можно задать максимальное
+ * время выполнения и отменить её через #GCancellable. При отмене или истечении
+ * времени функция обратного вызова вызывается сразу, а результат операции,
+ * завершившейся позже, отбрасывается. Функция обратного вызова вызывается в
+ * контексте #GMainContext, используемом по умолчанию в потоке, из которого
+ * была запущена операция.
  */
 
 #include "hyscan-discover.h"
+#include "hyscan-driver-profile.h"
+#include "hyscan-sonar.h"
+
+#include <hyscan-buffer.h>
+
+#define HYSCAN_DISCOVER_PROFILE_START_KEY  "hyscan-discover-profile-start"
+
+#define HYSCAN_DISCOVER_ASYNC_THREADS      16      /* Число потоков асинхронных операций. */
+
+typedef struct
+{
+  gchar                       *name;           /* Название драйвера. */
+  gint64                       start;          /* Время подключения к устройству, мкс. */
+  gint                         done;           /* Признак приёма первых данных. */
+} HyScanDiscoverProfileData;
+
+typedef struct
+{
+  HyScanDiscover              *discover;       /* Интерфейс HyScanDiscover. */
+  gchar                       *uri;            /* Путь для подключения к устройству. */
+  HyScanParamList             *params;         /* Параметры драйвера. */
+  gboolean                     connect;        /* Признак операции подключения. */
+  gint                         done;           /* Признак завершения операции. */
+  GSource                     *timeout;        /* Источник события истечения времени. */
+  GSource                     *cancel;         /* Источник события отмены. */
+} HyScanDiscoverAsync;
+
+static void    hyscan_discover_profile_completed   (HyScanDiscover            *discover);
+static void    hyscan_discover_profile_data        (HyScanSonar               *sonar,
+                                                    gint                       source,
+                                                    guint                      channel,
+                                                    gboolean                   noise,
+                                                    gint64                     time,
+                                                    HyScanBuffer              *data,
+                                                    HyScanDiscoverProfileData *profile);
+static void    hyscan_discover_profile_data_free   (gpointer                   data,
+                                                    GClosure                  *closure);
+
+static void    hyscan_discover_async_free          (gpointer                   data);
+static gboolean hyscan_discover_async_complete     (GTask                     *task,
+                                                    gpointer                   device,
+                                                    gboolean                   status,
+                                                    GError                    *error);
+static void    hyscan_discover_async_func          (gpointer                   data,
+                                                    gpointer                   user_data);
+static gboolean hyscan_discover_async_timeout      (gpointer                   data);
+static gboolean hyscan_discover_async_cancel       (GCancellable              *cancellable,
+                                                    gpointer                   data);
+static void    hyscan_discover_async_run           (HyScanDiscover            *discover,
+                                                    const gchar               *uri,
+                                                    HyScanParamList           *params,
+                                                    gboolean                   connect,
+                                                    gdouble                    timeout,
+                                                    GCancellable              *cancellable,
+                                                    GAsyncReadyCallback        callback,
+                                                    gpointer                   user_data,
+                                                    gpointer                   source_tag);
 
 G_DEFINE_INTERFACE (HyScanDiscover, hyscan_discover, G_TYPE_OBJECT)
 
+/* Обработчик сигнала completed при профилировании. */
+static void
+hyscan_discover_profile_completed (HyScanDiscover *discover)
+{
+  const gchar *name = hyscan_driver_profile_get_name (G_OBJECT (discover));
+  gint64 *start = g_object_get_data (G_OBJECT (discover), HYSCAN_DISCOVER_PROFILE_START_KEY);
+
+  if ((name == NULL) || (start == NULL) || (*start == 0))
+    return;
+
+  hyscan_driver_profile_add (name, HYSCAN_DRIVER_PROFILE_DISCOVER, *start, g_get_monotonic_time ());
+  *start = 0;
+}
+
+/* Обработчик первых гидроакустических данных при профилировании. */
+static void
+hyscan_discover_profile_data (HyScanSonar               *sonar,
+                              gint                       source,
+                              guint                      channel,
+                              gboolean                   noise,
+                              gint64                     time,
+                              HyScanBuffer              *data,
+                              HyScanDiscoverProfileData *profile)
+{
+  /* Данные могут приходить одновременно из нескольких потоков. */
+  if (!g_atomic_int_compare_and_exchange (&profile->done, 0, 1))
+    return;
+
+  hyscan_driver_profile_add (profile->name, HYSCAN_DRIVER_PROFILE_FIRST_DATA,
+                             profile->start, g_get_monotonic_time ());
+
+  g_signal_handlers_disconnect_by_func (sonar, hyscan_discover_profile_data, profile);
+}
+
+/* Функция освобождает данные обработчика. */
+static void
+hyscan_discover_profile_data_free (gpointer  data,
+                                   GClosure *closure)
+{
+  HyScanDiscoverProfileData *profile = data;
+
+  g_free (profile->name);
+  g_slice_free (HyScanDiscoverProfileData, profile);
+}
+
+/* Функция освобождает данные асинхронной операции. */
+static void
+hyscan_discover_async_free (gpointer data)
+{
+  HyScanDiscoverAsync *async = data;
+
+  if (async->timeout != NULL)
+    g_source_unref (async->timeout);
+  if (async->cancel != NULL)
+    g_source_unref (async->cancel);
+
+  g_clear_object (&async->params);
+  g_object_unref (async->discover);
+  g_free (async->uri);
+
+  g_slice_free (HyScanDiscoverAsync, async);
+}
+
+/* Функция завершает асинхронную операцию. Операция завершается только один
+ * раз: первым по результату её выполнения, истечению времени или отмене.
+ * Результат, полученный после завершения, отбрасывается. */
+static gboolean
+hyscan_discover_async_complete (GTask    *task,
+                                gpointer  device,
+                                gboolean  status,
+                                GError   *error)
+{
+  HyScanDiscoverAsync *async = g_task_get_task_data (task);
+
+  if (!g_atomic_int_compare_and_exchange (&async->done, 0, 1))
+    {
+      g_clear_object (&device);
+      g_clear_error (&error);
+      return FALSE;
+    }
+
+  if (async->timeout != NULL)
+    g_source_destroy (async->timeout);
+  if (async->cancel != NULL)
+    g_source_destroy (async->cancel);
+
+  if (error != NULL)
+    g_task_return_error (task, error);
+  else if (async->connect)
+    g_task_return_pointer (task, device, g_object_unref);
+  else
+    g_task_return_boolean (task, status);
+
+  return TRUE;
+}
+
+/* Функция выполнения асинхронной операции в пуле потоков. */
+static void
+hyscan_discover_async_func (gpointer data,
+                            gpointer user_data)
+{
+  GTask *task = data;
+  HyScanDiscoverAsync *async = g_task_get_task_data (task);
+
+  /* Операция отменена до начала выполнения. */
+  if (g_atomic_int_get (&async->done))
+    {
+      g_object_unref (task);
+      return;
+    }
+
+  if (async->connect)
+    {
+      HyScanDevice *device;
+      GError *error = NULL;
+
+      device = hyscan_discover_connect (async->discover, async->uri, async->params);
+      if (device == NULL)
+        {
+          error = g_error_new (G_IO_ERROR, G_IO_ERROR_FAILED,
+                               "can't connect to %s", async->uri);
+        }
+
+      hyscan_discover_async_complete (task, device, FALSE, error);
+    }
+  else
+    {
+      gboolean status;
+
+      status = hyscan_discover_check (async->discover, async->uri, async->params);
+      hyscan_discover_async_complete (task, NULL, status, NULL);
+    }
+
+  g_object_unref (task);
+}
+
+/* Обработчик истечения времени асинхронной операции. */
+static gboolean
+hyscan_discover_async_timeout (gpointer data)
+{
+  GTask *task = data;
+  HyScanDiscoverAsync *async = g_task_get_task_data (task);
+
+  hyscan_discover_async_complete (task, NULL, FALSE,
+                                  g_error_new (G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+                                               "%s: timeout", async->uri));
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Обработчик отмены асинхронной операции. */
+static gboolean
+hyscan_discover_async_cancel (GCancellable *cancellable,
+                              gpointer      data)
+{
+  GTask *task = data;
+  GError *error = NULL;
+
+  g_cancellable_set_error_if_cancelled (cancellable, &error);
+  hyscan_discover_async_complete (task, NULL, FALSE, error);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Функция запускает асинхронную операцию в общем пуле потоков. */
+static void
+hyscan_discover_async_run (HyScanDiscover      *discover,
+                           const gchar         *uri,
+                           HyScanParamList     *params,
+                           gboolean             connect,
+                           gdouble              timeout,
+                           GCancellable        *cancellable,
+                           GAsyncReadyCallback  callback,
+                           gpointer             user_data,
+                           gpointer             source_tag)
+{
+  static GThreadPool *pool = NULL;
+
+  HyScanDiscoverAsync *async;
+  GTask *task;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (hyscan_discover_async_func, NULL,
+                                    HYSCAN_DISCOVER_ASYNC_THREADS, FALSE, NULL);
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  async = g_slice_new0 (HyScanDiscoverAsync);
+  async->discover = g_object_ref (discover);
+  async->uri = g_strdup (uri);
+  async->params = (params != NULL) ? g_object_ref (params) : NULL;
+  async->connect = connect;
+
+  task = g_task_new (discover, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+  g_task_set_task_data (task, async, hyscan_discover_async_free);
+
+  /* Истечение времени и отмена обрабатываются в контексте задачи, поэтому
+   * функция обратного вызова не ждёт завершения операции драйвером. */
+  if (timeout > 0.0)
+    {
+      async->timeout = g_timeout_source_new (timeout * 1000.0);
+      g_source_set_callback (async->timeout, hyscan_discover_async_timeout,
+                             g_object_ref (task), g_object_unref);
+      g_source_attach (async->timeout, g_task_get_context (task));
+    }
+
+  if (cancellable != NULL)
+    {
+      async->cancel = g_cancellable_source_new (cancellable);
+      g_source_set_callback (async->cancel, (GSourceFunc)(GCallback)hyscan_discover_async_cancel,
+                             g_object_ref (task), g_object_unref);
+      g_source_attach (async->cancel, g_task_get_context (task));
+    }
+
+  g_thread_pool_push (pool, task, NULL);
+}
+
 static void
 hyscan_discover_default_init (HyScanDiscoverInterface *iface)
 {
@@ -104,6 +405,39 @@ hyscan_discover_default_init (HyScanDiscoverInterface *iface)
                 NULL, NULL,
                 g_cclosure_marshal_VOID__VOID,
                 G_TYPE_NONE, 0);
+
+  /**
+   * HyScanDiscover::device-found:
+   * @discover: указатель на #HyScanDiscover
+   * @info: (transfer none): информация об устройстве #HyScanDiscoverInfo
+   *
+   * Данный сигнал посылается при обнаружении нового устройства. Информация
+   * об устройстве передаётся без копирования и действительна только во время
+   * обработки сигнала. Сигнал посылается из рабочего потока драйвера, таким
+   * образом обработчики этого сигнала не могут использовать функции
+   * работающие через #GMainLoop, например все функции Gtk.
+   */
+  g_signal_new ("device-found", HYSCAN_TYPE_DISCOVER, G_SIGNAL_RUN_LAST, 0,
+                NULL, NULL,
+                g_cclosure_marshal_VOID__BOXED,
+                G_TYPE_NONE, 1, HYSCAN_TYPE_DISCOVER_INFO | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  /**
+   * HyScanDiscover::device-lost:
+   * @discover: указатель на #HyScanDiscover
+   * @info: (transfer none): информация об устройстве #HyScanDiscoverInfo
+   *
+   * Данный сигнал посылается, если ранее обнаруженное устройство стало
+   * недоступным. Информация об устройстве передаётся без копирования и
+   * действительна только во время обработки сигнала. Сигнал посылается из
+   * рабочего потока драйвера, таким образом обработчики этого сигнала не
+   * могут использовать функции работающие через #GMainLoop, например все
+   * функции Gtk.
+   */
+  g_signal_new ("device-lost", HYSCAN_TYPE_DISCOVER, G_SIGNAL_RUN_LAST, 0,
+                NULL, NULL,
+                g_cclosure_marshal_VOID__BOXED,
+                G_TYPE_NONE, 1, HYSCAN_TYPE_DISCOVER_INFO | G_SIGNAL_TYPE_STATIC_SCOPE);
 }
 
 /**
@@ -119,6 +453,22 @@ hyscan_discover_start (HyScanDiscover *discover)
 
   g_return_if_fail (HYSCAN_IS_DISCOVER (discover));
 
+  /* Время поиска устройств драйвером. */
+  if (hyscan_driver_profile_is_enabled () &&
+      (hyscan_driver_profile_get_name (G_OBJECT (discover)) != NULL))
+    {
+      gint64 *start = g_object_get_data (G_OBJECT (discover), HYSCAN_DISCOVER_PROFILE_START_KEY);
+
+      if (start == NULL)
+        {
+          start = g_new0 (gint64, 1);
+          g_object_set_data_full (G_OBJECT (discover), HYSCAN_DISCOVER_PROFILE_START_KEY, start, g_free);
+          g_signal_connect (discover, "completed", G_CALLBACK (hyscan_discover_profile_completed), NULL);
+        }
+
+      *start = g_get_monotonic_time ();
+    }
+
   iface = HYSCAN_DISCOVER_GET_IFACE (discover);
   if (iface->start != NULL)
     (* iface->start) (discover);
@@ -169,6 +519,32 @@ hyscan_discover_list (HyScanDiscover *discover)
   return NULL;
 }
 
+/**
+ * hyscan_discover_get_generation:
+ * @discover: указатель на #HyScanDiscover
+ *
+ * Функция возвращает номер изменения списка обнаруженных устройств. Номер
+ * начинается с единицы и увеличивается при каждом изменении списка,
+ * возвращаемого функцией #hyscan_discover_list. Если номер не изменился,
+ * повторно запрашивать список не требуется.
+ *
+ * Returns: Номер изменения списка устройств или ноль, если драйвер не
+ * поддерживает отслеживание изменений.
+ */
+guint
+hyscan_discover_get_generation (HyScanDiscover *discover)
+{
+  HyScanDiscoverInterface *iface;
+
+  g_return_val_if_fail (HYSCAN_IS_DISCOVER (discover), 0);
+
+  iface = HYSCAN_DISCOVER_GET_IFACE (discover);
+  if (iface->get_generation != NULL)
+    return (* iface->get_generation) (discover);
+
+  return 0;
+}
+
 /**
  * hyscan_discover_config:
  * @discover: указатель на #HyScanDiscover
@@ -239,13 +615,151 @@ hyscan_discover_connect (HyScanDiscover  *discover,
 {
   HyScanDiscoverInterface *iface;
 
+  HyScanDevice *device = NULL;
+  const gchar *name;
+  gint64 start;
+
   g_return_val_if_fail (HYSCAN_IS_DISCOVER (discover), NULL);
 
   iface = HYSCAN_DISCOVER_GET_IFACE (discover);
-  if (iface->connect != NULL)
-    return (* iface->connect) (discover, uri, params);
+  if (iface->connect == NULL)
+    return NULL;
 
-  return NULL;
+  name = hyscan_driver_profile_get_name (G_OBJECT (discover));
+  if (!hyscan_driver_profile_is_enabled ())
+    name = NULL;
+
+  start = g_get_monotonic_time ();
+  device = (* iface->connect) (discover, uri, params);
+
+  /* Время подключения к устройству и приёма первых данных. */
+  if (name != NULL)
+    {
+      gint64 end = g_get_monotonic_time ();
+
+      hyscan_driver_profile_add (name, HYSCAN_DRIVER_PROFILE_CONNECT, start, end);
+
+      if (HYSCAN_IS_SONAR (device))
+        {
+          HyScanDiscoverProfileData *profile = g_slice_new (HyScanDiscoverProfileData);
+
+          profile->name = g_strdup (name);
+          profile->start = end;
+          profile->done = 0;
+
+          g_signal_connect_data (device, "sonar-acoustic-data",
+                                 G_CALLBACK (hyscan_discover_profile_data), profile,
+                                 hyscan_discover_profile_data_free, 0);
+        }
+    }
+
+  return device;
+}
+
+/**
+ * hyscan_discover_connect_async:
+ * @discover: указатель на #HyScanDiscover
+ * @uri: путь для подключения к устройству
+ * @params: (nullable): параметры драйвера
+ * @timeout: максимальное время подключения, с
+ * @cancellable: (nullable): объект #GCancellable для отмены подключения
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные для функции обратного вызова
+ *
+ * Функция асинхронно производит подключение к устройству. По завершении
+ * подключения вызывается функция обратного вызова, в которой необходимо
+ * получить результат функцией #hyscan_discover_connect_finish. Если время
+ * подключения меньше или равно нулю, ограничение не используется. Параметры
+ * драйвера не должны изменяться до завершения подключения.
+ */
+void
+hyscan_discover_connect_async (HyScanDiscover      *discover,
+                               const gchar         *uri,
+                               HyScanParamList     *params,
+                               gdouble              timeout,
+                               GCancellable        *cancellable,
+                               GAsyncReadyCallback  callback,
+                               gpointer             user_data)
+{
+  g_return_if_fail (HYSCAN_IS_DISCOVER (discover));
+
+  hyscan_discover_async_run (discover, uri, params, TRUE, timeout, cancellable,
+                             callback, user_data, hyscan_discover_connect_async);
+}
+
+/**
+ * hyscan_discover_connect_finish:
+ * @discover: указатель на #HyScanDiscover
+ * @result: результат асинхронной операции #GAsyncResult
+ * @error: (nullable): указатель на #GError
+ *
+ * Функция возвращает результат асинхронного подключения к устройству. В
+ * случае ошибки, отмены или истечения времени подключения в @error
+ * возвращается её описание.
+ *
+ * Returns: (transfer full): #HyScanDevice или NULL в случае ошибки. Для удаления #g_object_unref.
+ */
+HyScanDevice *
+hyscan_discover_connect_finish (HyScanDiscover  *discover,
+                                GAsyncResult    *result,
+                                GError         **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, discover), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/**
+ * hyscan_discover_check_async:
+ * @discover: указатель на #HyScanDiscover
+ * @uri: путь для подключения к устройству
+ * @params: (nullable): параметры драйвера
+ * @timeout: максимальное время проверки, с
+ * @cancellable: (nullable): объект #GCancellable для отмены проверки
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные для функции обратного вызова
+ *
+ * Функция асинхронно проверяет возможность подключения к устройству. По
+ * завершении проверки вызывается функция обратного вызова, в которой
+ * необходимо получить результат функцией #hyscan_discover_check_finish. Если
+ * время проверки меньше или равно нулю, ограничение не используется.
+ * Параметры драйвера не должны изменяться до завершения проверки.
+ */
+void
+hyscan_discover_check_async (HyScanDiscover      *discover,
+                             const gchar         *uri,
+                             HyScanParamList     *params,
+                             gdouble              timeout,
+                             GCancellable        *cancellable,
+                             GAsyncReadyCallback  callback,
+                             gpointer             user_data)
+{
+  g_return_if_fail (HYSCAN_IS_DISCOVER (discover));
+
+  hyscan_discover_async_run (discover, uri, params, FALSE, timeout, cancellable,
+                             callback, user_data, hyscan_discover_check_async);
+}
+
+/**
+ * hyscan_discover_check_finish:
+ * @discover: указатель на #HyScanDiscover
+ * @result: результат асинхронной операции #GAsyncResult
+ * @error: (nullable): указатель на #GError
+ *
+ * Функция возвращает результат асинхронной проверки возможности подключения
+ * к устройству. В случае отмены или истечения времени проверки в @error
+ * возвращается её описание.
+ *
+ * Returns: %TRUE если подключение возможно, иначе %FALSE.
+ */
+gboolean
+hyscan_discover_check_finish (HyScanDiscover  *discover,
+                              GAsyncResult    *result,
+                              GError         **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, discover), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
 }
 
 /**
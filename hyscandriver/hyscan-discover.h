@@ -38,6 +38,7 @@
 #include <hyscan-device.h>
 #include <hyscan-param-list.h>
 #include <hyscan-data-schema.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
@@ -78,6 +79,7 @@ struct _HyScanDiscoverInfo
  * @config: Функция возвращает схему с параметрами драйвера устройства.
  * @check: Функция проверяет возможность подключения к устройству.
  * @connect: Функция производит подключение к устройству.
+ * @get_generation: Функция возвращает номер изменения списка устройств.
  */
 struct _HyScanDiscoverInterface
 {
@@ -99,6 +101,8 @@ struct _HyScanDiscoverInterface
   HyScanDevice *               (*connect)                      (HyScanDiscover                *discover,
                                                                 const gchar                   *uri,
                                                                 HyScanParamList               *params);
+
+  guint                        (*get_generation)               (HyScanDiscover                *discover);
 };
 
 HYSCAN_API
@@ -116,6 +120,9 @@ void                           hyscan_discover_stop            (HyScanDiscover
 HYSCAN_API
 GList *                        hyscan_discover_list            (HyScanDiscover                *discover);
 
+HYSCAN_API
+guint                          hyscan_discover_get_generation  (HyScanDiscover                *discover);
+
 HYSCAN_API
 HyScanDataSchema *             hyscan_discover_config          (HyScanDiscover                *discover,
                                                                 const gchar                   *uri);
@@ -130,6 +137,34 @@ HyScanDevice *                 hyscan_discover_connect         (HyScanDiscover
                                                                 const gchar                   *uri,
                                                                 HyScanParamList               *params);
 
+HYSCAN_API
+void                           hyscan_discover_connect_async   (HyScanDiscover                *discover,
+                                                                const gchar                   *uri,
+                                                                HyScanParamList               *params,
+                                                                gdouble                        timeout,
+                                                                GCancellable                  *cancellable,
+                                                                GAsyncReadyCallback            callback,
+                                                                gpointer                       user_data);
+
+HYSCAN_API
+HyScanDevice *                 hyscan_discover_connect_finish  (HyScanDiscover                *discover,
+                                                                GAsyncResult                  *result,
+                                                                GError                       **error);
+
+HYSCAN_API
+void                           hyscan_discover_check_async     (HyScanDiscover                *discover,
+                                                                const gchar                   *uri,
+                                                                HyScanParamList               *params,
+                                                                gdouble                        timeout,
+                                                                GCancellable                  *cancellable,
+                                                                GAsyncReadyCallback            callback,
+                                                                gpointer                       user_data);
+
+HYSCAN_API
+gboolean                       hyscan_discover_check_finish    (HyScanDiscover                *discover,
+                                                                GAsyncResult                  *result,
+                                                                GError                       **error);
+
 HYSCAN_API
 HyScanDiscoverInfo *           hyscan_discover_info_new        (const gchar                   *name,
                                                                 HyScanDataSchema              *info,
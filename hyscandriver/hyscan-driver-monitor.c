@@ -0,0 +1,388 @@
+/* hyscan-driver-monitor.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-driver-monitor
+ * @Short_description: класс отслеживания изменений драйверов
+ * @Title: HyScanDriverMonitor
+ *
+ * Класс отслеживает появление, замену и удаление файлов драйверов в
+ * указанном каталоге. Каталог проверяется каждую секунду. Об изменении
+ * файла сообщается только после того как его размер и время модификации
+ * перестанут меняться, то есть после завершения копирования файла.
+ *
+ * При появлении нового драйвера посылается сигнал
+ * #HyScanDriverMonitor::driver-added, при замене файла драйвера сигнал
+ * #HyScanDriverMonitor::driver-changed, а при его удалении сигнал
+ * #HyScanDriverMonitor::driver-removed.
+ *
+ * Перед отправкой сигналов об изменении и удалении драйвера вызывается
+ * функция #hyscan_driver_invalidate. Если драйвер ещё не был загружен или
+ * поддерживает перезагрузку, объекты #HyScanDriver, созданные в обработчике
+ * сигнала #HyScanDriverMonitor::driver-changed и позднее, используют новую
+ * версию драйвера. Программа может переключить устройства на новую версию
+ * драйвера с поддержкой перезагрузки в удобный для неё момент, после чего
+ * предыдущая версия будет выгружена. Обычный загруженный драйвер не
+ * выгружается, поэтому для перехода на его новую версию программа должна
+ * быть перезапущена.
+ */
+
+#include "hyscan-driver-monitor.h"
+
+#include <glib/gstdio.h>
+
+#define HYSCAN_DRIVER_NAME_PATTERN     "^hyscan-([0-9A-Za-z]+)\\.drv$"
+
+#define POLL_PERIOD            100     /* Период проверки завершения работы, мс. */
+#define RESCAN_PERIOD          1000000 /* Период проверки каталога с драйверами, мкс. */
+
+enum
+{
+  PROP_O,
+  PROP_PATH
+};
+
+enum
+{
+  SIGNAL_DRIVER_ADDED,
+  SIGNAL_DRIVER_CHANGED,
+  SIGNAL_DRIVER_REMOVED,
+  SIGNAL_LAST
+};
+
+struct _HyScanDriverMonitorPrivate
+{
+  gchar               *path;           /* Путь к каталогу с драйверами. */
+
+  GThread             *watcher;        /* Поток отслеживания изменений. */
+  gint                 shutdown;       /* Признак завершения работы. */
+
+  GRegex              *pattern;        /* Шаблон имени файла драйвера. */
+  GHashTable          *drivers;        /* Известные драйверы и состояние их файлов. */
+  GHashTable          *pending;        /* Изменившиеся файлы драйверов. */
+};
+
+static void        hyscan_driver_monitor_set_property         (GObject               *object,
+                                                               guint                  prop_id,
+                                                               const GValue          *value,
+                                                               GParamSpec            *pspec);
+static void        hyscan_driver_monitor_object_constructed   (GObject               *object);
+static void        hyscan_driver_monitor_object_finalize      (GObject               *object);
+
+static GHashTable *hyscan_driver_monitor_scan                 (HyScanDriverMonitor   *monitor);
+
+static void        hyscan_driver_monitor_update               (HyScanDriverMonitor   *monitor);
+
+static gpointer    hyscan_driver_monitor_watcher              (gpointer               data);
+
+static guint       hyscan_driver_monitor_signals[SIGNAL_LAST] = { 0 };
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanDriverMonitor, hyscan_driver_monitor, G_TYPE_OBJECT)
+
+static void
+hyscan_driver_monitor_class_init (HyScanDriverMonitorClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = hyscan_driver_monitor_set_property;
+
+  object_class->constructed = hyscan_driver_monitor_object_constructed;
+  object_class->finalize = hyscan_driver_monitor_object_finalize;
+
+  g_object_class_install_property (object_class, PROP_PATH,
+    g_param_spec_string ("path", "Path", "Path to device drivers", NULL,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+
+  /**
+   * HyScanDriverMonitor::driver-added:
+   * @monitor: указатель на #HyScanDriverMonitor
+   * @name: название драйвера
+   *
+   * Данный сигнал посылается при появлении нового драйвера. Сигнал
+   * посылается из потока отслеживания изменений, таким образом обработчики
+   * этого сигнала не могут использовать функции работающие через #GMainLoop,
+   * например все функции Gtk.
+   */
+  hyscan_driver_monitor_signals[SIGNAL_DRIVER_ADDED] =
+    g_signal_new ("driver-added", HYSCAN_TYPE_DRIVER_MONITOR, G_SIGNAL_RUN_LAST, 0,
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__STRING,
+                  G_TYPE_NONE, 1, G_TYPE_STRING);
+
+  /**
+   * HyScanDriverMonitor::driver-changed:
+   * @monitor: указатель на #HyScanDriverMonitor
+   * @name: название драйвера
+   *
+   * Данный сигнал посылается при замене файла драйвера новой версией.
+   * Сигнал посылается из потока отслеживания изменений.
+   */
+  hyscan_driver_monitor_signals[SIGNAL_DRIVER_CHANGED] =
+    g_signal_new ("driver-changed", HYSCAN_TYPE_DRIVER_MONITOR, G_SIGNAL_RUN_LAST, 0,
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__STRING,
+                  G_TYPE_NONE, 1, G_TYPE_STRING);
+
+  /**
+   * HyScanDriverMonitor::driver-removed:
+   * @monitor: указатель на #HyScanDriverMonitor
+   * @name: название драйвера
+   *
+   * Данный сигнал посылается при удалении файла драйвера. Сигнал
+   * посылается из потока отслеживания изменений.
+   */
+  hyscan_driver_monitor_signals[SIGNAL_DRIVER_REMOVED] =
+    g_signal_new ("driver-removed", HYSCAN_TYPE_DRIVER_MONITOR, G_SIGNAL_RUN_LAST, 0,
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__STRING,
+                  G_TYPE_NONE, 1, G_TYPE_STRING);
+}
+
+static void
+hyscan_driver_monitor_init (HyScanDriverMonitor *monitor)
+{
+  monitor->priv = hyscan_driver_monitor_get_instance_private (monitor);
+}
+
+static void
+hyscan_driver_monitor_set_property (GObject      *object,
+                                    guint         prop_id,
+                                    const GValue *value,
+                                    GParamSpec   *pspec)
+{
+  HyScanDriverMonitor *monitor = HYSCAN_DRIVER_MONITOR (object);
+  HyScanDriverMonitorPrivate *priv = monitor->priv;
+
+  switch (prop_id)
+    {
+    case PROP_PATH:
+      priv->path = g_value_dup_string (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+hyscan_driver_monitor_object_constructed (GObject *object)
+{
+  HyScanDriverMonitor *monitor = HYSCAN_DRIVER_MONITOR (object);
+  HyScanDriverMonitorPrivate *priv = monitor->priv;
+
+  priv->pattern = g_regex_new (HYSCAN_DRIVER_NAME_PATTERN, G_REGEX_OPTIMIZE, 0, NULL);
+  priv->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  priv->drivers = hyscan_driver_monitor_scan (monitor);
+
+  priv->watcher = g_thread_new ("driver-monitor", hyscan_driver_monitor_watcher, monitor);
+}
+
+static void
+hyscan_driver_monitor_object_finalize (GObject *object)
+{
+  HyScanDriverMonitor *monitor = HYSCAN_DRIVER_MONITOR (object);
+  HyScanDriverMonitorPrivate *priv = monitor->priv;
+
+  g_atomic_int_set (&priv->shutdown, 1);
+  g_thread_join (priv->watcher);
+
+  g_hash_table_unref (priv->drivers);
+  g_hash_table_unref (priv->pending);
+  g_regex_unref (priv->pattern);
+  g_free (priv->path);
+
+  G_OBJECT_CLASS (hyscan_driver_monitor_parent_class)->finalize (object);
+}
+
+/* Функция возвращает таблицу драйверов в каталоге. Ключом таблицы является
+ * название драйвера, а значением строка с размером и временем модификации
+ * файла драйвера. */
+static GHashTable *
+hyscan_driver_monitor_scan (HyScanDriverMonitor *monitor)
+{
+  HyScanDriverMonitorPrivate *priv = monitor->priv;
+  GHashTable *drivers;
+  const gchar *name;
+  GDir *dir;
+
+  drivers = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  dir = g_dir_open (priv->path, 0, NULL);
+  if (dir == NULL)
+    return drivers;
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      GMatchInfo *match_info;
+
+      if (g_regex_match (priv->pattern, name, 0, &match_info))
+        {
+          gchar *module_path;
+          GStatBuf stat_buf;
+
+          module_path = g_build_filename (priv->path, name, NULL);
+          if (g_stat (module_path, &stat_buf) == 0)
+            {
+              g_hash_table_insert (drivers,
+                                   g_match_info_fetch (match_info, 1),
+                                   g_strdup_printf ("%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT,
+                                                    (gint64)stat_buf.st_size,
+                                                    (gint64)stat_buf.st_mtime));
+            }
+
+          g_free (module_path);
+        }
+
+      g_match_info_free (match_info);
+    }
+
+  g_dir_close (dir);
+
+  return drivers;
+}
+
+/* Функция проверяет каталог с драйверами и посылает сигналы об изменениях.
+ * Об изменении файла сообщается, если его состояние не изменилось с момента
+ * предыдущей проверки. */
+static void
+hyscan_driver_monitor_update (HyScanDriverMonitor *monitor)
+{
+  HyScanDriverMonitorPrivate *priv = monitor->priv;
+  GHashTableIter iter;
+  GHashTable *drivers;
+  GList *removed = NULL;
+  GList *link;
+  gpointer name;
+  gpointer state;
+
+  drivers = hyscan_driver_monitor_scan (monitor);
+
+  /* Новые и изменившиеся драйверы. */
+  g_hash_table_iter_init (&iter, drivers);
+  while (g_hash_table_iter_next (&iter, &name, &state))
+    {
+      const gchar *known_state = g_hash_table_lookup (priv->drivers, name);
+      const gchar *pending_state = g_hash_table_lookup (priv->pending, name);
+      gboolean added;
+
+      if (g_strcmp0 (known_state, state) == 0)
+        {
+          g_hash_table_remove (priv->pending, name);
+          continue;
+        }
+
+      /* Файл ещё изменяется. */
+      if (g_strcmp0 (pending_state, state) != 0)
+        {
+          g_hash_table_insert (priv->pending, g_strdup (name), g_strdup (state));
+          continue;
+        }
+
+      added = (known_state == NULL);
+
+      g_hash_table_remove (priv->pending, name);
+      g_hash_table_insert (priv->drivers, g_strdup (name), g_strdup (state));
+
+      if (added)
+        {
+          g_signal_emit (monitor, hyscan_driver_monitor_signals[SIGNAL_DRIVER_ADDED], 0, name);
+        }
+      else
+        {
+          hyscan_driver_invalidate (priv->path, name);
+          g_signal_emit (monitor, hyscan_driver_monitor_signals[SIGNAL_DRIVER_CHANGED], 0, name);
+        }
+    }
+
+  /* Удалённые драйверы. */
+  g_hash_table_iter_init (&iter, priv->drivers);
+  while (g_hash_table_iter_next (&iter, &name, NULL))
+    {
+      if (!g_hash_table_contains (drivers, name))
+        removed = g_list_prepend (removed, g_strdup (name));
+    }
+
+  for (link = removed; link != NULL; link = link->next)
+    {
+      g_hash_table_remove (priv->drivers, link->data);
+      g_hash_table_remove (priv->pending, link->data);
+
+      hyscan_driver_invalidate (priv->path, link->data);
+      g_signal_emit (monitor, hyscan_driver_monitor_signals[SIGNAL_DRIVER_REMOVED], 0, link->data);
+    }
+
+  g_list_free_full (removed, g_free);
+  g_hash_table_unref (drivers);
+}
+
+/* Поток отслеживания изменений. */
+static gpointer
+hyscan_driver_monitor_watcher (gpointer data)
+{
+  HyScanDriverMonitor *monitor = data;
+  HyScanDriverMonitorPrivate *priv = monitor->priv;
+  gint64 rescan_time = g_get_monotonic_time () + RESCAN_PERIOD;
+
+  while (!g_atomic_int_get (&priv->shutdown))
+    {
+      g_usleep (POLL_PERIOD * 1000);
+
+      if (g_get_monotonic_time () < rescan_time)
+        continue;
+
+      rescan_time = g_get_monotonic_time () + RESCAN_PERIOD;
+
+      hyscan_driver_monitor_update (monitor);
+    }
+
+  return NULL;
+}
+
+/**
+ * hyscan_driver_monitor_new:
+ * @path: путь к каталогу с драйверами
+ *
+ * Функция создаёт новый объект #HyScanDriverMonitor и запускает поток
+ * отслеживания изменений в каталоге с драйверами.
+ *
+ * Returns: #HyScanDriverMonitor. Для удаления #g_object_unref.
+ */
+HyScanDriverMonitor *
+hyscan_driver_monitor_new (const gchar *path)
+{
+  return g_object_new (HYSCAN_TYPE_DRIVER_MONITOR,
+                       "path", path,
+                       NULL);
+}
@@ -0,0 +1,424 @@
+/* hyscan-driver-profile.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-driver-profile
+ * @Short_description: профилирование загрузки драйверов
+ * @Title: HyScanDriverProfile
+ *
+ * Функции предназначены для сбора информации о времени выполнения этапов
+ * работы драйверов: загрузки модуля, поиска функций драйвера, формирования
+ * информации о драйвере, поиска устройств, подключения к устройству и
+ * приёма первых гидроакустических данных. Этапы перечислены в
+ * #HyScanDriverProfilePhase.
+ *
+ * Профилирование включается функцией #hyscan_driver_profile_set_enabled
+ * или переменной окружения HYSCAN_DRIVER_PROFILE=1. Если профилирование
+ * выключено, измерения не выполняются.
+ *
+ * Время выполнения этапов сохраняется отдельно для каждого драйвера.
+ * Классы #HyScanDriver и #HyScanDiscover измеряют время автоматически.
+ * Поиск устройств и подключение к ним измеряются только для объектов
+ * #HyScanDiscover, которым назначено название функцией
+ * #hyscan_driver_profile_set_name. Класс #HyScanDriver назначает его
+ * объектам, созданным драйверами.
+ *
+ * Собранную информацию можно получить в виде текстового отчёта функцией
+ * #hyscan_driver_profile_get_report или в формате Chrome Trace Event (JSON)
+ * функцией #hyscan_driver_profile_get_trace. Второй вариант можно открыть в
+ * chrome://tracing или https://ui.perfetto.dev. Время в отчётах отсчитывается
+ * от момента первого включения профилирования.
+ *
+ * Сохраняются только этапы, начавшиеся после включения профилирования.
+ * Текстовый отчёт учитывает все сохранённые этапы, а для диаграммы
+ * хранятся только последние 4096 этапов.
+ */
+
+#include "hyscan-driver-profile.h"
+
+#define HYSCAN_DRIVER_PROFILE_NAME_KEY "hyscan-driver-profile-name"
+
+#define HYSCAN_DRIVER_PROFILE_N_PHASES (HYSCAN_DRIVER_PROFILE_FIRST_DATA + 1)
+#define HYSCAN_DRIVER_PROFILE_N_EVENTS 4096            /* Число этапов, хранимых для диаграммы. */
+
+typedef struct
+{
+  guint                        count;          /* Число измерений. */
+  gint64                       total;          /* Суммарное время выполнения, мкс. */
+  gint64                       max;            /* Максимальное время выполнения, мкс. */
+  gint64                       first;          /* Время первого начала этапа, мкс. */
+} HyScanDriverProfileStat;
+
+typedef struct
+{
+  gchar                       *name;           /* Название драйвера. */
+  guint                        index;          /* Порядковый номер драйвера. */
+  HyScanDriverProfileStat      stats[HYSCAN_DRIVER_PROFILE_N_PHASES];
+} HyScanDriverProfileDriver;
+
+typedef struct
+{
+  HyScanDriverProfileDriver   *driver;         /* Драйвер. */
+  HyScanDriverProfilePhase     phase;          /* Этап работы драйвера. */
+  gint64                       start;          /* Время начала этапа, мкс. */
+  gint64                       end;            /* Время окончания этапа, мкс. */
+} HyScanDriverProfileEvent;
+
+static const gchar *hyscan_driver_profile_phases[] =
+{
+  "load",
+  "symbols",
+  "info",
+  "discover",
+  "connect",
+  "first-data"
+};
+
+static gint hyscan_driver_profile_enabled = -1;
+static gint64 hyscan_driver_profile_start = 0;
+static gint64 hyscan_driver_profile_enable_time = 0;
+
+static GPtrArray *hyscan_driver_profile_drivers = NULL;
+static GHashTable *hyscan_driver_profile_names = NULL;
+static HyScanDriverProfileEvent *hyscan_driver_profile_events = NULL;
+static guint hyscan_driver_profile_n_events = 0;
+static guint hyscan_driver_profile_last_event = 0;
+
+G_LOCK_DEFINE_STATIC (hyscan_driver_profile);
+
+/* Функция освобождает память, занятую записью о драйвере. */
+static void
+hyscan_driver_profile_driver_free (gpointer data)
+{
+  HyScanDriverProfileDriver *driver = data;
+
+  g_free (driver->name);
+  g_slice_free (HyScanDriverProfileDriver, driver);
+}
+
+/* Функция возвращает запись о драйвере, создавая её при необходимости.
+ * Функция должна вызываться при захваченной блокировке. */
+static HyScanDriverProfileDriver *
+hyscan_driver_profile_driver (const gchar *name)
+{
+  HyScanDriverProfileDriver *driver;
+
+  if (hyscan_driver_profile_drivers == NULL)
+    {
+      hyscan_driver_profile_drivers = g_ptr_array_new_with_free_func (hyscan_driver_profile_driver_free);
+      hyscan_driver_profile_names = g_hash_table_new (g_str_hash, g_str_equal);
+      hyscan_driver_profile_events = g_new0 (HyScanDriverProfileEvent, HYSCAN_DRIVER_PROFILE_N_EVENTS);
+    }
+
+  driver = g_hash_table_lookup (hyscan_driver_profile_names, name);
+  if (driver != NULL)
+    return driver;
+
+  driver = g_slice_new0 (HyScanDriverProfileDriver);
+  driver->name = g_strdup (name);
+  driver->index = hyscan_driver_profile_drivers->len;
+
+  g_ptr_array_add (hyscan_driver_profile_drivers, driver);
+  g_hash_table_insert (hyscan_driver_profile_names, driver->name, driver);
+
+  return driver;
+}
+
+/**
+ * hyscan_driver_profile_is_enabled:
+ *
+ * Функция проверяет, включено ли профилирование.
+ *
+ * Returns: %TRUE если профилирование включено, иначе %FALSE.
+ */
+gboolean
+hyscan_driver_profile_is_enabled (void)
+{
+  gint enabled = g_atomic_int_get (&hyscan_driver_profile_enabled);
+
+  if (enabled < 0)
+    {
+      const gchar *env = g_getenv ("HYSCAN_DRIVER_PROFILE");
+
+      enabled = (env != NULL) && (g_strcmp0 (env, "0") != 0);
+      hyscan_driver_profile_set_enabled (enabled);
+    }
+
+  return enabled;
+}
+
+/**
+ * hyscan_driver_profile_set_enabled:
+ * @enabled: признак включения профилирования
+ *
+ * Функция включает или выключает профилирование.
+ */
+void
+hyscan_driver_profile_set_enabled (gboolean enabled)
+{
+  G_LOCK (hyscan_driver_profile);
+
+  if (enabled && (g_atomic_int_get (&hyscan_driver_profile_enabled) != 1))
+    hyscan_driver_profile_enable_time = g_get_monotonic_time ();
+
+  if (enabled && (hyscan_driver_profile_start == 0))
+    hyscan_driver_profile_start = hyscan_driver_profile_enable_time;
+
+  g_atomic_int_set (&hyscan_driver_profile_enabled, enabled ? 1 : 0);
+
+  G_UNLOCK (hyscan_driver_profile);
+}
+
+/**
+ * hyscan_driver_profile_add:
+ * @name: название драйвера
+ * @phase: этап работы драйвера #HyScanDriverProfilePhase
+ * @start: время начала этапа по #g_get_monotonic_time, мкс
+ * @end: время окончания этапа по #g_get_monotonic_time, мкс
+ *
+ * Функция сохраняет время выполнения этапа работы драйвера. Если
+ * профилирование выключено или этап начался до его включения, функция
+ * ничего не делает.
+ */
+void
+hyscan_driver_profile_add (const gchar              *name,
+                           HyScanDriverProfilePhase  phase,
+                           gint64                    start,
+                           gint64                    end)
+{
+  HyScanDriverProfileDriver *driver;
+  HyScanDriverProfileStat *stat;
+  HyScanDriverProfileEvent *event;
+
+  g_return_if_fail (name != NULL);
+  g_return_if_fail (phase <= HYSCAN_DRIVER_PROFILE_FIRST_DATA);
+
+  if (!hyscan_driver_profile_is_enabled ())
+    return;
+
+  end = MAX (start, end);
+
+  G_LOCK (hyscan_driver_profile);
+
+  if (!g_atomic_int_get (&hyscan_driver_profile_enabled) ||
+      (start < hyscan_driver_profile_enable_time))
+    {
+      G_UNLOCK (hyscan_driver_profile);
+      return;
+    }
+
+  driver = hyscan_driver_profile_driver (name);
+
+  /* Статистика этапа. */
+  stat = &driver->stats[phase];
+  stat->first = (stat->count == 0) ? start : MIN (stat->first, start);
+  stat->count += 1;
+  stat->total += end - start;
+  stat->max = MAX (stat->max, end - start);
+
+  /* Последние этапы для диаграммы. */
+  hyscan_driver_profile_last_event = (hyscan_driver_profile_last_event + 1) % HYSCAN_DRIVER_PROFILE_N_EVENTS;
+  if (hyscan_driver_profile_n_events < HYSCAN_DRIVER_PROFILE_N_EVENTS)
+    hyscan_driver_profile_n_events += 1;
+
+  event = &hyscan_driver_profile_events[hyscan_driver_profile_last_event];
+  event->driver = driver;
+  event->phase = phase;
+  event->start = start;
+  event->end = end;
+
+  G_UNLOCK (hyscan_driver_profile);
+}
+
+/**
+ * hyscan_driver_profile_set_name:
+ * @object: указатель на #GObject
+ * @name: название драйвера
+ *
+ * Функция назначает объекту название драйвера, под которым сохраняется
+ * время выполнения этапов работы с этим объектом.
+ */
+void
+hyscan_driver_profile_set_name (GObject     *object,
+                                const gchar *name)
+{
+  g_return_if_fail (G_IS_OBJECT (object));
+
+  g_object_set_data_full (object, HYSCAN_DRIVER_PROFILE_NAME_KEY, g_strdup (name), g_free);
+}
+
+/**
+ * hyscan_driver_profile_get_name:
+ * @object: указатель на #GObject
+ *
+ * Функция возвращает название драйвера, назначенное объекту.
+ *
+ * Returns: Название драйвера или NULL.
+ */
+const gchar *
+hyscan_driver_profile_get_name (GObject *object)
+{
+  g_return_val_if_fail (G_IS_OBJECT (object), NULL);
+
+  return g_object_get_data (object, HYSCAN_DRIVER_PROFILE_NAME_KEY);
+}
+
+/**
+ * hyscan_driver_profile_get_report:
+ *
+ * Функция возвращает текстовый отчёт о времени выполнения этапов работы
+ * драйверов. Для каждого драйвера и этапа выводится число измерений,
+ * суммарное и максимальное время выполнения, а также время первого начала
+ * этапа относительно включения профилирования.
+ *
+ * Returns: Текстовый отчёт. Для удаления #g_free.
+ */
+gchar *
+hyscan_driver_profile_get_report (void)
+{
+  GString *report;
+  guint i;
+
+  report = g_string_new (NULL);
+  g_string_append_printf (report, "%-24s %-12s %6s %12s %12s %12s\n",
+                          "driver", "phase", "count", "total, ms", "max, ms", "first, ms");
+
+  G_LOCK (hyscan_driver_profile);
+
+  for (i = 0; (hyscan_driver_profile_drivers != NULL) && (i < hyscan_driver_profile_drivers->len); i++)
+    {
+      HyScanDriverProfileDriver *driver = g_ptr_array_index (hyscan_driver_profile_drivers, i);
+      guint phase;
+
+      for (phase = HYSCAN_DRIVER_PROFILE_LOAD; phase <= HYSCAN_DRIVER_PROFILE_FIRST_DATA; phase++)
+        {
+          HyScanDriverProfileStat *stat = &driver->stats[phase];
+
+          if (stat->count == 0)
+            continue;
+
+          g_string_append_printf (report, "%-24s %-12s %6u %12.3f %12.3f %12.3f\n",
+                                  driver->name, hyscan_driver_profile_phases[phase], stat->count,
+                                  stat->total / 1000.0, stat->max / 1000.0,
+                                  (stat->first - hyscan_driver_profile_start) / 1000.0);
+        }
+    }
+
+  G_UNLOCK (hyscan_driver_profile);
+
+  return g_string_free (report, FALSE);
+}
+
+/**
+ * hyscan_driver_profile_get_trace:
+ *
+ * Функция возвращает информацию о времени выполнения этапов работы
+ * драйверов в формате Chrome Trace Event (JSON). Этапы каждого драйвера
+ * размещаются в отдельной строке диаграммы. Приём первых данных
+ * отображается как интервал от подключения до получения данных.
+ *
+ * Returns: Строка JSON. Для удаления #g_free.
+ */
+gchar *
+hyscan_driver_profile_get_trace (void)
+{
+  GString *trace;
+  guint i;
+
+  trace = g_string_new ("{\"traceEvents\":[");
+
+  G_LOCK (hyscan_driver_profile);
+
+  /* Названия строк диаграммы. */
+  for (i = 0; (hyscan_driver_profile_drivers != NULL) && (i < hyscan_driver_profile_drivers->len); i++)
+    {
+      HyScanDriverProfileDriver *driver = g_ptr_array_index (hyscan_driver_profile_drivers, i);
+      gchar *name = g_strescape (driver->name, NULL);
+
+      g_string_append_printf (trace,
+                              "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                              "\"args\":{\"name\":\"%s\"}}",
+                              (i > 0) ? "," : "", i + 1, name);
+
+      g_free (name);
+    }
+
+  /* Этапы работы драйверов в порядке сохранения. */
+  for (i = 0; i < hyscan_driver_profile_n_events; i++)
+    {
+      HyScanDriverProfileEvent *event;
+      guint index;
+      gchar *name;
+
+      index = hyscan_driver_profile_last_event + HYSCAN_DRIVER_PROFILE_N_EVENTS - hyscan_driver_profile_n_events + i + 1;
+      event = &hyscan_driver_profile_events[index % HYSCAN_DRIVER_PROFILE_N_EVENTS];
+      name = g_strescape (event->driver->name, NULL);
+
+      g_string_append_printf (trace,
+                              ",\n{\"name\":\"%s\",\"cat\":\"driver\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                              "\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT ","
+                              "\"args\":{\"driver\":\"%s\"}}",
+                              hyscan_driver_profile_phases[event->phase], event->driver->index + 1,
+                              event->start - hyscan_driver_profile_start,
+                              event->end - event->start,
+                              name);
+
+      g_free (name);
+    }
+
+  G_UNLOCK (hyscan_driver_profile);
+
+  g_string_append (trace, "\n]}\n");
+
+  return g_string_free (trace, FALSE);
+}
+
+/**
+ * hyscan_driver_profile_clear:
+ *
+ * Функция удаляет всю собранную информацию.
+ */
+void
+hyscan_driver_profile_clear (void)
+{
+  G_LOCK (hyscan_driver_profile);
+
+  g_clear_pointer (&hyscan_driver_profile_names, g_hash_table_unref);
+  g_clear_pointer (&hyscan_driver_profile_drivers, g_ptr_array_unref);
+  g_clear_pointer (&hyscan_driver_profile_events, g_free);
+  hyscan_driver_profile_n_events = 0;
+  hyscan_driver_profile_last_event = 0;
+
+  G_UNLOCK (hyscan_driver_profile);
+}
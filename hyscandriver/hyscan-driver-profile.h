@@ -0,0 +1,93 @@
+/* hyscan-driver-profile.h
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_DRIVER_PROFILE_H__
+#define __HYSCAN_DRIVER_PROFILE_H__
+
+#include <hyscan-types.h>
+
+G_BEGIN_DECLS
+
+/**
+ * HyScanDriverProfilePhase:
+ * @HYSCAN_DRIVER_PROFILE_LOAD: загрузка модуля драйвера
+ * @HYSCAN_DRIVER_PROFILE_SYMBOLS: поиск функций драйвера
+ * @HYSCAN_DRIVER_PROFILE_INFO: формирование информации о драйвере
+ * @HYSCAN_DRIVER_PROFILE_DISCOVER: поиск устройств, от запуска до завершения
+ * @HYSCAN_DRIVER_PROFILE_CONNECT: подключение к устройству
+ * @HYSCAN_DRIVER_PROFILE_FIRST_DATA: приём первых гидроакустических данных после подключения
+ *
+ * Этапы работы драйвера.
+ */
+typedef enum
+{
+  HYSCAN_DRIVER_PROFILE_LOAD,
+  HYSCAN_DRIVER_PROFILE_SYMBOLS,
+  HYSCAN_DRIVER_PROFILE_INFO,
+  HYSCAN_DRIVER_PROFILE_DISCOVER,
+  HYSCAN_DRIVER_PROFILE_CONNECT,
+  HYSCAN_DRIVER_PROFILE_FIRST_DATA
+} HyScanDriverProfilePhase;
+
+HYSCAN_API
+gboolean               hyscan_driver_profile_is_enabled        (void);
+
+HYSCAN_API
+void                   hyscan_driver_profile_set_enabled       (gboolean                  enabled);
+
+HYSCAN_API
+void                   hyscan_driver_profile_add               (const gchar              *name,
+                                                                HyScanDriverProfilePhase  phase,
+                                                                gint64                    start,
+                                                                gint64                    end);
+
+HYSCAN_API
+void                   hyscan_driver_profile_set_name          (GObject                  *object,
+                                                                const gchar              *name);
+
+HYSCAN_API
+const gchar *          hyscan_driver_profile_get_name          (GObject                  *object);
+
+HYSCAN_API
+gchar *                hyscan_driver_profile_get_report        (void);
+
+HYSCAN_API
+gchar *                hyscan_driver_profile_get_trace         (void);
+
+HYSCAN_API
+void                   hyscan_driver_profile_clear             (void);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_DRIVER_PROFILE_H__ */
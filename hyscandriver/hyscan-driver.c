@@ -53,6 +53,10 @@
  * #HyScanDataSchema. Этот объект должен содержать схему параметров с
  * информацией о драйвере.
  *
+ * Сигналы #HyScanDiscover::progress, #HyScanDiscover::completed,
+ * #HyScanDiscover::device-found и #HyScanDiscover::device-lost объекта,
+ * возвращённого драйвером, передаются через объект #HyScanDriver.
+ *
  * После загрузки драйвера и подключения к гидролокатору или датчику можно
  * использовать интерфейсы #HyScanSonar и #HyScanSensor для работы с этими
  * устройствами.
@@ -62,7 +66,15 @@
  * указатель на новый объект, иначе возвращается NULL.
  *
  * Драйвер, загруженный с помощью функции #hyscan_driver_new, не выгружается
- * из памяти до окончания работы программы, даже если удалить объект.
+ * из памяти до окончания работы программы, даже если удалить объект. Это не
+ * относится к драйверам с поддержкой перезагрузки, описанным ниже.
+ *
+ * Загруженные драйверы хранятся в общем для процесса реестре модулей. Для
+ * каждого файла драйвера модуль загружается один раз, а объект
+ * #HyScanDiscover и информация о драйвере создаются при первом обращении и
+ * затем используются всеми объектами #HyScanDriver этого драйвера. Повторные
+ * вызовы функции #hyscan_driver_get_info возвращают информацию из реестра без
+ * обращения к файлу драйвера.
  *
  * Информацию о драйвере можно узнать с помощью функции #hyscan_driver_get_info.
  * Информация возвращается в виде схемы данных со значениями по умолчанию.
@@ -77,20 +89,77 @@
  *
  * Схема данных может содержать дополнительные поля.
  *
+ * Драйверы, скомпонованные с программой, регистрируются функцией
+ * #hyscan_driver_builtin_register. Такие драйверы не требуют загрузки
+ * динамических библиотек и используются так же, как и загружаемые.
+ *
+ * При замене файла драйвера новой версией необходимо вызвать функцию
+ * #hyscan_driver_invalidate. Если драйвер ещё не загружен, новые объекты
+ * #HyScanDriver используют новую версию драйвера. Обычный загруженный
+ * драйвер продолжает использоваться до перезапуска программы, так как
+ * выгрузка модуля со статически зарегистрированными в нём типами GObject
+ * невозможна. Для автоматического отслеживания изменений в каталоге с
+ * драйверами предназначен класс #HyScanDriverMonitor.
+ *
+ * Драйвер с поддержкой перезагрузки дополнительно экспортирует функцию
+ * "hyscan_driver_reloadable" типа #HyScanDriverReloadableFunc. Эта функция
+ * вызывается при каждой загрузке драйвера и должна регистрировать все типы
+ * GObject драйвера в переданном ей #GTypeModule, например функцией
+ * #g_type_module_register_type. Для каждой загруженной версии драйвера
+ * создаётся отдельный модуль типов с уникальным названием, которое драйвер
+ * должен добавлять к названиям своих типов, так как разные версии
+ * драйвера используются одновременно. Драйвер не должен хранить ссылки на
+ * свои объекты, а объект, возвращаемый функцией "hyscan_driver_discover",
+ * и подключенные через него устройства должны иметь типы, реализованные
+ * драйвером.
+ *
+ * После вызова #hyscan_driver_invalidate для такого драйвера новые объекты
+ * #HyScanDriver загружают новую версию драйвера параллельно с предыдущей.
+ * Уже созданные объекты и подключенные через них устройства продолжают
+ * работать с предыдущей версией, поэтому программа может переключить
+ * устройства на новую версию в удобный для неё момент. Предыдущая версия
+ * выгружается после удаления последнего объекта её типов, то есть после
+ * удаления всех использующих её объектов #HyScanDriver и устройств.
+ *
  * Функция #hyscan_driver_list возвращает список драйверов, доступных для
- * загрузки из указанного каталога.
+ * загрузки из указанного каталога. Список упорядочен по названиям драйверов.
+ * Драйверы, информация о которых отсутствует в кэше, проверяются параллельно
+ * в пуле потоков. Время загрузки каждого драйвера выводится в отладочных
+ * сообщениях, что позволяет найти медленно загружаемые драйверы.
+ *
+ * Для ускорения работы функций #hyscan_driver_list и #hyscan_driver_get_info
+ * информация о драйверах сохраняется в кэш - файл hyscan-drivers.cache в
+ * каталоге с драйверами. Если запись в этот каталог запрещена, кэш
+ * размещается в пользовательском каталоге кэша. Для каждого драйвера в кэше
+ * хранятся размер, время модификации и контрольная сумма файла, а также
+ * схема с информацией о драйвере. Драйвер загружается только если его файл
+ * изменился с момента сохранения информации. Использование кэша можно
+ * отключить, установив переменную окружения HYSCAN_DRIVER_CACHE=0.
  */
 
 #include "hyscan-driver-schema.h"
+#include "hyscan-driver-profile.h"
 #include "hyscan-driver.h"
 
+#include <glib/gstdio.h>
 #include <gmodule.h>
 #include <string.h>
 
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#else
+#define W_OK 2
+#endif
+
 #define HYSCAN_DRIVER_NAME_PREFIX      "hyscan"
 #define HYSCAN_DRIVER_NAME_EXTENSION   "drv"
 #define HYSCAN_DRIVER_DISCOVER_SYMBOL  "hyscan_driver_discover"
 #define HYSCAN_DRIVER_INFO_SYMBOL      "hyscan_driver_info"
+#define HYSCAN_DRIVER_RELOAD_SYMBOL    "hyscan_driver_reloadable"
+
+#define HYSCAN_DRIVER_CACHE_NAME       "hyscan-drivers.cache"
+#define HYSCAN_DRIVER_CACHE_GROUP      "cache"
+#define HYSCAN_DRIVER_CACHE_VERSION    1
 
 enum
 {
@@ -99,13 +168,50 @@ enum
   PROP_NAME
 };
 
-typedef HyScanDiscover *(*hyscan_discover_func) (void);
-typedef HyScanDataSchema *(*hyscan_info_func) (void);
+typedef struct
+{
+  GTypeModule                  parent_instance;
+
+  gchar                       *name;           /* Название драйвера. */
+  gchar                       *module_path;    /* Путь к файлу драйвера. */
+  gchar                       *load_path;      /* Путь к загруженной копии файла драйвера. */
+  GModule                     *module;         /* Загруженный модуль драйвера. */
+  gboolean                     unloaded;       /* Признак выгрузки драйвера. */
+} HyScanDriverTypeModule;
+
+typedef struct
+{
+  GTypeModuleClass             parent_class;
+} HyScanDriverTypeModuleClass;
+
+typedef struct
+{
+  gchar                       *path;           /* Путь к каталогу с драйверами. */
+  gchar                       *name;           /* Название драйвера. */
+  gchar                       *module_path;    /* Путь к файлу драйвера. */
+  GModule                     *module;         /* Загруженный модуль драйвера. */
+  HyScanDriverTypeModule      *types;          /* Модуль типов драйвера с поддержкой перезагрузки. */
+  HyScanDriverDiscoverFunc     discover_func;  /* Функция встроенного драйвера hyscan_driver_discover. */
+  HyScanDriverInfoFunc         info_func;      /* Функция встроенного драйвера hyscan_driver_info. */
+  HyScanDiscover              *discover;       /* Интерфейс HyScanDiscover. */
+  HyScanDataSchema            *info;           /* Информация о драйвере. */
+  gint                         ref_count;      /* Число пользователей модуля. */
+  gboolean                     stale;          /* Признак заменённой версии драйвера. */
+} HyScanDriverModule;
+
+typedef struct
+{
+  gchar                       *name;           /* Название драйвера. */
+  HyScanDataSchema            *info;           /* Информация о драйвере. */
+  gboolean                     need_load;      /* Признак необходимости загрузки драйвера. */
+  gint64                       time;           /* Время загрузки драйвера, мкс. */
+} HyScanDriverScanJob;
 
 struct _HyScanDriverPrivate
 {
   gchar                       *path;           /* Путь к драйверу. */
   gchar                       *name;           /* Название драёвера. */
+  HyScanDriverModule          *module;         /* Модуль драйвера. */
   HyScanDiscover              *discover;       /* Интерфейс HyScanDiscover */
 };
 
@@ -117,16 +223,93 @@ static void                    hyscan_driver_set_property        (GObject
 static void                    hyscan_driver_object_constructed  (GObject                 *object);
 static void                    hyscan_driver_object_finalize     (GObject                 *object);
 
+static void                    hyscan_driver_progress            (HyScanDiscover          *discover,
+                                                                  gdouble                  progress,
+                                                                  HyScanDriver            *driver);
+static void                    hyscan_driver_completed           (HyScanDiscover          *discover,
+                                                                  HyScanDriver            *driver);
+static void                    hyscan_driver_device_found        (HyScanDiscover          *discover,
+                                                                  HyScanDiscoverInfo      *info,
+                                                                  HyScanDriver            *driver);
+static void                    hyscan_driver_device_lost         (HyScanDiscover          *discover,
+                                                                  HyScanDiscoverInfo      *info,
+                                                                  HyScanDriver            *driver);
+
 static HyScanDiscover *        hyscan_driver_get_discover_int    (GModule                 *module);
-static HyScanDataSchema *      hyscan_driver_get_info_int        (GModule                 *module);
+static HyScanDataSchema *      hyscan_driver_get_info_int        (GModule                 *module,
+                                                                  const gchar             *name);
+static HyScanDiscover *        hyscan_driver_call_discover       (HyScanDriverDiscoverFunc discover_func);
+static HyScanDataSchema *      hyscan_driver_call_info           (HyScanDriverInfoFunc     info_func,
+                                                                  const gchar             *name);
 
+static gchar *                 hyscan_driver_module_name         (const gchar             *name);
 static GModule *               hyscan_driver_load_driver         (const gchar             *path,
+                                                                  const gchar             *name,
+                                                                  gchar                  **load_path);
+static GModule *               hyscan_driver_open_module         (const gchar             *module_path,
+                                                                  const gchar             *name);
+static GModule *               hyscan_driver_open_version        (const gchar             *module_path,
+                                                                  const gchar             *name,
+                                                                  gchar                  **load_path);
+static gchar *                 hyscan_driver_copy_module         (const gchar             *module_path);
+static void                    hyscan_driver_remove_copy         (const gchar             *load_path);
+
+static gboolean                hyscan_driver_type_module_load    (GTypeModule             *type_module);
+static void                    hyscan_driver_type_module_unload  (GTypeModule             *type_module);
+
+static HyScanDriverModule *    hyscan_driver_module_find         (const gchar             *path,
+                                                                  const gchar             *name);
+static HyScanDriverModule *    hyscan_driver_module_lookup       (const gchar             *path,
+                                                                  const gchar             *name);
+static HyScanDriverModule *    hyscan_driver_module_acquire      (const gchar             *path,
                                                                   const gchar             *name);
+static void                    hyscan_driver_module_open         (HyScanDriverModule      *module);
+static void                    hyscan_driver_module_release      (HyScanDriverModule      *module);
+static void                    hyscan_driver_module_free         (gpointer                 data);
+static gchar **                hyscan_driver_builtin_list        (void);
+
+static gchar *                 hyscan_driver_cache_path          (const gchar             *path);
+static GKeyFile *              hyscan_driver_cache_load          (const gchar             *path);
+static void                    hyscan_driver_cache_save          (const gchar             *path,
+                                                                  GKeyFile                *cache);
+static gchar *                 hyscan_driver_cache_hash          (const gchar             *module_path);
+static gboolean                hyscan_driver_cache_lookup        (GKeyFile                *cache,
+                                                                  const gchar             *path,
+                                                                  const gchar             *name,
+                                                                  HyScanDataSchema       **info,
+                                                                  gboolean                *updated);
+static void                    hyscan_driver_cache_store         (GKeyFile                *cache,
+                                                                  const gchar             *path,
+                                                                  const gchar             *name,
+                                                                  HyScanDataSchema        *info);
+static HyScanDataSchema *      hyscan_driver_cache_get_info      (GKeyFile                *cache,
+                                                                  const gchar             *path,
+                                                                  const gchar             *name,
+                                                                  gboolean                *updated);
+
+static void                    hyscan_driver_scan_func           (gpointer                 data,
+                                                                  gpointer                 user_data);
+static GRegex *                hyscan_driver_name_regex          (void);
+static gint                    hyscan_driver_scan_compare        (gconstpointer            a,
+                                                                  gconstpointer            b);
+static gint                    hyscan_driver_name_compare        (gconstpointer            a,
+                                                                  gconstpointer            b);
+
+static GHashTable *hyscan_driver_modules = NULL;
+static GHashTable *hyscan_driver_builtins = NULL;
+static GList *hyscan_driver_type_modules = NULL;
+static guint hyscan_driver_type_modules_counter = 0;
+
+G_LOCK_DEFINE_STATIC (hyscan_driver_registry);
+G_LOCK_DEFINE_STATIC (hyscan_driver_types);
+G_LOCK_DEFINE_STATIC (hyscan_driver_cache);
 
 G_DEFINE_TYPE_WITH_CODE (HyScanDriver, hyscan_driver, G_TYPE_OBJECT,
                          G_ADD_PRIVATE (HyScanDriver)
                          G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_DISCOVER, hyscan_driver_interface_init))
 
+G_DEFINE_TYPE (HyScanDriverTypeModule, hyscan_driver_type_module, G_TYPE_TYPE_MODULE)
+
 static void
 hyscan_driver_class_init (HyScanDriverClass *klass)
 {
@@ -152,6 +335,20 @@ hyscan_driver_init (HyScanDriver *driver)
   driver->priv = hyscan_driver_get_instance_private (driver);
 }
 
+static void
+hyscan_driver_type_module_class_init (HyScanDriverTypeModuleClass *klass)
+{
+  GTypeModuleClass *type_module_class = G_TYPE_MODULE_CLASS (klass);
+
+  type_module_class->load = hyscan_driver_type_module_load;
+  type_module_class->unload = hyscan_driver_type_module_unload;
+}
+
+static void
+hyscan_driver_type_module_init (HyScanDriverTypeModule *types)
+{
+}
+
 static void
 hyscan_driver_set_property (GObject      *object,
                              guint         prop_id,
@@ -182,15 +379,25 @@ hyscan_driver_object_constructed (GObject *object)
 {
   HyScanDriver *driver = HYSCAN_DRIVER (object);
   HyScanDriverPrivate *priv = driver->priv;
-  GModule *module;
 
   /* Загрузка драйвера. */
-  module = hyscan_driver_load_driver (priv->path, priv->name);
+  priv->module = hyscan_driver_module_acquire (priv->path, priv->name);
 
   /* Интерфейс HyScanDiscover. */
-  priv->discover = hyscan_driver_get_discover_int (module);
-  if (priv->discover == NULL)
-    g_clear_pointer (&module, g_module_close);
+  if (priv->module == NULL)
+    return;
+
+  priv->discover = g_object_ref (priv->module->discover);
+
+  /* Сигналы процесса поиска устройств драйвером. */
+  g_signal_connect (priv->discover, "progress",
+                    G_CALLBACK (hyscan_driver_progress), driver);
+  g_signal_connect (priv->discover, "completed",
+                    G_CALLBACK (hyscan_driver_completed), driver);
+  g_signal_connect (priv->discover, "device-found",
+                    G_CALLBACK (hyscan_driver_device_found), driver);
+  g_signal_connect (priv->discover, "device-lost",
+                    G_CALLBACK (hyscan_driver_device_lost), driver);
 }
 
 static void
@@ -202,38 +409,71 @@ hyscan_driver_object_finalize (GObject *object)
   g_free (priv->path);
   g_free (priv->name);
 
+  if (priv->discover != NULL)
+    g_signal_handlers_disconnect_by_data (priv->discover, driver);
+
   g_clear_object (&priv->discover);
+  g_clear_pointer (&priv->module, hyscan_driver_module_release);
 
   G_OBJECT_CLASS (hyscan_driver_parent_class)->finalize (object);
 }
 
+/* Обработчик сигнала progress драйвера. */
+static void
+hyscan_driver_progress (HyScanDiscover *discover,
+                        gdouble         progress,
+                        HyScanDriver   *driver)
+{
+  g_signal_emit_by_name (driver, "progress", progress);
+}
+
+/* Обработчик сигнала completed драйвера. */
+static void
+hyscan_driver_completed (HyScanDiscover *discover,
+                         HyScanDriver   *driver)
+{
+  g_signal_emit_by_name (driver, "completed");
+}
+
+/* Обработчик сигнала device-found драйвера. */
+static void
+hyscan_driver_device_found (HyScanDiscover     *discover,
+                            HyScanDiscoverInfo *info,
+                            HyScanDriver       *driver)
+{
+  g_signal_emit_by_name (driver, "device-found", info);
+}
+
+/* Обработчик сигнала device-lost драйвера. */
+static void
+hyscan_driver_device_lost (HyScanDiscover     *discover,
+                           HyScanDiscoverInfo *info,
+                           HyScanDriver       *driver)
+{
+  g_signal_emit_by_name (driver, "device-lost", info);
+}
+
 /* Функция возвращает указатель на интерфейс HyScanDiscover. */
 static HyScanDiscover *
 hyscan_driver_get_discover_int (GModule *module)
 {
-  hyscan_discover_func discover_func;
-  HyScanDiscover *discover = NULL;
+  HyScanDriverDiscoverFunc discover_func;
 
   if (module == NULL)
     return NULL;
 
-  if (g_module_symbol (module, HYSCAN_DRIVER_DISCOVER_SYMBOL, (gpointer *) &discover_func))
-    {
-      discover = discover_func ();
-
-      if (!HYSCAN_IS_DISCOVER (discover))
-        g_clear_object (&discover);
-    }
+  if (!g_module_symbol (module, HYSCAN_DRIVER_DISCOVER_SYMBOL, (gpointer *) &discover_func))
+    return NULL;
 
-  return discover;
+  return hyscan_driver_call_discover (discover_func);
 }
 
 /* Функция возвращает указатель на объект HyScanDataSchema. */
 static HyScanDataSchema *
-hyscan_driver_get_info_int (GModule *module)
+hyscan_driver_get_info_int (GModule     *module,
+                            const gchar *name)
 {
-  hyscan_info_func info_func;
-  HyScanDataSchema *info = NULL;
+  HyScanDriverInfoFunc info_func;
 
   if (module == NULL)
     return NULL;
@@ -241,7 +481,42 @@ hyscan_driver_get_info_int (GModule *module)
   if (!g_module_symbol (module, HYSCAN_DRIVER_INFO_SYMBOL, (gpointer *) &info_func))
     return NULL;
 
+  return hyscan_driver_call_info (info_func, name);
+}
+
+/* Функция вызывает функцию драйвера hyscan_driver_discover и проверяет
+ * возвращённый объект. */
+static HyScanDiscover *
+hyscan_driver_call_discover (HyScanDriverDiscoverFunc discover_func)
+{
+  HyScanDiscover *discover;
+
+  discover = discover_func ();
+  if (HYSCAN_IS_DISCOVER (discover))
+    return discover;
+
+  g_clear_object (&discover);
+
+  return NULL;
+}
+
+/* Функция вызывает функцию драйвера hyscan_driver_info и проверяет
+ * возвращённый объект. */
+static HyScanDataSchema *
+hyscan_driver_call_info (HyScanDriverInfoFunc  info_func,
+                         const gchar          *name)
+{
+  HyScanDataSchema *info;
+  gboolean profile;
+  gint64 start;
+
+  profile = hyscan_driver_profile_is_enabled ();
+
+  start = g_get_monotonic_time ();
   info = info_func ();
+  if (profile)
+    hyscan_driver_profile_add (name, HYSCAN_DRIVER_PROFILE_INFO, start, g_get_monotonic_time ());
+
   if (hyscan_driver_schema_check_id (info))
     return info;
 
@@ -250,235 +525,1249 @@ hyscan_driver_get_info_int (GModule *module)
   return NULL;
 }
 
-/* Функция загружает драйвер. */
+/* Функция возвращает имя файла драйвера. */
+static gchar *
+hyscan_driver_module_name (const gchar *name)
+{
+  return g_strdup_printf ("%s-%s.%s",
+                          HYSCAN_DRIVER_NAME_PREFIX,
+                          name,
+                          HYSCAN_DRIVER_NAME_EXTENSION);
+}
+
+/* Функция загружает драйвер. Если драйвер загружен из копии файла, путь
+ * к ней возвращается в load_path, копия должна быть удалена после
+ * выгрузки модуля функцией hyscan_driver_remove_copy. */
 static GModule *
-hyscan_driver_load_driver (const gchar *path,
-                           const gchar *name)
+hyscan_driver_load_driver (const gchar  *path,
+                           const gchar  *name,
+                           gchar       **load_path)
 {
   gchar *module_name;
   gchar *module_path;
 
   GModule *module;
 
-  gpointer discover = NULL;
-  gpointer info = NULL;
-
   /* Путь к файлу драйвера. */
-  module_name = g_strdup_printf ("%s-%s.%s",
-                                 HYSCAN_DRIVER_NAME_PREFIX,
-                                 name,
-                                 HYSCAN_DRIVER_NAME_EXTENSION);
+  module_name = hyscan_driver_module_name (name);
   module_path = g_build_filename (path, module_name, NULL);
 
   /* Загрузка драйвера. */
+  module = hyscan_driver_open_version (module_path, name, load_path);
+
+  g_free (module_name);
+  g_free (module_path);
+
+  return module;
+}
+
+/* Функция загружает драйвер из указанного файла. */
+static GModule *
+hyscan_driver_open_module (const gchar *module_path,
+                           const gchar *name)
+{
+  GModule *module;
+
+  gpointer discover = NULL;
+  gpointer info = NULL;
+
+  gboolean profile;
+  gint64 load_time;
+  gint64 symbols_time;
+
+  profile = hyscan_driver_profile_is_enabled ();
+
+  load_time = g_get_monotonic_time ();
   module = g_module_open (module_path, G_MODULE_BIND_LAZY | G_MODULE_BIND_LOCAL);
+  symbols_time = g_get_monotonic_time ();
+
   if (module != NULL)
     {
       g_module_symbol (module, HYSCAN_DRIVER_DISCOVER_SYMBOL, (gpointer *) &discover);
       g_module_symbol (module, HYSCAN_DRIVER_INFO_SYMBOL, (gpointer *) &info);
     }
 
+  if (profile)
+    hyscan_driver_profile_add (name, HYSCAN_DRIVER_PROFILE_LOAD, load_time, symbols_time);
+  if (profile && (module != NULL))
+    hyscan_driver_profile_add (name, HYSCAN_DRIVER_PROFILE_SYMBOLS, symbols_time, g_get_monotonic_time ());
+
   if ((discover == NULL) || (info == NULL))
     g_clear_pointer (&module, g_module_close);
 
-  g_free (module_name);
-  g_free (module_path);
-
   return module;
 }
 
-static void
-hyscan_driver_discover_start (HyScanDiscover *discover)
+/* Функция загружает текущую версию драйвера из указанного файла. Если из
+ * этого файла уже загружена предыдущая версия драйвера с поддержкой
+ * перезагрузки, загружается копия файла, так как повторная загрузка файла
+ * с тем же именем возвращает уже загруженный модуль. Путь к копии
+ * возвращается в load_path, иначе в load_path записывается NULL. */
+static GModule *
+hyscan_driver_open_version (const gchar  *module_path,
+                            const gchar  *name,
+                            gchar       **load_path)
 {
-  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+  gboolean loaded = FALSE;
+  GModule *module;
+  GList *link;
 
-  if (driver->priv->discover != NULL)
-    hyscan_discover_start (driver->priv->discover);
-}
+  *load_path = NULL;
 
-static void
-hyscan_driver_discover_stop (HyScanDiscover *discover)
-{
-  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+  G_LOCK (hyscan_driver_types);
 
-  if (driver->priv->discover != NULL)
-    hyscan_discover_stop (driver->priv->discover);
-}
+  for (link = hyscan_driver_type_modules; link != NULL; link = link->next)
+    {
+      HyScanDriverTypeModule *types = link->data;
 
-static GList *
-hyscan_driver_discover_list (HyScanDiscover *discover)
-{
-  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+      if ((types->module != NULL) && (types->load_path == NULL) &&
+          g_str_equal (types->module_path, module_path))
+        {
+          loaded = TRUE;
+        }
+    }
 
-  if (driver->priv->discover == NULL)
+  G_UNLOCK (hyscan_driver_types);
+
+  if (!loaded)
+    return hyscan_driver_open_module (module_path, name);
+
+  *load_path = hyscan_driver_copy_module (module_path);
+  if (*load_path == NULL)
     return NULL;
 
-  return hyscan_discover_list (driver->priv->discover);
+  module = hyscan_driver_open_module (*load_path, name);
+  if (module == NULL)
+    {
+      hyscan_driver_remove_copy (*load_path);
+      g_clear_pointer (load_path, g_free);
+    }
+
+  return module;
 }
 
-static HyScanDataSchema *
-hyscan_driver_discover_config (HyScanDiscover *discover,
-                               const gchar    *uri)
+/* Функция копирует файл драйвера во временный каталог и возвращает путь
+ * к копии. */
+static gchar *
+hyscan_driver_copy_module (const gchar *module_path)
 {
-  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+  gchar *load_path = NULL;
+  gchar *base_name;
+  gchar *tmp_dir;
+  gchar *data;
+  gsize size;
+
+  tmp_dir = g_dir_make_tmp ("hyscan-driver-XXXXXX", NULL);
+  if (tmp_dir == NULL)
+    {
+      g_warning ("HyScanDriver: can't create directory for driver %s", module_path);
+      return NULL;
+    }
 
-  if (driver->priv->discover == NULL)
-    return NULL;
+  base_name = g_path_get_basename (module_path);
+  load_path = g_build_filename (tmp_dir, base_name, NULL);
 
-  return hyscan_discover_config (driver->priv->discover, uri);
-}
+  if (!g_file_get_contents (module_path, &data, &size, NULL))
+    data = NULL;
 
-static gboolean
-hyscan_driver_discover_check (HyScanDiscover  *discover,
-                              const gchar     *uri,
-                              HyScanParamList *params)
-{
-  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+  if ((data == NULL) || !g_file_set_contents (load_path, data, size, NULL))
+    {
+      g_warning ("HyScanDriver: can't copy driver %s", module_path);
+      g_clear_pointer (&load_path, g_free);
+      g_rmdir (tmp_dir);
+    }
 
-  if (driver->priv->discover == NULL)
-    return FALSE;
+  g_free (base_name);
+  g_free (tmp_dir);
+  g_free (data);
 
-  return hyscan_discover_check (driver->priv->discover, uri, params);
+  return load_path;
 }
 
-static HyScanDevice *
-hyscan_driver_discover_connect (HyScanDiscover  *discover,
-                                const gchar     *uri,
-                                HyScanParamList *params)
+/* Функция удаляет копию файла драйвера. */
+static void
+hyscan_driver_remove_copy (const gchar *load_path)
 {
-  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+  gchar *tmp_dir;
 
-  if (driver->priv->discover == NULL)
-    return NULL;
+  if (load_path == NULL)
+    return;
 
-  return hyscan_discover_connect (driver->priv->discover, uri, params);
+  tmp_dir = g_path_get_dirname (load_path);
+  g_unlink (load_path);
+  g_rmdir (tmp_dir);
+  g_free (tmp_dir);
 }
 
-/**
- * hyscan_driver_new:
- * @path: путь к каталогу с драйверами
- * @name: название драйвера
- *
- * Функция загружает драйвер из указанного каталога.
- *
- * Returns: #HyScanDriver. Для удаления #g_object_unref.
- */
-HyScanDriver *
-hyscan_driver_new (const gchar *path,
-                   const gchar *name)
+/* Функция загрузки модуля типов драйвера с поддержкой перезагрузки.
+ * Вызывается GTypeModule при первом использовании модуля. */
+static gboolean
+hyscan_driver_type_module_load (GTypeModule *type_module)
 {
-  HyScanDriver *driver;
+  HyScanDriverTypeModule *types = (HyScanDriverTypeModule *) type_module;
+  HyScanDriverReloadableFunc reloadable_func = NULL;
+  const gchar *load_path;
+  GModule *module;
 
-  driver = g_object_new (HYSCAN_TYPE_DRIVER,
-                         "path", path,
-                         "name", name,
-                         NULL);
+  /* Файл выгруженной версии драйвера мог быть заменён, поэтому повторно
+   * она не загружается. */
+  if (types->unloaded)
+    {
+      g_warning ("HyScanDriver: unloaded version of driver %s can't be used", types->name);
+      return FALSE;
+    }
 
-  if (driver->priv->discover == NULL)
-    g_clear_object (&driver);
+  load_path = (types->load_path != NULL) ? types->load_path : types->module_path;
+  module = hyscan_driver_open_module (load_path, types->name);
+  if (module != NULL)
+    g_module_symbol (module, HYSCAN_DRIVER_RELOAD_SYMBOL, (gpointer *) &reloadable_func);
 
-  return driver;
+  if (reloadable_func == NULL)
+    {
+      g_clear_pointer (&module, g_module_close);
+      return FALSE;
+    }
+
+  reloadable_func (type_module);
+
+  G_LOCK (hyscan_driver_types);
+  types->module = module;
+  G_UNLOCK (hyscan_driver_types);
+
+  return TRUE;
 }
 
-/**
- * hyscan_driver_get_info:
- * @path: путь к каталогу с драйверами
- * @name: название драйвера
- *
- * Функция возвращает информацию о драйвере.
- *
- * Returns: #HyScanDataSchema. Для удаления #g_object_unref.
- */
-HyScanDataSchema *
-hyscan_driver_get_info (const gchar *path,
-                        const gchar *name)
+/* Функция выгрузки модуля типов драйвера с поддержкой перезагрузки.
+ * Вызывается GTypeModule после удаления последнего объекта типов драйвера
+ * и освобождения записи реестра. */
+static void
+hyscan_driver_type_module_unload (GTypeModule *type_module)
 {
+  HyScanDriverTypeModule *types = (HyScanDriverTypeModule *) type_module;
   GModule *module;
-  HyScanDataSchema *info;
 
-  /* Загружаем драйвер. */
-  module = hyscan_driver_load_driver (path, name);
-  info = hyscan_driver_get_info_int (module);
+  G_LOCK (hyscan_driver_types);
+  module = types->module;
+  types->module = NULL;
+  types->unloaded = TRUE;
+  G_UNLOCK (hyscan_driver_types);
+
   g_clear_pointer (&module, g_module_close);
 
-  return info;
+  hyscan_driver_remove_copy (types->load_path);
+  g_clear_pointer (&types->load_path, g_free);
+
+  g_debug ("HyScanDriver: driver %s unloaded", type_module->name);
 }
 
-/**
- * hyscan_driver_list:
- * @path: путь к каталогу с драйверами
- *
- * Функция возвращает список названий драйверов доступных для загрузки из
- * указанного каталога.
- *
- * Returns (transfer full): список названий драйверов. Для удаления #g_strfreev.
- */
-gchar **
-hyscan_driver_list (const gchar *path)
+/* Функция ищет запись реестра модулей драйверов. Если запись отсутствует,
+ * возвращается NULL. Функция должна вызываться при захваченной блокировке
+ * реестра. */
+static HyScanDriverModule *
+hyscan_driver_module_find (const gchar *path,
+                           const gchar *name)
 {
-  GDir *dir;
-  GArray *names;
-  GError *error = NULL;
-
-  gchar *pattern;
-  gsize prefix_len;
-  gsize suffix_len;
-  const gchar *name;
+  HyScanDriverModule *module;
+  gchar *module_name;
+  gchar *module_path;
 
-  /* Каталог с драйверами. */
-  if ((dir = g_dir_open (path, 0, &error)) == NULL)
+  /* Встроенные драйверы имеют приоритет над загружаемыми. */
+  if (hyscan_driver_builtins != NULL)
     {
-      g_warning ("HyScanDriver: %s", error->message);
-      g_error_free (error);
-      return NULL;
+      module = g_hash_table_lookup (hyscan_driver_builtins, name);
+      if (module != NULL)
+        return module;
     }
 
-  /* Список драйверов. */
-  names = g_array_new (TRUE, TRUE, sizeof (gchar*));
-
-  /* Шаблон имени драйвера. */
-  pattern = g_strdup_printf ("^%s-[0-9A-Za-z]+\\.%s$",
-                             HYSCAN_DRIVER_NAME_PREFIX,
-                             HYSCAN_DRIVER_NAME_EXTENSION);
+  if (hyscan_driver_modules == NULL)
+    return NULL;
 
-  /* Длина префикса имени драйвера, до названия драйвера. */
-  prefix_len = strlen (HYSCAN_DRIVER_NAME_PREFIX) + 1;
+  module_name = hyscan_driver_module_name (name);
+  module_path = g_build_filename (path, module_name, NULL);
+  module = g_hash_table_lookup (hyscan_driver_modules, module_path);
 
-  /* Длина окончания имени драйвера, после названия драйвера. */
-  suffix_len = strlen (HYSCAN_DRIVER_NAME_EXTENSION) + 1;
+  g_free (module_name);
+  g_free (module_path);
 
-  /* Поиск драйверов в каталоге. */
-  while ((name = g_dir_read_name (dir)) != NULL)
-    {
-      gchar *driver_name;
-      GModule *module;
-      HyScanDataSchema *info;
+  return module;
+}
 
-      /* Проверка имени файла по шаблону имени драйвера. */
-      if (!g_regex_match_simple (pattern, name, 0, 0))
-        continue;
+/* Функция возвращает запись реестра модулей драйверов. Если запись
+ * отсутствует, она создаётся. Функция должна вызываться при захваченной
+ * блокировке реестра. */
+static HyScanDriverModule *
+hyscan_driver_module_lookup (const gchar *path,
+                             const gchar *name)
+{
+  HyScanDriverModule *module;
+  gchar *module_name;
 
-      /* Название драйвера. */
-      driver_name = g_utf8_substring (name, prefix_len, strlen (name) - suffix_len);
+  module = hyscan_driver_module_find (path, name);
+  if (module != NULL)
+    return module;
 
-      /* Загружаем драйвер. */
-      module = hyscan_driver_load_driver (path, driver_name);
-      info = hyscan_driver_get_info_int (module);
+  if (hyscan_driver_modules == NULL)
+    hyscan_driver_modules = g_hash_table_new (g_str_hash, g_str_equal);
 
-      /* Проверка валидности драйвера. */
-      if (info == NULL)
-        g_clear_pointer (&driver_name, g_free);
+  module_name = hyscan_driver_module_name (name);
 
-      g_clear_pointer (&module, g_module_close);
+  module = g_slice_new0 (HyScanDriverModule);
+  module->path = g_strdup (path);
+  module->name = g_strdup (name);
+  module->module_path = g_build_filename (path, module_name, NULL);
+  g_hash_table_insert (hyscan_driver_modules, module->module_path, module);
 
-      g_clear_object (&info);
+  g_free (module_name);
 
-      if (driver_name != NULL)
-        g_array_append_val (names, driver_name);
+  return module;
+}
+
+/* Функция захватывает модуль драйвера и возвращает запись реестра с
+ * загруженным модулем, объектом HyScanDiscover и информацией о драйвере.
+ * Модуль загружается только при первом захвате. Если драйвер не удалось
+ * загрузить, возвращается NULL. */
+static HyScanDriverModule *
+hyscan_driver_module_acquire (const gchar *path,
+                              const gchar *name)
+{
+  HyScanDriverModule *module;
+
+  G_LOCK (hyscan_driver_registry);
+
+  module = hyscan_driver_module_lookup (path, name);
+
+  /* Встроенный драйвер. */
+  if (module->discover_func != NULL)
+    {
+      if (module->discover == NULL)
+        {
+          module->discover = hyscan_driver_call_discover (module->discover_func);
+
+          if (module->discover != NULL)
+            hyscan_driver_profile_set_name (G_OBJECT (module->discover), module->name);
+        }
+
+      if (module->info == NULL)
+        module->info = hyscan_driver_call_info (module->info_func, module->name);
+    }
+
+  /* Загружаемый драйвер. */
+  else
+    {
+      GModule *gmodule;
+
+      if ((module->module == NULL) && (module->types == NULL))
+        hyscan_driver_module_open (module);
+
+      gmodule = (module->types != NULL) ? module->types->module : module->module;
+
+      if ((gmodule != NULL) && (module->discover == NULL))
+        {
+          module->discover = hyscan_driver_get_discover_int (gmodule);
+
+          if (module->discover != NULL)
+            hyscan_driver_profile_set_name (G_OBJECT (module->discover), module->name);
+        }
+
+      if ((gmodule != NULL) && (module->info == NULL))
+        module->info = hyscan_driver_get_info_int (gmodule, module->name);
+    }
+
+  if ((module->discover == NULL) || (module->info == NULL))
+    {
+      if ((module->ref_count == 0) && (module->discover == NULL))
+        {
+          g_clear_pointer (&module->module, g_module_close);
+
+          if (module->types != NULL)
+            g_type_module_unuse (G_TYPE_MODULE (module->types));
+          module->types = NULL;
+        }
+
+      /* Запись о драйвере, который не удалось загрузить, не сохраняется. */
+      if ((module->ref_count == 0) && (module->discover_func == NULL) &&
+          (module->module == NULL) && (module->types == NULL) && (module->info == NULL))
+        {
+          g_hash_table_remove (hyscan_driver_modules, module->module_path);
+          hyscan_driver_module_free (module);
+        }
+
+      module = NULL;
+    }
+  else
+    {
+      module->ref_count += 1;
+    }
+
+  G_UNLOCK (hyscan_driver_registry);
+
+  return module;
+}
+
+/* Функция загружает модуль драйвера для записи реестра. Драйвер с
+ * поддержкой перезагрузки загружается через новый модуль типов, который
+ * используется записью реестра до её удаления. Функция должна вызываться
+ * при захваченной блокировке реестра. */
+static void
+hyscan_driver_module_open (HyScanDriverModule *module)
+{
+  HyScanDriverTypeModule *types;
+  gpointer reloadable_func = NULL;
+  GModule *gmodule;
+  gchar *load_path;
+  gchar *types_name;
+
+  gmodule = hyscan_driver_open_version (module->module_path, module->name, &load_path);
+  if (gmodule == NULL)
+    return;
+
+  /* Обычный драйвер не выгружается. Если он загружен из копии файла,
+   * копия остаётся до окончания работы программы. */
+  if (!g_module_symbol (gmodule, HYSCAN_DRIVER_RELOAD_SYMBOL, &reloadable_func))
+    {
+      module->module = gmodule;
+      g_free (load_path);
+      return;
+    }
+
+  G_LOCK (hyscan_driver_types);
+  hyscan_driver_type_modules_counter += 1;
+  types_name = g_strdup_printf ("%s-%u", module->name, hyscan_driver_type_modules_counter);
+  G_UNLOCK (hyscan_driver_types);
+
+  /* Модуль типов не удаляется, так как зарегистрированные в нём типы
+   * остаются в системе типов GObject. */
+  types = g_object_new (hyscan_driver_type_module_get_type (), NULL);
+  types->name = g_strdup (module->name);
+  types->module_path = g_strdup (module->module_path);
+  types->load_path = load_path;
+  g_type_module_set_name (G_TYPE_MODULE (types), types_name);
+
+  G_LOCK (hyscan_driver_types);
+  hyscan_driver_type_modules = g_list_prepend (hyscan_driver_type_modules, types);
+  G_UNLOCK (hyscan_driver_types);
+
+  if (g_type_module_use (G_TYPE_MODULE (types)))
+    {
+      module->types = types;
+      g_debug ("HyScanDriver: driver %s loaded as %s", module->name, types_name);
+    }
+  else
+    {
+      types->unloaded = TRUE;
+      hyscan_driver_remove_copy (types->load_path);
+      g_clear_pointer (&types->load_path, g_free);
+    }
+
+  /* Модуль типов использует собственную ссылку на модуль драйвера. */
+  g_module_close (gmodule);
+
+  g_free (types_name);
+}
+
+/* Функция освобождает модуль драйвера. Обычный модуль, из которого был
+ * получен объект HyScanDiscover, не выгружается, так как в нём могут быть
+ * зарегистрированы типы GObject. Запись реестра заменённой версии драйвера
+ * удаляется после освобождения последним пользователем. */
+static void
+hyscan_driver_module_release (HyScanDriverModule *module)
+{
+  gboolean unused;
+
+  G_LOCK (hyscan_driver_registry);
+
+  if (module->ref_count > 0)
+    module->ref_count -= 1;
+
+  unused = module->stale && (module->ref_count == 0);
+
+  G_UNLOCK (hyscan_driver_registry);
+
+  if (unused)
+    hyscan_driver_module_free (module);
+}
+
+/* Функция удаляет запись реестра. Модуль типов драйвера с поддержкой
+ * перезагрузки выгружается, когда не останется объектов его типов. */
+static void
+hyscan_driver_module_free (gpointer data)
+{
+  HyScanDriverModule *module = data;
+
+  g_clear_object (&module->discover);
+  g_clear_object (&module->info);
+  g_clear_pointer (&module->module, g_module_close);
+
+  if (module->types != NULL)
+    g_type_module_unuse (G_TYPE_MODULE (module->types));
+
+  g_free (module->path);
+  g_free (module->name);
+  g_free (module->module_path);
+
+  g_slice_free (HyScanDriverModule, module);
+}
+
+/* Функция возвращает отсортированный список названий корректных
+ * встроенных драйверов. */
+static gchar **
+hyscan_driver_builtin_list (void)
+{
+  GHashTableIter iter;
+  HyScanDriverModule *module;
+  GArray *names;
+
+  names = g_array_new (TRUE, TRUE, sizeof (gchar*));
+
+  G_LOCK (hyscan_driver_registry);
+
+  if (hyscan_driver_builtins != NULL)
+    {
+      g_hash_table_iter_init (&iter, hyscan_driver_builtins);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &module))
+        {
+          gchar *name;
+
+          if (module->info == NULL)
+            module->info = hyscan_driver_call_info (module->info_func, module->name);
+
+          if (module->info == NULL)
+            continue;
+
+          name = g_strdup (module->name);
+          g_array_append_val (names, name);
+        }
+    }
+
+  G_UNLOCK (hyscan_driver_registry);
+
+  g_array_sort (names, hyscan_driver_name_compare);
+
+  if (names->len == 0)
+    {
+      g_array_unref (names);
+      return NULL;
+    }
+
+  return (gchar**)g_array_free (names, FALSE);
+}
+
+/* Функция возвращает путь к файлу кэша информации о драйверах. Кэш
+ * размещается в каталоге с драйверами, если в него разрешена запись,
+ * иначе в пользовательском каталоге кэша. */
+static gchar *
+hyscan_driver_cache_path (const gchar *path)
+{
+  gchar *cache_path;
+  gchar *cache_name;
+  gchar *full_path;
+  gchar *hash;
+
+  if (g_access (path, W_OK) == 0)
+    return g_build_filename (path, HYSCAN_DRIVER_CACHE_NAME, NULL);
+
+  /* Для разных каталогов с драйверами используются разные файлы кэша. */
+  if (g_path_is_absolute (path))
+    {
+      full_path = g_strdup (path);
+    }
+  else
+    {
+      gchar *current_dir = g_get_current_dir ();
+      full_path = g_build_filename (current_dir, path, NULL);
+      g_free (current_dir);
+    }
+
+  hash = g_compute_checksum_for_string (G_CHECKSUM_SHA1, full_path, -1);
+  cache_name = g_strdup_printf ("%s-%s", hash, HYSCAN_DRIVER_CACHE_NAME);
+  cache_path = g_build_filename (g_get_user_cache_dir (), "hyscan", cache_name, NULL);
+
+  g_free (cache_name);
+  g_free (full_path);
+  g_free (hash);
+
+  return cache_path;
+}
+
+/* Функция загружает кэш информации о драйверах. Если кэш отключён,
+ * возвращается NULL. Если файл кэша отсутствует или имеет другую версию,
+ * возвращается пустой кэш. */
+static GKeyFile *
+hyscan_driver_cache_load (const gchar *path)
+{
+  GKeyFile *cache;
+  gchar *cache_path;
+  const gchar *env;
+
+  /* Кэш можно отключить переменной окружения HYSCAN_DRIVER_CACHE=0. */
+  env = g_getenv ("HYSCAN_DRIVER_CACHE");
+  if ((env != NULL) && (g_strcmp0 (env, "0") == 0))
+    return NULL;
+
+  cache = g_key_file_new ();
+  cache_path = hyscan_driver_cache_path (path);
+
+  if (g_key_file_load_from_file (cache, cache_path, G_KEY_FILE_NONE, NULL))
+    {
+      gint64 version;
+
+      version = g_key_file_get_int64 (cache, HYSCAN_DRIVER_CACHE_GROUP, "version", NULL);
+      if (version != HYSCAN_DRIVER_CACHE_VERSION)
+        {
+          g_key_file_free (cache);
+          cache = g_key_file_new ();
+        }
+    }
+
+  g_key_file_set_int64 (cache, HYSCAN_DRIVER_CACHE_GROUP, "version", HYSCAN_DRIVER_CACHE_VERSION);
+
+  g_free (cache_path);
+
+  return cache;
+}
+
+/* Функция сохраняет кэш информации о драйверах. Файл кэша заменяется
+ * атомарно, поэтому одновременная работа нескольких процессов безопасна.
+ * Кэш формируется без блокировки, под блокировкой выполняется только
+ * замена файла. Ошибка записи не является критичной, так как кэш только
+ * ускоряет получение информации. */
+static void
+hyscan_driver_cache_save (const gchar *path,
+                          GKeyFile    *cache)
+{
+  gchar *cache_path;
+  gchar *cache_dir;
+  gchar *data;
+  gsize size;
+  GError *error = NULL;
+
+  cache_path = hyscan_driver_cache_path (path);
+  cache_dir = g_path_get_dirname (cache_path);
+  data = g_key_file_to_data (cache, &size, NULL);
+
+  G_LOCK (hyscan_driver_cache);
+
+  g_mkdir_with_parents (cache_dir, 0755);
+  if (!g_file_set_contents (cache_path, data, size, &error))
+    {
+      g_debug ("HyScanDriver: can't save drivers cache: %s", error->message);
+      g_error_free (error);
+    }
+
+  G_UNLOCK (hyscan_driver_cache);
+
+  g_free (cache_path);
+  g_free (cache_dir);
+  g_free (data);
+}
+
+/* Функция вычисляет контрольную сумму файла драйвера. */
+static gchar *
+hyscan_driver_cache_hash (const gchar *module_path)
+{
+  gchar *data;
+  gsize size;
+  gchar *hash;
+
+  if (!g_file_get_contents (module_path, &data, &size, NULL))
+    return NULL;
+
+  hash = g_compute_checksum_for_data (G_CHECKSUM_SHA1, (const guchar *) data, size);
+  g_free (data);
+
+  return hash;
+}
+
+/* Функция ищет информацию о драйвере в кэше. Информация считается
+ * актуальной, если файл драйвера не изменился с момента её сохранения.
+ * Если изменилось только время модификации файла, сравниваются
+ * контрольные суммы. Функция возвращает TRUE, если в кэше найдена
+ * актуальная информация. Для некорректного драйвера info при этом
+ * равен NULL. Признак изменения кэша возвращается в переменной updated. */
+static gboolean
+hyscan_driver_cache_lookup (GKeyFile          *cache,
+                            const gchar       *path,
+                            const gchar       *name,
+                            HyScanDataSchema **info,
+                            gboolean          *updated)
+{
+  gchar *module_name;
+  gchar *module_path;
+  GStatBuf stat_buf;
+
+  gboolean actual = FALSE;
+  gchar *schema_id = NULL;
+  gchar *schema_data = NULL;
+
+  *info = NULL;
+
+  if (cache == NULL)
+    return FALSE;
+
+  module_name = hyscan_driver_module_name (name);
+  module_path = g_build_filename (path, module_name, NULL);
+
+  if (g_stat (module_path, &stat_buf) != 0)
+    goto exit;
+
+  if (!g_key_file_has_group (cache, module_name))
+    goto exit;
+
+  if (g_key_file_get_int64 (cache, module_name, "size", NULL) != stat_buf.st_size)
+    goto exit;
+
+  if (g_key_file_get_int64 (cache, module_name, "mtime", NULL) != stat_buf.st_mtime)
+    {
+      gchar *cached_hash = g_key_file_get_string (cache, module_name, "hash", NULL);
+      gchar *hash = hyscan_driver_cache_hash (module_path);
+
+      if ((hash != NULL) && (g_strcmp0 (hash, cached_hash) == 0))
+        {
+          g_key_file_set_int64 (cache, module_name, "mtime", stat_buf.st_mtime);
+          *updated = TRUE;
+        }
+      else
+        {
+          g_clear_pointer (&module_name, g_free);
+        }
+
+      g_free (cached_hash);
+      g_free (hash);
+
+      if (module_name == NULL)
+        goto exit;
+    }
+
+  /* Некорректный драйвер. */
+  if (!g_key_file_get_boolean (cache, module_name, "valid", NULL))
+    {
+      actual = TRUE;
+      goto exit;
+    }
+
+  schema_id = g_key_file_get_string (cache, module_name, "schema-id", NULL);
+  schema_data = g_key_file_get_string (cache, module_name, "schema", NULL);
+
+  if ((schema_id != NULL) && (schema_data != NULL))
+    *info = hyscan_data_schema_new_from_string (schema_data, schema_id);
+
+  if ((*info != NULL) && !hyscan_driver_schema_check_id (*info))
+    g_clear_object (info);
+
+  actual = (*info != NULL);
+
+exit:
+  g_free (module_name);
+  g_free (module_path);
+  g_free (schema_id);
+  g_free (schema_data);
+
+  return actual;
+}
+
+/* Функция сохраняет информацию о драйвере в кэш. */
+static void
+hyscan_driver_cache_store (GKeyFile         *cache,
+                           const gchar      *path,
+                           const gchar      *name,
+                           HyScanDataSchema *info)
+{
+  gchar *module_name;
+  gchar *module_path;
+  GStatBuf stat_buf;
+  gchar *hash;
+
+  if (cache == NULL)
+    return;
+
+  module_name = hyscan_driver_module_name (name);
+  module_path = g_build_filename (path, module_name, NULL);
+
+  g_key_file_remove_group (cache, module_name, NULL);
+
+  if (g_stat (module_path, &stat_buf) != 0)
+    goto exit;
+
+  hash = hyscan_driver_cache_hash (module_path);
+
+  g_key_file_set_int64 (cache, module_name, "mtime", stat_buf.st_mtime);
+  g_key_file_set_int64 (cache, module_name, "size", stat_buf.st_size);
+  g_key_file_set_string (cache, module_name, "hash", (hash != NULL) ? hash : "");
+  g_key_file_set_boolean (cache, module_name, "valid", (info != NULL));
+
+  if (info != NULL)
+    {
+      gchar *schema_data = hyscan_data_schema_get_data (info);
+
+      g_key_file_set_string (cache, module_name, "schema-id", hyscan_data_schema_get_id (info));
+      g_key_file_set_string (cache, module_name, "schema", schema_data);
+
+      g_free (schema_data);
+    }
+
+  g_free (hash);
+
+exit:
+  g_free (module_name);
+  g_free (module_path);
+}
+
+/* Функция возвращает информацию о драйвере из кэша или загружает драйвер,
+ * если информация в кэше отсутствует или устарела. */
+static HyScanDataSchema *
+hyscan_driver_cache_get_info (GKeyFile    *cache,
+                              const gchar *path,
+                              const gchar *name,
+                              gboolean    *updated)
+{
+  HyScanDataSchema *info;
+  GModule *module;
+  gchar *load_path;
+
+  if (hyscan_driver_cache_lookup (cache, path, name, &info, updated))
+    return info;
+
+  module = hyscan_driver_load_driver (path, name, &load_path);
+  info = hyscan_driver_get_info_int (module, name);
+  g_clear_pointer (&module, g_module_close);
+
+  hyscan_driver_remove_copy (load_path);
+  g_free (load_path);
+
+  if (cache != NULL)
+    {
+      hyscan_driver_cache_store (cache, path, name, info);
+      *updated = TRUE;
+    }
+
+  return info;
+}
+
+/* Функция проверки драйвера, выполняемая в пуле потоков. */
+static void
+hyscan_driver_scan_func (gpointer data,
+                         gpointer user_data)
+{
+  HyScanDriverScanJob *job = data;
+  const gchar *path = user_data;
+  GModule *module;
+  gchar *load_path;
+  gint64 start;
+
+  start = g_get_monotonic_time ();
+
+  module = hyscan_driver_load_driver (path, job->name, &load_path);
+  job->info = hyscan_driver_get_info_int (module, job->name);
+  g_clear_pointer (&module, g_module_close);
+
+  hyscan_driver_remove_copy (load_path);
+  g_free (load_path);
+
+  job->time = g_get_monotonic_time () - start;
+}
+
+/* Функция возвращает шаблон имени файла драйвера. */
+static GRegex *
+hyscan_driver_name_regex (void)
+{
+  static gsize initialized = 0;
+  static GRegex *regex = NULL;
+
+  if (g_once_init_enter (&initialized))
+    {
+      gchar *pattern;
+
+      pattern = g_strdup_printf ("^%s-([0-9A-Za-z]+)\\.%s$",
+                                 HYSCAN_DRIVER_NAME_PREFIX,
+                                 HYSCAN_DRIVER_NAME_EXTENSION);
+      regex = g_regex_new (pattern, G_REGEX_OPTIMIZE, 0, NULL);
+      g_free (pattern);
+
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return regex;
+}
+
+/* Функция сравнения названий драйверов. */
+static gint
+hyscan_driver_scan_compare (gconstpointer a,
+                            gconstpointer b)
+{
+  const HyScanDriverScanJob *job_a = a;
+  const HyScanDriverScanJob *job_b = b;
+
+  return g_strcmp0 (job_a->name, job_b->name);
+}
+
+/* Функция сравнения названий драйверов в массиве строк. */
+static gint
+hyscan_driver_name_compare (gconstpointer a,
+                            gconstpointer b)
+{
+  const gchar * const *name_a = a;
+  const gchar * const *name_b = b;
+
+  return g_strcmp0 (*name_a, *name_b);
+}
+
+static void
+hyscan_driver_discover_start (HyScanDiscover *discover)
+{
+  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+
+  if (driver->priv->discover != NULL)
+    hyscan_discover_start (driver->priv->discover);
+}
+
+static void
+hyscan_driver_discover_stop (HyScanDiscover *discover)
+{
+  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+
+  if (driver->priv->discover != NULL)
+    hyscan_discover_stop (driver->priv->discover);
+}
+
+static GList *
+hyscan_driver_discover_list (HyScanDiscover *discover)
+{
+  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+
+  if (driver->priv->discover == NULL)
+    return NULL;
+
+  return hyscan_discover_list (driver->priv->discover);
+}
+
+static guint
+hyscan_driver_discover_get_generation (HyScanDiscover *discover)
+{
+  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+
+  if (driver->priv->discover == NULL)
+    return 0;
+
+  return hyscan_discover_get_generation (driver->priv->discover);
+}
+
+static HyScanDataSchema *
+hyscan_driver_discover_config (HyScanDiscover *discover,
+                               const gchar    *uri)
+{
+  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+
+  if (driver->priv->discover == NULL)
+    return NULL;
+
+  return hyscan_discover_config (driver->priv->discover, uri);
+}
+
+static gboolean
+hyscan_driver_discover_check (HyScanDiscover  *discover,
+                              const gchar     *uri,
+                              HyScanParamList *params)
+{
+  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+
+  if (driver->priv->discover == NULL)
+    return FALSE;
+
+  return hyscan_discover_check (driver->priv->discover, uri, params);
+}
+
+static HyScanDevice *
+hyscan_driver_discover_connect (HyScanDiscover  *discover,
+                                const gchar     *uri,
+                                HyScanParamList *params)
+{
+  HyScanDriver *driver = HYSCAN_DRIVER (discover);
+
+  if (driver->priv->discover == NULL)
+    return NULL;
+
+  return hyscan_discover_connect (driver->priv->discover, uri, params);
+}
+
+/**
+ * hyscan_driver_new:
+ * @path: путь к каталогу с драйверами
+ * @name: название драйвера
+ *
+ * Функция загружает драйвер из указанного каталога.
+ *
+ * Returns: #HyScanDriver. Для удаления #g_object_unref.
+ */
+HyScanDriver *
+hyscan_driver_new (const gchar *path,
+                   const gchar *name)
+{
+  HyScanDriver *driver;
+
+  driver = g_object_new (HYSCAN_TYPE_DRIVER,
+                         "path", path,
+                         "name", name,
+                         NULL);
+
+  if (driver->priv->discover == NULL)
+    g_clear_object (&driver);
+
+  return driver;
+}
+
+/**
+ * hyscan_driver_get_info:
+ * @path: путь к каталогу с драйверами
+ * @name: название драйвера
+ *
+ * Функция возвращает информацию о драйвере.
+ *
+ * Returns: #HyScanDataSchema. Для удаления #g_object_unref.
+ */
+HyScanDataSchema *
+hyscan_driver_get_info (const gchar *path,
+                        const gchar *name)
+{
+  HyScanDriverModule *module;
+  GKeyFile *cache;
+  HyScanDataSchema *info = NULL;
+  gboolean updated = FALSE;
+  gboolean builtin = FALSE;
+
+  /* Информация из реестра модулей. Запрос не создаёт новых записей в
+   * реестре, чтобы запросы несуществующих драйверов не занимали память. */
+  G_LOCK (hyscan_driver_registry);
+  module = hyscan_driver_module_find (path, name);
+  if (module != NULL)
+    {
+      if ((module->info == NULL) && (module->info_func != NULL))
+        module->info = hyscan_driver_call_info (module->info_func, module->name);
+      if (module->info != NULL)
+        info = g_object_ref (module->info);
+      builtin = (module->info_func != NULL);
+    }
+  G_UNLOCK (hyscan_driver_registry);
+
+  if ((info != NULL) || builtin)
+    return info;
+
+  /* Информация о драйвере из кэша или из самого драйвера. */
+  cache = hyscan_driver_cache_load (path);
+  info = hyscan_driver_cache_get_info (cache, path, name, &updated);
+
+  if (updated)
+    hyscan_driver_cache_save (path, cache);
+
+  g_clear_pointer (&cache, g_key_file_free);
+
+  /* Запоминаем информацию в реестре модулей. Отсутствующие и
+   * некорректные драйверы в реестре не сохраняются. */
+  if (info != NULL)
+    {
+      G_LOCK (hyscan_driver_registry);
+      module = hyscan_driver_module_lookup (path, name);
+      if (module->info == NULL)
+        module->info = g_object_ref (info);
+      G_UNLOCK (hyscan_driver_registry);
+    }
+
+  return info;
+}
+
+/**
+ * hyscan_driver_list:
+ * @path: путь к каталогу с драйверами
+ *
+ * Функция возвращает список названий драйверов доступных для загрузки из
+ * указанного каталога.
+ *
+ * Returns (transfer full): список названий драйверов. Для удаления #g_strfreev.
+ */
+gchar **
+hyscan_driver_list (const gchar *path)
+{
+  GDir *dir;
+  GArray *jobs;
+  GArray *names;
+  GError *error = NULL;
+
+  GRegex *regex;
+  const gchar *name;
+  gchar **builtins;
+  guint n_loads = 0;
+  guint i;
+
+  GKeyFile *cache;
+  gboolean updated = FALSE;
+  gint64 start;
+
+  /* Каталог с драйверами. */
+  if ((dir = g_dir_open (path, 0, &error)) == NULL)
+    {
+      g_warning ("HyScanDriver: %s", error->message);
+      g_error_free (error);
+      return hyscan_driver_builtin_list ();
+    }
+
+  start = g_get_monotonic_time ();
+
+  /* Поиск драйверов в каталоге. */
+  jobs = g_array_new (FALSE, TRUE, sizeof (HyScanDriverScanJob));
+  regex = hyscan_driver_name_regex ();
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      HyScanDriverScanJob job = {0};
+      GMatchInfo *match_info;
+
+      /* Проверка имени файла по шаблону имени драйвера. */
+      if (g_regex_match (regex, name, 0, &match_info))
+        {
+          job.name = g_match_info_fetch (match_info, 1);
+          g_array_append_val (jobs, job);
+        }
+
+      g_match_info_free (match_info);
     }
 
   g_dir_close (dir);
-  g_free (pattern);
+
+  /* Порядок драйверов не зависит от порядка файлов в каталоге. */
+  g_array_sort (jobs, hyscan_driver_scan_compare);
+
+  /* Информация о драйверах из кэша. */
+  cache = hyscan_driver_cache_load (path);
+  for (i = 0; i < jobs->len; i++)
+    {
+      HyScanDriverScanJob *job = &g_array_index (jobs, HyScanDriverScanJob, i);
+
+      job->need_load = !hyscan_driver_cache_lookup (cache, path, job->name, &job->info, &updated);
+      if (job->need_load)
+        n_loads += 1;
+    }
+
+  /* Драйверы, отсутствующие в кэше, проверяются параллельно. */
+  if (n_loads > 1)
+    {
+      GThreadPool *pool;
+      guint n_threads;
+
+      n_threads = MIN (n_loads, g_get_num_processors ());
+      pool = g_thread_pool_new (hyscan_driver_scan_func, (gpointer) path, n_threads, TRUE, NULL);
+
+      for (i = 0; i < jobs->len; i++)
+        {
+          HyScanDriverScanJob *job = &g_array_index (jobs, HyScanDriverScanJob, i);
+
+          if (job->need_load)
+            g_thread_pool_push (pool, job, NULL);
+        }
+
+      g_thread_pool_free (pool, FALSE, TRUE);
+    }
+  else if (n_loads == 1)
+    {
+      for (i = 0; i < jobs->len; i++)
+        {
+          HyScanDriverScanJob *job = &g_array_index (jobs, HyScanDriverScanJob, i);
+
+          if (job->need_load)
+            hyscan_driver_scan_func (job, (gpointer) path);
+        }
+    }
+
+  /* Сохраняем информацию о загруженных драйверах в кэш. */
+  for (i = 0; i < jobs->len; i++)
+    {
+      HyScanDriverScanJob *job = &g_array_index (jobs, HyScanDriverScanJob, i);
+
+      if (!job->need_load)
+        continue;
+
+      g_debug ("HyScanDriver: driver %s %s in %.3f ms",
+               job->name, (job->info != NULL) ? "loaded" : "rejected",
+               job->time / 1000.0);
+
+      if (cache != NULL)
+        {
+          hyscan_driver_cache_store (cache, path, job->name, job->info);
+          updated = TRUE;
+        }
+    }
+
+  /* Удаляем из кэша информацию об отсутствующих драйверах. */
+  if (cache != NULL)
+    {
+      gchar **groups = g_key_file_get_groups (cache, NULL);
+      guint j;
+
+      for (j = 0; groups[j] != NULL; j++)
+        {
+          gboolean found = FALSE;
+
+          if (g_str_equal (groups[j], HYSCAN_DRIVER_CACHE_GROUP))
+            continue;
+
+          for (i = 0; (i < jobs->len) && !found; i++)
+            {
+              HyScanDriverScanJob *job = &g_array_index (jobs, HyScanDriverScanJob, i);
+              gchar *module_name = hyscan_driver_module_name (job->name);
+
+              found = g_str_equal (groups[j], module_name);
+              g_free (module_name);
+            }
+
+          if (found)
+            continue;
+
+          g_key_file_remove_group (cache, groups[j], NULL);
+          updated = TRUE;
+        }
+
+      g_strfreev (groups);
+    }
+
+  if (updated)
+    hyscan_driver_cache_save (path, cache);
+
+  g_clear_pointer (&cache, g_key_file_free);
+
+  /* Список корректных драйверов. */
+  names = g_array_new (TRUE, TRUE, sizeof (gchar*));
+  for (i = 0; i < jobs->len; i++)
+    {
+      HyScanDriverScanJob *job = &g_array_index (jobs, HyScanDriverScanJob, i);
+
+      if (job->info != NULL)
+        {
+          g_array_append_val (names, job->name);
+          job->name = NULL;
+        }
+
+      g_clear_object (&job->info);
+      g_free (job->name);
+    }
+
+  g_debug ("HyScanDriver: %u drivers found, %u loaded in %.3f ms",
+           names->len, n_loads, (g_get_monotonic_time () - start) / 1000.0);
+
+  g_array_unref (jobs);
+
+  /* Встроенные драйверы. */
+  builtins = hyscan_driver_builtin_list ();
+  if (builtins != NULL)
+    {
+      for (i = 0; builtins[i] != NULL; i++)
+        {
+          if (g_strv_contains ((const gchar * const *) names->data, builtins[i]))
+            continue;
+
+          name = g_strdup (builtins[i]);
+          g_array_append_val (names, name);
+        }
+
+      g_array_sort (names, hyscan_driver_name_compare);
+      g_strfreev (builtins);
+    }
 
   if (names->len == 0)
     {
@@ -489,6 +1778,132 @@ hyscan_driver_list (const gchar *path)
   return (gchar**)g_array_free (names, FALSE);
 }
 
+/**
+ * hyscan_driver_builtin_register:
+ * @name: название драйвера
+ * @discover_func: функция драйвера hyscan_driver_discover
+ * @info_func: функция драйвера hyscan_driver_info
+ *
+ * Функция регистрирует встроенный драйвер, скомпонованный с программой.
+ * Функции @discover_func и @info_func должны вести себя так же, как
+ * экспортируемые функции загружаемого драйвера. Встроенный драйвер доступен
+ * через #hyscan_driver_new и #hyscan_driver_get_info при любом пути к
+ * каталогу с драйверами и включается в список #hyscan_driver_list. Если
+ * в каталоге есть загружаемый драйвер с таким же названием, используется
+ * встроенный драйвер.
+ *
+ * Returns: %TRUE если драйвер зарегистрирован, иначе %FALSE.
+ */
+gboolean
+hyscan_driver_builtin_register (const gchar              *name,
+                                HyScanDriverDiscoverFunc  discover_func,
+                                HyScanDriverInfoFunc      info_func)
+{
+  HyScanDriverModule *module;
+  gboolean status = FALSE;
+
+  g_return_val_if_fail (name != NULL, FALSE);
+  g_return_val_if_fail (discover_func != NULL, FALSE);
+  g_return_val_if_fail (info_func != NULL, FALSE);
+
+  if (!g_regex_match_simple ("^[0-9A-Za-z]+$", name, 0, 0))
+    {
+      g_warning ("HyScanDriver: invalid builtin driver name %s", name);
+      return FALSE;
+    }
+
+  G_LOCK (hyscan_driver_registry);
+
+  if (hyscan_driver_builtins == NULL)
+    hyscan_driver_builtins = g_hash_table_new (g_str_hash, g_str_equal);
+
+  if (!g_hash_table_contains (hyscan_driver_builtins, name))
+    {
+      module = g_slice_new0 (HyScanDriverModule);
+      module->name = g_strdup (name);
+      module->discover_func = discover_func;
+      module->info_func = info_func;
+      g_hash_table_insert (hyscan_driver_builtins, module->name, module);
+
+      status = TRUE;
+    }
+  else
+    {
+      g_warning ("HyScanDriver: builtin driver %s already registered", name);
+    }
+
+  G_UNLOCK (hyscan_driver_registry);
+
+  return status;
+}
+
+/**
+ * hyscan_driver_invalidate:
+ * @path: путь к каталогу с драйверами
+ * @name: название драйвера
+ *
+ * Функция сообщает о замене или удалении файла драйвера. Если драйвер ещё
+ * не загружен или поддерживает перезагрузку, информация о нём удаляется из
+ * реестра модулей и объекты #HyScanDriver, созданные после вызова этой
+ * функции, используют новую версию драйвера. Уже созданные объекты и
+ * подключенные через них устройства продолжают работать с предыдущей
+ * версией драйвера с поддержкой перезагрузки, которая выгружается после
+ * удаления последнего из них.
+ *
+ * Обычный загруженный драйвер не выгружается, так как в нём могут быть
+ * зарегистрированы типы GObject, и продолжает использоваться до перезапуска
+ * программы.
+ *
+ * Returns: %TRUE если будет использоваться новая версия драйвера,
+ * %FALSE если загруженная версия используется до перезапуска программы.
+ */
+gboolean
+hyscan_driver_invalidate (const gchar *path,
+                          const gchar *name)
+{
+  HyScanDriverModule *module = NULL;
+  HyScanDriverModule *unused = NULL;
+  gboolean status = TRUE;
+  gchar *module_name;
+  gchar *module_path;
+
+  g_return_val_if_fail (path != NULL, FALSE);
+  g_return_val_if_fail (name != NULL, FALSE);
+
+  module_name = hyscan_driver_module_name (name);
+  module_path = g_build_filename (path, module_name, NULL);
+
+  G_LOCK (hyscan_driver_registry);
+
+  if (hyscan_driver_modules != NULL)
+    module = g_hash_table_lookup (hyscan_driver_modules, module_path);
+
+  if ((module != NULL) && (module->module != NULL))
+    {
+      status = FALSE;
+    }
+  else if (module != NULL)
+    {
+      g_hash_table_remove (hyscan_driver_modules, module_path);
+
+      /* Используемая версия драйвера удаляется после её освобождения. */
+      if (module->ref_count == 0)
+        unused = module;
+      else
+        module->stale = TRUE;
+    }
+
+  G_UNLOCK (hyscan_driver_registry);
+
+  if (unused != NULL)
+    hyscan_driver_module_free (unused);
+
+  g_free (module_name);
+  g_free (module_path);
+
+  return status;
+}
+
 static void
 hyscan_driver_interface_init (HyScanDiscoverInterface *iface)
 {
@@ -498,4 +1913,5 @@ hyscan_driver_interface_init (HyScanDiscoverInterface *iface)
   iface->config = hyscan_driver_discover_config;
   iface->check = hyscan_driver_discover_check;
   iface->connect = hyscan_driver_discover_connect;
+  iface->get_generation = hyscan_driver_discover_get_generation;
 }
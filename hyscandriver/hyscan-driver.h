@@ -50,6 +50,34 @@ typedef struct _HyScanDriver HyScanDriver;
 typedef struct _HyScanDriverPrivate HyScanDriverPrivate;
 typedef struct _HyScanDriverClass HyScanDriverClass;
 
+/**
+ * HyScanDriverDiscoverFunc:
+ *
+ * Тип функции драйвера, возвращающей указатель на объект, реализующий
+ * интерфейс #HyScanDiscover.
+ *
+ * Returns: #HyScanDiscover. Для удаления #g_object_unref.
+ */
+typedef HyScanDiscover *(*HyScanDriverDiscoverFunc) (void);
+
+/**
+ * HyScanDriverInfoFunc:
+ *
+ * Тип функции драйвера, возвращающей информацию о драйвере.
+ *
+ * Returns: #HyScanDataSchema. Для удаления #g_object_unref.
+ */
+typedef HyScanDataSchema *(*HyScanDriverInfoFunc) (void);
+
+/**
+ * HyScanDriverReloadableFunc:
+ * @module: модуль типов загруженной версии драйвера
+ *
+ * Тип функции драйвера с поддержкой перезагрузки, регистрирующей типы
+ * GObject драйвера в модуле @module.
+ */
+typedef void (*HyScanDriverReloadableFunc) (GTypeModule *module);
+
 struct _HyScanDriver
 {
   GObject parent_instance;
@@ -76,6 +104,15 @@ HyScanDataSchema *     hyscan_driver_get_info          (const gchar           *p
 HYSCAN_API
 gchar **               hyscan_driver_list              (const gchar           *path);
 
+HYSCAN_API
+gboolean               hyscan_driver_invalidate        (const gchar           *path,
+                                                        const gchar           *name);
+
+HYSCAN_API
+gboolean               hyscan_driver_builtin_register  (const gchar              *name,
+                                                        HyScanDriverDiscoverFunc  discover_func,
+                                                        HyScanDriverInfoFunc      info_func);
+
 G_END_DECLS
 
 #endif /* __HYSCAN_DRIVER_H__ */
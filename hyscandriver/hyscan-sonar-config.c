@@ -0,0 +1,522 @@
+/* hyscan-sonar-config.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-sonar-config
+ * @Short_description: пакет параметров гидролокатора
+ * @Title: HyScanSonarConfig
+ *
+ * Класс собирает параметры нескольких источников гидролокационных данных
+ * для применения их одной командой #hyscan_sonar_configure. Функции задания
+ * параметров повторяют функции интерфейса #HyScanSonar, но не обращаются к
+ * гидролокатору, а только запоминают параметры.
+ *
+ * Для каждого источника данных хранятся последние заданные параметры
+ * смещения антенны, приёмника, генератора и системы ВАРУ. Параметры
+ * подсистем, которые не задавались, не изменяются при применении пакета.
+ *
+ * Драйверы, поддерживающие пакетную настройку, получают список источников
+ * функцией #hyscan_sonar_config_list_sources и их параметры функцией
+ * #hyscan_sonar_config_get_source. Источники перечисляются в порядке
+ * первого задания их параметров.
+ *
+ * Класс не является потокобезопасным.
+ */
+
+#include "hyscan-sonar-config.h"
+
+struct _HyScanSonarConfigPrivate
+{
+  GArray                      *list;           /* Список источников данных. */
+  GHashTable                  *sources;        /* Параметры источников данных. */
+};
+
+static void            hyscan_sonar_config_object_constructed  (GObject               *object);
+static void            hyscan_sonar_config_object_finalize     (GObject               *object);
+
+static HyScanSonarConfigSource *
+                       hyscan_sonar_config_lookup              (HyScanSonarConfig     *config,
+                                                                HyScanSourceType       source);
+
+G_DEFINE_BOXED_TYPE (HyScanSonarConfigSource, hyscan_sonar_config_source,
+                     hyscan_sonar_config_source_copy, hyscan_sonar_config_source_free)
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanSonarConfig, hyscan_sonar_config, G_TYPE_OBJECT)
+
+static void
+hyscan_sonar_config_class_init (HyScanSonarConfigClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->constructed = hyscan_sonar_config_object_constructed;
+  object_class->finalize = hyscan_sonar_config_object_finalize;
+}
+
+static void
+hyscan_sonar_config_init (HyScanSonarConfig *config)
+{
+  config->priv = hyscan_sonar_config_get_instance_private (config);
+}
+
+static void
+hyscan_sonar_config_object_constructed (GObject *object)
+{
+  HyScanSonarConfig *config = HYSCAN_SONAR_CONFIG (object);
+  HyScanSonarConfigPrivate *priv = config->priv;
+
+  priv->list = g_array_new (FALSE, FALSE, sizeof (HyScanSourceType));
+  priv->sources = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                                         (GDestroyNotify)hyscan_sonar_config_source_free);
+}
+
+static void
+hyscan_sonar_config_object_finalize (GObject *object)
+{
+  HyScanSonarConfig *config = HYSCAN_SONAR_CONFIG (object);
+  HyScanSonarConfigPrivate *priv = config->priv;
+
+  g_array_unref (priv->list);
+  g_hash_table_unref (priv->sources);
+
+  G_OBJECT_CLASS (hyscan_sonar_config_parent_class)->finalize (object);
+}
+
+/* Функция возвращает параметры источника данных, создавая их при
+ * необходимости. */
+static HyScanSonarConfigSource *
+hyscan_sonar_config_lookup (HyScanSonarConfig *config,
+                            HyScanSourceType   source)
+{
+  HyScanSonarConfigPrivate *priv = config->priv;
+  HyScanSonarConfigSource *info;
+
+  info = g_hash_table_lookup (priv->sources, GINT_TO_POINTER (source));
+  if (info != NULL)
+    return info;
+
+  info = g_slice_new0 (HyScanSonarConfigSource);
+  info->source = source;
+
+  g_hash_table_insert (priv->sources, GINT_TO_POINTER (source), info);
+  g_array_append_val (priv->list, source);
+
+  return info;
+}
+
+/**
+ * hyscan_sonar_config_new:
+ *
+ * Функция создаёт новый объект #HyScanSonarConfig.
+ *
+ * Returns: #HyScanSonarConfig. Для удаления #g_object_unref.
+ */
+HyScanSonarConfig *
+hyscan_sonar_config_new (void)
+{
+  return g_object_new (HYSCAN_TYPE_SONAR_CONFIG, NULL);
+}
+
+/**
+ * hyscan_sonar_config_list_sources:
+ * @config: указатель на #HyScanSonarConfig
+ * @n_sources: (out): число источников данных
+ *
+ * Функция возвращает список источников данных, для которых заданы
+ * параметры.
+ *
+ * Returns: (transfer none) (array length=n_sources): Список источников данных.
+ */
+const HyScanSourceType *
+hyscan_sonar_config_list_sources (HyScanSonarConfig *config,
+                                  guint32           *n_sources)
+{
+  HyScanSonarConfigPrivate *priv;
+
+  g_return_val_if_fail (HYSCAN_IS_SONAR_CONFIG (config), NULL);
+
+  priv = config->priv;
+
+  *n_sources = priv->list->len;
+
+  return (const HyScanSourceType *)priv->list->data;
+}
+
+/**
+ * hyscan_sonar_config_get_source:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ *
+ * Функция возвращает параметры источника данных.
+ *
+ * Returns: (nullable) (transfer none): Параметры источника данных или NULL.
+ */
+const HyScanSonarConfigSource *
+hyscan_sonar_config_get_source (HyScanSonarConfig *config,
+                                HyScanSourceType   source)
+{
+  g_return_val_if_fail (HYSCAN_IS_SONAR_CONFIG (config), NULL);
+
+  return g_hash_table_lookup (config->priv->sources, GINT_TO_POINTER (source));
+}
+
+/**
+ * hyscan_sonar_config_set_source:
+ * @config: указатель на #HyScanSonarConfig
+ * @info: параметры источника данных
+ *
+ * Функция заменяет все параметры источника данных.
+ */
+void
+hyscan_sonar_config_set_source (HyScanSonarConfig             *config,
+                                const HyScanSonarConfigSource *info)
+{
+  HyScanSonarConfigSource *cur_info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+  g_return_if_fail (info != NULL);
+
+  cur_info = hyscan_sonar_config_lookup (config, info->source);
+
+  hyscan_antenna_offset_free (cur_info->offset);
+  *cur_info = *info;
+  cur_info->offset = hyscan_antenna_offset_copy (info->offset);
+}
+
+/**
+ * hyscan_sonar_config_antenna_set_offset:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ * @offset: смещение антенны
+ *
+ * Функция задаёт смещение приёмной антенны. Аналогична функции
+ * #hyscan_sonar_antenna_set_offset.
+ */
+void
+hyscan_sonar_config_antenna_set_offset (HyScanSonarConfig         *config,
+                                        HyScanSourceType           source,
+                                        const HyScanAntennaOffset *offset)
+{
+  HyScanSonarConfigSource *info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+  g_return_if_fail (offset != NULL);
+
+  info = hyscan_sonar_config_lookup (config, source);
+
+  hyscan_antenna_offset_free (info->offset);
+  info->offset = hyscan_antenna_offset_copy (offset);
+}
+
+/**
+ * hyscan_sonar_config_receiver_set_time:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ * @receive_time: время приёма эхосигнала, с
+ * @wait_time: время задержки излучения после приёма, с
+ *
+ * Функция задаёт время приёма эхосигнала. Аналогична функции
+ * #hyscan_sonar_receiver_set_time.
+ */
+void
+hyscan_sonar_config_receiver_set_time (HyScanSonarConfig *config,
+                                       HyScanSourceType   source,
+                                       gdouble            receive_time,
+                                       gdouble            wait_time)
+{
+  HyScanSonarConfigSource *info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+
+  info = hyscan_sonar_config_lookup (config, source);
+  info->receiver_set = TRUE;
+  info->receiver_mode = HYSCAN_SONAR_RECEIVER_MODE_MANUAL;
+  info->receive_time = receive_time;
+  info->wait_time = wait_time;
+}
+
+/**
+ * hyscan_sonar_config_receiver_set_auto:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ *
+ * Функция задаёт автоматический выбор времени приёма эхосигнала.
+ * Аналогична функции #hyscan_sonar_receiver_set_auto.
+ */
+void
+hyscan_sonar_config_receiver_set_auto (HyScanSonarConfig *config,
+                                       HyScanSourceType   source)
+{
+  HyScanSonarConfigSource *info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+
+  info = hyscan_sonar_config_lookup (config, source);
+  info->receiver_set = TRUE;
+  info->receiver_mode = HYSCAN_SONAR_RECEIVER_MODE_AUTO;
+}
+
+/**
+ * hyscan_sonar_config_receiver_disable:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ *
+ * Функция отключает приём эхосигнала. Аналогична функции
+ * #hyscan_sonar_receiver_disable.
+ */
+void
+hyscan_sonar_config_receiver_disable (HyScanSonarConfig *config,
+                                      HyScanSourceType   source)
+{
+  HyScanSonarConfigSource *info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+
+  info = hyscan_sonar_config_lookup (config, source);
+  info->receiver_set = TRUE;
+  info->receiver_mode = HYSCAN_SONAR_RECEIVER_MODE_NONE;
+}
+
+/**
+ * hyscan_sonar_config_generator_set_preset:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ * @preset: идентификатор преднастройки
+ *
+ * Функция устанавливает режим работы генератора. Аналогична функции
+ * #hyscan_sonar_generator_set_preset.
+ */
+void
+hyscan_sonar_config_generator_set_preset (HyScanSonarConfig *config,
+                                          HyScanSourceType   source,
+                                          gint64             preset)
+{
+  HyScanSonarConfigSource *info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+
+  info = hyscan_sonar_config_lookup (config, source);
+  info->generator_set = TRUE;
+  info->generator_enable = TRUE;
+  info->generator_preset = preset;
+}
+
+/**
+ * hyscan_sonar_config_generator_disable:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ *
+ * Функция отключает излучение сигнала генератором. Аналогична функции
+ * #hyscan_sonar_generator_disable.
+ */
+void
+hyscan_sonar_config_generator_disable (HyScanSonarConfig *config,
+                                       HyScanSourceType   source)
+{
+  HyScanSonarConfigSource *info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+
+  info = hyscan_sonar_config_lookup (config, source);
+  info->generator_set = TRUE;
+  info->generator_enable = FALSE;
+}
+
+/**
+ * hyscan_sonar_config_tvg_set_auto:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ * @level: целевой уровень сигнала
+ * @sensitivity: чувствительность автомата регулировки
+ *
+ * Функция включает автоматический режим управления системой ВАРУ.
+ * Аналогична функции #hyscan_sonar_tvg_set_auto.
+ */
+void
+hyscan_sonar_config_tvg_set_auto (HyScanSonarConfig *config,
+                                  HyScanSourceType   source,
+                                  gdouble            level,
+                                  gdouble            sensitivity)
+{
+  HyScanSonarConfigSource *info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+
+  info = hyscan_sonar_config_lookup (config, source);
+  info->tvg_set = TRUE;
+  info->tvg_mode = HYSCAN_SONAR_TVG_MODE_AUTO;
+  info->tvg_level = level;
+  info->tvg_sensitivity = sensitivity;
+}
+
+/**
+ * hyscan_sonar_config_tvg_set_constant:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ * @gain: коэффициент усиления, дБ
+ *
+ * Функция устанавливает постоянный уровень усиления. Аналогична функции
+ * #hyscan_sonar_tvg_set_constant.
+ */
+void
+hyscan_sonar_config_tvg_set_constant (HyScanSonarConfig *config,
+                                      HyScanSourceType   source,
+                                      gdouble            gain)
+{
+  HyScanSonarConfigSource *info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+
+  info = hyscan_sonar_config_lookup (config, source);
+  info->tvg_set = TRUE;
+  info->tvg_mode = HYSCAN_SONAR_TVG_MODE_CONSTANT;
+  info->tvg_gain = gain;
+}
+
+/**
+ * hyscan_sonar_config_tvg_set_linear_db:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ * @gain0: начальный уровень усиления, дБ
+ * @gain_step: величина изменения усиления каждые 100 метров, дБ
+ *
+ * Функция устанавливает линейное увеличение усиления в дБ на 100 метров.
+ * Аналогична функции #hyscan_sonar_tvg_set_linear_db.
+ */
+void
+hyscan_sonar_config_tvg_set_linear_db (HyScanSonarConfig *config,
+                                       HyScanSourceType   source,
+                                       gdouble            gain0,
+                                       gdouble            gain_step)
+{
+  HyScanSonarConfigSource *info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+
+  info = hyscan_sonar_config_lookup (config, source);
+  info->tvg_set = TRUE;
+  info->tvg_mode = HYSCAN_SONAR_TVG_MODE_LINEAR_DB;
+  info->tvg_gain0 = gain0;
+  info->tvg_gain_step = gain_step;
+}
+
+/**
+ * hyscan_sonar_config_tvg_set_logarithmic:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ * @gain0: начальный уровень усиления, дБ
+ * @beta: коэффициент отражения цели, дБ
+ * @alpha: коэффициент поглощения цели, дБ/м
+ *
+ * Функция устанавливает логарифмический вид закона усиления системой ВАРУ.
+ * Аналогична функции #hyscan_sonar_tvg_set_logarithmic.
+ */
+void
+hyscan_sonar_config_tvg_set_logarithmic (HyScanSonarConfig *config,
+                                         HyScanSourceType   source,
+                                         gdouble            gain0,
+                                         gdouble            beta,
+                                         gdouble            alpha)
+{
+  HyScanSonarConfigSource *info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+
+  info = hyscan_sonar_config_lookup (config, source);
+  info->tvg_set = TRUE;
+  info->tvg_mode = HYSCAN_SONAR_TVG_MODE_LOGARITHMIC;
+  info->tvg_gain0 = gain0;
+  info->tvg_beta = beta;
+  info->tvg_alpha = alpha;
+}
+
+/**
+ * hyscan_sonar_config_tvg_disable:
+ * @config: указатель на #HyScanSonarConfig
+ * @source: тип источника данных
+ *
+ * Функция отключает управление усилением. Аналогична функции
+ * #hyscan_sonar_tvg_disable.
+ */
+void
+hyscan_sonar_config_tvg_disable (HyScanSonarConfig *config,
+                                 HyScanSourceType   source)
+{
+  HyScanSonarConfigSource *info;
+
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+
+  info = hyscan_sonar_config_lookup (config, source);
+  info->tvg_set = TRUE;
+  info->tvg_mode = HYSCAN_SONAR_TVG_MODE_NONE;
+}
+
+/**
+ * hyscan_sonar_config_source_copy:
+ * @info: структура #HyScanSonarConfigSource для копирования
+ *
+ * Функция создаёт копию структуры #HyScanSonarConfigSource.
+ *
+ * Returns: (transfer full): Новая структура #HyScanSonarConfigSource.
+ * Для удаления #hyscan_sonar_config_source_free.
+ */
+HyScanSonarConfigSource *
+hyscan_sonar_config_source_copy (const HyScanSonarConfigSource *info)
+{
+  HyScanSonarConfigSource *new_info;
+
+  if (info == NULL)
+    return NULL;
+
+  new_info = g_slice_dup (HyScanSonarConfigSource, info);
+  new_info->offset = hyscan_antenna_offset_copy (info->offset);
+
+  return new_info;
+}
+
+/**
+ * hyscan_sonar_config_source_free:
+ * @info: структура #HyScanSonarConfigSource для удаления
+ *
+ * Функция удаляет структуру #HyScanSonarConfigSource.
+ */
+void
+hyscan_sonar_config_source_free (HyScanSonarConfigSource *info)
+{
+  if (info == NULL)
+    return;
+
+  hyscan_antenna_offset_free (info->offset);
+
+  g_slice_free (HyScanSonarConfigSource, info);
+}
@@ -0,0 +1,203 @@
+/* hyscan-sonar-config.h
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_SONAR_CONFIG_H__
+#define __HYSCAN_SONAR_CONFIG_H__
+
+#include <hyscan-sonar.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_SONAR_CONFIG_SOURCE      (hyscan_sonar_config_source_get_type ())
+
+#define HYSCAN_TYPE_SONAR_CONFIG             (hyscan_sonar_config_get_type ())
+#define HYSCAN_SONAR_CONFIG(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_SONAR_CONFIG, HyScanSonarConfig))
+#define HYSCAN_IS_SONAR_CONFIG(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_SONAR_CONFIG))
+#define HYSCAN_SONAR_CONFIG_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_SONAR_CONFIG, HyScanSonarConfigClass))
+#define HYSCAN_IS_SONAR_CONFIG_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_SONAR_CONFIG))
+#define HYSCAN_SONAR_CONFIG_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_SONAR_CONFIG, HyScanSonarConfigClass))
+
+typedef struct _HyScanSonarConfigPrivate HyScanSonarConfigPrivate;
+typedef struct _HyScanSonarConfigClass HyScanSonarConfigClass;
+typedef struct _HyScanSonarConfigSource HyScanSonarConfigSource;
+
+struct _HyScanSonarConfig
+{
+  GObject parent_instance;
+
+  HyScanSonarConfigPrivate *priv;
+};
+
+struct _HyScanSonarConfigClass
+{
+  GObjectClass parent_class;
+};
+
+/**
+ * HyScanSonarConfigSource:
+ * @source: тип источника данных
+ * @offset: (nullable): смещение приёмной антенны
+ * @receiver_set: признак наличия параметров приёмника
+ * @receiver_mode: режим работы приёмника, %HYSCAN_SONAR_RECEIVER_MODE_NONE - отключение
+ * @receive_time: время приёма эхосигнала, с
+ * @wait_time: время задержки излучения после приёма, с
+ * @generator_set: признак наличия параметров генератора
+ * @generator_enable: признак включения генератора
+ * @generator_preset: идентификатор преднастройки генератора
+ * @tvg_set: признак наличия параметров ВАРУ
+ * @tvg_mode: режим работы ВАРУ, %HYSCAN_SONAR_TVG_MODE_NONE - отключение
+ * @tvg_level: целевой уровень сигнала для автоматического режима
+ * @tvg_sensitivity: чувствительность автоматического режима
+ * @tvg_gain: коэффициент усиления для постоянного режима, дБ
+ * @tvg_gain0: начальный уровень усиления, дБ
+ * @tvg_gain_step: величина изменения усиления каждые 100 метров, дБ
+ * @tvg_beta: коэффициент отражения цели, дБ
+ * @tvg_alpha: коэффициент поглощения цели, дБ/м
+ *
+ * Параметры гидролокационного источника данных, задаваемые одной командой.
+ * Если признак наличия параметров подсистемы сброшен, её параметры не
+ * изменяются.
+ */
+struct _HyScanSonarConfigSource
+{
+  HyScanSourceType             source;
+
+  HyScanAntennaOffset         *offset;
+
+  gboolean                     receiver_set;
+  HyScanSonarReceiverModeType  receiver_mode;
+  gdouble                      receive_time;
+  gdouble                      wait_time;
+
+  gboolean                     generator_set;
+  gboolean                     generator_enable;
+  gint64                       generator_preset;
+
+  gboolean                     tvg_set;
+  HyScanSonarTVGModeType       tvg_mode;
+  gdouble                      tvg_level;
+  gdouble                      tvg_sensitivity;
+  gdouble                      tvg_gain;
+  gdouble                      tvg_gain0;
+  gdouble                      tvg_gain_step;
+  gdouble                      tvg_beta;
+  gdouble                      tvg_alpha;
+};
+
+HYSCAN_API
+GType                           hyscan_sonar_config_source_get_type      (void);
+
+HYSCAN_API
+GType                           hyscan_sonar_config_get_type             (void);
+
+HYSCAN_API
+HyScanSonarConfig *             hyscan_sonar_config_new                  (void);
+
+HYSCAN_API
+const HyScanSourceType *        hyscan_sonar_config_list_sources         (HyScanSonarConfig              *config,
+                                                                          guint32                        *n_sources);
+
+HYSCAN_API
+const HyScanSonarConfigSource * hyscan_sonar_config_get_source           (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source);
+
+HYSCAN_API
+void                            hyscan_sonar_config_set_source           (HyScanSonarConfig              *config,
+                                                                          const HyScanSonarConfigSource  *info);
+
+HYSCAN_API
+void                            hyscan_sonar_config_antenna_set_offset   (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source,
+                                                                          const HyScanAntennaOffset      *offset);
+
+HYSCAN_API
+void                            hyscan_sonar_config_receiver_set_time    (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source,
+                                                                          gdouble                         receive_time,
+                                                                          gdouble                         wait_time);
+
+HYSCAN_API
+void                            hyscan_sonar_config_receiver_set_auto    (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source);
+
+HYSCAN_API
+void                            hyscan_sonar_config_receiver_disable     (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source);
+
+HYSCAN_API
+void                            hyscan_sonar_config_generator_set_preset (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source,
+                                                                          gint64                          preset);
+
+HYSCAN_API
+void                            hyscan_sonar_config_generator_disable    (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source);
+
+HYSCAN_API
+void                            hyscan_sonar_config_tvg_set_auto         (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source,
+                                                                          gdouble                         level,
+                                                                          gdouble                         sensitivity);
+
+HYSCAN_API
+void                            hyscan_sonar_config_tvg_set_constant     (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source,
+                                                                          gdouble                         gain);
+
+HYSCAN_API
+void                            hyscan_sonar_config_tvg_set_linear_db    (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source,
+                                                                          gdouble                         gain0,
+                                                                          gdouble                         gain_step);
+
+HYSCAN_API
+void                            hyscan_sonar_config_tvg_set_logarithmic  (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source,
+                                                                          gdouble                         gain0,
+                                                                          gdouble                         beta,
+                                                                          gdouble                         alpha);
+
+HYSCAN_API
+void                            hyscan_sonar_config_tvg_disable          (HyScanSonarConfig              *config,
+                                                                          HyScanSourceType                source);
+
+HYSCAN_API
+HyScanSonarConfigSource *       hyscan_sonar_config_source_copy          (const HyScanSonarConfigSource  *info);
+
+HYSCAN_API
+void                            hyscan_sonar_config_source_free          (HyScanSonarConfigSource        *info);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_SONAR_CONFIG_H__ */
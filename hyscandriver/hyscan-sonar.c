@@ -108,6 +108,30 @@
  * параметрами, можно при помощи функции #hyscan_sonar_start, остановить
  * #hyscan_sonar_stop.
  *
+ * Каждая из функций настройки, как правило, требует отдельного обмена с
+ * гидролокатором. Параметры нескольких источников данных можно собрать в
+ * объекте #HyScanSonarConfig и применить их функцией #hyscan_sonar_configure.
+ * Если драйвер поддерживает такую возможность, параметры передаются в
+ * гидролокатор за один обмен, иначе они применяются последовательным вызовом
+ * функций настройки.
+ *
+ * Для всех функций настройки, а также для функций #hyscan_sonar_start,
+ * #hyscan_sonar_stop и #hyscan_sonar_configure имеются асинхронные варианты
+ * с суффиксом _async, которые не блокируют вызывающий поток. Результат их
+ * выполнения передаётся в функцию обратного вызова и считывается функцией
+ * #hyscan_sonar_finish. Функция обратного вызова вызывается в контексте
+ * #GMainContext, используемом по умолчанию в потоке, из которого была
+ * запущена команда.
+ *
+ * Драйвер может реализовать асинхронные команды самостоятельно. Для этого
+ * используются функции интерфейса configure_async, start_async и stop_async.
+ * Асинхронные варианты функций настройки передаются драйверу через
+ * configure_async. Эти функции используются, только если драйвер реализует
+ * их все, и в этом случае драйвер сам отвечает за выполнение команд в
+ * порядке их вызова. Иначе все асинхронные команды выполняются синхронными
+ * функциями драйвера в отдельном потоке. Команды одного гидролокатора
+ * выполняются по одной в порядке их вызова.
+ *
  * Настройку режимов работы гидролокатора необходимо выполнять каждый раз перед
  * его переводом в рабочий режим из режиме останова. Если для какого-либо
  * источника данных не задан режим работы приёмника, этот источник данных будет
@@ -126,10 +150,20 @@
  */
 
 #include "hyscan-sonar.h"
+#include "hyscan-sonar-config.h"
+#include "hyscan-device-async.h"
 #include "hyscan-driver-marshallers.h"
 
 #include <hyscan-buffer.h>
 
+typedef struct
+{
+  gchar                       *project_name;   /* Название проекта. */
+  gchar                       *track_name;     /* Название галса. */
+  HyScanTrackType              track_type;     /* Тип галса. */
+  HyScanTrackPlan             *track_plan;     /* План галса. */
+} HyScanSonarStartAsync;
+
 G_DEFINE_INTERFACE (HyScanSonar, hyscan_sonar, G_TYPE_OBJECT)
 
 static void
@@ -588,3 +622,715 @@ hyscan_sonar_stop (HyScanSonar *sonar)
 
   return FALSE;
 }
+
+/* Функция применяет параметры источника данных последовательным вызовом
+ * функций настройки. */
+static gboolean
+hyscan_sonar_configure_source (HyScanSonar                   *sonar,
+                               const HyScanSonarConfigSource *info)
+{
+  HyScanSourceType source = info->source;
+
+  if (info->offset != NULL)
+    {
+      if (!hyscan_sonar_antenna_set_offset (sonar, source, info->offset))
+        return FALSE;
+    }
+
+  if (info->receiver_set)
+    {
+      gboolean status;
+
+      if (info->receiver_mode == HYSCAN_SONAR_RECEIVER_MODE_MANUAL)
+        status = hyscan_sonar_receiver_set_time (sonar, source, info->receive_time, info->wait_time);
+      else if (info->receiver_mode == HYSCAN_SONAR_RECEIVER_MODE_AUTO)
+        status = hyscan_sonar_receiver_set_auto (sonar, source);
+      else
+        status = hyscan_sonar_receiver_disable (sonar, source);
+
+      if (!status)
+        return FALSE;
+    }
+
+  if (info->generator_set)
+    {
+      gboolean status;
+
+      if (info->generator_enable)
+        status = hyscan_sonar_generator_set_preset (sonar, source, info->generator_preset);
+      else
+        status = hyscan_sonar_generator_disable (sonar, source);
+
+      if (!status)
+        return FALSE;
+    }
+
+  if (info->tvg_set)
+    {
+      gboolean status;
+
+      switch (info->tvg_mode)
+        {
+        case HYSCAN_SONAR_TVG_MODE_AUTO:
+          status = hyscan_sonar_tvg_set_auto (sonar, source, info->tvg_level, info->tvg_sensitivity);
+          break;
+
+        case HYSCAN_SONAR_TVG_MODE_CONSTANT:
+          status = hyscan_sonar_tvg_set_constant (sonar, source, info->tvg_gain);
+          break;
+
+        case HYSCAN_SONAR_TVG_MODE_LINEAR_DB:
+          status = hyscan_sonar_tvg_set_linear_db (sonar, source, info->tvg_gain0, info->tvg_gain_step);
+          break;
+
+        case HYSCAN_SONAR_TVG_MODE_LOGARITHMIC:
+          status = hyscan_sonar_tvg_set_logarithmic (sonar, source, info->tvg_gain0, info->tvg_beta, info->tvg_alpha);
+          break;
+
+        default:
+          status = hyscan_sonar_tvg_disable (sonar, source);
+        }
+
+      if (!status)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Функция применяет параметры всех источников данных последовательным
+ * вызовом функций настройки. */
+static gboolean
+hyscan_sonar_configure_sources (HyScanSonar       *sonar,
+                                HyScanSonarConfig *config)
+{
+  const HyScanSourceType *sources;
+  guint32 n_sources;
+  guint32 i;
+
+  sources = hyscan_sonar_config_list_sources (config, &n_sources);
+  for (i = 0; i < n_sources; i++)
+    {
+      const HyScanSonarConfigSource *info = hyscan_sonar_config_get_source (config, sources[i]);
+
+      if (!hyscan_sonar_configure_source (sonar, info))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * hyscan_sonar_configure:
+ * @sonar: указатель на #HyScanSonar
+ * @config: указатель на #HyScanSonarConfig
+ *
+ * Функция применяет параметры источников данных, собранные в объекте
+ * #HyScanSonarConfig. Если драйвер поддерживает пакетную настройку,
+ * параметры передаются в гидролокатор за один обмен. В противном случае
+ * параметры применяются последовательным вызовом функций настройки для
+ * каждого источника данных, до первой ошибки.
+ *
+ * Returns: %TRUE если команда выполнена успешно, иначе %FALSE.
+ */
+gboolean
+hyscan_sonar_configure (HyScanSonar       *sonar,
+                        HyScanSonarConfig *config)
+{
+  HyScanSonarInterface *iface;
+
+  g_return_val_if_fail (HYSCAN_IS_SONAR (sonar), FALSE);
+  g_return_val_if_fail (HYSCAN_IS_SONAR_CONFIG (config), FALSE);
+
+  iface = HYSCAN_SONAR_GET_IFACE (sonar);
+  if (iface->configure != NULL)
+    return (* iface->configure) (sonar, config);
+
+  return hyscan_sonar_configure_sources (sonar, config);
+}
+
+/* Функция освобождает параметры асинхронного запуска. */
+static void
+hyscan_sonar_start_async_free (gpointer data)
+{
+  HyScanSonarStartAsync *start = data;
+
+  g_free (start->project_name);
+  g_free (start->track_name);
+  if (start->track_plan != NULL)
+    g_slice_free (HyScanTrackPlan, start->track_plan);
+
+  g_slice_free (HyScanSonarStartAsync, start);
+}
+
+/* Функция выполняет команды настройки в очереди гидролокатора. */
+static gboolean
+hyscan_sonar_setup_func (GObject  *sonar,
+                         gpointer  data)
+{
+  return hyscan_sonar_configure_sources (HYSCAN_SONAR (sonar), data);
+}
+
+/* Функция выполняет пакетную настройку в очереди гидролокатора. */
+static gboolean
+hyscan_sonar_configure_func (GObject  *sonar,
+                             gpointer  data)
+{
+  return hyscan_sonar_configure (HYSCAN_SONAR (sonar), data);
+}
+
+/* Функция выполняет запуск в очереди гидролокатора. */
+static gboolean
+hyscan_sonar_start_func (GObject  *sonar,
+                         gpointer  data)
+{
+  HyScanSonarStartAsync *start = data;
+
+  return hyscan_sonar_start (HYSCAN_SONAR (sonar),
+                             start->project_name, start->track_name,
+                             start->track_type, start->track_plan);
+}
+
+/* Функция выполняет останов в очереди гидролокатора. */
+static gboolean
+hyscan_sonar_stop_func (GObject  *sonar,
+                        gpointer  data)
+{
+  return hyscan_sonar_stop (HYSCAN_SONAR (sonar));
+}
+
+/* Функция проверяет, реализует ли драйвер все асинхронные команды. Если
+ * реализована только часть команд, смешивать их с очередью гидролокатора
+ * нельзя, так как порядок выполнения команд не сохранится. */
+static gboolean
+hyscan_sonar_async_native (HyScanSonarInterface *iface)
+{
+  return (iface->configure_async != NULL) && (iface->configure_finish != NULL) &&
+         (iface->start_async != NULL) && (iface->start_finish != NULL) &&
+         (iface->stop_async != NULL) && (iface->stop_finish != NULL);
+}
+
+/* Функция асинхронно применяет параметры, заданные одной функцией
+ * настройки. Если драйвер реализует асинхронные команды, используется
+ * асинхронная пакетная настройка, иначе в очереди гидролокатора вызывается
+ * соответствующая синхронная функция. Функция забирает ссылку на config. */
+static void
+hyscan_sonar_setup_async (HyScanSonar         *sonar,
+                          HyScanSonarConfig   *config,
+                          GCancellable        *cancellable,
+                          GAsyncReadyCallback  callback,
+                          gpointer             user_data,
+                          gpointer             source_tag)
+{
+  HyScanSonarInterface *iface = HYSCAN_SONAR_GET_IFACE (sonar);
+
+  if (hyscan_sonar_async_native (iface))
+    {
+      GTask *task;
+
+      task = hyscan_device_async_native (sonar, (HyScanDeviceAsyncFinish)iface->configure_finish,
+                                         cancellable, callback, user_data, source_tag);
+      (* iface->configure_async) (sonar, config, cancellable, hyscan_device_async_native_ready, task);
+      g_object_unref (config);
+
+      return;
+    }
+
+  hyscan_device_async_run (sonar, hyscan_sonar_setup_func, config, g_object_unref,
+                           cancellable, callback, user_data, source_tag);
+}
+
+/**
+ * hyscan_sonar_antenna_set_offset_async:
+ * @sonar: указатель на #HyScanSonar
+ * @source: идентификатор источника данных #HyScanSourceType
+ * @offset: смещение антенны
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно задаёт смещение приёмных антенн. Аналогична функции
+ * #hyscan_sonar_antenna_set_offset. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_antenna_set_offset_async (HyScanSonar               *sonar,
+                                       HyScanSourceType           source,
+                                       const HyScanAntennaOffset *offset,
+                                       GCancellable              *cancellable,
+                                       GAsyncReadyCallback        callback,
+                                       gpointer                   user_data)
+{
+  HyScanSonarConfig *config;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_antenna_set_offset (config, source, offset);
+  hyscan_sonar_setup_async (sonar, config, cancellable, callback, user_data,
+                            hyscan_sonar_antenna_set_offset_async);
+}
+
+/**
+ * hyscan_sonar_receiver_set_time_async:
+ * @sonar: указатель на #HyScanSonar
+ * @source: идентификатор источника данных #HyScanSourceType
+ * @receive_time: время приёма эхосигнала, секунды
+ * @wait_time: время задержки излучения после приёма, секунды
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно задаёт время приёма эхосигнала. Аналогична функции
+ * #hyscan_sonar_receiver_set_time. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_receiver_set_time_async (HyScanSonar         *sonar,
+                                      HyScanSourceType     source,
+                                      gdouble              receive_time,
+                                      gdouble              wait_time,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  HyScanSonarConfig *config;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_receiver_set_time (config, source, receive_time, wait_time);
+  hyscan_sonar_setup_async (sonar, config, cancellable, callback, user_data,
+                            hyscan_sonar_receiver_set_time_async);
+}
+
+/**
+ * hyscan_sonar_receiver_set_auto_async:
+ * @sonar: указатель на #HyScanSonar
+ * @source: идентификатор источника данных #HyScanSourceType
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно задаёт автоматический выбор времени приёма эхосигнала. Аналогична функции
+ * #hyscan_sonar_receiver_set_auto. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_receiver_set_auto_async (HyScanSonar         *sonar,
+                                      HyScanSourceType     source,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  HyScanSonarConfig *config;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_receiver_set_auto (config, source);
+  hyscan_sonar_setup_async (sonar, config, cancellable, callback, user_data,
+                            hyscan_sonar_receiver_set_auto_async);
+}
+
+/**
+ * hyscan_sonar_receiver_disable_async:
+ * @sonar: указатель на #HyScanSonar
+ * @source: идентификатор источника данных #HyScanSourceType
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно отключает приём эхосигнала. Аналогична функции
+ * #hyscan_sonar_receiver_disable. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_receiver_disable_async (HyScanSonar         *sonar,
+                                     HyScanSourceType     source,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+  HyScanSonarConfig *config;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_receiver_disable (config, source);
+  hyscan_sonar_setup_async (sonar, config, cancellable, callback, user_data,
+                            hyscan_sonar_receiver_disable_async);
+}
+
+/**
+ * hyscan_sonar_generator_set_preset_async:
+ * @sonar: указатель на #HyScanSonar
+ * @source: идентификатор источника данных #HyScanSourceType
+ * @preset: идентификатор преднастройки
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно устанавливает режим работы генератора. Аналогична функции
+ * #hyscan_sonar_generator_set_preset. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_generator_set_preset_async (HyScanSonar         *sonar,
+                                         HyScanSourceType     source,
+                                         gint64               preset,
+                                         GCancellable        *cancellable,
+                                         GAsyncReadyCallback  callback,
+                                         gpointer             user_data)
+{
+  HyScanSonarConfig *config;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_generator_set_preset (config, source, preset);
+  hyscan_sonar_setup_async (sonar, config, cancellable, callback, user_data,
+                            hyscan_sonar_generator_set_preset_async);
+}
+
+/**
+ * hyscan_sonar_generator_disable_async:
+ * @sonar: указатель на #HyScanSonar
+ * @source: идентификатор источника данных #HyScanSourceType
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно отключает излучение сигнала генератором. Аналогична функции
+ * #hyscan_sonar_generator_disable. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_generator_disable_async (HyScanSonar         *sonar,
+                                      HyScanSourceType     source,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  HyScanSonarConfig *config;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_generator_disable (config, source);
+  hyscan_sonar_setup_async (sonar, config, cancellable, callback, user_data,
+                            hyscan_sonar_generator_disable_async);
+}
+
+/**
+ * hyscan_sonar_tvg_set_auto_async:
+ * @sonar: указатель на #HyScanSonar
+ * @source: идентификатор источника данных #HyScanSourceType
+ * @level: целевой уровень сигнала
+ * @sensitivity: чувствительность автомата регулировки
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно включает автоматический режим управления системой ВАРУ. Аналогична функции
+ * #hyscan_sonar_tvg_set_auto. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_tvg_set_auto_async (HyScanSonar         *sonar,
+                                 HyScanSourceType     source,
+                                 gdouble              level,
+                                 gdouble              sensitivity,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  HyScanSonarConfig *config;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_tvg_set_auto (config, source, level, sensitivity);
+  hyscan_sonar_setup_async (sonar, config, cancellable, callback, user_data,
+                            hyscan_sonar_tvg_set_auto_async);
+}
+
+/**
+ * hyscan_sonar_tvg_set_constant_async:
+ * @sonar: указатель на #HyScanSonar
+ * @source: идентификатор источника данных #HyScanSourceType
+ * @gain: коэффициент усиления, дБ
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно устанавливает постоянный уровень усиления. Аналогична функции
+ * #hyscan_sonar_tvg_set_constant. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_tvg_set_constant_async (HyScanSonar         *sonar,
+                                     HyScanSourceType     source,
+                                     gdouble              gain,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+  HyScanSonarConfig *config;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_tvg_set_constant (config, source, gain);
+  hyscan_sonar_setup_async (sonar, config, cancellable, callback, user_data,
+                            hyscan_sonar_tvg_set_constant_async);
+}
+
+/**
+ * hyscan_sonar_tvg_set_linear_db_async:
+ * @sonar: указатель на #HyScanSonar
+ * @source: идентификатор источника данных #HyScanSourceType
+ * @gain0: начальный уровень усиления, дБ
+ * @gain_step: величина изменения усиления каждые 100 метров, дБ
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно устанавливает линейное увеличение усиления в дБ на 100 метров. Аналогична функции
+ * #hyscan_sonar_tvg_set_linear_db. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_tvg_set_linear_db_async (HyScanSonar         *sonar,
+                                      HyScanSourceType     source,
+                                      gdouble              gain0,
+                                      gdouble              gain_step,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  HyScanSonarConfig *config;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_tvg_set_linear_db (config, source, gain0, gain_step);
+  hyscan_sonar_setup_async (sonar, config, cancellable, callback, user_data,
+                            hyscan_sonar_tvg_set_linear_db_async);
+}
+
+/**
+ * hyscan_sonar_tvg_set_logarithmic_async:
+ * @sonar: указатель на #HyScanSonar
+ * @source: идентификатор источника данных #HyScanSourceType
+ * @gain0: начальный уровень усиления, дБ
+ * @beta: коэффициент отражения цели, дБ
+ * @alpha: коэффициент поглощения цели, дБ/м
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно устанавливает логарифмический вид закона усиления системой ВАРУ. Аналогична функции
+ * #hyscan_sonar_tvg_set_logarithmic. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_tvg_set_logarithmic_async (HyScanSonar         *sonar,
+                                        HyScanSourceType     source,
+                                        gdouble              gain0,
+                                        gdouble              beta,
+                                        gdouble              alpha,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data)
+{
+  HyScanSonarConfig *config;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_tvg_set_logarithmic (config, source, gain0, beta, alpha);
+  hyscan_sonar_setup_async (sonar, config, cancellable, callback, user_data,
+                            hyscan_sonar_tvg_set_logarithmic_async);
+}
+
+/**
+ * hyscan_sonar_tvg_disable_async:
+ * @sonar: указатель на #HyScanSonar
+ * @source: идентификатор источника данных #HyScanSourceType
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно отключает управление усилением. Аналогична функции
+ * #hyscan_sonar_tvg_disable. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_tvg_disable_async (HyScanSonar         *sonar,
+                                HyScanSourceType     source,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+  HyScanSonarConfig *config;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_tvg_disable (config, source);
+  hyscan_sonar_setup_async (sonar, config, cancellable, callback, user_data,
+                            hyscan_sonar_tvg_disable_async);
+}
+
+/**
+ * hyscan_sonar_start_async:
+ * @sonar: указатель на #HyScanSonar
+ * @project_name: название проекта, в который записывать данные
+ * @track_name: название галса, в который записывать данные
+ * @track_type: тип галса
+ * @track_plan: (nullable): запланированные параметры галса
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно переводит гидролокатор в рабочий режим. Аналогична
+ * функции #hyscan_sonar_start. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_start_async (HyScanSonar           *sonar,
+                          const gchar           *project_name,
+                          const gchar           *track_name,
+                          HyScanTrackType        track_type,
+                          const HyScanTrackPlan *track_plan,
+                          GCancellable          *cancellable,
+                          GAsyncReadyCallback    callback,
+                          gpointer               user_data)
+{
+  HyScanSonarInterface *iface;
+  HyScanSonarStartAsync *start;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  iface = HYSCAN_SONAR_GET_IFACE (sonar);
+  if (hyscan_sonar_async_native (iface))
+    {
+      GTask *task;
+
+      task = hyscan_device_async_native (sonar, (HyScanDeviceAsyncFinish)iface->start_finish,
+                                         cancellable, callback, user_data, hyscan_sonar_start_async);
+      (* iface->start_async) (sonar, project_name, track_name, track_type, track_plan,
+                              cancellable, hyscan_device_async_native_ready, task);
+
+      return;
+    }
+
+  start = g_slice_new0 (HyScanSonarStartAsync);
+  start->project_name = g_strdup (project_name);
+  start->track_name = g_strdup (track_name);
+  start->track_type = track_type;
+  if (track_plan != NULL)
+    start->track_plan = g_slice_dup (HyScanTrackPlan, track_plan);
+
+  hyscan_device_async_run (sonar, hyscan_sonar_start_func, start, hyscan_sonar_start_async_free,
+                           cancellable, callback, user_data, hyscan_sonar_start_async);
+}
+
+/**
+ * hyscan_sonar_stop_async:
+ * @sonar: указатель на #HyScanSonar
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно переводит гидролокатор в ждущий режим. Аналогична
+ * функции #hyscan_sonar_stop. Результат выполнения можно получить функцией
+ * #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_stop_async (HyScanSonar         *sonar,
+                         GCancellable        *cancellable,
+                         GAsyncReadyCallback  callback,
+                         gpointer             user_data)
+{
+  HyScanSonarInterface *iface;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+
+  iface = HYSCAN_SONAR_GET_IFACE (sonar);
+  if (hyscan_sonar_async_native (iface))
+    {
+      GTask *task;
+
+      task = hyscan_device_async_native (sonar, (HyScanDeviceAsyncFinish)iface->stop_finish,
+                                         cancellable, callback, user_data, hyscan_sonar_stop_async);
+      (* iface->stop_async) (sonar, cancellable, hyscan_device_async_native_ready, task);
+
+      return;
+    }
+
+  hyscan_device_async_run (sonar, hyscan_sonar_stop_func, NULL, NULL,
+                           cancellable, callback, user_data, hyscan_sonar_stop_async);
+}
+
+/**
+ * hyscan_sonar_configure_async:
+ * @sonar: указатель на #HyScanSonar
+ * @config: указатель на #HyScanSonarConfig
+ * @cancellable: (nullable): #GCancellable
+ * @callback: функция обратного вызова
+ * @user_data: пользовательские данные
+ *
+ * Функция асинхронно применяет параметры источников данных. Аналогична
+ * функции #hyscan_sonar_configure. Результат выполнения можно получить
+ * функцией #hyscan_sonar_finish.
+ */
+void
+hyscan_sonar_configure_async (HyScanSonar         *sonar,
+                              HyScanSonarConfig   *config,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              gpointer             user_data)
+{
+  HyScanSonarInterface *iface;
+
+  g_return_if_fail (HYSCAN_IS_SONAR (sonar));
+  g_return_if_fail (HYSCAN_IS_SONAR_CONFIG (config));
+
+  iface = HYSCAN_SONAR_GET_IFACE (sonar);
+  if (hyscan_sonar_async_native (iface))
+    {
+      GTask *task;
+
+      task = hyscan_device_async_native (sonar, (HyScanDeviceAsyncFinish)iface->configure_finish,
+                                         cancellable, callback, user_data, hyscan_sonar_configure_async);
+      (* iface->configure_async) (sonar, config, cancellable, hyscan_device_async_native_ready, task);
+
+      return;
+    }
+
+  hyscan_device_async_run (sonar, hyscan_sonar_configure_func, g_object_ref (config), g_object_unref,
+                           cancellable, callback, user_data, hyscan_sonar_configure_async);
+}
+
+/**
+ * hyscan_sonar_finish:
+ * @sonar: указатель на #HyScanSonar
+ * @result: #GAsyncResult
+ * @error: (nullable): #GError
+ *
+ * Функция возвращает результат выполнения асинхронной команды
+ * гидролокатора. Функция должна вызываться из функции обратного вызова.
+ *
+ * Returns: %TRUE если команда выполнена успешно, иначе %FALSE.
+ */
+gboolean
+hyscan_sonar_finish (HyScanSonar   *sonar,
+                     GAsyncResult  *result,
+                     GError       **error)
+{
+  g_return_val_if_fail (HYSCAN_IS_SONAR (sonar), FALSE);
+
+  return hyscan_device_async_finish (sonar, result, error);
+}
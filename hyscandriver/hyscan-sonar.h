@@ -36,6 +36,7 @@
 #define __HYSCAN_SONAR_H__
 
 #include <hyscan-types.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
@@ -82,6 +83,7 @@ typedef enum
 
 typedef struct _HyScanSonar HyScanSonar;
 typedef struct _HyScanSonarInterface HyScanSonarInterface;
+typedef struct _HyScanSonarConfig HyScanSonarConfig;
 
 /**
  * HyScanSonarInterface:
@@ -99,6 +101,13 @@ typedef struct _HyScanSonarInterface HyScanSonarInterface;
  * @tvg_disable: Функция отключает управление усилением.
  * @start: Функция переводит гидролокатор в рабочий режим.
  * @stop: Функция переводит гидролокатор в ждущий режим и отключает запись данных.
+ * @configure: Функция применяет параметры нескольких источников данных за один обмен.
+ * @configure_async: Функция асинхронно применяет параметры нескольких источников данных.
+ * @configure_finish: Функция возвращает результат асинхронной настройки.
+ * @start_async: Функция асинхронно переводит гидролокатор в рабочий режим.
+ * @start_finish: Функция возвращает результат асинхронного запуска.
+ * @stop_async: Функция асинхронно переводит гидролокатор в ждущий режим.
+ * @stop_finish: Функция возвращает результат асинхронного останова.
  */
 struct _HyScanSonarInterface
 {
@@ -156,6 +165,41 @@ struct _HyScanSonarInterface
                                                                 const HyScanTrackPlan          *track_plan);
 
   gboolean             (*stop)                                 (HyScanSonar                    *sonar);
+
+  gboolean             (*configure)                            (HyScanSonar                    *sonar,
+                                                                HyScanSonarConfig              *config);
+
+  void                 (*configure_async)                      (HyScanSonar                    *sonar,
+                                                                HyScanSonarConfig              *config,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+  gboolean             (*configure_finish)                     (HyScanSonar                    *sonar,
+                                                                GAsyncResult                   *result,
+                                                                GError                        **error);
+
+  void                 (*start_async)                          (HyScanSonar                    *sonar,
+                                                                const gchar                    *project_name,
+                                                                const gchar                    *track_name,
+                                                                HyScanTrackType                 track_type,
+                                                                const HyScanTrackPlan          *track_plan,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+  gboolean             (*start_finish)                         (HyScanSonar                    *sonar,
+                                                                GAsyncResult                   *result,
+                                                                GError                        **error);
+
+  void                 (*stop_async)                           (HyScanSonar                    *sonar,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+  gboolean             (*stop_finish)                          (HyScanSonar                    *sonar,
+                                                                GAsyncResult                   *result,
+                                                                GError                        **error);
 };
 
 HYSCAN_API
@@ -227,6 +271,127 @@ gboolean               hyscan_sonar_start                      (HyScanSonar
 HYSCAN_API
 gboolean               hyscan_sonar_stop                       (HyScanSonar                    *sonar);
 
+HYSCAN_API
+gboolean               hyscan_sonar_configure                  (HyScanSonar                    *sonar,
+                                                                HyScanSonarConfig              *config);
+
+HYSCAN_API
+void                   hyscan_sonar_antenna_set_offset_async   (HyScanSonar                    *sonar,
+                                                                HyScanSourceType                source,
+                                                                const HyScanAntennaOffset      *offset,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_receiver_set_time_async    (HyScanSonar                    *sonar,
+                                                                HyScanSourceType                source,
+                                                                gdouble                         receive_time,
+                                                                gdouble                         wait_time,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_receiver_set_auto_async    (HyScanSonar                    *sonar,
+                                                                HyScanSourceType                source,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_receiver_disable_async     (HyScanSonar                    *sonar,
+                                                                HyScanSourceType                source,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_generator_set_preset_async (HyScanSonar                    *sonar,
+                                                                HyScanSourceType                source,
+                                                                gint64                          preset,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_generator_disable_async    (HyScanSonar                    *sonar,
+                                                                HyScanSourceType                source,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_tvg_set_auto_async         (HyScanSonar                    *sonar,
+                                                                HyScanSourceType                source,
+                                                                gdouble                         level,
+                                                                gdouble                         sensitivity,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_tvg_set_constant_async     (HyScanSonar                    *sonar,
+                                                                HyScanSourceType                source,
+                                                                gdouble                         gain,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_tvg_set_linear_db_async    (HyScanSonar                    *sonar,
+                                                                HyScanSourceType                source,
+                                                                gdouble                         gain0,
+                                                                gdouble                         gain_step,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_tvg_set_logarithmic_async  (HyScanSonar                    *sonar,
+                                                                HyScanSourceType                source,
+                                                                gdouble                         gain0,
+                                                                gdouble                         beta,
+                                                                gdouble                         alpha,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_tvg_disable_async          (HyScanSonar                    *sonar,
+                                                                HyScanSourceType                source,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_start_async                (HyScanSonar                    *sonar,
+                                                                const gchar                    *project_name,
+                                                                const gchar                    *track_name,
+                                                                HyScanTrackType                 track_type,
+                                                                const HyScanTrackPlan          *track_plan,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_stop_async                 (HyScanSonar                    *sonar,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+void                   hyscan_sonar_configure_async            (HyScanSonar                    *sonar,
+                                                                HyScanSonarConfig              *config,
+                                                                GCancellable                   *cancellable,
+                                                                GAsyncReadyCallback             callback,
+                                                                gpointer                        user_data);
+
+HYSCAN_API
+gboolean               hyscan_sonar_finish                     (HyScanSonar                    *sonar,
+                                                                GAsyncResult                   *result,
+                                                                GError                        **error);
+
 G_END_DECLS
 
 #endif /* __HYSCAN_SONAR_H__ */
@@ -0,0 +1,363 @@
+/* hyscan-uart-monitor.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-uart-monitor
+ * @Short_description: класс отслеживания подключения UART портов
+ * @Title: HyScanUARTMonitor
+ *
+ * Класс хранит список UART портов, доступных в системе, и отслеживает
+ * их подключение и отключение. Список UART портов можно получить функцией
+ * #hyscan_uart_monitor_list. Эта функция возвращает копию текущего списка
+ * и не обращается к системе.
+ *
+ * При подключении нового UART порта посылается сигнал
+ * #HyScanUARTMonitor::device-added, а при его отключении сигнал
+ * #HyScanUARTMonitor::device-removed.
+ *
+ * В Linux изменения отслеживаются с помощью inotify для каталога /dev.
+ * Список UART портов формируется заново только при создании или удалении
+ * устройств tty. Если inotify недоступен, а также в Windows, список UART
+ * портов формируется заново каждую секунду.
+ */
+
+#include "hyscan-uart-monitor.h"
+
+#if defined (__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#define POLL_PERIOD            100     /* Период проверки завершения работы, мс. */
+#define SETTLE_TIME            50000   /* Время ожидания настройки нового устройства, мкс. */
+#define RESCAN_PERIOD          1000000 /* Период формирования списка без inotify, мкс. */
+
+enum
+{
+  SIGNAL_DEVICE_ADDED,
+  SIGNAL_DEVICE_REMOVED,
+  SIGNAL_LAST
+};
+
+struct _HyScanUARTMonitorPrivate
+{
+  GThread             *watcher;        /* Поток отслеживания изменений. */
+  gint                 shutdown;       /* Признак завершения работы. */
+
+  GMutex               lock;           /* Блокировка доступа к списку. */
+  GList               *devices;        /* Текущий список UART портов. */
+};
+
+static void        hyscan_uart_monitor_object_constructed   (GObject               *object);
+static void        hyscan_uart_monitor_object_finalize      (GObject               *object);
+
+static gint        hyscan_uart_monitor_compare              (gconstpointer          a,
+                                                             gconstpointer          b);
+
+static gpointer    hyscan_uart_monitor_device_copy          (gconstpointer          device,
+                                                             gpointer               data);
+
+static void        hyscan_uart_monitor_update               (HyScanUARTMonitor     *monitor);
+
+static gpointer    hyscan_uart_monitor_watcher              (gpointer               data);
+
+static guint       hyscan_uart_monitor_signals[SIGNAL_LAST] = { 0 };
+
+G_DEFINE_TYPE_WITH_PRIVATE (HyScanUARTMonitor, hyscan_uart_monitor, G_TYPE_OBJECT)
+
+static void
+hyscan_uart_monitor_class_init (HyScanUARTMonitorClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->constructed = hyscan_uart_monitor_object_constructed;
+  object_class->finalize = hyscan_uart_monitor_object_finalize;
+
+  /**
+   * HyScanUARTMonitor::device-added:
+   * @monitor: указатель на #HyScanUARTMonitor
+   * @device: описание UART порта #HyScanUARTDevice
+   *
+   * Данный сигнал посылается при подключении нового UART порта. Сигнал
+   * посылается из потока отслеживания изменений, таким образом обработчики
+   * этого сигнала не могут использовать функции работающие через #GMainLoop,
+   * например все функции Gtk.
+   */
+  hyscan_uart_monitor_signals[SIGNAL_DEVICE_ADDED] =
+    g_signal_new ("device-added", HYSCAN_TYPE_UART_MONITOR, G_SIGNAL_RUN_LAST, 0,
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__BOXED,
+                  G_TYPE_NONE, 1, HYSCAN_TYPE_UART_DEVICE);
+
+  /**
+   * HyScanUARTMonitor::device-removed:
+   * @monitor: указатель на #HyScanUARTMonitor
+   * @device: описание UART порта #HyScanUARTDevice
+   *
+   * Данный сигнал посылается при отключении UART порта. Сигнал посылается
+   * из потока отслеживания изменений.
+   */
+  hyscan_uart_monitor_signals[SIGNAL_DEVICE_REMOVED] =
+    g_signal_new ("device-removed", HYSCAN_TYPE_UART_MONITOR, G_SIGNAL_RUN_LAST, 0,
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__BOXED,
+                  G_TYPE_NONE, 1, HYSCAN_TYPE_UART_DEVICE);
+}
+
+static void
+hyscan_uart_monitor_init (HyScanUARTMonitor *monitor)
+{
+  monitor->priv = hyscan_uart_monitor_get_instance_private (monitor);
+}
+
+static void
+hyscan_uart_monitor_object_constructed (GObject *object)
+{
+  HyScanUARTMonitor *monitor = HYSCAN_UART_MONITOR (object);
+  HyScanUARTMonitorPrivate *priv = monitor->priv;
+
+  g_mutex_init (&priv->lock);
+
+  priv->devices = hyscan_uart_list ();
+  priv->watcher = g_thread_new ("uart-monitor", hyscan_uart_monitor_watcher, monitor);
+}
+
+static void
+hyscan_uart_monitor_object_finalize (GObject *object)
+{
+  HyScanUARTMonitor *monitor = HYSCAN_UART_MONITOR (object);
+  HyScanUARTMonitorPrivate *priv = monitor->priv;
+
+  g_atomic_int_set (&priv->shutdown, 1);
+  g_thread_join (priv->watcher);
+
+  g_list_free_full (priv->devices, (GDestroyNotify)hyscan_uart_device_free);
+  g_mutex_clear (&priv->lock);
+
+  G_OBJECT_CLASS (hyscan_uart_monitor_parent_class)->finalize (object);
+}
+
+/* Функция сравнивает описания UART портов по пути к устройству. */
+static gint
+hyscan_uart_monitor_compare (gconstpointer a,
+                             gconstpointer b)
+{
+  const HyScanUARTDevice *device1 = a;
+  const HyScanUARTDevice *device2 = b;
+
+  return g_strcmp0 (device1->path, device2->path);
+}
+
+/* Функция копирования описания UART порта для g_list_copy_deep. */
+static gpointer
+hyscan_uart_monitor_device_copy (gconstpointer device,
+                                 gpointer      data)
+{
+  return hyscan_uart_device_copy (device);
+}
+
+/* Функция формирует новый список UART портов и посылает сигналы
+ * об изменениях в нём. */
+static void
+hyscan_uart_monitor_update (HyScanUARTMonitor *monitor)
+{
+  HyScanUARTMonitorPrivate *priv = monitor->priv;
+  GList *devices;
+  GList *added = NULL;
+  GList *removed = NULL;
+  GList *link;
+
+  devices = hyscan_uart_list ();
+
+  g_mutex_lock (&priv->lock);
+
+  for (link = devices; link != NULL; link = link->next)
+    {
+      if (g_list_find_custom (priv->devices, link->data, hyscan_uart_monitor_compare) == NULL)
+        added = g_list_prepend (added, link->data);
+    }
+
+  for (link = priv->devices; link != NULL; link = link->next)
+    {
+      if (g_list_find_custom (devices, link->data, hyscan_uart_monitor_compare) == NULL)
+        removed = g_list_prepend (removed, link->data);
+    }
+
+  /* Старый список удаляется после отправки сигналов. Новый список
+   * изменяется только в этом потоке, поэтому его элементы можно
+   * использовать после снятия блокировки. */
+  link = priv->devices;
+  priv->devices = devices;
+  devices = link;
+
+  g_mutex_unlock (&priv->lock);
+
+  for (link = removed; link != NULL; link = link->next)
+    g_signal_emit (monitor, hyscan_uart_monitor_signals[SIGNAL_DEVICE_REMOVED], 0, link->data);
+
+  for (link = added; link != NULL; link = link->next)
+    g_signal_emit (monitor, hyscan_uart_monitor_signals[SIGNAL_DEVICE_ADDED], 0, link->data);
+
+  g_list_free (added);
+  g_list_free (removed);
+  g_list_free_full (devices, (GDestroyNotify)hyscan_uart_device_free);
+}
+
+/* Поток отслеживания изменений. */
+static gpointer
+hyscan_uart_monitor_watcher (gpointer data)
+{
+  HyScanUARTMonitor *monitor = data;
+  HyScanUARTMonitorPrivate *priv = monitor->priv;
+  gint64 rescan_time = 0;
+
+#if defined (__linux__)
+  gint fd;
+
+  /* Отслеживаем создание и удаление файлов устройств. */
+  fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+  if ((fd >= 0) && (inotify_add_watch (fd, "/dev", IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO) < 0))
+    {
+      close (fd);
+      fd = -1;
+    }
+#endif
+
+  while (!g_atomic_int_get (&priv->shutdown))
+    {
+#if defined (__linux__)
+      if (fd >= 0)
+        {
+          struct pollfd pfd;
+
+          pfd.fd = fd;
+          pfd.events = POLLIN;
+          pfd.revents = 0;
+
+          if (poll (&pfd, 1, POLL_PERIOD) > 0)
+            {
+              union
+              {
+                struct inotify_event event;
+                gchar                data[4096];
+              } buffer;
+              gssize size;
+
+              /* Список формируется заново только при изменении устройств tty.
+               * Повторное формирование откладывается до завершения настройки
+               * нового устройства. */
+              while ((size = read (fd, &buffer, sizeof (buffer))) > 0)
+                {
+                  gchar *cur = buffer.data;
+
+                  while (cur < buffer.data + size)
+                    {
+                      const struct inotify_event *event = (const struct inotify_event *)cur;
+
+                      if ((event->len > 0) && g_str_has_prefix (event->name, "tty"))
+                        rescan_time = g_get_monotonic_time () + SETTLE_TIME;
+
+                      cur += sizeof (struct inotify_event) + event->len;
+                    }
+                }
+            }
+
+          if ((rescan_time == 0) || (g_get_monotonic_time () < rescan_time))
+            continue;
+
+          rescan_time = 0;
+        }
+      else
+#endif
+        {
+          g_usleep (POLL_PERIOD * 1000);
+
+          if (g_get_monotonic_time () < rescan_time)
+            continue;
+
+          rescan_time = g_get_monotonic_time () + RESCAN_PERIOD;
+        }
+
+      hyscan_uart_monitor_update (monitor);
+    }
+
+#if defined (__linux__)
+  if (fd >= 0)
+    close (fd);
+#endif
+
+  return NULL;
+}
+
+/**
+ * hyscan_uart_monitor_new:
+ *
+ * Функция создаёт новый объект #HyScanUARTMonitor. При создании объекта
+ * формируется список UART портов и запускается поток отслеживания изменений.
+ *
+ * Returns: #HyScanUARTMonitor. Для удаления #g_object_unref.
+ */
+HyScanUARTMonitor *
+hyscan_uart_monitor_new (void)
+{
+  return g_object_new (HYSCAN_TYPE_UART_MONITOR, NULL);
+}
+
+/**
+ * hyscan_uart_monitor_list:
+ * @monitor: указатель на #HyScanUARTMonitor
+ *
+ * Функция возвращает текущий список UART портов.
+ *
+ * Память выделенная под список должна быть освобождена после использования
+ * функцией #g_list_free_full. Для освобождения элементов списка необходимо
+ * использовать функцию #hyscan_uart_device_free.
+ *
+ * Returns: (element-type HyScanUARTDevice) (transfer full): Список UART
+ * устройств или NULL.
+ */
+GList *
+hyscan_uart_monitor_list (HyScanUARTMonitor *monitor)
+{
+  GList *list;
+
+  g_return_val_if_fail (HYSCAN_IS_UART_MONITOR (monitor), NULL);
+
+  g_mutex_lock (&monitor->priv->lock);
+  list = g_list_copy_deep (monitor->priv->devices, hyscan_uart_monitor_device_copy, NULL);
+  g_mutex_unlock (&monitor->priv->lock);
+
+  return list;
+}
@@ -57,6 +57,62 @@
  * Для обмена данными предназначены функции #hyscan_uart_read,
  * #hyscan_uart_read_byte, #hyscan_uart_write и #hyscan_uart_write_byte.
  *
+ * Функция #hyscan_uart_read_some считывает все данные, уже находящиеся в
+ * буфере порта, одним системным вызовом, ожидая только первый байт. Она
+ * предназначена для обработки потоков данных с собственным разбором кадров,
+ * например NMEA сообщений, без побайтового чтения. Функция #hyscan_uart_wait
+ * позволяет одному потоку ожидать поступления данных сразу в несколько
+ * портов.
+ *
+ * Если для принятых данных требуется точная метка времени, следует
+ * использовать функции #hyscan_uart_read_timed и #hyscan_uart_read_byte_timed.
+ * Эти функции фиксируют время сразу после считывания первого фрагмента
+ * данных и оценивают время начала приёма кадра с учётом скорости обмена и
+ * числа байт, уже находившихся в буфере порта. Таким образом, метка времени
+ * не зависит от задержек, возникающих в процессе дальнейшего приёма данных.
+ *
+ * Драйвер операционной системы и USB адаптеры UART портов по умолчанию
+ * накапливают принятые данные перед их передачей приложению. Задержка при
+ * этом может достигать десятков миллисекунд. Для её уменьшения предназначен
+ * режим низкой задержки, включаемый функцией #hyscan_uart_set_low_latency.
+ * В этом режиме устанавливается флаг низкой задержки драйвера порта и
+ * минимальное значение таймера задержки USB адаптера, если он его
+ * поддерживает. Функция возвращает набор реально применённых
+ * настроек. Режим сохраняется при повторном открытии порта, а исходные
+ * настройки восстанавливаются при его закрытии.
+ *
+ * Функция #hyscan_uart_write_async ставит данные в очередь отправки и сразу
+ * возвращает управление. Данные из очереди отправляются рабочим потоком,
+ * который запускается при первом вызове этой функции. Сообщения,
+ * накопившиеся в очереди за время отправки предыдущих, объединяются и
+ * отправляются одной операцией записи. По завершении отправки каждого
+ * сообщения вызывается функция обратного вызова со статусом его отправки.
+ * Дождаться отправки всех сообщений из очереди можно функцией
+ * #hyscan_uart_write_flush.
+ *
+ * Для каждого порта ведётся статистика обмена данными: число принятых и
+ * отправленных байт, системных вызовов, таймаутов и неполных операций, а
+ * также ошибок приёма, зафиксированных драйвером порта (только Linux).
+ * Дополнительно строится гистограмма интервалов между поступлениями данных
+ * и вычисляется загрузка линии относительно скорости обмена. Статистику
+ * можно получить функцией #hyscan_uart_get_stats и сбросить функцией
+ * #hyscan_uart_reset_stats. Статистика сбрасывается при открытии порта.
+ *
+ * Для отладки и воспроизведения работы драйверов предусмотрена запись всех
+ * принятых через порт данных в файл с метками времени. Запись включается
+ * функцией #hyscan_uart_capture_start и отключается функцией
+ * #hyscan_uart_capture_stop. Файл начинается с заголовка размером
+ * #HYSCAN_UART_CAPTURE_HEADER_SIZE: сигнатура #HYSCAN_UART_CAPTURE_MAGIC,
+ * версия формата #HYSCAN_UART_CAPTURE_VERSION и режим работы порта
+ * (guint32). Режим обновляется при каждом открытии порта и равен
+ * #HYSCAN_UART_MODE_DISABLED, если порт не открывался. Далее следуют
+ * записи, каждая из которых состоит из заголовка размером
+ * #HYSCAN_UART_CAPTURE_RECORD_SIZE с меткой монотонного времени приёма
+ * данных (gint64, мкс, g_get_monotonic_time) и размером данных (guint32),
+ * и самих данных. Все числа записываются в формате little-endian.
+ * Записанные данные можно воспроизвести через псевдотерминал с исходными
+ * временными интервалами утилитой uart-replay.
+ *
  * Если обмен данными завершился с ошибкой #HYSCAN_UART_STATUS_ERROR, то это
  * обозначает что порт более не доступен. Требуется его закрыть и попытаться
  * открыть заново.
@@ -66,14 +122,24 @@
  */
 
 #include "hyscan-uart.h"
+#include <glib/gstdio.h>
+#include <string.h>
 
 #if defined (G_OS_UNIX)
 
 #include <fcntl.h>
 #include <errno.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <termios.h>
+#include <poll.h>
+#include <sys/ioctl.h>
 #include <sys/select.h>
+#include <sys/uio.h>
+
+#if defined (__linux__)
+#include <linux/serial.h>
+#endif
 
 #define HANDLE gint
 #define INVALID_HANDLE_VALUE -1
@@ -93,6 +159,16 @@
 #endif
 
 #define DEFAULT_TIMEOUT        1.0     /* Таймаут по умолчанию. */
+#define LOW_LATENCY_TIMER      1       /* Значение таймера задержки USB адаптера, мс. */
+#define WRITE_BATCH_SIZE       64      /* Максимальное число сообщений в одной операции записи. */
+
+typedef struct
+{
+  guint8                    *data;     /* Данные для отправки. */
+  guint32                    size;     /* Размер данных. */
+  HyScanUARTWriteFunc        callback; /* Функция обратного вызова. */
+  gpointer                   user_data;/* Пользовательские данные. */
+} HyScanUARTMessage;
 
 struct _HyScanUARTPrivate
 {
@@ -100,8 +176,33 @@ struct _HyScanUARTPrivate
   gchar               *path;           /* Путь к UART порту. */
   HyScanUARTMode       mode;           /* Текущий режим работы порта. */
   guint32              block_size;     /* Размер блока записи данных. */
+  gdouble              byte_time;      /* Время передачи одного байта, мкс. */
   gdouble              rx_timeout;     /* Таймаут операции чтения данных. */
   gdouble              tx_timeout;     /* Таймаут операции записи данных. */
+
+  gboolean             low_latency;    /* Признак включения режима низкой задержки. */
+  HyScanUARTLatency    latency;        /* Применённые настройки режима низкой задержки. */
+  gint                 serial_flags;   /* Исходные флаги драйвера порта. */
+  gint                 latency_timer;  /* Исходное значение таймера задержки USB адаптера. */
+
+  GMutex               io_lock;        /* Блокировка записи данных в порт. */
+
+  GThread             *writer;         /* Поток асинхронной отправки данных. */
+  GMutex               write_lock;     /* Блокировка очереди отправки. */
+  GCond                write_cond;     /* Сигнализатор изменения очереди отправки. */
+  GQueue               write_queue;    /* Очередь сообщений для отправки. */
+  guint                write_active;   /* Число отправляемых в данный момент сообщений. */
+  gboolean             write_shutdown; /* Признак завершения потока отправки. */
+  gboolean             write_closed;   /* Признак закрытия порта для отправки. */
+
+  GMutex               stats_lock;     /* Блокировка доступа к статистике. */
+  HyScanUARTStats      stats;          /* Статистика обмена данными. */
+  gint64               stats_start;    /* Время начала накопления статистики. */
+  gint64               rx_last;        /* Время последнего поступления данных. */
+  gint64               icount[5];      /* Начальные значения счётчиков ошибок драйвера. */
+
+  GMutex               capture_lock;   /* Блокировка записи принятых данных. */
+  FILE                *capture;        /* Файл записи принятых данных. */
 };
 
 static void    hyscan_uart_object_constructed       (GObject               *object);
@@ -109,6 +210,9 @@ static void    hyscan_uart_object_finalize          (GObject               *obje
 
 static guint32 hyscan_uart_get_speed                (HyScanUARTMode         mode);
 
+static gint64  hyscan_uart_rx_time                  (HyScanUARTPrivate     *priv,
+                                                     guint32                size);
+
 static HANDLE  hyscan_uart_open_internal            (const gchar           *path,
                                                      HyScanUARTMode         mode);
 
@@ -118,16 +222,65 @@ static void    hyscan_uart_timeout_internal         (HANDLE                 fd,
                                                      gdouble                rx_timeout,
                                                      gdouble                tx_timeout);
 
+static void    hyscan_uart_stats_io                 (HyScanUARTPrivate     *priv,
+                                                     gboolean               rx,
+                                                     gssize                 size);
+
+static void    hyscan_uart_stats_complete           (HyScanUARTPrivate     *priv,
+                                                     gboolean               rx,
+                                                     HyScanUARTStatus       status,
+                                                     guint32                done,
+                                                     guint32                requested);
+
+static void    hyscan_uart_capture_mode             (HyScanUARTPrivate     *priv);
+static void    hyscan_uart_capture_write            (HyScanUARTPrivate     *priv,
+                                                     const guint8          *data,
+                                                     guint32                size);
+
+static gboolean hyscan_uart_icount_internal         (HANDLE                 fd,
+                                                     gint64                *icount);
+
+static HyScanUARTLatency
+               hyscan_uart_latency_enable           (HyScanUARTPrivate     *priv);
+
+static void    hyscan_uart_latency_restore          (HyScanUARTPrivate     *priv);
+
 static HyScanUARTStatus
                hyscan_uart_read_internal            (HyScanUARTPrivate     *priv,
                                                      guint8                *buffer,
-                                                     guint32               *size);
+                                                     guint32               *size,
+                                                     gint64                *time);
+
+static HyScanUARTStatus
+               hyscan_uart_read_some_internal       (HyScanUARTPrivate     *priv,
+                                                     guint8                *buffer,
+                                                     guint32               *size,
+                                                     gint64                *time);
+
+static gint    hyscan_uart_wait_internal            (HANDLE                *fds,
+                                                     gboolean              *ready,
+                                                     guint                  n_fds,
+                                                     gdouble                timeout);
 
 static HyScanUARTStatus
                hyscan_uart_write_internal           (HyScanUARTPrivate     *priv,
                                                      guint8                *buffer,
                                                      guint32               *size);
 
+static HyScanUARTStatus
+               hyscan_uart_write_batch_internal     (HyScanUARTPrivate     *priv,
+                                                     HyScanUARTMessage    **messages,
+                                                     guint                  n_messages,
+                                                     guint                 *n_sent);
+
+static void    hyscan_uart_message_complete         (HyScanUART            *uart,
+                                                     HyScanUARTMessage     *message,
+                                                     HyScanUARTStatus       status);
+
+static gpointer hyscan_uart_writer                  (gpointer               data);
+
+static void    hyscan_uart_writer_stop              (HyScanUART            *uart);
+
 G_DEFINE_TYPE_WITH_PRIVATE (HyScanUART, hyscan_uart, G_TYPE_OBJECT)
 
 static void
@@ -152,14 +305,30 @@ hyscan_uart_object_constructed (GObject *object)
   HyScanUARTPrivate *priv = uart->priv;
 
   priv->fd = INVALID_HANDLE_VALUE;
+  priv->write_closed = TRUE;
+
+  g_mutex_init (&priv->io_lock);
+  g_mutex_init (&priv->stats_lock);
+  g_mutex_init (&priv->capture_lock);
+  g_mutex_init (&priv->write_lock);
+  g_cond_init (&priv->write_cond);
+  g_queue_init (&priv->write_queue);
 }
 
 static void
 hyscan_uart_object_finalize (GObject *object)
 {
   HyScanUART *uart = HYSCAN_UART (object);
+  HyScanUARTPrivate *priv = uart->priv;
 
   hyscan_uart_close (uart);
+  hyscan_uart_capture_stop (uart);
+
+  g_mutex_clear (&priv->io_lock);
+  g_mutex_clear (&priv->stats_lock);
+  g_mutex_clear (&priv->capture_lock);
+  g_mutex_clear (&priv->write_lock);
+  g_cond_clear (&priv->write_cond);
 
   G_OBJECT_CLASS (hyscan_uart_parent_class)->finalize (object);
 }
@@ -194,6 +363,141 @@ hyscan_uart_get_speed (HyScanUARTMode mode)
   return 0;
 }
 
+/* Функция оценивает время начала приёма данных. Время окончания приёма
+ * фиксируется в момент вызова, а время начала вычисляется по числу
+ * принятых байт и скорости обмена. Для режима 8N1 передача одного байта
+ * занимает 10 бит. */
+static gint64
+hyscan_uart_rx_time (HyScanUARTPrivate *priv,
+                     guint32            size)
+{
+  return g_get_real_time () - (gint64)(size * priv->byte_time);
+}
+
+/* Функция учитывает в статистике системный вызов чтения или записи. */
+static void
+hyscan_uart_stats_io (HyScanUARTPrivate *priv,
+                      gboolean           rx,
+                      gssize             size)
+{
+  g_mutex_lock (&priv->stats_lock);
+
+  if (rx)
+    {
+      priv->stats.rx_calls += 1;
+
+      if (size > 0)
+        {
+          gint64 now = g_get_monotonic_time ();
+
+          priv->stats.rx_bytes += size;
+
+          /* Интервал между поступлениями данных, i-й элемент гистограммы
+           * соответствует интервалу от 2^i до 2^(i+1) мкс. */
+          if (priv->rx_last > 0)
+            {
+              guint bin = g_bit_storage (MAX (now - priv->rx_last, 1)) - 1;
+
+              priv->stats.histogram[MIN (bin, HYSCAN_UART_STATS_HISTOGRAM_SIZE - 1)] += 1;
+            }
+
+          priv->rx_last = now;
+        }
+    }
+  else
+    {
+      priv->stats.tx_calls += 1;
+
+      if (size > 0)
+        priv->stats.tx_bytes += size;
+    }
+
+  g_mutex_unlock (&priv->stats_lock);
+}
+
+/* Функция учитывает в статистике результат операции приёма или отправки. */
+static void
+hyscan_uart_stats_complete (HyScanUARTPrivate *priv,
+                            gboolean           rx,
+                            HyScanUARTStatus   status,
+                            guint32            done,
+                            guint32            requested)
+{
+  g_mutex_lock (&priv->stats_lock);
+
+  if (status == HYSCAN_UART_STATUS_TIMEOUT)
+    rx ? priv->stats.rx_timeouts++ : priv->stats.tx_timeouts++;
+
+  if ((done > 0) && (done < requested))
+    rx ? priv->stats.rx_partial++ : priv->stats.tx_partial++;
+
+  g_mutex_unlock (&priv->stats_lock);
+}
+
+/* Функция записывает текущий режим работы порта в заголовок файла записи
+ * принятых данных. */
+static void
+hyscan_uart_capture_mode (HyScanUARTPrivate *priv)
+{
+  guint32 mode_le = GUINT32_TO_LE (priv->mode);
+
+  g_mutex_lock (&priv->capture_lock);
+
+  if (priv->capture == NULL)
+    {
+      g_mutex_unlock (&priv->capture_lock);
+      return;
+    }
+
+  /* Режим работы записан в заголовке после сигнатуры и версии формата. */
+  if ((fseek (priv->capture, 8, SEEK_SET) != 0) ||
+      (fwrite (&mode_le, sizeof (mode_le), 1, priv->capture) != 1) ||
+      (fseek (priv->capture, 0, SEEK_END) != 0))
+    {
+      g_warning ("HyScanUART: capture write error");
+      fclose (priv->capture);
+      priv->capture = NULL;
+    }
+
+  g_mutex_unlock (&priv->capture_lock);
+}
+
+/* Функция записывает принятые данные в файл. Метки времени берутся из
+ * монотонных часов, чтобы коррекция системного времени не нарушала
+ * интервалы между записями. */
+static void
+hyscan_uart_capture_write (HyScanUARTPrivate *priv,
+                           const guint8      *data,
+                           guint32            size)
+{
+  guint8 header[HYSCAN_UART_CAPTURE_RECORD_SIZE];
+  guint32 size_le;
+  gint64 time_le;
+
+  g_mutex_lock (&priv->capture_lock);
+
+  if (priv->capture == NULL)
+    {
+      g_mutex_unlock (&priv->capture_lock);
+      return;
+    }
+
+  time_le = GINT64_TO_LE (g_get_monotonic_time ());
+  size_le = GUINT32_TO_LE (size);
+  memcpy (header, &time_le, sizeof (time_le));
+  memcpy (header + sizeof (time_le), &size_le, sizeof (size_le));
+
+  if ((fwrite (header, sizeof (header), 1, priv->capture) != 1) ||
+      (fwrite (data, size, 1, priv->capture) != 1))
+    {
+      g_warning ("HyScanUART: capture write error");
+      fclose (priv->capture);
+      priv->capture = NULL;
+    }
+
+  g_mutex_unlock (&priv->capture_lock);
+}
+
 #if defined (G_OS_UNIX)
 
 static HANDLE
@@ -270,18 +574,180 @@ hyscan_uart_close_internal (HANDLE fd)
   close (fd);
 }
 
+/* Порт открывается в неблокирующем режиме, поэтому параметры VMIN/VTIME
+ * на него не влияют. Функции чтения и записи ожидают готовности порта
+ * функцией select с таймаутами rx_timeout и tx_timeout и возвращают данные
+ * сразу после поступления первого байта, поэтому дополнительные настройки
+ * порта не требуются. */
 static void
 hyscan_uart_timeout_internal (HANDLE  fd,
                               gdouble rx_timeout,
                               gdouble tx_timeout)
 {
+}
+
+/* Функция считывает счётчики ошибок драйвера порта: переполнение
+ * аппаратного буфера, переполнение буфера драйвера, ошибки кадра,
+ * ошибки чётности и сигналы BREAK. */
+static gboolean
+hyscan_uart_icount_internal (HANDLE  fd,
+                             gint64 *icount)
+{
+#if defined (__linux__) && defined (TIOCGICOUNT)
+  struct serial_icounter_struct counters;
+
+  if (ioctl (fd, TIOCGICOUNT, &counters) != 0)
+    return FALSE;
+
+  icount[0] = counters.overrun;
+  icount[1] = counters.buf_overrun;
+  icount[2] = counters.frame;
+  icount[3] = counters.parity;
+  icount[4] = counters.brk;
+
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+#if defined (__linux__)
+
+/* Функция возвращает путь к файлу таймера задержки USB адаптера. */
+static gchar *
+hyscan_uart_latency_timer_path (const gchar *path)
+{
+  gchar *real_path;
+  gchar *name;
+  gchar *timer_path;
+
+  real_path = realpath (path, NULL);
+  if (real_path == NULL)
+    return NULL;
+
+  name = g_path_get_basename (real_path);
+  timer_path = g_build_filename ("/sys/class/tty", name, "device", "latency_timer", NULL);
+
+  free (real_path);
+  g_free (name);
+
+  return timer_path;
+}
+
+/* Функция считывает значение таймера задержки USB адаптера. */
+static gint
+hyscan_uart_latency_timer_read (const gchar *timer_path)
+{
+  gchar *contents = NULL;
+  gint value = -1;
+
+  if (g_file_get_contents (timer_path, &contents, NULL, NULL))
+    value = g_ascii_strtoll (contents, NULL, 10);
+
+  g_free (contents);
+
+  return value;
+}
+
+/* Функция записывает значение таймера задержки USB адаптера. */
+static gboolean
+hyscan_uart_latency_timer_write (const gchar *timer_path,
+                                 gint         value)
+{
+  gchar buffer[16];
+  gboolean status;
+  gint length;
+  gint fd;
+
+  fd = open (timer_path, O_WRONLY);
+  if (fd < 0)
+    return FALSE;
+
+  length = g_snprintf (buffer, sizeof (buffer), "%d", value);
+  status = (write (fd, buffer, length) == length);
+
+  close (fd);
+
+  return status;
+}
+
+#endif
+
+static HyScanUARTLatency
+hyscan_uart_latency_enable (HyScanUARTPrivate *priv)
+{
+  HyScanUARTLatency latency = HYSCAN_UART_LATENCY_NONE;
+
+#if defined (__linux__)
+  struct serial_struct serial;
+  gchar *timer_path;
+
+  /* Флаг низкой задержки драйвера порта. */
+  if (ioctl (priv->fd, TIOCGSERIAL, &serial) == 0)
+    {
+      priv->serial_flags = serial.flags;
+      serial.flags |= ASYNC_LOW_LATENCY;
+      if (ioctl (priv->fd, TIOCSSERIAL, &serial) == 0)
+        latency |= HYSCAN_UART_LATENCY_DRIVER;
+    }
+
+  /* Таймер задержки USB адаптера. Есть только у некоторых
+   * адаптеров, например FTDI. */
+  timer_path = hyscan_uart_latency_timer_path (priv->path);
+  if (timer_path != NULL)
+    {
+      priv->latency_timer = hyscan_uart_latency_timer_read (timer_path);
+      if (priv->latency_timer == LOW_LATENCY_TIMER)
+        {
+          latency |= HYSCAN_UART_LATENCY_TIMER;
+        }
+      else if (priv->latency_timer > 0)
+        {
+          if (hyscan_uart_latency_timer_write (timer_path, LOW_LATENCY_TIMER))
+            latency |= HYSCAN_UART_LATENCY_TIMER;
+        }
+    }
+
+  g_free (timer_path);
+#endif
+
+  return latency;
+}
+
+static void
+hyscan_uart_latency_restore (HyScanUARTPrivate *priv)
+{
+#if defined (__linux__)
+  if (priv->latency & HYSCAN_UART_LATENCY_DRIVER)
+    {
+      struct serial_struct serial;
+
+      if (ioctl (priv->fd, TIOCGSERIAL, &serial) == 0)
+        {
+          serial.flags &= ~ASYNC_LOW_LATENCY;
+          serial.flags |= priv->serial_flags & ASYNC_LOW_LATENCY;
+          ioctl (priv->fd, TIOCSSERIAL, &serial);
+        }
+    }
 
+  if ((priv->latency & HYSCAN_UART_LATENCY_TIMER) &&
+      (priv->latency_timer > 0) && (priv->latency_timer != LOW_LATENCY_TIMER))
+    {
+      gchar *timer_path = hyscan_uart_latency_timer_path (priv->path);
+
+      if (timer_path != NULL)
+        hyscan_uart_latency_timer_write (timer_path, priv->latency_timer);
+
+      g_free (timer_path);
+    }
+#endif
 }
 
 static HyScanUARTStatus
 hyscan_uart_read_internal (HyScanUARTPrivate *priv,
                            guint8            *buffer,
-                           guint32           *size)
+                           guint32           *size,
+                           gint64            *time)
 {
   fd_set set;
   struct timeval tv;
@@ -294,6 +760,7 @@ hyscan_uart_read_internal (HyScanUARTPrivate *priv,
     {
       gint selected;
       gssize readed;
+      gint error;
 
       /* Ожидаем новые данные в течение timeout секунд. */
       FD_ZERO (&set);
@@ -308,9 +775,28 @@ hyscan_uart_read_internal (HyScanUARTPrivate *priv,
         return  HYSCAN_UART_STATUS_TIMEOUT;
 
       /* Считываем доступные данные. */
+      /* Код ошибки сохраняется до учёта вызова в статистике, так как
+       * блокировка статистики может изменить errno. */
       readed = read (priv->fd, buffer + total, remain);
-      if ((readed < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+      error = errno;
+      hyscan_uart_stats_io (priv, TRUE, readed);
+      if ((readed < 0) && (error != EAGAIN) && (error != EWOULDBLOCK))
         return  HYSCAN_UART_STATUS_ERROR;
+      if (readed <= 0)
+        continue;
+
+      hyscan_uart_capture_write (priv, buffer + total, readed);
+
+      /* Время начала приёма данных. Учитываем данные, оставшиеся в буфере. */
+      if ((time != NULL) && (total == 0))
+        {
+          int pending = 0;
+
+          if (ioctl (priv->fd, FIONREAD, &pending) < 0)
+            pending = 0;
+
+          *time = hyscan_uart_rx_time (priv, readed + pending);
+        }
 
       total += readed;
       remain -= readed;
@@ -320,6 +806,94 @@ hyscan_uart_read_internal (HyScanUARTPrivate *priv,
   return HYSCAN_UART_STATUS_OK;
 }
 
+static HyScanUARTStatus
+hyscan_uart_read_some_internal (HyScanUARTPrivate *priv,
+                                guint8            *buffer,
+                                guint32           *size,
+                                gint64            *time)
+{
+  fd_set set;
+  struct timeval tv;
+
+  guint32 remain = *size;
+  gint selected;
+  gssize readed;
+  gint error;
+
+  *size = 0;
+
+  /* Ожидаем новые данные в течение timeout секунд. */
+  FD_ZERO (&set);
+  tv.tv_sec = (gint)priv->rx_timeout;
+  tv.tv_usec = (gint)(G_USEC_PER_SEC * priv->rx_timeout) % G_USEC_PER_SEC;
+  FD_SET (priv->fd, &set);
+
+  selected = select (priv->fd + 1, &set, NULL, NULL, &tv);
+  if (selected < 0)
+    return  HYSCAN_UART_STATUS_ERROR;
+  if (selected == 0)
+    return  HYSCAN_UART_STATUS_TIMEOUT;
+
+  /* Считываем все доступные данные. Если порт готов к чтению, но данных
+   * нет, значит соединение с ним разорвано. */
+  readed = read (priv->fd, buffer, remain);
+  error = errno;
+  hyscan_uart_stats_io (priv, TRUE, readed);
+  if ((readed < 0) && ((error == EAGAIN) || (error == EWOULDBLOCK)))
+    return  HYSCAN_UART_STATUS_TIMEOUT;
+  if (readed <= 0)
+    return  HYSCAN_UART_STATUS_ERROR;
+
+  hyscan_uart_capture_write (priv, buffer, readed);
+
+  /* Время начала приёма данных. Учитываем данные, оставшиеся в буфере. */
+  if (time != NULL)
+    {
+      int pending = 0;
+
+      if (ioctl (priv->fd, FIONREAD, &pending) < 0)
+        pending = 0;
+
+      *time = hyscan_uart_rx_time (priv, readed + pending);
+    }
+
+  *size = readed;
+
+  return HYSCAN_UART_STATUS_OK;
+}
+
+static gint
+hyscan_uart_wait_internal (HANDLE   *fds,
+                           gboolean *ready,
+                           guint     n_fds,
+                           gdouble   timeout)
+{
+  struct pollfd *pfds;
+  gint n_ready;
+  guint i;
+
+  pfds = g_new0 (struct pollfd, n_fds);
+  for (i = 0; i < n_fds; i++)
+    {
+      pfds[i].fd = fds[i];
+      pfds[i].events = POLLIN;
+    }
+
+  /* Закрытые порты (fd = -1) функцией poll игнорируются. Ошибки и разрыв
+   * соединения также считаются готовностью, чтобы о них сообщила функция
+   * чтения данных. */
+  n_ready = poll (pfds, n_fds, (gint)(1000.0 * timeout));
+  for (i = 0; i < n_fds; i++)
+    ready[i] = (n_ready > 0) && (pfds[i].revents != 0);
+
+  g_free (pfds);
+
+  if ((n_ready < 0) && (errno == EINTR))
+    return 0;
+
+  return n_ready;
+}
+
 static HyScanUARTStatus
 hyscan_uart_write_internal (HyScanUARTPrivate *priv,
                             guint8            *buffer,
@@ -336,6 +910,7 @@ hyscan_uart_write_internal (HyScanUARTPrivate *priv,
     {
       gint selected;
       gssize written;
+      gint error;
 
       /* Ожидаем возможность отправки данных timeout секунд. */
       FD_ZERO (&set);
@@ -351,8 +926,12 @@ hyscan_uart_write_internal (HyScanUARTPrivate *priv,
 
       /* Отправляем данные. */
       written = write (priv->fd, buffer + total, MIN (priv->block_size, remain));
-      if ((written < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+      error = errno;
+      hyscan_uart_stats_io (priv, FALSE, written);
+      if ((written < 0) && (error != EAGAIN) && (error != EWOULDBLOCK))
         return  HYSCAN_UART_STATUS_ERROR;
+      if (written <= 0)
+        continue;
 
       total += written;
       remain -= written;
@@ -362,6 +941,71 @@ hyscan_uart_write_internal (HyScanUARTPrivate *priv,
   return HYSCAN_UART_STATUS_OK;
 }
 
+static HyScanUARTStatus
+hyscan_uart_write_batch_internal (HyScanUARTPrivate  *priv,
+                                  HyScanUARTMessage **messages,
+                                  guint               n_messages,
+                                  guint              *n_sent)
+{
+  struct iovec iov[WRITE_BATCH_SIZE];
+  fd_set set;
+  struct timeval tv;
+
+  guint first = 0;
+  gsize offset = 0;
+
+  *n_sent = 0;
+  while (first < n_messages)
+    {
+      gint selected;
+      gssize written;
+      gint error;
+      guint n_iov;
+      guint i;
+
+      /* Ожидаем возможность отправки данных timeout секунд. */
+      FD_ZERO (&set);
+      tv.tv_sec = (gint)priv->tx_timeout;
+      tv.tv_usec = (gint)(G_USEC_PER_SEC * priv->tx_timeout) % G_USEC_PER_SEC;
+      FD_SET (priv->fd, &set);
+
+      selected = select (priv->fd + 1, NULL, &set, NULL, &tv);
+      if (selected < 0)
+        return  HYSCAN_UART_STATUS_ERROR;
+      if (selected == 0)
+        return  HYSCAN_UART_STATUS_TIMEOUT;
+
+      /* Все неотправленные сообщения передаются одной операцией записи. */
+      for (i = first, n_iov = 0; i < n_messages; i++, n_iov++)
+        {
+          gsize skip = (i == first) ? offset : 0;
+
+          iov[n_iov].iov_base = messages[i]->data + skip;
+          iov[n_iov].iov_len = messages[i]->size - skip;
+        }
+
+      written = writev (priv->fd, iov, n_iov);
+      error = errno;
+      hyscan_uart_stats_io (priv, FALSE, written);
+      if ((written < 0) && (error != EAGAIN) && (error != EWOULDBLOCK))
+        return  HYSCAN_UART_STATUS_ERROR;
+      if (written <= 0)
+        continue;
+
+      /* Определяем полностью отправленные сообщения. */
+      offset += written;
+      while ((first < n_messages) && (offset >= messages[first]->size))
+        {
+          offset -= messages[first]->size;
+          first += 1;
+        }
+
+      *n_sent = first;
+    }
+
+  return HYSCAN_UART_STATUS_OK;
+}
+
 #elif defined (G_OS_WIN32)
 
 static HANDLE
@@ -451,10 +1095,34 @@ hyscan_uart_timeout_internal (HANDLE  fd,
   SetCommTimeouts (fd, &cto);
 }
 
+/* В Windows драйвер порта сообщает только о наличии ошибок, но не об их
+ * количестве. */
+static gboolean
+hyscan_uart_icount_internal (HANDLE  fd,
+                             gint64 *icount)
+{
+  return FALSE;
+}
+
+/* В Windows задержка приёма данных определяется таймаутами, которые
+ * устанавливаются в функции hyscan_uart_timeout_internal, а таймер
+ * задержки USB адаптеров настраивается только через их драйвер. */
+static HyScanUARTLatency
+hyscan_uart_latency_enable (HyScanUARTPrivate *priv)
+{
+  return HYSCAN_UART_LATENCY_NONE;
+}
+
+static void
+hyscan_uart_latency_restore (HyScanUARTPrivate *priv)
+{
+}
+
 static HyScanUARTStatus
 hyscan_uart_read_internal (HyScanUARTPrivate *priv,
                            guint8            *buffer,
-                           guint32           *size)
+                           guint32           *size,
+                           gint64            *time)
 {
   guint32 total = 0;
   guint32 remain = *size;
@@ -465,10 +1133,29 @@ hyscan_uart_read_internal (HyScanUARTPrivate *priv,
       DWORD readed;
 
       if (!ReadFile (priv->fd, buffer + total, remain, &readed, NULL))
-        return  HYSCAN_UART_STATUS_ERROR;
-      else if (readed == 0)
+        {
+          hyscan_uart_stats_io (priv, TRUE, -1);
+          return  HYSCAN_UART_STATUS_ERROR;
+        }
+
+      hyscan_uart_stats_io (priv, TRUE, readed);
+      if (readed == 0)
         return  HYSCAN_UART_STATUS_TIMEOUT;
 
+      hyscan_uart_capture_write (priv, buffer + total, readed);
+
+      /* Время начала приёма данных. Учитываем данные, оставшиеся в буфере. */
+      if ((time != NULL) && (total == 0))
+        {
+          COMSTAT comstat;
+          DWORD errors;
+
+          if (!ClearCommError (priv->fd, &errors, &comstat))
+            comstat.cbInQue = 0;
+
+          *time = hyscan_uart_rx_time (priv, readed + comstat.cbInQue);
+        }
+
       total += readed;
       remain -= readed;
       *size = total;
@@ -478,27 +1165,139 @@ hyscan_uart_read_internal (HyScanUARTPrivate *priv,
 }
 
 static HyScanUARTStatus
-hyscan_uart_write_internal (HyScanUARTPrivate *priv,
-                            guint8            *buffer,
-                            guint32           *size)
+hyscan_uart_read_some_internal (HyScanUARTPrivate *priv,
+                                guint8            *buffer,
+                                guint32           *size,
+                                gint64            *time)
 {
   guint32 total = 0;
   guint32 remain = *size;
+  COMSTAT comstat;
+  DWORD errors;
+  DWORD readed;
 
   *size = 0;
-  while (remain > 0)
-    {
-      DWORD written;
-      BOOL status;
 
-      status = WriteFile (priv->fd, buffer + total, MIN (priv->block_size, remain), &written, NULL);
-      total += written;
-      remain -= written;
-      *size = total;
+  /* Если в буфере порта нет данных, ожидаем первый байт с заданным
+   * таймаутом. Затем считываем данные, уже находящиеся в буфере. */
+  if (!ClearCommError (priv->fd, &errors, &comstat))
+    return  HYSCAN_UART_STATUS_ERROR;
 
-      if (!status)
+  if (comstat.cbInQue == 0)
+    {
+      if (!ReadFile (priv->fd, buffer, 1, &readed, NULL))
         {
-          if (GetLastError () == ERROR_COUNTER_TIMEOUT)
+          hyscan_uart_stats_io (priv, TRUE, -1);
+          return  HYSCAN_UART_STATUS_ERROR;
+        }
+
+      hyscan_uart_stats_io (priv, TRUE, readed);
+      if (readed == 0)
+        return  HYSCAN_UART_STATUS_TIMEOUT;
+
+      hyscan_uart_capture_write (priv, buffer, readed);
+
+      total = readed;
+      remain -= readed;
+
+      if (!ClearCommError (priv->fd, &errors, &comstat))
+        comstat.cbInQue = 0;
+    }
+
+  if ((remain > 0) && (comstat.cbInQue > 0))
+    {
+      if (!ReadFile (priv->fd, buffer + total, MIN (remain, comstat.cbInQue), &readed, NULL))
+        {
+          hyscan_uart_stats_io (priv, TRUE, -1);
+          return  HYSCAN_UART_STATUS_ERROR;
+        }
+
+      hyscan_uart_stats_io (priv, TRUE, readed);
+      hyscan_uart_capture_write (priv, buffer + total, readed);
+
+      total += readed;
+      comstat.cbInQue -= MIN (readed, comstat.cbInQue);
+    }
+
+  if (total == 0)
+    return  HYSCAN_UART_STATUS_TIMEOUT;
+
+  /* Время начала приёма данных. Учитываем данные, оставшиеся в буфере. */
+  if (time != NULL)
+    *time = hyscan_uart_rx_time (priv, total + comstat.cbInQue);
+
+  *size = total;
+
+  return HYSCAN_UART_STATUS_OK;
+}
+
+/* В Windows нет аналога функции poll для UART портов, поэтому наличие
+ * данных проверяется периодически с интервалом 1 мс. */
+static gint
+hyscan_uart_wait_internal (HANDLE   *fds,
+                           gboolean *ready,
+                           guint     n_fds,
+                           gdouble   timeout)
+{
+  gint64 end_time = g_get_monotonic_time () + (gint64)(G_USEC_PER_SEC * timeout);
+  gint n_ready;
+  guint i;
+
+  do
+    {
+      n_ready = 0;
+      for (i = 0; i < n_fds; i++)
+        {
+          COMSTAT comstat;
+          DWORD errors;
+
+          ready[i] = FALSE;
+          if (fds[i] == INVALID_HANDLE_VALUE)
+            continue;
+
+          if (!ClearCommError (fds[i], &errors, &comstat) || (comstat.cbInQue > 0))
+            {
+              ready[i] = TRUE;
+              n_ready += 1;
+            }
+        }
+
+      if (n_ready > 0)
+        break;
+
+      Sleep (1);
+    }
+  while (g_get_monotonic_time () < end_time);
+
+  return n_ready;
+}
+
+static HyScanUARTStatus
+hyscan_uart_write_internal (HyScanUARTPrivate *priv,
+                            guint8            *buffer,
+                            guint32           *size)
+{
+  guint32 total = 0;
+  guint32 remain = *size;
+
+  *size = 0;
+  while (remain > 0)
+    {
+      DWORD written;
+      DWORD error;
+      BOOL status;
+
+      /* Код ошибки сохраняется до учёта вызова в статистике. */
+      status = WriteFile (priv->fd, buffer + total, MIN (priv->block_size, remain), &written, NULL);
+      error = status ? ERROR_SUCCESS : GetLastError ();
+      hyscan_uart_stats_io (priv, FALSE, written);
+      total += written;
+      remain -= written;
+      *size = total;
+
+      if (!status)
+        {
+          if (error == ERROR_COUNTER_TIMEOUT)
             return  HYSCAN_UART_STATUS_TIMEOUT;
 
           return  HYSCAN_UART_STATUS_ERROR;
@@ -508,8 +1307,140 @@ hyscan_uart_write_internal (HyScanUARTPrivate *priv,
   return HYSCAN_UART_STATUS_OK;
 }
 
+static HyScanUARTStatus
+hyscan_uart_write_batch_internal (HyScanUARTPrivate  *priv,
+                                  HyScanUARTMessage **messages,
+                                  guint               n_messages,
+                                  guint              *n_sent)
+{
+  HyScanUARTStatus status;
+  GByteArray *batch;
+  guint32 written;
+  guint i;
+
+  /* Все сообщения объединяются и передаются одной операцией записи. */
+  batch = g_byte_array_new ();
+  for (i = 0; i < n_messages; i++)
+    g_byte_array_append (batch, messages[i]->data, messages[i]->size);
+
+  written = batch->len;
+  status = hyscan_uart_write_internal (priv, batch->data, &written);
+
+  /* Определяем полностью отправленные сообщения. */
+  for (*n_sent = 0; *n_sent < n_messages; *n_sent += 1)
+    {
+      if (written < messages[*n_sent]->size)
+        break;
+
+      written -= messages[*n_sent]->size;
+    }
+
+  g_byte_array_free (batch, TRUE);
+
+  return status;
+}
+
 #endif
 
+/* Функция завершает отправку сообщения. */
+static void
+hyscan_uart_message_complete (HyScanUART        *uart,
+                              HyScanUARTMessage *message,
+                              HyScanUARTStatus   status)
+{
+  if (message->callback != NULL)
+    message->callback (uart, status, message->user_data);
+
+  g_free (message->data);
+  g_slice_free (HyScanUARTMessage, message);
+}
+
+/* Поток асинхронной отправки данных. */
+static gpointer
+hyscan_uart_writer (gpointer data)
+{
+  HyScanUART *uart = data;
+  HyScanUARTPrivate *priv = uart->priv;
+  HyScanUARTMessage *messages[WRITE_BATCH_SIZE];
+
+  g_mutex_lock (&priv->write_lock);
+
+  while (!priv->write_shutdown)
+    {
+      HyScanUARTStatus status;
+      guint n_messages = 0;
+      guint n_sent;
+      guint i;
+
+      if (g_queue_is_empty (&priv->write_queue))
+        {
+          g_cond_wait (&priv->write_cond, &priv->write_lock);
+          continue;
+        }
+
+      /* Забираем все накопившиеся сообщения. */
+      while ((n_messages < WRITE_BATCH_SIZE) && !g_queue_is_empty (&priv->write_queue))
+        messages[n_messages++] = g_queue_pop_head (&priv->write_queue);
+
+      priv->write_active = n_messages;
+      g_mutex_unlock (&priv->write_lock);
+
+      g_mutex_lock (&priv->io_lock);
+      status = hyscan_uart_write_batch_internal (priv, messages, n_messages, &n_sent);
+      g_mutex_unlock (&priv->io_lock);
+
+      hyscan_uart_stats_complete (priv, FALSE, status, n_sent, n_messages);
+
+      /* Сообщения, отправленные до таймаута или ошибки, считаются
+       * успешно отправленными. */
+      for (i = 0; i < n_messages; i++)
+        hyscan_uart_message_complete (uart, messages[i], (i < n_sent) ? HYSCAN_UART_STATUS_OK : status);
+
+      g_mutex_lock (&priv->write_lock);
+      priv->write_active = 0;
+      g_cond_broadcast (&priv->write_cond);
+    }
+
+  g_mutex_unlock (&priv->write_lock);
+
+  return NULL;
+}
+
+/* Функция останавливает поток асинхронной отправки данных. После этого
+ * новые сообщения в очередь не принимаются, а оставшиеся в ней сообщения
+ * завершаются с ошибкой. */
+static void
+hyscan_uart_writer_stop (HyScanUART *uart)
+{
+  HyScanUARTPrivate *priv = uart->priv;
+  HyScanUARTMessage *message;
+  GQueue pending = G_QUEUE_INIT;
+  GThread *writer;
+
+  g_mutex_lock (&priv->write_lock);
+  writer = priv->writer;
+  priv->write_closed = TRUE;
+  priv->write_shutdown = TRUE;
+  g_cond_broadcast (&priv->write_cond);
+  g_mutex_unlock (&priv->write_lock);
+
+  if (writer != NULL)
+    g_thread_join (writer);
+
+  g_mutex_lock (&priv->write_lock);
+  priv->writer = NULL;
+  priv->write_shutdown = FALSE;
+  while ((message = g_queue_pop_head (&priv->write_queue)) != NULL)
+    g_queue_push_tail (&pending, message);
+  g_cond_broadcast (&priv->write_cond);
+  g_mutex_unlock (&priv->write_lock);
+
+  /* Функции обратного вызова вызываются без блокировки, так как они могут
+   * обращаться к очереди отправки. */
+  while ((message = g_queue_pop_head (&pending)) != NULL)
+    hyscan_uart_message_complete (uart, message, HYSCAN_UART_STATUS_ERROR);
+}
+
 /**
  * hyscan_uart_new:
  *
@@ -546,11 +1477,27 @@ hyscan_uart_open (HyScanUART     *uart,
   priv = uart->priv;
 
   hyscan_uart_close (uart);
+  if (priv->fd != INVALID_HANDLE_VALUE)
+    return FALSE;
+
   priv->fd = hyscan_uart_open_internal (path, mode);
   if (priv->fd != INVALID_HANDLE_VALUE)
     {
+      guint32 speed = hyscan_uart_get_speed (mode);
+
       priv->path = g_strdup (path);
       priv->mode = mode;
+      priv->byte_time = (speed > 0) ? (10.0 * G_USEC_PER_SEC) / (8.0 * speed) : 0.0;
+
+      if (priv->low_latency)
+        priv->latency = hyscan_uart_latency_enable (priv);
+
+      hyscan_uart_reset_stats (uart);
+      hyscan_uart_capture_mode (priv);
+
+      g_mutex_lock (&priv->write_lock);
+      priv->write_closed = FALSE;
+      g_mutex_unlock (&priv->write_lock);
     }
 
   hyscan_uart_timeout (uart, DEFAULT_TIMEOUT, DEFAULT_TIMEOUT);
@@ -562,12 +1509,15 @@ hyscan_uart_open (HyScanUART     *uart,
  * hyscan_uart_close:
  * @uart: указатель на #HyScanUART
  *
- * Функция закрывает UART порт.
+ * Функция закрывает UART порт. Порт нельзя закрыть из функции обратного
+ * вызова #HyScanUARTWriteFunc, так как при закрытии ожидается завершение
+ * потока отправки данных. Такой вызов игнорируется.
  */
 void
 hyscan_uart_close (HyScanUART *uart)
 {
   HyScanUARTPrivate *priv;
+  gboolean in_writer;
 
   g_return_if_fail (HYSCAN_IS_UART (uart));
 
@@ -576,9 +1526,22 @@ hyscan_uart_close (HyScanUART *uart)
   if (priv->fd == INVALID_HANDLE_VALUE)
     return;
 
+  g_mutex_lock (&priv->write_lock);
+  in_writer = (priv->writer == g_thread_self ());
+  g_mutex_unlock (&priv->write_lock);
+
+  if (in_writer)
+    {
+      g_warning ("HyScanUART: can't close port from write callback");
+      return;
+    }
+
+  hyscan_uart_writer_stop (uart);
+  hyscan_uart_latency_restore (priv);
   hyscan_uart_close_internal (priv->fd);
 
   g_clear_pointer (&priv->path, g_free);
+  priv->latency = HYSCAN_UART_LATENCY_NONE;
   priv->mode = HYSCAN_UART_MODE_DISABLED;
   priv->fd = INVALID_HANDLE_VALUE;
 }
@@ -647,6 +1610,61 @@ hyscan_uart_timeout (HyScanUART *uart,
   hyscan_uart_timeout_internal (priv->fd, rx_timeout, tx_timeout);
 }
 
+/**
+ * hyscan_uart_set_low_latency:
+ * @uart: указатель на #HyScanUART
+ * @enable: включить или выключить режим низкой задержки
+ *
+ * Функция включает или выключает режим низкой задержки приёма данных.
+ * Если порт открыт, настройки применяются сразу, иначе при открытии порта.
+ * При выключении режима восстанавливаются исходные настройки порта.
+ *
+ * Изменение таймера задержки USB адаптера может требовать прав
+ * администратора. Если какую-либо настройку применить не удалось,
+ * соответствующий флаг в возвращаемом значении будет сброшен.
+ *
+ * Returns: Набор применённых настроек.
+ */
+HyScanUARTLatency
+hyscan_uart_set_low_latency (HyScanUART *uart,
+                             gboolean    enable)
+{
+  HyScanUARTPrivate *priv;
+
+  g_return_val_if_fail (HYSCAN_IS_UART (uart), HYSCAN_UART_LATENCY_NONE);
+
+  priv = uart->priv;
+
+  priv->low_latency = enable;
+
+  if (priv->fd == INVALID_HANDLE_VALUE)
+    return HYSCAN_UART_LATENCY_NONE;
+
+  if (priv->latency != HYSCAN_UART_LATENCY_NONE)
+    hyscan_uart_latency_restore (priv);
+
+  priv->latency = enable ? hyscan_uart_latency_enable (priv) : HYSCAN_UART_LATENCY_NONE;
+
+  return priv->latency;
+}
+
+/**
+ * hyscan_uart_get_low_latency:
+ * @uart: указатель на #HyScanUART
+ *
+ * Функция возвращает набор настроек режима низкой задержки, применённых
+ * к открытому порту.
+ *
+ * Returns: Набор применённых настроек.
+ */
+HyScanUARTLatency
+hyscan_uart_get_low_latency (HyScanUART *uart)
+{
+  g_return_val_if_fail (HYSCAN_IS_UART (uart), HYSCAN_UART_LATENCY_NONE);
+
+  return uart->priv->latency;
+}
+
 /**
  * hyscan_uart_read:
  * @uart: указатель на #HyScanUART
@@ -674,7 +1692,49 @@ hyscan_uart_read (HyScanUART   *uart,
   hyscan_buffer_set (buffer, HYSCAN_DATA_BLOB, NULL, size);
   data = hyscan_buffer_get (buffer, NULL, &size);
 
-  status = hyscan_uart_read_internal (uart->priv, data, &size);
+  status = hyscan_uart_read_internal (uart->priv, data, &size, NULL);
+  hyscan_uart_stats_complete (uart->priv, TRUE, status, size, hyscan_buffer_get_data_size (buffer));
+  if (status != HYSCAN_UART_STATUS_ERROR)
+    hyscan_buffer_set_data_size (buffer, size);
+
+  return status;
+}
+
+/**
+ * hyscan_uart_read_timed:
+ * @uart: указатель на #HyScanUART
+ * @buffer: буфер для принятых данных
+ * @size: размер принимаемых данных
+ * @time: (out): время начала приёма данных, мкс
+ *
+ * Функция аналогична #hyscan_uart_read, но дополнительно возвращает оценку
+ * времени начала приёма первого байта данных. Время фиксируется сразу после
+ * считывания первого фрагмента данных и корректируется на время передачи
+ * байт, находившихся к этому моменту в буфере порта.
+ *
+ * Если данные не были приняты, в @time записывается 0.
+ *
+ * Returns: Статус приёма данных.
+ */
+HyScanUARTStatus
+hyscan_uart_read_timed (HyScanUART   *uart,
+                        HyScanBuffer *buffer,
+                        guint32       size,
+                        gint64       *time)
+{
+  HyScanUARTStatus status;
+  guint8 *data;
+
+  g_return_val_if_fail (HYSCAN_IS_UART (uart), FALSE);
+  g_return_val_if_fail (time != NULL, FALSE);
+
+  *time = 0;
+
+  hyscan_buffer_set (buffer, HYSCAN_DATA_BLOB, NULL, size);
+  data = hyscan_buffer_get (buffer, NULL, &size);
+
+  status = hyscan_uart_read_internal (uart->priv, data, &size, time);
+  hyscan_uart_stats_complete (uart->priv, TRUE, status, size, hyscan_buffer_get_data_size (buffer));
   if (status != HYSCAN_UART_STATUS_ERROR)
     hyscan_buffer_set_data_size (buffer, size);
 
@@ -694,11 +1754,122 @@ HyScanUARTStatus
 hyscan_uart_read_byte (HyScanUART *uart,
                        guint8     *data)
 {
+  HyScanUARTStatus status;
   guint32 size = 1;
 
   g_return_val_if_fail (HYSCAN_IS_UART (uart), FALSE);
 
-  return hyscan_uart_read_internal (uart->priv, data, &size);
+  status = hyscan_uart_read_internal (uart->priv, data, &size, NULL);
+  hyscan_uart_stats_complete (uart->priv, TRUE, status, size, 1);
+
+  return status;
+}
+
+/**
+ * hyscan_uart_read_byte_timed:
+ * @uart: указатель на #HyScanUART
+ * @data: (out): буфер для принятых данных
+ * @time: (out): время начала приёма байта, мкс
+ *
+ * Функция считывает один байт из UART порта и возвращает оценку времени
+ * начала его приёма. Функция предназначена для определения времени начала
+ * кадра по его первому байту, например по символу '$' в NMEA сообщениях.
+ *
+ * Returns: Статус приёма данных.
+ */
+HyScanUARTStatus
+hyscan_uart_read_byte_timed (HyScanUART *uart,
+                             guint8     *data,
+                             gint64     *time)
+{
+  HyScanUARTStatus status;
+  guint32 size = 1;
+
+  g_return_val_if_fail (HYSCAN_IS_UART (uart), FALSE);
+  g_return_val_if_fail (time != NULL, FALSE);
+
+  *time = 0;
+
+  status = hyscan_uart_read_internal (uart->priv, data, &size, time);
+  hyscan_uart_stats_complete (uart->priv, TRUE, status, size, 1);
+
+  return status;
+}
+
+/**
+ * hyscan_uart_read_some:
+ * @uart: указатель на #HyScanUART
+ * @buffer: буфер для принятых данных
+ * @size: максимальный размер принимаемых данных
+ * @time: (out) (optional): время начала приёма данных, мкс
+ *
+ * Функция считывает данные, находящиеся в буфере UART порта, но не более
+ * @size байт. Если данных в буфере нет, функция ожидает поступления первого
+ * байта в течение таймаута приёма. В отличие от #hyscan_uart_read, функция
+ * не ожидает приёма всех @size байт, а возвращает данные, принятые на момент
+ * вызова, одним системным вызовом.
+ *
+ * Returns: Статус приёма данных.
+ */
+HyScanUARTStatus
+hyscan_uart_read_some (HyScanUART   *uart,
+                       HyScanBuffer *buffer,
+                       guint32       size,
+                       gint64       *time)
+{
+  HyScanUARTStatus status;
+  guint8 *data;
+
+  g_return_val_if_fail (HYSCAN_IS_UART (uart), FALSE);
+
+  if (time != NULL)
+    *time = 0;
+
+  hyscan_buffer_set (buffer, HYSCAN_DATA_BLOB, NULL, size);
+  data = hyscan_buffer_get (buffer, NULL, &size);
+
+  status = hyscan_uart_read_some_internal (uart->priv, data, &size, time);
+  hyscan_uart_stats_complete (uart->priv, TRUE, status, size, size);
+  hyscan_buffer_set_data_size (buffer, size);
+
+  return status;
+}
+
+/**
+ * hyscan_uart_wait:
+ * @uarts: (array length=n_uarts): список UART портов
+ * @ready: (array length=n_uarts) (out): признаки наличия данных в портах
+ * @n_uarts: число UART портов
+ * @timeout: таймаут ожидания, с
+ *
+ * Функция ожидает поступления данных в любой из UART портов в течение
+ * @timeout секунд. Для каждого порта, в который поступили данные или при
+ * работе с которым возникла ошибка, в массиве @ready устанавливается
+ * признак готовности. Закрытые порты игнорируются.
+ *
+ * Returns: Число портов готовых к чтению, 0 - по таймауту, -1 - при ошибке.
+ */
+gint
+hyscan_uart_wait (HyScanUART **uarts,
+                  gboolean    *ready,
+                  guint        n_uarts,
+                  gdouble      timeout)
+{
+  HANDLE *fds;
+  gint n_ready;
+  guint i;
+
+  g_return_val_if_fail ((uarts != NULL) && (ready != NULL), -1);
+
+  fds = g_new (HANDLE, n_uarts);
+  for (i = 0; i < n_uarts; i++)
+    fds[i] = HYSCAN_IS_UART (uarts[i]) ? uarts[i]->priv->fd : INVALID_HANDLE_VALUE;
+
+  n_ready = hyscan_uart_wait_internal (fds, ready, n_uarts, MAX (timeout, 0.0));
+
+  g_free (fds);
+
+  return n_ready;
 }
 
 /**
@@ -719,18 +1890,116 @@ hyscan_uart_write (HyScanUART   *uart,
                    guint32      *size)
 {
   HyScanUARTStatus status;
+  guint32 requested;
   guint32 written;
   guint8 *data;
 
   g_return_val_if_fail (HYSCAN_IS_UART (uart), FALSE);
 
-  data = hyscan_buffer_get (buffer, NULL, &written);
+  data = hyscan_buffer_get (buffer, NULL, &requested);
+  written = requested;
+
+  g_mutex_lock (&uart->priv->io_lock);
   status = hyscan_uart_write_internal (uart->priv, data, &written);
+  g_mutex_unlock (&uart->priv->io_lock);
+
+  hyscan_uart_stats_complete (uart->priv, FALSE, status, written, requested);
+
   (size != NULL) ? *size = written : 0;
 
   return status;
 }
 
+/**
+ * hyscan_uart_write_async:
+ * @uart: указатель на #HyScanUART
+ * @buffer: данные для отправки
+ * @callback: (nullable): функция обратного вызова
+ * @user_data: пользовательские данные для функции обратного вызова
+ *
+ * Функция ставит данные в очередь отправки и сразу возвращает управление.
+ * Данные копируются, поэтому буфер можно использовать повторно сразу после
+ * вызова функции.
+ *
+ * По завершении отправки вызывается функция @callback со статусом отправки.
+ * Функция вызывается из потока отправки данных. Если порт будет закрыт до
+ * отправки данных, функция будет вызвана со статусом
+ * #HYSCAN_UART_STATUS_ERROR. Во время закрытия порта и после него данные в
+ * очередь не принимаются.
+ *
+ * Returns: %TRUE если данные поставлены в очередь, иначе %FALSE.
+ */
+gboolean
+hyscan_uart_write_async (HyScanUART          *uart,
+                         HyScanBuffer        *buffer,
+                         HyScanUARTWriteFunc  callback,
+                         gpointer             user_data)
+{
+  HyScanUARTPrivate *priv;
+  HyScanUARTMessage *message;
+  guint32 size;
+  guint8 *data;
+
+  g_return_val_if_fail (HYSCAN_IS_UART (uart), FALSE);
+
+  priv = uart->priv;
+
+  data = hyscan_buffer_get (buffer, NULL, &size);
+  if ((data == NULL) || (size == 0))
+    return FALSE;
+
+  message = g_slice_new (HyScanUARTMessage);
+  message->data = g_malloc (size);
+  message->size = size;
+  message->callback = callback;
+  message->user_data = user_data;
+  memcpy (message->data, data, size);
+
+  g_mutex_lock (&priv->write_lock);
+  if (priv->write_closed)
+    {
+      g_mutex_unlock (&priv->write_lock);
+
+      g_free (message->data);
+      g_slice_free (HyScanUARTMessage, message);
+
+      return FALSE;
+    }
+
+  if (priv->writer == NULL)
+    priv->writer = g_thread_new ("uart-writer", hyscan_uart_writer, uart);
+  g_queue_push_tail (&priv->write_queue, message);
+  g_cond_broadcast (&priv->write_cond);
+  g_mutex_unlock (&priv->write_lock);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_uart_write_flush:
+ * @uart: указатель на #HyScanUART
+ *
+ * Функция ожидает завершения отправки всех сообщений из очереди. Функцию
+ * нельзя вызывать из функции обратного вызова #HyScanUARTWriteFunc.
+ */
+void
+hyscan_uart_write_flush (HyScanUART *uart)
+{
+  HyScanUARTPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_UART (uart));
+
+  priv = uart->priv;
+
+  g_mutex_lock (&priv->write_lock);
+  while ((priv->writer != NULL) &&
+         (!g_queue_is_empty (&priv->write_queue) || (priv->write_active > 0)))
+    {
+      g_cond_wait (&priv->write_cond, &priv->write_lock);
+    }
+  g_mutex_unlock (&priv->write_lock);
+}
+
 /**
  * hyscan_uart_write_byte:
  * @uart: указатель на #HyScanUART
@@ -746,26 +2015,290 @@ hyscan_uart_write_byte (HyScanUART *uart,
 {
   guint32 written = 1;
 
+  HyScanUARTStatus status;
+
   g_return_val_if_fail (HYSCAN_IS_UART (uart), FALSE);
 
-  return hyscan_uart_write_internal (uart->priv, &data, &written);
+  g_mutex_lock (&uart->priv->io_lock);
+  status = hyscan_uart_write_internal (uart->priv, &data, &written);
+  g_mutex_unlock (&uart->priv->io_lock);
+
+  hyscan_uart_stats_complete (uart->priv, FALSE, status, written, 1);
+
+  return status;
 }
 
 /**
- * hyscan_uart_list:
+ * hyscan_uart_get_stats:
+ * @uart: указатель на #HyScanUART
+ * @stats: (out): статистика обмена данными
  *
- * Функция возвращает список UART устройств.
+ * Функция возвращает статистику обмена данными, накопленную с момента
+ * открытия порта или последнего сброса статистики. Счётчики ошибок драйвера
+ * порта доступны только в Linux и только для драйверов, которые их
+ * поддерживают.
  *
- * Память выделенная под список должна быть освобождена после использования
- * функцией #g_list_free_full. Для освобождения элементов списка необходимо
- * использовать функцию #hyscan_uart_device_free.
+ * Загрузка линии вычисляется как отношение числа принятых или отправленных
+ * байт к числу байт, которое может быть передано за это же время с текущей
+ * скоростью обмена. Загрузка, близкая к единице, означает, что поток данных
+ * ограничен скоростью обмена порта.
  *
- * Returns: (element-type HyScanUARTDevice) (transfer full): Список UART
- * устройств или NULL.
+ * Returns: %TRUE если порт открыт, иначе %FALSE.
+ */
+gboolean
+hyscan_uart_get_stats (HyScanUART      *uart,
+                       HyScanUARTStats *stats)
+{
+  HyScanUARTPrivate *priv;
+  gint64 icount[5];
+
+  g_return_val_if_fail (HYSCAN_IS_UART (uart), FALSE);
+  g_return_val_if_fail (stats != NULL, FALSE);
+
+  priv = uart->priv;
+
+  memset (stats, 0, sizeof (HyScanUARTStats));
+
+  if (priv->fd == INVALID_HANDLE_VALUE)
+    return FALSE;
+
+  g_mutex_lock (&priv->stats_lock);
+
+  *stats = priv->stats;
+  stats->elapsed = (gdouble)(g_get_monotonic_time () - priv->stats_start) / G_USEC_PER_SEC;
+
+  if (hyscan_uart_icount_internal (priv->fd, icount))
+    {
+      stats->overrun = icount[0] - priv->icount[0];
+      stats->buf_overrun = icount[1] - priv->icount[1];
+      stats->frame = icount[2] - priv->icount[2];
+      stats->parity = icount[3] - priv->icount[3];
+      stats->brk = icount[4] - priv->icount[4];
+    }
+
+  g_mutex_unlock (&priv->stats_lock);
+
+  if ((stats->elapsed > 0.0) && (priv->byte_time > 0.0))
+    {
+      gdouble capacity = stats->elapsed * G_USEC_PER_SEC / priv->byte_time;
+
+      stats->rx_load = stats->rx_bytes / capacity;
+      stats->tx_load = stats->tx_bytes / capacity;
+    }
+
+  return TRUE;
+}
+
+/**
+ * hyscan_uart_reset_stats:
+ * @uart: указатель на #HyScanUART
+ *
+ * Функция сбрасывает статистику обмена данными.
+ */
+void
+hyscan_uart_reset_stats (HyScanUART *uart)
+{
+  HyScanUARTPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_UART (uart));
+
+  priv = uart->priv;
+
+  g_mutex_lock (&priv->stats_lock);
+
+  memset (&priv->stats, 0, sizeof (HyScanUARTStats));
+  priv->stats_start = g_get_monotonic_time ();
+  priv->rx_last = 0;
+
+  if ((priv->fd == INVALID_HANDLE_VALUE) ||
+      !hyscan_uart_icount_internal (priv->fd, priv->icount))
+    {
+      memset (priv->icount, 0, sizeof (priv->icount));
+    }
+
+  g_mutex_unlock (&priv->stats_lock);
+}
+
+/**
+ * hyscan_uart_capture_start:
+ * @uart: указатель на #HyScanUART
+ * @file_name: имя файла для записи
+ *
+ * Функция включает запись всех принятых через порт данных в файл. Если
+ * файл существует, он будет перезаписан. Если запись уже была включена,
+ * предыдущий файл закрывается. Запись можно включить до открытия порта.
+ * Запись продолжается при повторном открытии порта до вызова функции
+ * #hyscan_uart_capture_stop.
+ *
+ * Returns: %TRUE если запись включена, иначе %FALSE.
+ */
+gboolean
+hyscan_uart_capture_start (HyScanUART  *uart,
+                           const gchar *file_name)
+{
+  HyScanUARTPrivate *priv;
+  guint32 header[2];
+  FILE *capture;
+
+  g_return_val_if_fail (HYSCAN_IS_UART (uart), FALSE);
+  g_return_val_if_fail (file_name != NULL, FALSE);
+
+  priv = uart->priv;
+
+  hyscan_uart_capture_stop (uart);
+
+  capture = g_fopen (file_name, "wb");
+  if (capture == NULL)
+    {
+      g_warning ("HyScanUART: can't create capture file %s", file_name);
+      return FALSE;
+    }
+
+  header[0] = GUINT32_TO_LE (HYSCAN_UART_CAPTURE_VERSION);
+  header[1] = GUINT32_TO_LE (priv->mode);
+
+  if ((fwrite (HYSCAN_UART_CAPTURE_MAGIC, 4, 1, capture) != 1) ||
+      (fwrite (header, sizeof (header), 1, capture) != 1))
+    {
+      g_warning ("HyScanUART: can't write capture file %s", file_name);
+      fclose (capture);
+      return FALSE;
+    }
+
+  g_mutex_lock (&priv->capture_lock);
+  priv->capture = capture;
+  g_mutex_unlock (&priv->capture_lock);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_uart_capture_stop:
+ * @uart: указатель на #HyScanUART
+ *
+ * Функция отключает запись принятых данных и закрывает файл.
  */
+void
+hyscan_uart_capture_stop (HyScanUART *uart)
+{
+  HyScanUARTPrivate *priv;
+
+  g_return_if_fail (HYSCAN_IS_UART (uart));
+
+  priv = uart->priv;
+
+  g_mutex_lock (&priv->capture_lock);
+
+  if (priv->capture != NULL)
+    fclose (priv->capture);
+  priv->capture = NULL;
+
+  g_mutex_unlock (&priv->capture_lock);
+}
+
 #if defined (G_OS_UNIX)
-GList *
-hyscan_uart_list (void)
+
+/* Префиксы имён UART устройств и соответствующие им префиксы названий портов. */
+static const gchar *hyscan_uart_prefixes[][2] =
+{
+  { "ttyS",   "COM" },
+  { "ttyUSB", "USBCOM" },
+  { "ttyACM", "ACMCOM" },
+  { "ttyAMA", "AMACOM" }
+};
+
+/* Функция создаёт описание UART порта по имени его устройства. */
+static HyScanUARTDevice *
+hyscan_uart_device_new (const gchar *device)
+{
+  HyScanUARTDevice *port;
+  const gchar *index;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (hyscan_uart_prefixes); i++)
+    {
+      if (!g_str_has_prefix (device, hyscan_uart_prefixes[i][0]))
+        continue;
+
+      index = device + strlen (hyscan_uart_prefixes[i][0]);
+      if (!g_ascii_isdigit (*index))
+        continue;
+
+      port = g_slice_new (HyScanUARTDevice);
+      port->name = g_strdup_printf ("%s%d", hyscan_uart_prefixes[i][1], (gint)g_ascii_strtoll (index, NULL, 10) + 1);
+      port->path = g_strdup_printf ("/dev/%s", device);
+
+      return port;
+    }
+
+  return NULL;
+}
+
+#if defined (__linux__)
+
+/* Функция возвращает список UART устройств по информации из sysfs.
+ * Устройства при этом не открываются. Если sysfs недоступна, функция
+ * возвращает FALSE. */
+static gboolean
+hyscan_uart_list_sysfs (GList **list)
+{
+  GDir *dir;
+  const gchar *device;
+
+  dir = g_dir_open ("/sys/class/tty", 0, NULL);
+  if (dir == NULL)
+    return FALSE;
+
+  while ((device = g_dir_read_name (dir)) != NULL)
+    {
+      HyScanUARTDevice *port;
+      gchar *sys_path;
+      gboolean exists;
+
+      port = hyscan_uart_device_new (device);
+      if (port == NULL)
+        continue;
+
+      /* У виртуальных терминалов нет физического устройства. */
+      sys_path = g_build_filename ("/sys/class/tty", device, "device", NULL);
+      exists = g_file_test (sys_path, G_FILE_TEST_EXISTS);
+      g_free (sys_path);
+
+      /* Для ttyS драйвер создаёт устройства под все возможные порты,
+       * отсутствующие порты имеют тип 0 (PORT_UNKNOWN). */
+      if (exists && g_str_has_prefix (device, "ttyS"))
+        {
+          gchar *contents = NULL;
+
+          sys_path = g_build_filename ("/sys/class/tty", device, "type", NULL);
+          if (g_file_get_contents (sys_path, &contents, NULL, NULL))
+            exists = (g_ascii_strtoll (contents, NULL, 10) != 0);
+
+          g_free (contents);
+          g_free (sys_path);
+        }
+
+      /* Файл устройства должен существовать. */
+      if (exists)
+        exists = g_file_test (port->path, G_FILE_TEST_EXISTS);
+
+      if (exists)
+        *list = g_list_prepend (*list, port);
+      else
+        hyscan_uart_device_free (port);
+    }
+
+  g_dir_close (dir);
+
+  return TRUE;
+}
+
+#endif
+
+/* Функция возвращает список UART устройств, проверяя каждое
+ * устройство из каталога /dev. */
+static GList *
+hyscan_uart_list_dev (void)
 {
   GList *list = NULL;
 
@@ -780,56 +2313,64 @@ hyscan_uart_list (void)
   while ((device = g_dir_read_name (dir)) != NULL)
     {
       struct termios options;
-      gboolean usb_serial;
-      gboolean serial;
-      gchar *path;
+      HyScanUARTDevice *port;
       int fd;
 
-      /* Пропускаем элементы "." и ".." */
-      if (device[0] =='.' && device[1] == 0)
-        continue;
-      if (device[0] =='.' && device[1] =='.' && device[2] == 0)
-        continue;
-
-      /* Пропускаем все устройства, имена которых не начинаются на ttyS или ttyUSB. */
-      serial = g_str_has_prefix (device, "ttyS");
-      usb_serial = g_str_has_prefix (device, "ttyUSB");
-      if (!serial && !usb_serial)
+      /* Пропускаем все устройства, имена которых не соответствуют UART портам. */
+      port = hyscan_uart_device_new (device);
+      if (port == NULL)
         continue;
 
-      /* Открываем устройство и проверяем его тип. */
-      path = g_strdup_printf ("/dev/%s", device);
-      fd = open (path, O_RDWR | O_NONBLOCK | O_NOCTTY);
-      g_free (path);
-
-      /* Если не смогли открыть файл, возможно у нас нет на это прав. */
-      if (fd < 0)
-        continue;
+      /* Открываем устройство и проверяем его тип. Если не смогли
+       * открыть файл, возможно у нас нет на это прав. */
+      fd = open (port->path, O_RDWR | O_NONBLOCK | O_NOCTTY);
+      if ((fd >= 0) && (tcgetattr (fd, &options) == 0))
+        list = g_list_prepend (list, port);
+      else
+        hyscan_uart_device_free (port);
 
-      /* Проверяем тип устройства. */
-      if (tcgetattr (fd, &options) == 0)
-        {
-          HyScanUARTDevice *port;
-          gint index;
+      if (fd >= 0)
+        close (fd);
+    }
 
-          if (serial)
-            index = g_ascii_strtoll(device + 4, NULL, 10);
-          else
-            index = g_ascii_strtoll(device + 6, NULL, 10);
+  g_dir_close (dir);
 
-          port = g_slice_new (HyScanUARTDevice);
-          port->name = g_strdup_printf ("%s%d", serial ? "COM" : "USBCOM", index + 1);
-          port->path = g_strdup_printf ("/dev/%s", device);
+  return list;
+}
 
-          list = g_list_prepend (list, port);
-        }
+#endif
 
-      close (fd);
-    }
+/**
+ * hyscan_uart_list:
+ *
+ * Функция возвращает список UART устройств.
+ *
+ * В Linux список формируется по информации из sysfs (/sys/class/tty) без
+ * открытия устройств. Учитываются устройства ttyS, ttyUSB, ttyACM и ttyAMA.
+ * Если sysfs недоступна, проверяется каждое устройство из каталога /dev.
+ *
+ * Для отслеживания подключения и отключения UART портов без повторного
+ * формирования списка предназначен класс #HyScanUARTMonitor.
+ *
+ * Память выделенная под список должна быть освобождена после использования
+ * функцией #g_list_free_full. Для освобождения элементов списка необходимо
+ * использовать функцию #hyscan_uart_device_free.
+ *
+ * Returns: (element-type HyScanUARTDevice) (transfer full): Список UART
+ * устройств или NULL.
+ */
+#if defined (G_OS_UNIX)
+GList *
+hyscan_uart_list (void)
+{
+  GList *list = NULL;
 
-  g_dir_close (dir);
+#if defined (__linux__)
+  if (hyscan_uart_list_sysfs (&list))
+    return list;
+#endif
 
-  return list;
+  return hyscan_uart_list_dev ();
 }
 
 #elif defined (G_OS_WIN32)
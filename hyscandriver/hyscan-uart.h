@@ -39,6 +39,15 @@
 
 G_BEGIN_DECLS
 
+#define HYSCAN_TYPE_UART_DEVICE      (hyscan_uart_device_get_type ())
+
+#define HYSCAN_UART_STATS_HISTOGRAM_SIZE       24
+
+#define HYSCAN_UART_CAPTURE_MAGIC              "HSUC"
+#define HYSCAN_UART_CAPTURE_VERSION            2
+#define HYSCAN_UART_CAPTURE_HEADER_SIZE        12
+#define HYSCAN_UART_CAPTURE_RECORD_SIZE        12
+
 #define HYSCAN_TYPE_UART             (hyscan_uart_get_type ())
 #define HYSCAN_UART(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_UART, HyScanUART))
 #define HYSCAN_IS_UART(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_UART))
@@ -50,6 +59,7 @@ typedef struct _HyScanUART HyScanUART;
 typedef struct _HyScanUARTPrivate HyScanUARTPrivate;
 typedef struct _HyScanUARTClass HyScanUARTClass;
 typedef struct _HyScanUARTDevice HyScanUARTDevice;
+typedef struct _HyScanUARTStats HyScanUARTStats;
 
 struct _HyScanUART
 {
@@ -109,6 +119,21 @@ typedef enum
   HYSCAN_UART_STATUS_ERROR
 } HyScanUARTStatus;
 
+/**
+ * HyScanUARTLatency:
+ * @HYSCAN_UART_LATENCY_NONE: Настройки не применены.
+ * @HYSCAN_UART_LATENCY_DRIVER: Установлен флаг низкой задержки драйвера порта.
+ * @HYSCAN_UART_LATENCY_TIMER: Установлен минимальный таймер задержки USB адаптера.
+ *
+ * Настройки режима низкой задержки UART порта.
+ */
+typedef enum
+{
+  HYSCAN_UART_LATENCY_NONE             = 0,
+  HYSCAN_UART_LATENCY_DRIVER           = (1 << 0),
+  HYSCAN_UART_LATENCY_TIMER            = (1 << 1)
+} HyScanUARTLatency;
+
 /**
  * HyScanUARTDevice:
  * @name: название UART порта
@@ -122,6 +147,63 @@ struct _HyScanUARTDevice
   const gchar         *path;
 };
 
+/**
+ * HyScanUARTStats:
+ * @elapsed: время накопления статистики, с
+ * @rx_bytes: число принятых байт
+ * @tx_bytes: число отправленных байт
+ * @rx_calls: число системных вызовов чтения данных
+ * @tx_calls: число системных вызовов записи данных
+ * @rx_timeouts: число операций приёма, завершившихся по таймауту
+ * @tx_timeouts: число операций отправки, завершившихся по таймауту
+ * @rx_partial: число операций приёма, принявших только часть данных
+ * @tx_partial: число операций отправки, отправивших только часть данных
+ * @overrun: число переполнений аппаратного буфера приёма
+ * @buf_overrun: число переполнений буфера драйвера
+ * @frame: число ошибок кадра
+ * @parity: число ошибок чётности
+ * @brk: число принятых сигналов BREAK
+ * @rx_load: загрузка линии приёма, 0 - 1
+ * @tx_load: загрузка линии отправки, 0 - 1
+ * @histogram: гистограмма интервалов между поступлениями данных,
+ *   i-й элемент соответствует интервалу от 2^i до 2^(i+1) мкс
+ *
+ * Статистика обмена данными через UART порт.
+ */
+struct _HyScanUARTStats
+{
+  gdouble              elapsed;
+  guint64              rx_bytes;
+  guint64              tx_bytes;
+  guint64              rx_calls;
+  guint64              tx_calls;
+  guint64              rx_timeouts;
+  guint64              tx_timeouts;
+  guint64              rx_partial;
+  guint64              tx_partial;
+  guint64              overrun;
+  guint64              buf_overrun;
+  guint64              frame;
+  guint64              parity;
+  guint64              brk;
+  gdouble              rx_load;
+  gdouble              tx_load;
+  guint64              histogram[HYSCAN_UART_STATS_HISTOGRAM_SIZE];
+};
+
+/**
+ * HyScanUARTWriteFunc:
+ * @uart: указатель на #HyScanUART
+ * @status: статус отправки данных
+ * @user_data: пользовательские данные
+ *
+ * Функция обратного вызова, вызываемая по завершении асинхронной
+ * отправки данных.
+ */
+typedef void (*HyScanUARTWriteFunc)                    (HyScanUART                *uart,
+                                                        HyScanUARTStatus           status,
+                                                        gpointer                   user_data);
+
 HYSCAN_API
 GType                  hyscan_uart_device_get_type     (void);
 
@@ -150,15 +232,45 @@ void                   hyscan_uart_timeout             (HyScanUART
                                                         gdouble                    rx_timeout,
                                                         gdouble                    tx_timeout);
 
+HYSCAN_API
+HyScanUARTLatency      hyscan_uart_set_low_latency     (HyScanUART                *uart,
+                                                        gboolean                   enable);
+
+HYSCAN_API
+HyScanUARTLatency      hyscan_uart_get_low_latency     (HyScanUART                *uart);
+
 HYSCAN_API
 HyScanUARTStatus       hyscan_uart_read                (HyScanUART                *uart,
                                                         HyScanBuffer              *buffer,
                                                         guint32                    size);
 
+HYSCAN_API
+HyScanUARTStatus       hyscan_uart_read_timed          (HyScanUART                *uart,
+                                                        HyScanBuffer              *buffer,
+                                                        guint32                    size,
+                                                        gint64                    *time);
+
 HYSCAN_API
 HyScanUARTStatus       hyscan_uart_read_byte           (HyScanUART                *uart,
                                                         guint8                    *data);
 
+HYSCAN_API
+HyScanUARTStatus       hyscan_uart_read_byte_timed     (HyScanUART                *uart,
+                                                        guint8                    *data,
+                                                        gint64                    *time);
+
+HYSCAN_API
+HyScanUARTStatus       hyscan_uart_read_some           (HyScanUART                *uart,
+                                                        HyScanBuffer              *buffer,
+                                                        guint32                    size,
+                                                        gint64                    *time);
+
+HYSCAN_API
+gint                   hyscan_uart_wait                (HyScanUART               **uarts,
+                                                        gboolean                  *ready,
+                                                        guint                      n_uarts,
+                                                        gdouble                    timeout);
+
 HYSCAN_API
 HyScanUARTStatus       hyscan_uart_write               (HyScanUART                *uart,
                                                         HyScanBuffer              *buffer,
@@ -168,6 +280,29 @@ HYSCAN_API
 HyScanUARTStatus       hyscan_uart_write_byte          (HyScanUART                *uart,
                                                         guint8                     data);
 
+HYSCAN_API
+gboolean               hyscan_uart_write_async         (HyScanUART                *uart,
+                                                        HyScanBuffer              *buffer,
+                                                        HyScanUARTWriteFunc        callback,
+                                                        gpointer                   user_data);
+
+HYSCAN_API
+void                   hyscan_uart_write_flush         (HyScanUART                *uart);
+
+HYSCAN_API
+gboolean               hyscan_uart_get_stats           (HyScanUART                *uart,
+                                                        HyScanUARTStats           *stats);
+
+HYSCAN_API
+void                   hyscan_uart_reset_stats         (HyScanUART                *uart);
+
+HYSCAN_API
+gboolean               hyscan_uart_capture_start       (HyScanUART                *uart,
+                                                        const gchar               *file_name);
+
+HYSCAN_API
+void                   hyscan_uart_capture_stop        (HyScanUART                *uart);
+
 HYSCAN_API
 GList *                hyscan_uart_list                (void);
 
@@ -0,0 +1,373 @@
+/* device-async-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include <hyscan-sonar.h>
+#include <string.h>
+
+#define COMMAND_TIME           20000           /* Время выполнения синхронной команды, мкс. */
+#define WAIT_TIMEOUT           5000000         /* Время ожидания завершения команд, мкс. */
+
+/* Гидролокатор с синхронными командами. Выполненные команды записываются
+ * в журнал. */
+typedef struct
+{
+  GObject                      parent_instance;
+
+  GMutex                       lock;
+  GString                     *log;
+} TestSonar;
+
+typedef struct
+{
+  GObjectClass                 parent_class;
+} TestSonarClass;
+
+/* Гидролокатор, реализующий только асинхронную настройку. */
+typedef TestSonar TestPartialSonar;
+typedef TestSonarClass TestPartialSonarClass;
+
+/* Гидролокатор, реализующий все асинхронные команды. */
+typedef TestSonar TestNativeSonar;
+typedef TestSonarClass TestNativeSonarClass;
+
+static void    test_sonar_interface_init               (HyScanSonarInterface *iface);
+static void    test_partial_sonar_interface_init       (HyScanSonarInterface *iface);
+static void    test_native_sonar_interface_init        (HyScanSonarInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestSonar, test_sonar, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_SONAR, test_sonar_interface_init))
+
+G_DEFINE_TYPE_WITH_CODE (TestPartialSonar, test_partial_sonar, test_sonar_get_type (),
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_SONAR, test_partial_sonar_interface_init))
+
+G_DEFINE_TYPE_WITH_CODE (TestNativeSonar, test_native_sonar, test_sonar_get_type (),
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_SONAR, test_native_sonar_interface_init))
+
+static GString *completed;
+static gint n_completed;
+
+static void
+test_sonar_finalize (GObject *object)
+{
+  TestSonar *sonar = (TestSonar *) object;
+
+  g_string_free (sonar->log, TRUE);
+  g_mutex_clear (&sonar->lock);
+
+  G_OBJECT_CLASS (test_sonar_parent_class)->finalize (object);
+}
+
+static void
+test_sonar_class_init (TestSonarClass *klass)
+{
+  G_OBJECT_CLASS (klass)->finalize = test_sonar_finalize;
+}
+
+static void
+test_sonar_init (TestSonar *sonar)
+{
+  g_mutex_init (&sonar->lock);
+  sonar->log = g_string_new (NULL);
+}
+
+static void
+test_partial_sonar_class_init (TestPartialSonarClass *klass)
+{
+}
+
+static void
+test_partial_sonar_init (TestPartialSonar *sonar)
+{
+}
+
+static void
+test_native_sonar_class_init (TestNativeSonarClass *klass)
+{
+}
+
+static void
+test_native_sonar_init (TestNativeSonar *sonar)
+{
+}
+
+/* Функция записывает команду в журнал. */
+static void
+test_sonar_log (gpointer     sonar,
+                const gchar *command)
+{
+  TestSonar *test = sonar;
+
+  g_mutex_lock (&test->lock);
+  g_string_append_printf (test->log, "%s ", command);
+  g_mutex_unlock (&test->lock);
+}
+
+/* Синхронная команда. Команды, выполняемые одновременно, перемешались бы
+ * в журнале. */
+static gboolean
+test_sonar_command (gpointer     sonar,
+                    const gchar *command)
+{
+  g_usleep (COMMAND_TIME);
+  test_sonar_log (sonar, command);
+
+  return TRUE;
+}
+
+static gboolean
+test_sonar_generator_set_preset (HyScanSonar      *sonar,
+                                 HyScanSourceType  source,
+                                 gint64            preset)
+{
+  return test_sonar_command (sonar, "preset");
+}
+
+static gboolean
+test_sonar_start (HyScanSonar           *sonar,
+                  const gchar           *project_name,
+                  const gchar           *track_name,
+                  HyScanTrackType        track_type,
+                  const HyScanTrackPlan *track_plan)
+{
+  return test_sonar_command (sonar, "start");
+}
+
+static gboolean
+test_sonar_stop (HyScanSonar *sonar)
+{
+  return test_sonar_command (sonar, "stop");
+}
+
+/* Асинхронная команда драйвера. Команда записывается в журнал сразу, а
+ * результат возвращается через GTask. */
+static void
+test_sonar_native (HyScanSonar         *sonar,
+                   const gchar         *command,
+                   GCancellable        *cancellable,
+                   GAsyncReadyCallback  callback,
+                   gpointer             user_data)
+{
+  GTask *task;
+
+  test_sonar_log (sonar, command);
+
+  task = g_task_new (sonar, cancellable, callback, user_data);
+  g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+}
+
+static gboolean
+test_sonar_native_finish (HyScanSonar   *sonar,
+                          GAsyncResult  *result,
+                          GError       **error)
+{
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+test_sonar_configure_async (HyScanSonar         *sonar,
+                            HyScanSonarConfig   *config,
+                            GCancellable        *cancellable,
+                            GAsyncReadyCallback  callback,
+                            gpointer             user_data)
+{
+  test_sonar_native (sonar, "native-configure", cancellable, callback, user_data);
+}
+
+static void
+test_sonar_start_async (HyScanSonar           *sonar,
+                        const gchar           *project_name,
+                        const gchar           *track_name,
+                        HyScanTrackType        track_type,
+                        const HyScanTrackPlan *track_plan,
+                        GCancellable          *cancellable,
+                        GAsyncReadyCallback    callback,
+                        gpointer               user_data)
+{
+  test_sonar_native (sonar, "native-start", cancellable, callback, user_data);
+}
+
+static void
+test_sonar_stop_async (HyScanSonar         *sonar,
+                       GCancellable        *cancellable,
+                       GAsyncReadyCallback  callback,
+                       gpointer             user_data)
+{
+  test_sonar_native (sonar, "native-stop", cancellable, callback, user_data);
+}
+
+static void
+test_sonar_interface_init (HyScanSonarInterface *iface)
+{
+  iface->generator_set_preset = test_sonar_generator_set_preset;
+  iface->start = test_sonar_start;
+  iface->stop = test_sonar_stop;
+}
+
+static void
+test_partial_sonar_interface_init (HyScanSonarInterface *iface)
+{
+  iface->configure_async = test_sonar_configure_async;
+  iface->configure_finish = test_sonar_native_finish;
+}
+
+static void
+test_native_sonar_interface_init (HyScanSonarInterface *iface)
+{
+  iface->configure_async = test_sonar_configure_async;
+  iface->configure_finish = test_sonar_native_finish;
+  iface->start_async = test_sonar_start_async;
+  iface->start_finish = test_sonar_native_finish;
+  iface->stop_async = test_sonar_stop_async;
+  iface->stop_finish = test_sonar_native_finish;
+}
+
+/* Функция обратного вызова асинхронной команды. */
+static void
+ready (GObject      *source,
+       GAsyncResult *result,
+       gpointer      user_data)
+{
+  GError *error = NULL;
+
+  if (!hyscan_sonar_finish (HYSCAN_SONAR (source), result, &error))
+    g_error ("%s: %s", (const gchar *) user_data, (error != NULL) ? error->message : "failed");
+
+  g_string_append_printf (completed, "%s ", (const gchar *) user_data);
+  n_completed += 1;
+}
+
+/* Функция обрабатывает события, пока не завершится указанное число команд. */
+static void
+wait_completed (gint         n,
+                const gchar *step)
+{
+  gint64 end_time = g_get_monotonic_time () + WAIT_TIMEOUT;
+
+  while (n_completed < n)
+    {
+      if (g_get_monotonic_time () > end_time)
+        g_error ("%s: commands aren't completed", step);
+
+      if (!g_main_context_iteration (NULL, FALSE))
+        g_usleep (1000);
+    }
+}
+
+/* Функция выполняет последовательность асинхронных команд и проверяет
+ * порядок их выполнения и завершения. */
+static void
+check_order (GType        type,
+             const gchar *expected,
+             const gchar *step)
+{
+  HyScanSonar *sonar;
+  TestSonar *test;
+  gint64 start;
+
+  sonar = g_object_new (type, NULL);
+  test = (TestSonar *) sonar;
+
+  g_string_truncate (completed, 0);
+  n_completed = 0;
+
+  start = g_get_monotonic_time ();
+  hyscan_sonar_generator_set_preset_async (sonar, HYSCAN_SOURCE_SIDE_SCAN_STARBOARD, 1, NULL, ready, "preset");
+  hyscan_sonar_start_async (sonar, "project", "track", HYSCAN_TRACK_SURVEY, NULL, NULL, ready, "start");
+  hyscan_sonar_stop_async (sonar, NULL, ready, "stop");
+
+  if (g_get_monotonic_time () - start > 2 * COMMAND_TIME)
+    g_error ("%s: asynchronous commands block caller", step);
+
+  wait_completed (3, step);
+
+  g_message ("%s: executed %s", step, test->log->str);
+
+  if (g_strcmp0 (test->log->str, expected) != 0)
+    g_error ("%s: commands executed out of order", step);
+
+  if (g_strcmp0 (completed->str, "preset start stop ") != 0)
+    g_error ("%s: commands completed out of order", step);
+
+  g_object_unref (sonar);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gpointer sonar;
+  gint64 end_time;
+
+  completed = g_string_new (NULL);
+
+  /* Синхронные команды драйвера выполняются в очереди устройства. */
+  check_order (test_sonar_get_type (), "preset start stop ", "queue");
+
+  /* Если драйвер реализует только часть асинхронных команд, все команды
+   * выполняются в очереди, чтобы не нарушить их порядок. */
+  check_order (test_partial_sonar_get_type (), "preset start stop ", "partial");
+
+  /* Все асинхронные команды реализованы драйвером. */
+  check_order (test_native_sonar_get_type (), "native-configure native-start native-stop ", "native");
+
+  /* Устройство, удаляемое до завершения команды, удаляется вместе с
+   * очередью, в том числе из потока очереди. */
+  g_string_truncate (completed, 0);
+  n_completed = 0;
+
+  sonar = g_object_new (test_sonar_get_type (), NULL);
+  g_object_add_weak_pointer (sonar, &sonar);
+
+  hyscan_sonar_stop_async (sonar, NULL, ready, "stop");
+  g_object_unref (sonar);
+
+  wait_completed (1, "unref");
+
+  end_time = g_get_monotonic_time () + WAIT_TIMEOUT;
+  while (sonar != NULL)
+    {
+      if (g_get_monotonic_time () > end_time)
+        g_error ("unref: device isn't released");
+
+      if (!g_main_context_iteration (NULL, FALSE))
+        g_usleep (1000);
+    }
+
+  g_string_free (completed, TRUE);
+
+  g_message ("All done");
+
+  return 0;
+}
@@ -0,0 +1,180 @@
+/* device-clock-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include <hyscan-device-clock.h>
+
+#define WINDOW                 256             /* Размер окна модели. */
+#define N_PACKETS              2000            /* Число пакетов. */
+#define PERIOD                 10000           /* Период пакетов, мкс. */
+#define OFFSET                 1600000000000000 /* Смещение часов компьютера, мкс. */
+#define DRIFT                  50e-6           /* Уход частоты часов устройства. */
+#define DELAY                  500             /* Минимальная задержка передачи, мкс. */
+#define JITTER                 200             /* Разброс задержки передачи, мкс. */
+#define OUTLIERS               0.05            /* Доля сильно задержанных пакетов. */
+#define MAX_ERROR              50              /* Допустимая ошибка преобразования, мкс. */
+#define MAX_DRIFT_ERROR        3e-5            /* Допустимая ошибка ухода частоты. */
+#define JUMP                   1500000         /* Задержка, превышающая допустимое отклонение от модели, мкс. */
+#define RESTART_PACKETS        3               /* Число пакетов, после которых модель перезапускается. */
+
+/* Время приёма пакета компьютером. */
+static gint64
+host_time (GRand  *rand,
+           gint64  device_time,
+           gint64  offset)
+{
+  gdouble delay = DELAY + g_rand_double_range (rand, 0.0, JITTER);
+
+  if (g_rand_double (rand) < OUTLIERS)
+    delay += g_rand_double_range (rand, 20000.0, 100000.0);
+
+  return offset + device_time * (1.0 + DRIFT) + delay;
+}
+
+/* Ожидаемое время компьютера с учётом средней задержки передачи. */
+static gint64
+expected_time (gint64 device_time,
+               gint64 offset)
+{
+  return offset + device_time * (1.0 + DRIFT) + DELAY + JITTER / 2;
+}
+
+/* Функция проверяет модель часов после поступления пакетов. */
+static void
+check_model (HyScanDeviceClock *clock,
+             gint64             device_time,
+             gint64             offset)
+{
+  gint64 error;
+  gdouble drift;
+
+  if (!hyscan_device_clock_get_model (clock, NULL, &drift))
+    g_error ("clock model isn't ready");
+
+  error = hyscan_device_clock_convert (clock, device_time) - expected_time (device_time, offset);
+
+  g_message ("Conversion error %" G_GINT64_FORMAT " us, drift error %.2f ppm",
+             error, (drift - DRIFT) * 1e6);
+
+  if (ABS (error) > MAX_ERROR)
+    g_error ("conversion error is too large");
+
+  if (ABS (drift - DRIFT) > MAX_DRIFT_ERROR)
+    g_error ("drift error is too large");
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanDeviceClock *clock;
+  GRand *rand;
+  gint64 device_time = 1000000;
+  guint i;
+
+  rand = g_rand_new_with_seed (1);
+  clock = hyscan_device_clock_new (WINDOW);
+
+  /* Без данных время не преобразовывается. */
+  if (hyscan_device_clock_get_model (clock, NULL, NULL))
+    g_error ("clock model is ready without data");
+
+  if (hyscan_device_clock_convert (clock, device_time) != device_time)
+    g_error ("conversion without data failed");
+
+  /* Поток пакетов с задержками и выбросами. */
+  for (i = 0; i < N_PACKETS; i++)
+    {
+      device_time += PERIOD;
+      hyscan_device_clock_add (clock, device_time, host_time (rand, device_time, OFFSET));
+
+      if ((i >= WINDOW) && (i % 500 == 0))
+        check_model (clock, device_time + PERIOD, OFFSET);
+    }
+
+  check_model (clock, device_time + PERIOD, OFFSET);
+
+  /* Одиночные сильно задержанные или переставленные пакеты, в том числе
+   * идущие подряд в меньшем, чем для перезапуска, числе, отбрасываются. */
+  for (i = 1; i < RESTART_PACKETS; i++)
+    {
+      guint j;
+
+      for (j = 0; j < i; j++)
+        {
+          device_time += PERIOD;
+          hyscan_device_clock_add (clock, device_time, host_time (rand, device_time, OFFSET) + JUMP);
+        }
+
+      check_model (clock, device_time + PERIOD, OFFSET);
+
+      hyscan_device_clock_add (clock, device_time - 100 * PERIOD,
+                               host_time (rand, device_time - 100 * PERIOD, OFFSET));
+      check_model (clock, device_time + PERIOD, OFFSET);
+
+      device_time += PERIOD;
+      hyscan_device_clock_add (clock, device_time, host_time (rand, device_time, OFFSET));
+    }
+
+  /* Перезапуск устройства: время устройства начинается заново. Модель
+   * перестраивается после нескольких пакетов подряд. */
+  device_time = 0;
+  for (i = 0; i < RESTART_PACKETS; i++)
+    {
+      device_time += PERIOD;
+      hyscan_device_clock_add (clock, device_time, host_time (rand, device_time, 2 * OFFSET));
+    }
+
+  if (ABS (hyscan_device_clock_convert (clock, device_time) - expected_time (device_time, 2 * OFFSET)) > JUMP / 10)
+    g_error ("clock model isn't restarted");
+
+  for (i = RESTART_PACKETS; i < WINDOW; i++)
+    {
+      device_time += PERIOD;
+      hyscan_device_clock_add (clock, device_time, host_time (rand, device_time, 2 * OFFSET));
+    }
+
+  check_model (clock, device_time + PERIOD, 2 * OFFSET);
+
+  /* Сброс модели. */
+  hyscan_device_clock_reset (clock);
+  if (hyscan_device_clock_get_model (clock, NULL, NULL))
+    g_error ("clock model is ready after reset");
+
+  g_object_unref (clock);
+  g_rand_free (rand);
+
+  g_message ("All done");
+
+  return 0;
+}
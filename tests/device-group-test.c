@@ -0,0 +1,793 @@
+/* device-group-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include "hyscan-dummy-device.h"
+#include <hyscan-device-group.h>
+#include <hyscan-sonar-info.h>
+#include <hyscan-sensor-schema.h>
+#include <hyscan-actuator-schema.h>
+#include <hyscan-data-schema-builder.h>
+#include <hyscan-buffer.h>
+#include <string.h>
+
+#define N_DEVICES              4
+
+/* Допустимое отклонение времени запуска, мкс. Оно учитывает неточность
+ * g_usleep на загруженной системе и в несколько раз меньше разброса,
+ * который дал бы поочерёдный запуск. */
+#define MAX_SKEW               25000
+
+HyScanSourceType sources[N_DEVICES] =
+{
+  HYSCAN_SOURCE_SIDE_SCAN_STARBOARD,
+  HYSCAN_SOURCE_SIDE_SCAN_PORT,
+  HYSCAN_SOURCE_ECHOSOUNDER,
+  HYSCAN_SOURCE_PROFILER
+};
+
+/* Задержки передачи команд устройствам, мкс. При поочерёдном запуске
+ * разброс времени запуска составил бы около 160 мс. */
+gint64 latencies[N_DEVICES] =
+{
+  0,
+  20000,
+  40000,
+  80000
+};
+
+#define COMMON_PARAM           "/params/common"
+
+/* Устройство с датчиком "sensor-NAME", приводом "actuator-NAME" и
+ * параметрами "/params/NAME/value" и COMMON_PARAM. Устройство запоминает
+ * последнюю команду и завершает ошибкой обращение к чужим параметрам,
+ * датчикам и приводам. */
+typedef struct
+{
+  GObject                      parent_instance;
+
+  gchar                       *name;
+  HyScanDataSchema            *schema;
+  gint64                       value;
+  guint                        n_set;
+  guint                        n_get;
+  guint                        n_commands;
+  gchar                       *command;
+} TestMember;
+
+typedef struct
+{
+  GObjectClass                 parent_class;
+} TestMemberClass;
+
+typedef struct
+{
+  guint                        n_state;
+  guint                        n_log;
+  guint                        n_sensor_data;
+  guint                        n_source_info;
+  guint                        n_signal;
+  guint                        n_tvg;
+  guint                        n_acoustic_data;
+  HyScanBuffer                *buffer;
+} TestSignals;
+
+static void    test_member_param_interface_init        (HyScanParamInterface    *iface);
+static void    test_member_device_interface_init       (HyScanDeviceInterface   *iface);
+static void    test_member_sensor_interface_init       (HyScanSensorInterface   *iface);
+static void    test_member_actuator_interface_init     (HyScanActuatorInterface *iface);
+static void    test_member_object_finalize             (GObject                 *object);
+
+G_DEFINE_TYPE_WITH_CODE (TestMember, test_member, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_PARAM, test_member_param_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_DEVICE, test_member_device_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_SENSOR, test_member_sensor_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_ACTUATOR, test_member_actuator_interface_init))
+
+static gint n_warnings = 0;
+
+static void
+test_member_class_init (TestMemberClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = test_member_object_finalize;
+}
+
+static void
+test_member_init (TestMember *member)
+{
+}
+
+static void
+test_member_object_finalize (GObject *object)
+{
+  TestMember *member = (TestMember *) object;
+
+  g_free (member->name);
+  g_free (member->command);
+  g_clear_object (&member->schema);
+
+  G_OBJECT_CLASS (test_member_parent_class)->finalize (object);
+}
+
+static TestMember *
+test_member_new (const gchar *name)
+{
+  HyScanDeviceSchema *device;
+  HyScanSensorSchema *sensor;
+  HyScanActuatorSchema *actuator;
+  HyScanDataSchemaBuilder *builder;
+  TestMember *member;
+  gchar *key;
+
+  member = g_object_new (test_member_get_type (), NULL);
+  member->name = g_strdup (name);
+
+  device = hyscan_device_schema_new (HYSCAN_DEVICE_SCHEMA_VERSION);
+  sensor = hyscan_sensor_schema_new (device);
+  actuator = hyscan_actuator_schema_new (device);
+  builder = HYSCAN_DATA_SCHEMA_BUILDER (device);
+
+  key = g_strdup_printf ("sensor-%s", name);
+  hyscan_sensor_schema_add_sensor (sensor, key, name, NULL);
+  g_free (key);
+
+  key = g_strdup_printf ("actuator-%s", name);
+  hyscan_actuator_schema_add_actuator (actuator, key, name, NULL,
+                                       HYSCAN_ACTUATOR_MODE_SCAN | HYSCAN_ACTUATOR_MODE_MANUAL);
+  g_free (key);
+
+  key = g_strdup_printf ("/params/%s/value", name);
+  hyscan_data_schema_builder_key_integer_create (builder, key, "value", NULL, 0);
+  hyscan_data_schema_builder_key_integer_create (builder, COMMON_PARAM, "common", NULL, 0);
+  g_free (key);
+
+  member->schema = hyscan_data_schema_builder_get_schema (builder);
+
+  g_object_unref (sensor);
+  g_object_unref (actuator);
+  g_object_unref (device);
+
+  return member;
+}
+
+/* Функция проверяет, что все параметры списка принадлежат устройству. */
+static gboolean
+test_member_check_params (TestMember      *member,
+                          HyScanParamList *list)
+{
+  const gchar * const *keys = hyscan_param_list_params (list);
+  gchar *key = g_strdup_printf ("/params/%s/value", member->name);
+  gboolean status = (keys != NULL);
+  guint i;
+
+  for (i = 0; (keys != NULL) && (keys[i] != NULL); i++)
+    {
+      if ((g_strcmp0 (keys[i], key) != 0) && (g_strcmp0 (keys[i], COMMON_PARAM) != 0))
+        status = FALSE;
+    }
+
+  g_free (key);
+
+  return status;
+}
+
+static HyScanDataSchema *
+test_member_param_schema (HyScanParam *param)
+{
+  return g_object_ref (((TestMember *) param)->schema);
+}
+
+static gboolean
+test_member_param_set (HyScanParam     *param,
+                       HyScanParamList *list)
+{
+  TestMember *member = (TestMember *) param;
+  gchar *key;
+
+  member->n_set += 1;
+  if (!test_member_check_params (member, list))
+    return FALSE;
+
+  key = g_strdup_printf ("/params/%s/value", member->name);
+  if (hyscan_param_list_contains (list, key))
+    member->value = hyscan_param_list_get_integer (list, key);
+  g_free (key);
+
+  return TRUE;
+}
+
+static gboolean
+test_member_param_get (HyScanParam     *param,
+                       HyScanParamList *list)
+{
+  TestMember *member = (TestMember *) param;
+  gchar *key;
+
+  member->n_get += 1;
+  if (!test_member_check_params (member, list))
+    return FALSE;
+
+  key = g_strdup_printf ("/params/%s/value", member->name);
+  if (hyscan_param_list_contains (list, key))
+    hyscan_param_list_set_integer (list, key, member->value);
+  g_free (key);
+
+  return TRUE;
+}
+
+/* Функция запоминает команду, переданную устройству. */
+static gboolean
+test_member_command (gpointer     device,
+                     const gchar *type,
+                     const gchar *name)
+{
+  TestMember *member = device;
+  gchar *expected = g_strdup_printf ("%s-%s", type, member->name);
+  gboolean status = (g_strcmp0 (name, expected) == 0);
+
+  member->n_commands += 1;
+  g_free (member->command);
+  member->command = g_strdup (name);
+  g_free (expected);
+
+  return status;
+}
+
+static gboolean
+test_member_antenna_set_offset (HyScanSensor              *sensor,
+                                const gchar               *name,
+                                const HyScanAntennaOffset *offset)
+{
+  return test_member_command (sensor, "sensor", name);
+}
+
+static gboolean
+test_member_set_enable (HyScanSensor *sensor,
+                        const gchar  *name,
+                        gboolean      enable)
+{
+  return test_member_command (sensor, "sensor", name);
+}
+
+static gboolean
+test_member_actuator_disable (HyScanActuator *actuator,
+                              const gchar    *name)
+{
+  return test_member_command (actuator, "actuator", name);
+}
+
+static gboolean
+test_member_actuator_scan (HyScanActuator *actuator,
+                           const gchar    *name,
+                           gdouble         from,
+                           gdouble         to,
+                           gdouble         speed)
+{
+  return test_member_command (actuator, "actuator", name);
+}
+
+static gboolean
+test_member_actuator_manual (HyScanActuator *actuator,
+                             const gchar    *name,
+                             gdouble         angle)
+{
+  return test_member_command (actuator, "actuator", name);
+}
+
+static void
+test_member_param_interface_init (HyScanParamInterface *iface)
+{
+  iface->schema = test_member_param_schema;
+  iface->set = test_member_param_set;
+  iface->get = test_member_param_get;
+}
+
+static void
+test_member_device_interface_init (HyScanDeviceInterface *iface)
+{
+}
+
+static void
+test_member_sensor_interface_init (HyScanSensorInterface *iface)
+{
+  iface->antenna_set_offset = test_member_antenna_set_offset;
+  iface->set_enable = test_member_set_enable;
+}
+
+static void
+test_member_actuator_interface_init (HyScanActuatorInterface *iface)
+{
+  iface->disable = test_member_actuator_disable;
+  iface->scan = test_member_actuator_scan;
+  iface->manual = test_member_actuator_manual;
+}
+
+/* Функция проверяет последнюю команду устройства. */
+static void
+check_command (TestMember  *member,
+               guint        n_commands,
+               const gchar *command,
+               const gchar *step)
+{
+  if ((member->n_commands != n_commands) || (g_strcmp0 (member->command, command) != 0))
+    g_error ("%s: device %s commands mismatch", step, member->name);
+}
+
+/* Обработчик предупреждений, подсчитывающий сообщения о повторах. */
+static void
+warning_handler (const gchar    *log_domain,
+                 GLogLevelFlags  log_level,
+                 const gchar    *message,
+                 gpointer        user_data)
+{
+  const gchar *expected = user_data;
+
+  if (strstr (message, expected) != NULL)
+    g_atomic_int_inc (&n_warnings);
+}
+
+static void
+device_state (HyScanDevice *device,
+              const gchar  *dev_id,
+              TestSignals  *signals)
+{
+  if (g_strcmp0 (dev_id, "b") != 0)
+    g_error ("device-state arguments mismatch");
+
+  signals->n_state += 1;
+}
+
+static void
+device_log (HyScanDevice *device,
+            const gchar  *source,
+            gint64        time,
+            gint          level,
+            const gchar  *message,
+            TestSignals  *signals)
+{
+  if ((g_strcmp0 (source, "b") != 0) || (time != 1) ||
+      (level != HYSCAN_LOG_LEVEL_INFO) || (g_strcmp0 (message, "log") != 0))
+    {
+      g_error ("device-log arguments mismatch");
+    }
+
+  signals->n_log += 1;
+}
+
+static void
+sensor_data (HyScanSensor *sensor,
+             const gchar  *name,
+             gint          source,
+             gint64        time,
+             HyScanBuffer *data,
+             TestSignals  *signals)
+{
+  if ((g_strcmp0 (name, "sensor-a") != 0) || (source != HYSCAN_SOURCE_NMEA) ||
+      (time != 2) || (data != signals->buffer))
+    {
+      g_error ("sensor-data arguments mismatch");
+    }
+
+  signals->n_sensor_data += 1;
+}
+
+static void
+sonar_source_info (HyScanSonar  *sonar,
+                   gint          source,
+                   guint         channel,
+                   const gchar  *description,
+                   const gchar  *actuator,
+                   gpointer      info,
+                   TestSignals  *signals)
+{
+  if ((source != HYSCAN_SOURCE_SIDE_SCAN_STARBOARD) || (channel != 1) ||
+      (g_strcmp0 (description, "description") != 0) ||
+      (g_strcmp0 (actuator, "actuator-a") != 0) || (info != signals))
+    {
+      g_error ("sonar-source-info arguments mismatch");
+    }
+
+  signals->n_source_info += 1;
+}
+
+static void
+sonar_signal (HyScanSonar  *sonar,
+              gint          source,
+              guint         channel,
+              gint64        time,
+              HyScanBuffer *image,
+              TestSignals  *signals)
+{
+  if ((source != HYSCAN_SOURCE_SIDE_SCAN_STARBOARD) || (channel != 1) || (time != 3) || (image != signals->buffer))
+    g_error ("sonar-signal arguments mismatch");
+
+  signals->n_signal += 1;
+}
+
+static void
+sonar_tvg (HyScanSonar  *sonar,
+           gint          source,
+           guint         channel,
+           gint64        time,
+           HyScanBuffer *gains,
+           TestSignals  *signals)
+{
+  if ((source != HYSCAN_SOURCE_SIDE_SCAN_STARBOARD) || (channel != 2) || (time != 4) || (gains != signals->buffer))
+    g_error ("sonar-tvg arguments mismatch");
+
+  signals->n_tvg += 1;
+}
+
+static void
+sonar_acoustic_data (HyScanSonar  *sonar,
+                     gint          source,
+                     guint         channel,
+                     gboolean      noise,
+                     gint64        time,
+                     HyScanBuffer *data,
+                     TestSignals  *signals)
+{
+  if ((source != HYSCAN_SOURCE_SIDE_SCAN_STARBOARD) || (channel != 1) || !noise || (time != 5) || (data != signals->buffer))
+    g_error ("sonar-acoustic-data arguments mismatch");
+
+  signals->n_acoustic_data += 1;
+}
+
+/* Функция проверяет разделение параметров, передачу команд датчикам и
+ * приводам и передачу сигналов устройств через группу. */
+static void
+check_routing (HyScanDummyDevice *dummy)
+{
+  HyScanDeviceGroup *group;
+  HyScanParamList *list;
+  HyScanAntennaOffset offset = { 0 };
+  TestMember *a, *b;
+  TestSignals signals = { 0 };
+
+  group = hyscan_device_group_new ();
+  a = test_member_new ("a");
+  b = test_member_new ("b");
+
+  if (!hyscan_device_group_add (group, HYSCAN_DEVICE (a)) ||
+      !hyscan_device_group_add (group, HYSCAN_DEVICE (b)) ||
+      !hyscan_device_group_add (group, HYSCAN_DEVICE (dummy)))
+    {
+      g_error ("can't add devices");
+    }
+
+  /* Каждое устройство получает только свои параметры. */
+  list = hyscan_param_list_new ();
+  hyscan_param_list_set_integer (list, "/params/a/value", 1);
+  hyscan_param_list_set_integer (list, "/params/b/value", 2);
+  if (!hyscan_param_set (HYSCAN_PARAM (group), list))
+    g_error ("can't set parameters");
+
+  if ((a->n_set != 1) || (a->value != 1) || (b->n_set != 1) || (b->value != 2))
+    g_error ("parameters aren't split between devices");
+
+  g_object_unref (list);
+  list = hyscan_param_list_new ();
+  hyscan_param_list_set_integer (list, "/params/a/value", 3);
+  if (!hyscan_param_set (HYSCAN_PARAM (group), list))
+    g_error ("can't set parameter");
+
+  if ((a->n_set != 2) || (a->value != 3) || (b->n_set != 1))
+    g_error ("parameter set on wrong device");
+
+  g_object_unref (list);
+  list = hyscan_param_list_new ();
+  hyscan_param_list_add (list, "/params/a/value");
+  hyscan_param_list_add (list, "/params/b/value");
+  if (!hyscan_param_get (HYSCAN_PARAM (group), list))
+    g_error ("can't get parameters");
+
+  if ((a->n_get != 1) || (b->n_get != 1) ||
+      (hyscan_param_list_get_integer (list, "/params/a/value") != 3) ||
+      (hyscan_param_list_get_integer (list, "/params/b/value") != 2))
+    {
+      g_error ("parameters aren't merged from devices");
+    }
+
+  /* Неизвестный параметр не передаётся ни одному устройству. */
+  g_object_unref (list);
+  list = hyscan_param_list_new ();
+  hyscan_param_list_set_integer (list, "/params/a/value", 4);
+  hyscan_param_list_set_integer (list, "/params/unknown", 4);
+  if (hyscan_param_set (HYSCAN_PARAM (group), list))
+    g_error ("unknown parameter set");
+
+  if ((a->n_set != 2) || (b->n_set != 1))
+    g_error ("parameters with unknown key passed to device");
+
+  g_object_unref (list);
+
+  /* Команды датчикам и приводам. */
+  if (!hyscan_sensor_set_enable (HYSCAN_SENSOR (group), "sensor-b", TRUE))
+    g_error ("can't enable sensor");
+  check_command (b, 1, "sensor-b", "sensor enable");
+  check_command (a, 0, NULL, "sensor enable");
+
+  if (!hyscan_sensor_antenna_set_offset (HYSCAN_SENSOR (group), "sensor-a", &offset))
+    g_error ("can't set sensor offset");
+  check_command (a, 1, "sensor-a", "sensor offset");
+
+  if (!hyscan_actuator_scan (HYSCAN_ACTUATOR (group), "actuator-a", -10.0, 10.0, 1.0))
+    g_error ("can't start actuator scan");
+  check_command (a, 2, "actuator-a", "actuator scan");
+
+  if (!hyscan_actuator_manual (HYSCAN_ACTUATOR (group), "actuator-b", 5.0))
+    g_error ("can't set actuator angle");
+  check_command (b, 2, "actuator-b", "actuator manual");
+
+  if (!hyscan_actuator_disable (HYSCAN_ACTUATOR (group), "actuator-a"))
+    g_error ("can't disable actuator");
+  check_command (a, 3, "actuator-a", "actuator disable");
+
+  if (hyscan_sensor_set_enable (HYSCAN_SENSOR (group), "sensor-unknown", TRUE) ||
+      hyscan_actuator_disable (HYSCAN_ACTUATOR (group), "actuator-unknown"))
+    {
+      g_error ("unknown sensor or actuator used");
+    }
+  check_command (a, 3, "actuator-a", "unknown names");
+  check_command (b, 2, "actuator-b", "unknown names");
+
+  /* Сигналы устройств передаются через группу. */
+  signals.buffer = hyscan_buffer_new ();
+
+  g_signal_connect (group, "device-state", G_CALLBACK (device_state), &signals);
+  g_signal_connect (group, "device-log", G_CALLBACK (device_log), &signals);
+  g_signal_connect (group, "sensor-data", G_CALLBACK (sensor_data), &signals);
+  g_signal_connect (group, "sonar-source-info", G_CALLBACK (sonar_source_info), &signals);
+  g_signal_connect (group, "sonar-signal", G_CALLBACK (sonar_signal), &signals);
+  g_signal_connect (group, "sonar-tvg", G_CALLBACK (sonar_tvg), &signals);
+  g_signal_connect (group, "sonar-acoustic-data", G_CALLBACK (sonar_acoustic_data), &signals);
+
+  g_signal_emit_by_name (b, "device-state", "b");
+  g_signal_emit_by_name (b, "device-log", "b", (gint64) 1, HYSCAN_LOG_LEVEL_INFO, "log");
+  g_signal_emit_by_name (a, "sensor-data", "sensor-a", HYSCAN_SOURCE_NMEA, (gint64) 2, signals.buffer);
+  g_signal_emit_by_name (dummy, "sonar-source-info", HYSCAN_SOURCE_SIDE_SCAN_STARBOARD, 1, "description", "actuator-a", &signals);
+  g_signal_emit_by_name (dummy, "sonar-signal", HYSCAN_SOURCE_SIDE_SCAN_STARBOARD, 1, (gint64) 3, signals.buffer);
+  g_signal_emit_by_name (dummy, "sonar-tvg", HYSCAN_SOURCE_SIDE_SCAN_STARBOARD, 2, (gint64) 4, signals.buffer);
+  g_signal_emit_by_name (dummy, "sonar-acoustic-data", HYSCAN_SOURCE_SIDE_SCAN_STARBOARD, 1, TRUE, (gint64) 5, signals.buffer);
+
+  if ((signals.n_state != 1) || (signals.n_log != 1) || (signals.n_sensor_data != 1) ||
+      (signals.n_source_info != 1) || (signals.n_signal != 1) ||
+      (signals.n_tvg != 1) || (signals.n_acoustic_data != 1))
+    {
+      g_error ("device signals aren't passed through group");
+    }
+
+  /* После удаления группы сигналы устройств не передаются. */
+  g_object_unref (group);
+  g_signal_emit_by_name (b, "device-state", "b");
+  if (signals.n_state != 1)
+    g_error ("device signal passed after group removal");
+
+  g_object_unref (signals.buffer);
+  g_object_unref (a);
+  g_object_unref (b);
+}
+
+/* Функция проверяет предупреждения о повторяющихся датчиках, приводах и
+ * параметрах. Команды передаются первому устройству с таким названием. */
+static void
+check_duplicates (void)
+{
+  HyScanDeviceGroup *group;
+  TestMember *a, *b, *c;
+  guint handler;
+
+  group = hyscan_device_group_new ();
+  a = test_member_new ("a");
+  b = test_member_new ("b");
+  c = test_member_new ("a");
+
+  /* Общий параметр второго устройства. */
+  handler = g_log_set_handler (G_LOG_DOMAIN, G_LOG_LEVEL_WARNING, warning_handler, "duplicate parameter");
+  if (!hyscan_device_group_add (group, HYSCAN_DEVICE (a)) ||
+      !hyscan_device_group_add (group, HYSCAN_DEVICE (b)))
+    {
+      g_error ("can't add devices");
+    }
+  g_log_remove_handler (G_LOG_DOMAIN, handler);
+
+  if (g_atomic_int_get (&n_warnings) != 1)
+    g_error ("duplicate parameter isn't reported");
+
+  /* Датчик, привод и параметры третьего устройства совпадают с первым. */
+  g_atomic_int_set (&n_warnings, 0);
+  handler = g_log_set_handler (G_LOG_DOMAIN, G_LOG_LEVEL_WARNING, warning_handler, "sensor-a");
+  if (!hyscan_device_group_add (group, HYSCAN_DEVICE (c)))
+    g_error ("can't add device");
+  g_log_remove_handler (G_LOG_DOMAIN, handler);
+
+  if (g_atomic_int_get (&n_warnings) != 1)
+    g_error ("duplicate sensor isn't reported");
+
+  if (!hyscan_sensor_set_enable (HYSCAN_SENSOR (group), "sensor-a", TRUE) ||
+      !hyscan_actuator_disable (HYSCAN_ACTUATOR (group), "actuator-a"))
+    {
+      g_error ("can't use duplicated names");
+    }
+
+  check_command (a, 2, "actuator-a", "duplicate names");
+  check_command (c, 0, NULL, "duplicate names");
+
+  g_object_unref (group);
+  g_object_unref (a);
+  g_object_unref (b);
+  g_object_unref (c);
+}
+
+/* Функция проверяет разброс моментов выполнения команды устройствами и
+ * отклонения, вычисленные группой. */
+static void
+check_skew (HyScanDeviceGroup  *group,
+            HyScanDummyDevice **devices,
+            gboolean            start)
+{
+  gint64 min_time = G_MAXINT64;
+  gint64 max_time = G_MININT64;
+  guint i;
+
+  for (i = 0; i < N_DEVICES; i++)
+    {
+      gint64 time, skew;
+
+      time = start ? hyscan_dummy_device_get_start_time (devices[i]) :
+                     hyscan_dummy_device_get_stop_time (devices[i]);
+
+      if (!hyscan_device_group_get_skew (group, HYSCAN_DEVICE (devices[i]), &skew))
+        g_error ("can't get device %d skew", i);
+
+      g_message ("Device %d %s skew %" G_GINT64_FORMAT " us",
+                 i, start ? "start" : "stop", skew);
+
+      if (start && (ABS (skew) > MAX_SKEW))
+        g_error ("device %d start skew is too large", i);
+
+      min_time = MIN (min_time, time);
+      max_time = MAX (max_time, time);
+    }
+
+  g_message ("%s spread %" G_GINT64_FORMAT " us", start ? "Start" : "Stop", max_time - min_time);
+
+  if (start && (max_time - min_time > MAX_SKEW))
+    g_error ("start spread is too large");
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanDummyDevice *devices[N_DEVICES];
+  HyScanDeviceGroup *group;
+  HyScanDataSchema *schema;
+  HyScanSonarInfo *info;
+  const HyScanSourceType *group_sources;
+  guint32 n_sources;
+  guint i;
+
+  group = hyscan_device_group_new ();
+
+  for (i = 0; i < N_DEVICES; i++)
+    {
+      devices[i] = hyscan_dummy_device_new (sources[i], latencies[i]);
+
+      if (!hyscan_device_group_add (group, HYSCAN_DEVICE (devices[i])))
+        g_error ("can't add device %d", i);
+    }
+
+  /* Схема группы должна содержать источники всех устройств. */
+  schema = hyscan_param_schema (HYSCAN_PARAM (group));
+  info = hyscan_sonar_info_new (schema);
+  group_sources = hyscan_sonar_info_list_sources (info, &n_sources);
+  if (n_sources != N_DEVICES)
+    g_error ("group sources mismatch");
+
+  for (i = 0; i < N_DEVICES; i++)
+    {
+      guint j;
+
+      for (j = 0; j < n_sources; j++)
+        if (group_sources[j] == sources[i])
+          break;
+
+      if (j == n_sources)
+        g_error ("source %d not found", sources[i]);
+    }
+
+  g_object_unref (info);
+  g_object_unref (schema);
+
+  /* До запуска отклонения неизвестны. */
+  if (hyscan_device_group_get_skew (group, HYSCAN_DEVICE (devices[0]), NULL))
+    g_error ("skew available before start");
+
+  /* Согласованный запуск. */
+  if (!hyscan_sonar_start (HYSCAN_SONAR (group), "project", "track", HYSCAN_TRACK_SURVEY, NULL))
+    g_error ("can't start devices");
+
+  for (i = 0; i < N_DEVICES; i++)
+    {
+      gint64 sync_time = hyscan_dummy_device_get_sync_time (devices[i]);
+      gint64 start_time = hyscan_dummy_device_get_start_time (devices[i]);
+
+      if ((sync_time == 0) || (sync_time >= start_time))
+        g_error ("device %d isn't synchronized before start", i);
+    }
+
+  check_skew (group, devices, TRUE);
+
+  /* Согласованный останов. */
+  if (!hyscan_sonar_stop (HYSCAN_SONAR (group)))
+    g_error ("can't stop devices");
+
+  check_skew (group, devices, FALSE);
+
+  /* Ошибка запуска одного устройства останавливает остальные. */
+  hyscan_dummy_device_set_fail_start (devices[N_DEVICES - 1], TRUE);
+
+  {
+    gint64 stop_time = hyscan_dummy_device_get_stop_time (devices[N_DEVICES - 1]);
+
+    if (hyscan_sonar_start (HYSCAN_SONAR (group), "project", "track", HYSCAN_TRACK_SURVEY, NULL))
+      g_error ("group started with failed device");
+
+    for (i = 0; i < N_DEVICES - 1; i++)
+      {
+        if (hyscan_dummy_device_get_stop_time (devices[i]) <= hyscan_dummy_device_get_start_time (devices[i]))
+          g_error ("device %d isn't stopped after failed start", i);
+      }
+
+    if (hyscan_dummy_device_get_stop_time (devices[N_DEVICES - 1]) != stop_time)
+      g_error ("failed device is stopped");
+  }
+
+  hyscan_dummy_device_set_fail_start (devices[N_DEVICES - 1], FALSE);
+
+  g_object_unref (group);
+
+  /* Разделение параметров, команды и сигналы устройств. */
+  check_routing (devices[0]);
+  check_duplicates ();
+
+  for (i = 0; i < N_DEVICES; i++)
+    g_object_unref (devices[i]);
+
+  g_message ("All done");
+
+  return 0;
+}
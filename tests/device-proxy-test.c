@@ -0,0 +1,411 @@
+/* device-proxy-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include "hyscan-dummy-device.h"
+#include <hyscan-device-proxy.h>
+
+#define SOURCE                 HYSCAN_SOURCE_SIDE_SCAN_STARBOARD
+#define LATENCY                1000            /* Задержка передачи команд, мкс. */
+#define SENSOR                 "sensor"
+#define ACTUATOR               "actuator"
+
+/* Устройство с датчиком и приводом. Команды для датчиков и приводов с
+ * другими названиями завершаются ошибкой. */
+typedef struct
+{
+  GObject                      parent_instance;
+
+  guint                        n_commands;
+} TestSensor;
+
+typedef struct
+{
+  GObjectClass                 parent_class;
+} TestSensorClass;
+
+static void    test_sensor_device_interface_init       (HyScanDeviceInterface   *iface);
+static void    test_sensor_sensor_interface_init       (HyScanSensorInterface   *iface);
+static void    test_sensor_actuator_interface_init     (HyScanActuatorInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestSensor, test_sensor, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_DEVICE, test_sensor_device_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_SENSOR, test_sensor_sensor_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_ACTUATOR, test_sensor_actuator_interface_init))
+
+static void
+test_sensor_class_init (TestSensorClass *klass)
+{
+}
+
+static void
+test_sensor_init (TestSensor *sensor)
+{
+}
+
+/* Функция учитывает команду, переданную устройству. */
+static gboolean
+test_sensor_command (gpointer     device,
+                     const gchar *name,
+                     const gchar *expected)
+{
+  TestSensor *sensor = device;
+
+  sensor->n_commands += 1;
+
+  return (g_strcmp0 (name, expected) == 0);
+}
+
+static gboolean
+test_sensor_antenna_set_offset (HyScanSensor              *sensor,
+                                const gchar               *name,
+                                const HyScanAntennaOffset *offset)
+{
+  return test_sensor_command (sensor, name, SENSOR);
+}
+
+static gboolean
+test_sensor_set_enable (HyScanSensor *sensor,
+                        const gchar  *name,
+                        gboolean      enable)
+{
+  return test_sensor_command (sensor, name, SENSOR);
+}
+
+static gboolean
+test_sensor_actuator_disable (HyScanActuator *actuator,
+                              const gchar    *name)
+{
+  return test_sensor_command (actuator, name, ACTUATOR);
+}
+
+static gboolean
+test_sensor_actuator_scan (HyScanActuator *actuator,
+                           const gchar    *name,
+                           gdouble         from,
+                           gdouble         to,
+                           gdouble         speed)
+{
+  return test_sensor_command (actuator, name, ACTUATOR);
+}
+
+static gboolean
+test_sensor_actuator_manual (HyScanActuator *actuator,
+                             const gchar    *name,
+                             gdouble         angle)
+{
+  return test_sensor_command (actuator, name, ACTUATOR);
+}
+
+static void
+test_sensor_device_interface_init (HyScanDeviceInterface *iface)
+{
+}
+
+static void
+test_sensor_sensor_interface_init (HyScanSensorInterface *iface)
+{
+  iface->antenna_set_offset = test_sensor_antenna_set_offset;
+  iface->set_enable = test_sensor_set_enable;
+}
+
+static void
+test_sensor_actuator_interface_init (HyScanActuatorInterface *iface)
+{
+  iface->disable = test_sensor_actuator_disable;
+  iface->scan = test_sensor_actuator_scan;
+  iface->manual = test_sensor_actuator_manual;
+}
+
+/* Функция проверяет число команд, переданных датчику или приводу. */
+static void
+check_sensor_commands (TestSensor  *sensor,
+                       guint        n_commands,
+                       const gchar *step)
+{
+  if (sensor->n_commands != n_commands)
+    g_error ("%s: %d commands instead of %d", step, sensor->n_commands, n_commands);
+}
+
+/* Функция проверяет запомненный режим работы привода. */
+static void
+check_actuator (HyScanDeviceProxy      *proxy,
+                HyScanActuatorModeType  mode,
+                gdouble                 value,
+                const gchar            *step)
+{
+  HyScanActuatorModeType cur_mode;
+  gdouble speed, angle;
+
+  if (!hyscan_device_proxy_get_actuator (proxy, ACTUATOR, &cur_mode, NULL, NULL, &speed, &angle))
+    g_error ("%s: actuator state unknown", step);
+
+  if (cur_mode != mode)
+    g_error ("%s: actuator mode mismatch", step);
+
+  if ((mode == HYSCAN_ACTUATOR_MODE_SCAN) && (speed != value))
+    g_error ("%s: actuator speed mismatch", step);
+
+  if ((mode == HYSCAN_ACTUATOR_MODE_MANUAL) && (angle != value))
+    g_error ("%s: actuator angle mismatch", step);
+}
+
+/* Функция проверяет прокси датчика и привода. */
+static void
+check_sensor (void)
+{
+  TestSensor *sensor;
+  HyScanDeviceProxy *proxy;
+  HyScanSensor *proxy_sensor;
+  HyScanActuator *proxy_actuator;
+  HyScanAntennaOffset offset = { 0 };
+  HyScanAntennaOffset *cur_offset;
+  gboolean enable;
+
+  sensor = g_object_new (test_sensor_get_type (), NULL);
+  proxy = hyscan_device_proxy_new (HYSCAN_DEVICE (sensor));
+
+  /* Прокси реализует только интерфейсы устройства. */
+  if (HYSCAN_IS_SONAR (proxy) || !HYSCAN_IS_SENSOR (proxy) || !HYSCAN_IS_ACTUATOR (proxy))
+    g_error ("sensor proxy interfaces mismatch");
+
+  proxy_sensor = HYSCAN_SENSOR (proxy);
+  proxy_actuator = HYSCAN_ACTUATOR (proxy);
+
+  /* Включение датчика. */
+  if (hyscan_device_proxy_get_sensor_enable (proxy, SENSOR, &enable))
+    g_error ("sensor state available before commands");
+
+  if (!hyscan_sensor_set_enable (proxy_sensor, SENSOR, TRUE))
+    g_error ("can't enable sensor");
+  check_sensor_commands (sensor, 1, "enable");
+
+  if (!hyscan_sensor_set_enable (proxy_sensor, SENSOR, TRUE))
+    g_error ("can't repeat enable");
+  check_sensor_commands (sensor, 1, "repeated enable");
+
+  if (!hyscan_device_proxy_get_sensor_enable (proxy, SENSOR, &enable) || !enable)
+    g_error ("sensor enable state mismatch");
+
+  if (!hyscan_sensor_set_enable (proxy_sensor, SENSOR, FALSE))
+    g_error ("can't disable sensor");
+  check_sensor_commands (sensor, 2, "disable");
+
+  if (!hyscan_device_proxy_get_sensor_enable (proxy, SENSOR, &enable) || enable)
+    g_error ("sensor disable state mismatch");
+
+  /* Смещение антенны датчика. */
+  if (hyscan_device_proxy_get_sensor_offset (proxy, SENSOR) != NULL)
+    g_error ("sensor offset available before commands");
+
+  offset.forward = 1.0;
+  if (!hyscan_sensor_antenna_set_offset (proxy_sensor, SENSOR, &offset))
+    g_error ("can't set offset");
+  check_sensor_commands (sensor, 3, "offset");
+
+  if (!hyscan_sensor_antenna_set_offset (proxy_sensor, SENSOR, &offset))
+    g_error ("can't repeat offset");
+  check_sensor_commands (sensor, 3, "repeated offset");
+
+  cur_offset = hyscan_device_proxy_get_sensor_offset (proxy, SENSOR);
+  if ((cur_offset == NULL) || (cur_offset->forward != 1.0))
+    g_error ("sensor offset mismatch");
+  hyscan_antenna_offset_free (cur_offset);
+
+  offset.yaw = 90.0;
+  if (!hyscan_sensor_antenna_set_offset (proxy_sensor, SENSOR, &offset))
+    g_error ("can't change offset");
+  check_sensor_commands (sensor, 4, "changed offset");
+
+  /* Ошибка команды датчика не запоминается. */
+  if (hyscan_sensor_set_enable (proxy_sensor, "unknown", TRUE))
+    g_error ("unknown sensor enabled");
+  if (hyscan_sensor_set_enable (proxy_sensor, "unknown", TRUE))
+    g_error ("unknown sensor enabled twice");
+  check_sensor_commands (sensor, 6, "unknown sensor");
+  if (hyscan_device_proxy_get_sensor_enable (proxy, "unknown", &enable))
+    g_error ("failed sensor command cached");
+
+  /* Режимы работы привода. */
+  if (hyscan_device_proxy_get_actuator (proxy, ACTUATOR, NULL, NULL, NULL, NULL, NULL))
+    g_error ("actuator state available before commands");
+
+  if (!hyscan_actuator_scan (proxy_actuator, ACTUATOR, -45.0, 45.0, 10.0))
+    g_error ("can't scan");
+  check_sensor_commands (sensor, 7, "scan");
+
+  if (!hyscan_actuator_scan (proxy_actuator, ACTUATOR, -45.0, 45.0, 10.0))
+    g_error ("can't repeat scan");
+  check_sensor_commands (sensor, 7, "repeated scan");
+  check_actuator (proxy, HYSCAN_ACTUATOR_MODE_SCAN, 10.0, "scan");
+
+  if (!hyscan_actuator_scan (proxy_actuator, ACTUATOR, -45.0, 45.0, 20.0))
+    g_error ("can't change scan");
+  check_sensor_commands (sensor, 8, "changed scan");
+  check_actuator (proxy, HYSCAN_ACTUATOR_MODE_SCAN, 20.0, "changed scan");
+
+  if (!hyscan_actuator_manual (proxy_actuator, ACTUATOR, 30.0))
+    g_error ("can't set manual");
+  if (!hyscan_actuator_manual (proxy_actuator, ACTUATOR, 30.0))
+    g_error ("can't repeat manual");
+  check_sensor_commands (sensor, 9, "manual");
+  check_actuator (proxy, HYSCAN_ACTUATOR_MODE_MANUAL, 30.0, "manual");
+
+  if (!hyscan_actuator_disable (proxy_actuator, ACTUATOR))
+    g_error ("can't disable actuator");
+  if (!hyscan_actuator_disable (proxy_actuator, ACTUATOR))
+    g_error ("can't repeat disable actuator");
+  check_sensor_commands (sensor, 10, "disable actuator");
+  check_actuator (proxy, HYSCAN_ACTUATOR_MODE_NONE, 0.0, "disable actuator");
+
+  /* Ошибка команды привода не запоминается. */
+  if (hyscan_actuator_manual (proxy_actuator, "unknown", 30.0))
+    g_error ("unknown actuator configured");
+  if (hyscan_actuator_manual (proxy_actuator, "unknown", 30.0))
+    g_error ("unknown actuator configured twice");
+  check_sensor_commands (sensor, 12, "unknown actuator");
+
+  /* После сброса команды передаются устройству. */
+  hyscan_device_proxy_invalidate (proxy);
+  if (!hyscan_sensor_set_enable (proxy_sensor, SENSOR, FALSE))
+    g_error ("can't disable sensor after invalidate");
+  if (!hyscan_actuator_disable (proxy_actuator, ACTUATOR))
+    g_error ("can't disable actuator after invalidate");
+  check_sensor_commands (sensor, 14, "invalidate");
+
+  g_object_unref (proxy);
+  g_object_unref (sensor);
+}
+
+/* Функция проверяет число команд, переданных устройству. */
+static void
+check_commands (HyScanDummyDevice *device,
+                guint              n_commands,
+                const gchar       *step)
+{
+  if (hyscan_dummy_device_get_n_commands (device) != n_commands)
+    {
+      g_error ("%s: %d commands instead of %d", step,
+               hyscan_dummy_device_get_n_commands (device), n_commands);
+    }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanDummyDevice *device;
+  HyScanDeviceProxy *proxy;
+  HyScanSonar *sonar;
+  HyScanSonarConfig *config;
+  HyScanSonarConfigSource *info;
+
+  device = hyscan_dummy_device_new (SOURCE, LATENCY);
+  proxy = hyscan_device_proxy_new (HYSCAN_DEVICE (device));
+  sonar = HYSCAN_SONAR (proxy);
+
+  /* Прокси гидролокатора не реализует интерфейсы датчика и привода. */
+  if (!HYSCAN_IS_SONAR (proxy) || HYSCAN_IS_SENSOR (proxy) || HYSCAN_IS_ACTUATOR (proxy))
+    g_error ("sonar proxy interfaces mismatch");
+
+  /* До первой команды состояние неизвестно. */
+  if (hyscan_device_proxy_get_source (proxy, SOURCE) != NULL)
+    g_error ("state available before commands");
+
+  /* Первая команда передаётся устройству, повторная нет. */
+  if (!hyscan_sonar_tvg_set_constant (sonar, SOURCE, 10.0))
+    g_error ("can't set tvg");
+  check_commands (device, 1, "first tvg");
+
+  if (!hyscan_sonar_tvg_set_constant (sonar, SOURCE, 10.0))
+    g_error ("can't repeat tvg");
+  check_commands (device, 1, "repeated tvg");
+
+  if (!hyscan_sonar_tvg_set_constant (sonar, SOURCE, 20.0))
+    g_error ("can't change tvg");
+  check_commands (device, 2, "changed tvg");
+
+  /* Состояние источника данных. */
+  info = hyscan_device_proxy_get_source (proxy, SOURCE);
+  if ((info == NULL) || !info->tvg_set ||
+      (info->tvg_mode != HYSCAN_SONAR_TVG_MODE_CONSTANT) || (info->tvg_gain != 20.0))
+    {
+      g_error ("tvg state mismatch");
+    }
+  if (info->generator_set || info->receiver_set)
+    g_error ("unknown state reported");
+  hyscan_sonar_config_source_free (info);
+
+  /* Пакетная настройка передаёт только изменившиеся параметры. */
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_tvg_set_constant (config, SOURCE, 20.0);
+  hyscan_sonar_config_generator_set_preset (config, SOURCE, 1);
+  if (!hyscan_sonar_configure (sonar, config))
+    g_error ("can't configure");
+  check_commands (device, 3, "configure");
+
+  if (!hyscan_sonar_configure (sonar, config))
+    g_error ("can't repeat configure");
+  check_commands (device, 3, "repeated configure");
+  g_object_unref (config);
+
+  info = hyscan_device_proxy_get_source (proxy, SOURCE);
+  if ((info == NULL) || !info->generator_set ||
+      !info->generator_enable || (info->generator_preset != 1))
+    {
+      g_error ("generator state mismatch");
+    }
+  hyscan_sonar_config_source_free (info);
+
+  /* Ошибка команды сбрасывает состояние. */
+  if (hyscan_sonar_tvg_set_constant (sonar, HYSCAN_SOURCE_SIDE_SCAN_PORT, 20.0))
+    g_error ("unknown source configured");
+  check_commands (device, 4, "unknown source");
+  if (hyscan_device_proxy_get_source (proxy, HYSCAN_SOURCE_SIDE_SCAN_PORT) != NULL)
+    g_error ("failed command cached");
+
+  /* После сброса команды передаются устройству. */
+  hyscan_device_proxy_invalidate (proxy);
+  if (!hyscan_sonar_tvg_set_constant (sonar, SOURCE, 20.0))
+    g_error ("can't set tvg after invalidate");
+  check_commands (device, 5, "invalidate");
+
+  g_object_unref (proxy);
+  g_object_unref (device);
+
+  check_sensor ();
+
+  g_message ("All done");
+
+  return 0;
+}
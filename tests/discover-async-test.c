@@ -0,0 +1,243 @@
+/* discover-async-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include "hyscan-dummy-discover.h"
+#include <string.h>
+
+#define CALL_TIME              500000          /* Время выполнения операции драйвером, мкс. */
+#define ASYNC_TIMEOUT          0.1             /* Время ожидания операции, с. */
+#define CANCEL_TIME            50              /* Время до отмены операции, мс. */
+#define WAIT_TIMEOUT           5000000         /* Время ожидания завершения операции, мкс. */
+#define N_RACES                32              /* Число операций, завершающихся одновременно с таймаутом. */
+
+typedef struct
+{
+  gint                         calls;          /* Число вызовов функции обратного вызова. */
+  gint64                       time;           /* Время первого вызова. */
+  gboolean                     status;         /* Результат проверки. */
+  HyScanDevice                *device;         /* Подключенное устройство. */
+  GError                      *error;          /* Ошибка. */
+} AsyncResult;
+
+/* Функция обратного вызова асинхронной проверки. */
+static void
+check_ready (GObject      *source,
+             GAsyncResult *res,
+             gpointer      user_data)
+{
+  AsyncResult *result = user_data;
+
+  if (result->calls++ > 0)
+    return;
+
+  result->time = g_get_monotonic_time ();
+  result->status = hyscan_discover_check_finish (HYSCAN_DISCOVER (source), res, &result->error);
+}
+
+/* Функция обратного вызова асинхронного подключения. */
+static void
+connect_ready (GObject      *source,
+               GAsyncResult *res,
+               gpointer      user_data)
+{
+  AsyncResult *result = user_data;
+
+  if (result->calls++ > 0)
+    return;
+
+  result->time = g_get_monotonic_time ();
+  result->device = hyscan_discover_connect_finish (HYSCAN_DISCOVER (source), res, &result->error);
+}
+
+/* Функция отмены операции по таймеру. */
+static gboolean
+cancel (gpointer data)
+{
+  g_cancellable_cancel (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Функция обрабатывает события, пока не будет вызвана функция обратного
+ * вызова или не пройдёт указанное время. */
+static void
+wait_result (AsyncResult *result,
+             gint64       wait_time,
+             const gchar *step)
+{
+  gint64 end_time = g_get_monotonic_time () + wait_time;
+
+  while (g_get_monotonic_time () < end_time)
+    {
+      if ((result != NULL) && (result->calls > 0))
+        return;
+
+      if (!g_main_context_iteration (NULL, FALSE))
+        g_usleep (1000);
+    }
+
+  if (result != NULL)
+    g_error ("%s: callback isn't called", step);
+}
+
+/* Функция проверяет, что операция завершилась указанной ошибкой. */
+static void
+check_error (AsyncResult *result,
+             gint         code,
+             const gchar *step)
+{
+  if (result->calls != 1)
+    g_error ("%s: callback called %d times", step, result->calls);
+
+  if (!g_error_matches (result->error, G_IO_ERROR, code))
+    g_error ("%s: unexpected result %s", step, (result->error != NULL) ? result->error->message : "");
+
+  if (result->status || (result->device != NULL))
+    g_error ("%s: result with error", step);
+}
+
+static void
+clear_result (AsyncResult *result)
+{
+  g_clear_object (&result->device);
+  g_clear_error (&result->error);
+  memset (result, 0, sizeof (AsyncResult));
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanDummyDiscover *dummy;
+  HyScanDiscover *discover;
+  GCancellable *cancellable;
+  AsyncResult result = {0};
+  AsyncResult races[N_RACES];
+  gint64 start;
+  guint i;
+
+  dummy = hyscan_dummy_discover_new ();
+  discover = HYSCAN_DISCOVER (dummy);
+
+  /* Операции без ограничения времени. */
+  hyscan_discover_check_async (discover, HYSCAN_DUMMY_DISCOVER_URI, NULL, 0.0, NULL, check_ready, &result);
+  wait_result (&result, WAIT_TIMEOUT, "check");
+  if (!result.status || (result.error != NULL))
+    g_error ("check: device isn't available");
+  clear_result (&result);
+
+  hyscan_discover_connect_async (discover, HYSCAN_DUMMY_DISCOVER_URI, NULL, 0.0, NULL, connect_ready, &result);
+  wait_result (&result, WAIT_TIMEOUT, "connect");
+  if (!HYSCAN_IS_DEVICE (result.device) || (result.error != NULL))
+    g_error ("connect: can't connect to device");
+  clear_result (&result);
+
+  hyscan_discover_connect_async (discover, "dummy://unknown", NULL, 0.0, NULL, connect_ready, &result);
+  wait_result (&result, WAIT_TIMEOUT, "connect unknown");
+  check_error (&result, G_IO_ERROR_FAILED, "connect unknown");
+  clear_result (&result);
+
+  /* Истечение времени завершает операцию, не дожидаясь драйвера, а
+   * результат драйвера отбрасывается. */
+  hyscan_dummy_discover_set_call_time (dummy, CALL_TIME);
+
+  start = g_get_monotonic_time ();
+  hyscan_discover_connect_async (discover, HYSCAN_DUMMY_DISCOVER_URI, NULL, ASYNC_TIMEOUT, NULL, connect_ready, &result);
+  wait_result (&result, WAIT_TIMEOUT, "connect timeout");
+  if (result.time - start > CALL_TIME / 2)
+    g_error ("connect timeout: callback waits for driver");
+
+  wait_result (NULL, 2 * CALL_TIME, "connect timeout");
+  check_error (&result, G_IO_ERROR_TIMED_OUT, "connect timeout");
+  clear_result (&result);
+
+  /* Отмена завершает операцию, не дожидаясь драйвера. */
+  cancellable = g_cancellable_new ();
+  g_timeout_add (CANCEL_TIME, cancel, cancellable);
+
+  start = g_get_monotonic_time ();
+  hyscan_discover_check_async (discover, HYSCAN_DUMMY_DISCOVER_URI, NULL, 0.0, cancellable, check_ready, &result);
+  wait_result (&result, WAIT_TIMEOUT, "check cancel");
+  if (result.time - start > CALL_TIME / 2)
+    g_error ("check cancel: callback waits for driver");
+
+  wait_result (NULL, 2 * CALL_TIME, "check cancel");
+  check_error (&result, G_IO_ERROR_CANCELLED, "check cancel");
+  clear_result (&result);
+  g_object_unref (cancellable);
+
+  /* Операция, отменённая до запуска, также завершается один раз. */
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+
+  hyscan_discover_check_async (discover, HYSCAN_DUMMY_DISCOVER_URI, NULL, ASYNC_TIMEOUT, cancellable, check_ready, &result);
+  wait_result (&result, WAIT_TIMEOUT, "check cancelled");
+  wait_result (NULL, 2 * CALL_TIME, "check cancelled");
+  check_error (&result, G_IO_ERROR_CANCELLED, "check cancelled");
+  clear_result (&result);
+  g_object_unref (cancellable);
+
+  /* Операции, завершающиеся драйвером одновременно с истечением времени,
+   * завершаются ровно один раз. */
+  hyscan_dummy_discover_set_call_time (dummy, ASYNC_TIMEOUT * G_USEC_PER_SEC);
+
+  memset (races, 0, sizeof (races));
+  for (i = 0; i < N_RACES; i++)
+    {
+      hyscan_discover_check_async (discover, HYSCAN_DUMMY_DISCOVER_URI, NULL, ASYNC_TIMEOUT,
+                                   NULL, check_ready, &races[i]);
+    }
+
+  for (i = 0; i < N_RACES; i++)
+    wait_result (&races[i], WAIT_TIMEOUT, "race");
+
+  wait_result (NULL, 2 * CALL_TIME, "race");
+
+  for (i = 0; i < N_RACES; i++)
+    {
+      if (races[i].calls != 1)
+        g_error ("race: callback called %d times", races[i].calls);
+
+      if (races[i].status == (races[i].error != NULL))
+        g_error ("race: incorrect result");
+
+      clear_result (&races[i]);
+    }
+
+  g_object_unref (dummy);
+
+  g_message ("All done");
+
+  return 0;
+}
@@ -0,0 +1,233 @@
+/* discover-cache-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include "hyscan-dummy-discover.h"
+#include <hyscan-discover-cache.h>
+#include <glib/gstdio.h>
+
+#define CACHE_NAME             "dummy:cache"   /* Название в кэше, содержащее разделитель. */
+#define SCAN_TIME              10000           /* Время поиска устройств, мкс. */
+#define SLOW_SCAN_TIME         60000000        /* Время прерываемого поиска, мкс. */
+#define CHECK_TIME             200000          /* Время проверки устройства, мкс. */
+#define WAIT_TIMEOUT           5000000         /* Время ожидания событий, мкс. */
+
+static gint n_completed = 0;
+static gint n_found = 0;
+static gint n_lost = 0;
+
+static void
+completed (HyScanDiscover *discover)
+{
+  g_atomic_int_inc (&n_completed);
+}
+
+static void
+device_found (HyScanDiscover     *discover,
+              HyScanDiscoverInfo *info)
+{
+  g_atomic_int_inc (&n_found);
+}
+
+static void
+device_lost (HyScanDiscover     *discover,
+             HyScanDiscoverInfo *info)
+{
+  g_atomic_int_inc (&n_lost);
+}
+
+/* Функция ожидает, пока счётчик событий не достигнет указанного значения. */
+static void
+wait_counter (gint        *counter,
+              gint         n,
+              const gchar *step)
+{
+  gint64 start = g_get_monotonic_time ();
+
+  while (g_atomic_int_get (counter) < n)
+    {
+      if (g_get_monotonic_time () - start > WAIT_TIMEOUT)
+        g_error ("%s: timeout", step);
+
+      g_usleep (1000);
+    }
+}
+
+/* Функция создаёт объект кэша и сбрасывает счётчики событий. */
+static HyScanDiscoverCache *
+cache_new (HyScanDummyDiscover *dummy,
+           const gchar         *name)
+{
+  HyScanDiscoverCache *cache;
+
+  g_atomic_int_set (&n_completed, 0);
+  g_atomic_int_set (&n_found, 0);
+  g_atomic_int_set (&n_lost, 0);
+
+  cache = hyscan_discover_cache_new (HYSCAN_DISCOVER (dummy), name, 0.0);
+
+  g_signal_connect (cache, "completed", G_CALLBACK (completed), NULL);
+  g_signal_connect (cache, "device-found", G_CALLBACK (device_found), NULL);
+  g_signal_connect (cache, "device-lost", G_CALLBACK (device_lost), NULL);
+
+  return cache;
+}
+
+/* Функция проверяет число устройств в списке. */
+static void
+check_list (HyScanDiscoverCache *cache,
+            guint                n,
+            const gchar         *step)
+{
+  GList *devices;
+
+  devices = hyscan_discover_list (HYSCAN_DISCOVER (cache));
+  if (g_list_length (devices) != n)
+    g_error ("%s: %u devices instead of %u", step, g_list_length (devices), n);
+
+  if ((devices != NULL) &&
+      (g_strcmp0 (((HyScanDiscoverInfo *) devices->data)->uri, HYSCAN_DUMMY_DISCOVER_URI) != 0))
+    {
+      g_error ("%s: incorrect device uri", step);
+    }
+
+  g_list_free_full (devices, (GDestroyNotify) hyscan_discover_info_free);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanDummyDiscover *dummy;
+  HyScanDiscoverCache *cache;
+  gchar *cache_dir;
+  gchar *cache_path;
+  gchar *hyscan_dir;
+  gint64 timeout;
+
+  /* Кэш во временном каталоге. */
+  cache_dir = g_dir_make_tmp ("discover-cache-XXXXXX", NULL);
+  if (cache_dir == NULL)
+    g_error ("can't create cache directory");
+
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+  g_unsetenv ("HYSCAN_DISCOVER_CACHE");
+
+  /* Результат поиска сохраняется в кэше. */
+  dummy = hyscan_dummy_discover_new ();
+  hyscan_dummy_discover_set_scan_time (dummy, SCAN_TIME);
+  cache = cache_new (dummy, CACHE_NAME);
+
+  check_list (cache, 0, "empty cache");
+  hyscan_discover_start (HYSCAN_DISCOVER (cache));
+  wait_counter (&n_completed, 1, "first scan");
+  check_list (cache, 1, "first scan");
+
+  g_object_unref (cache);
+  g_object_unref (dummy);
+
+  /* Название, являющееся префиксом другого названия, не видит его записи. */
+  dummy = hyscan_dummy_discover_new ();
+  cache = cache_new (dummy, "dummy");
+  check_list (cache, 0, "name prefix");
+  g_object_unref (cache);
+
+  /* Устройство из кэша доступно сразу и проверяется с параметрами по
+   * умолчанию. */
+  cache = cache_new (dummy, CACHE_NAME);
+  check_list (cache, 1, "cached list");
+  wait_counter (&n_found, 1, "cached device check");
+
+  if (hyscan_dummy_discover_get_checks (dummy, &timeout) != 1)
+    g_error ("cached device check: incorrect number of checks");
+  if (timeout != HYSCAN_DUMMY_DISCOVER_TIMEOUT)
+    g_error ("cached device check: default parameters aren't used");
+
+  /* Прерванный поиск не изменяет список и кэш. */
+  hyscan_dummy_discover_set_scan_time (dummy, SLOW_SCAN_TIME);
+  hyscan_discover_start (HYSCAN_DISCOVER (cache));
+  hyscan_discover_stop (HYSCAN_DISCOVER (cache));
+  wait_counter (&n_completed, 1, "aborted scan");
+  check_list (cache, 1, "aborted scan");
+
+  g_object_unref (cache);
+  g_object_unref (dummy);
+
+  /* Недоступное устройство удаляется из списка, но пустой результат поиска
+   * не перезаписывает кэш. */
+  dummy = hyscan_dummy_discover_new ();
+  hyscan_dummy_discover_set_scan_time (dummy, SCAN_TIME);
+  hyscan_dummy_discover_set_available (dummy, FALSE);
+
+  cache = cache_new (dummy, CACHE_NAME);
+  wait_counter (&n_lost, 1, "lost device check");
+  check_list (cache, 0, "lost device check");
+
+  hyscan_discover_start (HYSCAN_DISCOVER (cache));
+  wait_counter (&n_completed, 1, "empty scan");
+  check_list (cache, 0, "empty scan");
+  g_object_unref (cache);
+
+  hyscan_dummy_discover_set_available (dummy, TRUE);
+  cache = cache_new (dummy, CACHE_NAME);
+  check_list (cache, 1, "cache after empty scan");
+
+  /* Объект удаляется во время фоновой проверки. */
+  hyscan_dummy_discover_set_call_time (dummy, CHECK_TIME);
+  g_object_unref (cache);
+
+  cache = cache_new (dummy, CACHE_NAME);
+  g_usleep (CHECK_TIME / 4);
+  g_object_unref (cache);
+
+  g_usleep (2 * CHECK_TIME);
+  if (g_atomic_int_get (&n_found) != 0)
+    g_error ("signal emitted after unref");
+
+  g_object_unref (dummy);
+
+  /* Удаляем временный каталог кэша. */
+  cache_path = g_build_filename (cache_dir, "hyscan", "hyscan-discover.cache", NULL);
+  hyscan_dir = g_path_get_dirname (cache_path);
+  g_unlink (cache_path);
+  g_rmdir (hyscan_dir);
+  g_rmdir (cache_dir);
+
+  g_free (cache_path);
+  g_free (hyscan_dir);
+  g_free (cache_dir);
+
+  g_message ("All done");
+
+  return 0;
+}
@@ -0,0 +1,151 @@
+/* discover-group-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include "hyscan-dummy-discover.h"
+#include <hyscan-discover-group.h>
+
+#define FAST_SCAN_TIME         10000           /* Время поиска быстрым объектом, мкс. */
+#define SLOW_SCAN_TIME         60000000        /* Время поиска зависшим объектом, мкс. */
+#define CALL_TIME              200000          /* Время выполнения функций list и stop, мкс. */
+#define GROUP_TIMEOUT          0.5             /* Общее время поиска, с. */
+#define WAIT_TIMEOUT           5000000         /* Время ожидания завершения поиска, мкс. */
+
+static gint n_completed = 0;
+
+/* Обработчик сигнала completed группы. */
+static void
+completed (HyScanDiscover *discover)
+{
+  g_atomic_int_inc (&n_completed);
+}
+
+/* Функция ожидает завершения поиска и возвращает время с его запуска. */
+static gint64
+wait_completed (gint         n,
+                gint64       start,
+                const gchar *step)
+{
+  while (g_atomic_int_get (&n_completed) < n)
+    {
+      if (g_get_monotonic_time () - start > WAIT_TIMEOUT)
+        g_error ("%s: scan isn't completed", step);
+
+      g_usleep (1000);
+    }
+
+  return g_get_monotonic_time () - start;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanDummyDiscover *fast;
+  HyScanDummyDiscover *slow;
+  HyScanDiscoverGroup *group;
+  HyScanDiscover *discover;
+  GList *devices;
+  gint64 start;
+  gint64 elapsed;
+
+  fast = hyscan_dummy_discover_new ();
+  slow = hyscan_dummy_discover_new ();
+  hyscan_dummy_discover_set_scan_time (fast, FAST_SCAN_TIME);
+  hyscan_dummy_discover_set_scan_time (slow, SLOW_SCAN_TIME);
+
+  group = hyscan_discover_group_new ();
+  discover = HYSCAN_DISCOVER (group);
+  hyscan_discover_group_add (group, HYSCAN_DISCOVER (fast), 1.0);
+  hyscan_discover_group_add (group, HYSCAN_DISCOVER (slow), 1.0);
+  hyscan_discover_group_set_timeout (group, GROUP_TIMEOUT);
+
+  g_signal_connect (group, "completed", G_CALLBACK (completed), NULL);
+
+  /* Зависший объект не задерживает поиск дольше общего времени. */
+  start = g_get_monotonic_time ();
+  hyscan_discover_start (discover);
+  elapsed = wait_completed (1, start, "first scan");
+  if (elapsed < 0.9 * GROUP_TIMEOUT * G_USEC_PER_SEC)
+    g_error ("first scan: completed in %.3f s before timeout", elapsed / 1e6);
+
+  /* Списки устройств запрашиваются у объектов параллельно. */
+  hyscan_dummy_discover_set_call_time (fast, CALL_TIME);
+  hyscan_dummy_discover_set_call_time (slow, CALL_TIME);
+
+  start = g_get_monotonic_time ();
+  devices = hyscan_discover_list (discover);
+  elapsed = g_get_monotonic_time () - start;
+
+  if (g_list_length (devices) != 1)
+    g_error ("list: %u devices instead of 1", g_list_length (devices));
+  if (elapsed > 1.75 * CALL_TIME)
+    g_error ("list: members are called sequentially");
+
+  g_list_free_full (devices, (GDestroyNotify) hyscan_discover_info_free);
+
+  /* Зависший объект останавливается перед новым поиском. Сигнал completed,
+   * посланный им при остановке, не должен завершить новый поиск. */
+  start = g_get_monotonic_time ();
+  hyscan_discover_start (discover);
+  elapsed = wait_completed (2, start, "second scan");
+  if (elapsed < 0.9 * GROUP_TIMEOUT * G_USEC_PER_SEC)
+    g_error ("second scan: stale completion counted");
+
+  /* Поиск останавливается всеми объектами параллельно. */
+  hyscan_discover_start (discover);
+
+  start = g_get_monotonic_time ();
+  hyscan_discover_stop (discover);
+  elapsed = g_get_monotonic_time () - start;
+
+  if (elapsed > 1.75 * CALL_TIME)
+    g_error ("stop: members are called sequentially");
+
+  wait_completed (3, start, "stop");
+
+  /* Удаление группы во время поиска. Поздние сигналы объектов не должны
+   * обращаться к удалённой группе. */
+  hyscan_dummy_discover_set_call_time (slow, 0);
+  hyscan_discover_start (discover);
+  g_object_unref (group);
+
+  g_usleep (2 * FAST_SCAN_TIME);
+
+  g_object_unref (fast);
+  g_object_unref (slow);
+
+  g_message ("All done");
+
+  return 0;
+}
@@ -0,0 +1,142 @@
+/* discover-pool-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include "hyscan-dummy-discover.h"
+#include <hyscan-discover-pool.h>
+
+#define CALL_TIME              200000          /* Время подключения к устройству, мкс. */
+#define N_THREADS              8               /* Число одновременных подключений. */
+
+static HyScanDiscoverPool *pool;
+static HyScanParamList *thread_params;
+
+/* Поток одновременного подключения к устройству. */
+static gpointer
+connect_thread (gpointer data)
+{
+  return hyscan_discover_pool_connect (pool, HYSCAN_DUMMY_DISCOVER_URI, thread_params);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanDummyDiscover *dummy;
+  HyScanParamList *params1;
+  HyScanParamList *params2;
+  HyScanParamList *params3;
+  HyScanDevice *device1;
+  HyScanDevice *device2;
+  HyScanDevice *device3;
+  GThread *threads[N_THREADS];
+  HyScanDevice *devices[N_THREADS];
+  guint i;
+
+  dummy = hyscan_dummy_discover_new ();
+  pool = hyscan_discover_pool_new (HYSCAN_DISCOVER (dummy));
+
+  /* Одинаковые параметры, добавленные в разном порядке. */
+  params1 = hyscan_param_list_new ();
+  hyscan_param_list_set_integer (params1, "/timeout", 5);
+  hyscan_param_list_set_string (params1, "/address", "127.0.0.1");
+
+  params2 = hyscan_param_list_new ();
+  hyscan_param_list_set_string (params2, "/address", "127.0.0.1");
+  hyscan_param_list_set_integer (params2, "/timeout", 5);
+
+  /* Другое значение параметра. */
+  params3 = hyscan_param_list_new ();
+  hyscan_param_list_set_integer (params3, "/timeout", 5);
+  hyscan_param_list_set_string (params3, "/address", "127.0.0.2");
+
+  /* Порядок параметров не влияет на выбор подключения. */
+  device1 = hyscan_discover_pool_connect (pool, HYSCAN_DUMMY_DISCOVER_URI, params1);
+  device2 = hyscan_discover_pool_connect (pool, HYSCAN_DUMMY_DISCOVER_URI, params2);
+  if ((device1 == NULL) || (device1 != device2))
+    g_error ("params order: device isn't shared");
+
+  /* Разные значения параметров - разные подключения. */
+  device3 = hyscan_discover_pool_connect (pool, HYSCAN_DUMMY_DISCOVER_URI, params3);
+  if ((device3 == NULL) || (device3 == device1))
+    g_error ("params values: device is shared");
+
+  /* Подключение закрывается последним пользователем. */
+  g_object_add_weak_pointer (G_OBJECT (device1), (gpointer *)&device1);
+  g_object_add_weak_pointer (G_OBJECT (device3), (gpointer *)&device3);
+
+  hyscan_discover_pool_release (pool, device2);
+  if (device1 == NULL)
+    g_error ("release: device closed with active user");
+
+  hyscan_discover_pool_release (pool, device1);
+  hyscan_discover_pool_release (pool, device3);
+  if ((device1 != NULL) || (device3 != NULL))
+    g_error ("release: device isn't closed");
+
+  /* Ошибка подключения не сохраняется в пуле. */
+  for (i = 0; i < 2; i++)
+    {
+      if (hyscan_discover_pool_connect (pool, "dummy://unknown", NULL) != NULL)
+        g_error ("unknown device connected");
+    }
+
+  /* Одновременные подключения к одному устройству ожидают единственного
+   * подключения. */
+  hyscan_dummy_discover_set_call_time (dummy, CALL_TIME);
+  thread_params = params1;
+
+  for (i = 0; i < N_THREADS; i++)
+    threads[i] = g_thread_new ("pool-connect", connect_thread, NULL);
+  for (i = 0; i < N_THREADS; i++)
+    devices[i] = g_thread_join (threads[i]);
+
+  for (i = 0; i < N_THREADS; i++)
+    {
+      if ((devices[i] == NULL) || (devices[i] != devices[0]))
+        g_error ("concurrent connect: device isn't shared");
+    }
+
+  for (i = 0; i < N_THREADS; i++)
+    hyscan_discover_pool_release (pool, devices[i]);
+
+  g_object_unref (params1);
+  g_object_unref (params2);
+  g_object_unref (params3);
+  g_object_unref (pool);
+  g_object_unref (dummy);
+
+  g_message ("All done");
+
+  return 0;
+}
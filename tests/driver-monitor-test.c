@@ -0,0 +1,318 @@
+/* driver-monitor-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include "hyscan-dummy-discover.h"
+#include <hyscan-driver-monitor.h>
+#include <hyscan-driver.h>
+#include <glib/gstdio.h>
+
+#define WAIT_TIMEOUT           10000000        /* Время ожидания сигнала монитора, мкс. */
+#define MTIME_DELAY            1100000         /* Задержка изменения времени модификации файла, мкс. */
+#define RELOAD_DRIVER_URI      "reload://device"
+
+static gint n_added = 0;
+static gint n_changed = 0;
+
+/* Обработчик сигнала driver-added. */
+static void
+driver_added (HyScanDriverMonitor *monitor,
+              const gchar         *name)
+{
+  g_message ("Driver %s added", name);
+  g_atomic_int_inc (&n_added);
+}
+
+/* Обработчик сигнала driver-changed. */
+static void
+driver_changed (HyScanDriverMonitor *monitor,
+                const gchar         *name)
+{
+  g_message ("Driver %s changed", name);
+  g_atomic_int_inc (&n_changed);
+}
+
+/* Функция ожидает заданного значения счётчика сигналов. */
+static void
+wait_signal (gint        *counter,
+             gint         value,
+             const gchar *step)
+{
+  gint64 end_time = g_get_monotonic_time () + WAIT_TIMEOUT;
+
+  while (g_atomic_int_get (counter) < value)
+    {
+      if (g_get_monotonic_time () > end_time)
+        g_error ("%s: monitor signal timeout", step);
+
+      g_usleep (10000);
+    }
+}
+
+/* Функция копирует файл тестового драйвера. */
+static void
+copy_driver (const gchar *src_path,
+             const gchar *src_name,
+             const gchar *dst_path,
+             const gchar *dst_name)
+{
+  gchar *src;
+  gchar *dst;
+  gchar *data;
+  gsize size;
+
+  src = g_build_filename (src_path, src_name, NULL);
+  dst = g_build_filename (dst_path, dst_name, NULL);
+
+  if (!g_file_get_contents (src, &data, &size, NULL))
+    g_error ("can't read %s", src);
+
+  if (!g_file_set_contents (dst, data, size, NULL))
+    g_error ("can't write %s", dst);
+
+  g_free (src);
+  g_free (dst);
+  g_free (data);
+}
+
+/* Функция проверяет метку тестового драйвера. */
+static void
+check_mark (const gchar *path,
+            const gchar *name,
+            const gchar *key,
+            gint64       mark)
+{
+  HyScanDataSchema *info;
+  GVariant *value;
+
+  info = hyscan_driver_get_info (path, name);
+  if (info == NULL)
+    g_error ("can't get %s driver info", name);
+
+  value = hyscan_data_schema_key_get_default (info, key);
+  if (value == NULL)
+    g_error ("can't get %s driver mark", name);
+
+  if (g_variant_get_int64 (value) != mark)
+    g_error ("%s driver mark %" G_GINT64_FORMAT " instead of %" G_GINT64_FORMAT,
+             name, g_variant_get_int64 (value), mark);
+
+  g_variant_unref (value);
+  g_object_unref (info);
+}
+
+/* Функция загружает драйвер и подключается к устройству. */
+static void
+check_connect (const gchar *path,
+               const gchar *name)
+{
+  HyScanDriver *driver;
+  HyScanDevice *device;
+
+  driver = hyscan_driver_new (path, name);
+  if (driver == NULL)
+    g_error ("can't load driver %s", name);
+
+  device = hyscan_discover_connect (HYSCAN_DISCOVER (driver), HYSCAN_DUMMY_DISCOVER_URI, NULL);
+  if (device == NULL)
+    g_error ("can't connect through driver %s", name);
+
+  g_object_unref (device);
+  g_object_unref (driver);
+}
+
+/* Функция подключается к устройству через драйвер с поддержкой
+ * перезагрузки и проверяет версию драйвера устройства. */
+static HyScanDevice *
+connect_reload (HyScanDriver *driver,
+                gint          mark)
+{
+  HyScanDevice *device;
+
+  device = hyscan_discover_connect (HYSCAN_DISCOVER (driver), RELOAD_DRIVER_URI, NULL);
+  if (device == NULL)
+    g_error ("can't connect through reload driver");
+
+  if (GPOINTER_TO_INT (g_object_get_data (G_OBJECT (device), "reload")) != mark)
+    g_error ("reload driver version mismatch");
+
+  return device;
+}
+
+/* Функция возвращает модуль типов устройства. */
+static GTypeModule *
+device_types (HyScanDevice *device)
+{
+  GTypePlugin *plugin;
+
+  plugin = g_type_get_plugin (G_OBJECT_TYPE (device));
+  if (!G_IS_TYPE_MODULE (plugin))
+    g_error ("device type isn't registered in type module");
+
+  return G_TYPE_MODULE (plugin);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanDriverMonitor *monitor;
+  HyScanDriver *driver1, *driver2;
+  HyScanDevice *device1, *device2, *device3;
+  GTypeModule *types1, *types2;
+  const gchar *path;
+  gchar *tmp_dir;
+  gchar *file_name;
+
+  /* Путь к драйверам. */
+  if (argv[1] == NULL)
+    {
+      g_print ("Usage: driver-monitor-test <path-to-drivers>\n");
+      return -1;
+    }
+
+  path = argv[1];
+
+  tmp_dir = g_dir_make_tmp ("driver-monitor-test-XXXXXX", NULL);
+  if (tmp_dir == NULL)
+    g_error ("can't create temporary directory");
+
+  copy_driver (path, "hyscan-dummy1.drv", tmp_dir, "hyscan-loaded.drv");
+
+  monitor = hyscan_driver_monitor_new (tmp_dir);
+  g_signal_connect (monitor, "driver-added", G_CALLBACK (driver_added), NULL);
+  g_signal_connect (monitor, "driver-changed", G_CALLBACK (driver_changed), NULL);
+
+  /* Загружаем драйвер и подключаемся к устройству. */
+  check_mark (tmp_dir, "loaded", "/dummy", 1);
+  check_connect (tmp_dir, "loaded");
+
+  /* Заменяем загруженный драйвер. Время модификации файла должно измениться. */
+  g_usleep (MTIME_DELAY);
+  copy_driver (path, "hyscan-dummy2.drv", tmp_dir, "hyscan-loaded.drv");
+  wait_signal (&n_changed, 1, "loaded driver replace");
+
+  /* Загруженный драйвер продолжает использоваться до перезапуска программы. */
+  if (hyscan_driver_invalidate (tmp_dir, "loaded"))
+    g_error ("loaded driver invalidated");
+
+  check_mark (tmp_dir, "loaded", "/dummy", 1);
+  check_connect (tmp_dir, "loaded");
+
+  /* Новый драйвер, информация о котором получена без подключения. */
+  copy_driver (path, "hyscan-dummy3.drv", tmp_dir, "hyscan-fresh.drv");
+  wait_signal (&n_added, 1, "fresh driver add");
+  check_mark (tmp_dir, "fresh", "/dummy", 3);
+
+  /* Незагруженный драйвер заменяется новой версией. */
+  g_usleep (MTIME_DELAY);
+  copy_driver (path, "hyscan-dummy4.drv", tmp_dir, "hyscan-fresh.drv");
+  wait_signal (&n_changed, 2, "fresh driver replace");
+
+  check_mark (tmp_dir, "fresh", "/dummy", 4);
+  check_connect (tmp_dir, "fresh");
+
+  /* Драйвер с поддержкой перезагрузки. */
+  copy_driver (path, "hyscan-reload1.drv", tmp_dir, "hyscan-reload.drv");
+  wait_signal (&n_added, 2, "reload driver add");
+
+  driver1 = hyscan_driver_new (tmp_dir, "reload");
+  if (driver1 == NULL)
+    g_error ("can't load reload driver");
+
+  device1 = connect_reload (driver1, 1);
+  types1 = device_types (device1);
+
+  /* Новая версия загружается параллельно с используемой. */
+  g_usleep (MTIME_DELAY);
+  copy_driver (path, "hyscan-reload2.drv", tmp_dir, "hyscan-reload.drv");
+  wait_signal (&n_changed, 3, "reload driver replace");
+
+  if (!hyscan_driver_invalidate (tmp_dir, "reload"))
+    g_error ("reload driver isn't invalidated");
+
+  check_mark (tmp_dir, "reload", "/reload", 2);
+
+  driver2 = hyscan_driver_new (tmp_dir, "reload");
+  if (driver2 == NULL)
+    g_error ("can't load new version of reload driver");
+
+  device2 = connect_reload (driver2, 2);
+  types2 = device_types (device2);
+  if (types1 == types2)
+    g_error ("reload driver versions share type module");
+
+  /* Предыдущая версия выгружается после удаления последнего устройства. */
+  device3 = connect_reload (driver1, 1);
+
+  g_object_unref (driver1);
+  g_object_unref (device1);
+  if (types1->use_count == 0)
+    g_error ("reload driver unloaded while in use");
+
+  g_object_unref (device3);
+  if (types1->use_count != 0)
+    g_error ("reload driver isn't unloaded");
+
+  /* Текущая версия используется реестром до замены драйвера. */
+  g_object_unref (device2);
+  g_object_unref (driver2);
+  if (types2->use_count == 0)
+    g_error ("current reload driver unloaded");
+
+  g_object_unref (monitor);
+
+  file_name = g_build_filename (tmp_dir, "hyscan-reload.drv", NULL);
+  g_unlink (file_name);
+  g_free (file_name);
+
+  hyscan_driver_invalidate (tmp_dir, "reload");
+  if (types2->use_count != 0)
+    g_error ("removed reload driver isn't unloaded");
+
+  /* Удаляем временные файлы. */
+  file_name = g_build_filename (tmp_dir, "hyscan-loaded.drv", NULL);
+  g_unlink (file_name);
+  g_free (file_name);
+
+  file_name = g_build_filename (tmp_dir, "hyscan-fresh.drv", NULL);
+  g_unlink (file_name);
+  g_free (file_name);
+
+  g_rmdir (tmp_dir);
+  g_free (tmp_dir);
+
+  g_message ("All done");
+
+  return 0;
+}
@@ -32,9 +32,42 @@
  * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
  */
 
+#include "hyscan-dummy-discover.h"
+#include <hyscan-driver-schema.h>
+#include <hyscan-driver-profile.h>
 #include <hyscan-driver.h>
 #include <string.h>
 
+#define BUILTIN_DRIVER_MARK    (DUMMY_DRIVER_NUMBER + 1)
+
+/* Функции встроенного драйвера. */
+static HyScanDiscover *
+builtin_discover (void)
+{
+  return HYSCAN_DISCOVER (hyscan_dummy_discover_new ());
+}
+
+static HyScanDataSchema *
+builtin_info (void)
+{
+  HyScanDriverSchema *schema;
+  HyScanDataSchemaBuilder *builder;
+  HyScanDataSchema *info;
+
+  schema = hyscan_driver_schema_new (HYSCAN_DRIVER_SCHEMA_VERSION);
+  builder = HYSCAN_DATA_SCHEMA_BUILDER (schema);
+
+  hyscan_data_schema_builder_key_integer_create (builder, "/dummy",
+                                                 "Dummy mark", "Dummy mark",
+                                                 BUILTIN_DRIVER_MARK);
+
+  info = hyscan_data_schema_builder_get_schema (builder);
+
+  g_object_unref (schema);
+
+  return info;
+}
+
 int
 main (int    argc,
       char **argv)
@@ -51,6 +84,19 @@ main (int    argc,
       return -1;
     }
 
+  /* Время загрузки драйверов. */
+  hyscan_driver_profile_set_enabled (TRUE);
+
+  /* Встроенный драйвер. */
+  {
+    gchar *builtin_name = g_strdup_printf ("%s%d", DUMMY_DRIVER_PREFIX, BUILTIN_DRIVER_MARK);
+
+    if (!hyscan_driver_builtin_register (builtin_name, builtin_discover, builtin_info))
+      g_error ("can't register builtin driver");
+
+    g_free (builtin_name);
+  }
+
   /* Список всех драйверов. */
   path = argv[1];
   names = hyscan_driver_list (path);
@@ -58,6 +104,31 @@ main (int    argc,
   if (names == NULL)
     g_error ("can't get drivers list");
 
+  /* Повторное получение списка из кэша должно совпадать с первым и
+   * выполняться без загрузки драйверов. */
+  {
+    gchar **cached_names;
+    gchar *trace;
+
+    hyscan_driver_profile_clear ();
+    cached_names = hyscan_driver_list (path);
+
+    if ((cached_names == NULL) || (g_strv_length (cached_names) != g_strv_length (names)))
+      g_error ("cached drivers list mismatch");
+
+    for (i = 0; names[i] != NULL; i++)
+      if (!g_strv_contains ((const gchar * const *) cached_names, names[i]))
+        g_error ("driver %s not found in cached list", names[i]);
+
+    trace = hyscan_driver_profile_get_trace ();
+    if ((g_strcmp0 (g_getenv ("HYSCAN_DRIVER_CACHE"), "0") != 0) &&
+        (strstr (trace, "{\"name\":\"load\"") != NULL))
+      g_error ("drivers loaded while listing from cache");
+
+    g_free (trace);
+    g_strfreev (cached_names);
+  }
+
   /* Проверяем работу на драйверах - заглушках (dummy*). */
   for (i = 0; names[i] != NULL; i++)
     {
@@ -103,11 +174,25 @@ main (int    argc,
       num_drv += 1;
     }
 
-  if (num_drv != DUMMY_DRIVER_NUMBER)
+  if (num_drv != DUMMY_DRIVER_NUMBER + 1)
     g_error ("dummy drivers not found");
 
   g_strfreev (names);
 
+  /* Отчёт о времени загрузки драйверов. */
+  {
+    gchar *report = hyscan_driver_profile_get_report ();
+    gchar *trace = hyscan_driver_profile_get_trace ();
+
+    if (strstr (trace, "\"info\"") == NULL)
+      g_error ("drivers profile is empty");
+
+    g_print ("%s", report);
+
+    g_free (report);
+    g_free (trace);
+  }
+
   g_message ("All done");
 
   return 0;
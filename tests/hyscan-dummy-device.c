@@ -0,0 +1,335 @@
+/* hyscan-dummy-device.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/* Класс имитирует гидролокатор с одним источником данных и заданной
+ * задержкой передачи команд. Команда доходит до устройства через
+ * половину задержки, ответ приходит через вторую половину. Устройство
+ * запоминает моменты выполнения команд для проверки согласованности
+ * запуска нескольких устройств и число выполненных команд настройки.
+ * Для проверки отката запуска группы устройство можно настроить на
+ * завершение запуска ошибкой. */
+
+#include "hyscan-dummy-device.h"
+#include <hyscan-sonar-schema.h>
+
+enum
+{
+  PROP_O,
+  PROP_SOURCE,
+  PROP_LATENCY
+};
+
+struct _HyScanDummyDevicePrivate
+{
+  HyScanSourceType             source;         /* Источник данных. */
+  gint64                       latency;        /* Задержка передачи команд, мкс. */
+  HyScanDataSchema            *schema;         /* Схема устройства. */
+
+  gint64                       sync_time;      /* Время синхронизации. */
+  gint64                       start_time;     /* Время запуска. */
+  gint64                       stop_time;      /* Время останова. */
+
+  guint                        n_commands;     /* Число команд настройки. */
+  gboolean                     fail_start;     /* Признак ошибки запуска. */
+};
+
+static void            hyscan_dummy_device_param_interface_init        (HyScanParamInterface  *iface);
+static void            hyscan_dummy_device_device_interface_init       (HyScanDeviceInterface *iface);
+static void            hyscan_dummy_device_sonar_interface_init        (HyScanSonarInterface  *iface);
+
+static void            hyscan_dummy_device_set_property                (GObject               *object,
+                                                                        guint                  prop_id,
+                                                                        const GValue          *value,
+                                                                        GParamSpec            *pspec);
+static void            hyscan_dummy_device_object_constructed          (GObject               *object);
+static void            hyscan_dummy_device_object_finalize             (GObject               *object);
+
+static gint64          hyscan_dummy_device_command                     (HyScanDummyDevice     *dummy);
+
+G_DEFINE_TYPE_WITH_CODE (HyScanDummyDevice, hyscan_dummy_device, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (HyScanDummyDevice)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_PARAM, hyscan_dummy_device_param_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_DEVICE, hyscan_dummy_device_device_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_SONAR, hyscan_dummy_device_sonar_interface_init))
+
+static void
+hyscan_dummy_device_class_init (HyScanDummyDeviceClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = hyscan_dummy_device_set_property;
+  object_class->constructed = hyscan_dummy_device_object_constructed;
+  object_class->finalize = hyscan_dummy_device_object_finalize;
+
+  g_object_class_install_property (object_class, PROP_SOURCE,
+    g_param_spec_int ("source", "Source", "Source type",
+                      HYSCAN_SOURCE_INVALID, HYSCAN_SOURCE_LAST, HYSCAN_SOURCE_INVALID,
+                      G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_class_install_property (object_class, PROP_LATENCY,
+    g_param_spec_int64 ("latency", "Latency", "Command latency",
+                        0, G_MAXINT64, 0,
+                        G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+}
+
+static void
+hyscan_dummy_device_init (HyScanDummyDevice *dummy)
+{
+  dummy->priv = hyscan_dummy_device_get_instance_private (dummy);
+}
+
+static void
+hyscan_dummy_device_set_property (GObject      *object,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  HyScanDummyDevice *dummy = HYSCAN_DUMMY_DEVICE (object);
+  HyScanDummyDevicePrivate *priv = dummy->priv;
+
+  switch (prop_id)
+    {
+    case PROP_SOURCE:
+      priv->source = g_value_get_int (value);
+      break;
+
+    case PROP_LATENCY:
+      priv->latency = g_value_get_int64 (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+hyscan_dummy_device_object_constructed (GObject *object)
+{
+  HyScanDummyDevice *dummy = HYSCAN_DUMMY_DEVICE (object);
+  HyScanDummyDevicePrivate *priv = dummy->priv;
+  HyScanDeviceSchema *device;
+  HyScanSonarSchema *sonar;
+  gchar *dev_id;
+
+  dev_id = g_strdup_printf ("dummy-%d", priv->source);
+
+  device = hyscan_device_schema_new (HYSCAN_DEVICE_SCHEMA_VERSION);
+  sonar = hyscan_sonar_schema_new (device);
+
+  hyscan_sonar_schema_source_add (sonar, priv->source, dev_id, "Dummy sonar", NULL);
+
+  priv->schema = hyscan_data_schema_builder_get_schema (HYSCAN_DATA_SCHEMA_BUILDER (device));
+
+  g_object_unref (sonar);
+  g_object_unref (device);
+  g_free (dev_id);
+}
+
+static void
+hyscan_dummy_device_object_finalize (GObject *object)
+{
+  HyScanDummyDevice *dummy = HYSCAN_DUMMY_DEVICE (object);
+
+  g_object_unref (dummy->priv->schema);
+
+  G_OBJECT_CLASS (hyscan_dummy_device_parent_class)->finalize (object);
+}
+
+/* Функция имитирует выполнение команды устройством и возвращает
+ * момент её выполнения. */
+static gint64
+hyscan_dummy_device_command (HyScanDummyDevice *dummy)
+{
+  gint64 time;
+
+  g_usleep (dummy->priv->latency / 2);
+  time = g_get_monotonic_time ();
+  g_usleep (dummy->priv->latency / 2);
+
+  return time;
+}
+
+static HyScanDataSchema *
+hyscan_dummy_device_param_schema (HyScanParam *param)
+{
+  HyScanDummyDevice *dummy = HYSCAN_DUMMY_DEVICE (param);
+
+  return g_object_ref (dummy->priv->schema);
+}
+
+static gboolean
+hyscan_dummy_device_param_set (HyScanParam     *param,
+                               HyScanParamList *list)
+{
+  return TRUE;
+}
+
+static gboolean
+hyscan_dummy_device_param_get (HyScanParam     *param,
+                               HyScanParamList *list)
+{
+  return TRUE;
+}
+
+static gboolean
+hyscan_dummy_device_device_sync (HyScanDevice *device)
+{
+  HyScanDummyDevice *dummy = HYSCAN_DUMMY_DEVICE (device);
+
+  dummy->priv->sync_time = hyscan_dummy_device_command (dummy);
+
+  return TRUE;
+}
+
+static gboolean
+hyscan_dummy_device_sonar_generator_set_preset (HyScanSonar      *sonar,
+                                                HyScanSourceType  source,
+                                                gint64            preset)
+{
+  HyScanDummyDevice *dummy = HYSCAN_DUMMY_DEVICE (sonar);
+
+  hyscan_dummy_device_command (dummy);
+  g_atomic_int_inc (&dummy->priv->n_commands);
+
+  return (source == dummy->priv->source);
+}
+
+static gboolean
+hyscan_dummy_device_sonar_tvg_set_constant (HyScanSonar      *sonar,
+                                            HyScanSourceType  source,
+                                            gdouble           gain)
+{
+  HyScanDummyDevice *dummy = HYSCAN_DUMMY_DEVICE (sonar);
+
+  hyscan_dummy_device_command (dummy);
+  g_atomic_int_inc (&dummy->priv->n_commands);
+
+  return (source == dummy->priv->source);
+}
+
+static gboolean
+hyscan_dummy_device_sonar_start (HyScanSonar           *sonar,
+                                 const gchar           *project_name,
+                                 const gchar           *track_name,
+                                 HyScanTrackType        track_type,
+                                 const HyScanTrackPlan *track_plan)
+{
+  HyScanDummyDevice *dummy = HYSCAN_DUMMY_DEVICE (sonar);
+
+  if (dummy->priv->fail_start)
+    {
+      hyscan_dummy_device_command (dummy);
+      return FALSE;
+    }
+
+  dummy->priv->start_time = hyscan_dummy_device_command (dummy);
+
+  return TRUE;
+}
+
+static gboolean
+hyscan_dummy_device_sonar_stop (HyScanSonar *sonar)
+{
+  HyScanDummyDevice *dummy = HYSCAN_DUMMY_DEVICE (sonar);
+
+  dummy->priv->stop_time = hyscan_dummy_device_command (dummy);
+
+  return TRUE;
+}
+
+HyScanDummyDevice *
+hyscan_dummy_device_new (HyScanSourceType source,
+                         gint64           latency)
+{
+  return g_object_new (HYSCAN_TYPE_DUMMY_DEVICE,
+                       "source", source,
+                       "latency", latency,
+                       NULL);
+}
+
+gint64
+hyscan_dummy_device_get_sync_time (HyScanDummyDevice *dummy)
+{
+  return dummy->priv->sync_time;
+}
+
+gint64
+hyscan_dummy_device_get_start_time (HyScanDummyDevice *dummy)
+{
+  return dummy->priv->start_time;
+}
+
+gint64
+hyscan_dummy_device_get_stop_time (HyScanDummyDevice *dummy)
+{
+  return dummy->priv->stop_time;
+}
+
+guint
+hyscan_dummy_device_get_n_commands (HyScanDummyDevice *dummy)
+{
+  return g_atomic_int_get (&dummy->priv->n_commands);
+}
+
+void
+hyscan_dummy_device_set_fail_start (HyScanDummyDevice *dummy,
+                                    gboolean           fail_start)
+{
+  dummy->priv->fail_start = fail_start;
+}
+
+static void
+hyscan_dummy_device_param_interface_init (HyScanParamInterface *iface)
+{
+  iface->schema = hyscan_dummy_device_param_schema;
+  iface->set = hyscan_dummy_device_param_set;
+  iface->get = hyscan_dummy_device_param_get;
+}
+
+static void
+hyscan_dummy_device_device_interface_init (HyScanDeviceInterface *iface)
+{
+  iface->sync = hyscan_dummy_device_device_sync;
+  iface->set_sound_velocity = NULL;
+  iface->disconnect = NULL;
+}
+
+static void
+hyscan_dummy_device_sonar_interface_init (HyScanSonarInterface *iface)
+{
+  iface->generator_set_preset = hyscan_dummy_device_sonar_generator_set_preset;
+  iface->tvg_set_constant = hyscan_dummy_device_sonar_tvg_set_constant;
+  iface->start = hyscan_dummy_device_sonar_start;
+  iface->stop = hyscan_dummy_device_sonar_stop;
+}
@@ -0,0 +1,91 @@
+/* hyscan-dummy-device.h
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#ifndef __HYSCAN_DUMMY_DEVICE_H__
+#define __HYSCAN_DUMMY_DEVICE_H__
+
+#include <hyscan-sonar.h>
+#include <hyscan-param.h>
+
+G_BEGIN_DECLS
+
+#define HYSCAN_TYPE_DUMMY_DEVICE             (hyscan_dummy_device_get_type ())
+#define HYSCAN_DUMMY_DEVICE(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_DUMMY_DEVICE, HyScanDummyDevice))
+#define HYSCAN_IS_DUMMY_DEVICE(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_DUMMY_DEVICE))
+#define HYSCAN_DUMMY_DEVICE_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), HYSCAN_TYPE_DUMMY_DEVICE, HyScanDummyDeviceClass))
+#define HYSCAN_IS_DUMMY_DEVICE_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), HYSCAN_TYPE_DUMMY_DEVICE))
+#define HYSCAN_DUMMY_DEVICE_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), HYSCAN_TYPE_DUMMY_DEVICE, HyScanDummyDeviceClass))
+
+typedef struct _HyScanDummyDevice HyScanDummyDevice;
+typedef struct _HyScanDummyDevicePrivate HyScanDummyDevicePrivate;
+typedef struct _HyScanDummyDeviceClass HyScanDummyDeviceClass;
+
+struct _HyScanDummyDevice
+{
+  GObject parent_instance;
+
+  HyScanDummyDevicePrivate *priv;
+};
+
+struct _HyScanDummyDeviceClass
+{
+  GObjectClass parent_class;
+};
+
+HYSCAN_API
+GType                          hyscan_dummy_device_get_type            (void);
+
+HYSCAN_API
+HyScanDummyDevice *            hyscan_dummy_device_new                 (HyScanSourceType       source,
+                                                                        gint64                 latency);
+
+HYSCAN_API
+gint64                         hyscan_dummy_device_get_sync_time       (HyScanDummyDevice     *dummy);
+
+HYSCAN_API
+gint64                         hyscan_dummy_device_get_start_time      (HyScanDummyDevice     *dummy);
+
+HYSCAN_API
+gint64                         hyscan_dummy_device_get_stop_time       (HyScanDummyDevice     *dummy);
+
+HYSCAN_API
+guint                          hyscan_dummy_device_get_n_commands      (HyScanDummyDevice     *dummy);
+
+HYSCAN_API
+void                           hyscan_dummy_device_set_fail_start      (HyScanDummyDevice     *dummy,
+                                                                        gboolean               fail_start);
+
+G_END_DECLS
+
+#endif /* __HYSCAN_DUMMY_DEVICE_H__ */
@@ -33,20 +33,260 @@
  */
 
 #include "hyscan-dummy-discover.h"
+#include "hyscan-dummy-device.h"
+#include <hyscan-data-schema-builder.h>
 
-static void    hyscan_dummy_discover_interface_init           (HyScanDiscoverInterface *iface);
+struct _HyScanDummyDiscoverPrivate
+{
+  GMutex                       lock;           /* Блокировка. */
+  GCond                        cond;           /* Сигнализатор остановки поиска. */
+
+  GThread                     *scan;           /* Поток поиска устройств. */
+  gboolean                     stop;           /* Признак остановки поиска. */
+
+  gint64                       scan_time;      /* Время поиска устройств, мкс. */
+  gint64                       call_time;      /* Время выполнения функций list, stop, check и connect, мкс. */
+  gboolean                     available;      /* Признак доступности устройства. */
+
+  guint                        checks;         /* Число проверок устройства. */
+  gint64                       check_timeout;  /* Параметр /timeout последней проверки. */
+
+  GList                       *devices;        /* Найденные устройства. */
+  guint                        generation;     /* Номер изменения списка устройств. */
+};
+
+static void        hyscan_dummy_discover_interface_init       (HyScanDiscoverInterface *iface);
+static void        hyscan_dummy_discover_object_finalize      (GObject                 *object);
+static gboolean    hyscan_dummy_discover_scan_stop            (HyScanDummyDiscover     *dummy);
 
 G_DEFINE_TYPE_WITH_CODE (HyScanDummyDiscover, hyscan_dummy_discover, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (HyScanDummyDiscover)
                          G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_DISCOVER, hyscan_dummy_discover_interface_init))
 
 static void
 hyscan_dummy_discover_class_init (HyScanDummyDiscoverClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = hyscan_dummy_discover_object_finalize;
 }
 
 static void
 hyscan_dummy_discover_init (HyScanDummyDiscover *dummy)
 {
+  dummy->priv = hyscan_dummy_discover_get_instance_private (dummy);
+
+  g_mutex_init (&dummy->priv->lock);
+  g_cond_init (&dummy->priv->cond);
+  dummy->priv->generation = 1;
+  dummy->priv->available = TRUE;
+  dummy->priv->check_timeout = -1;
+}
+
+static void
+hyscan_dummy_discover_object_finalize (GObject *object)
+{
+  HyScanDummyDiscover *dummy = HYSCAN_DUMMY_DISCOVER (object);
+  HyScanDummyDiscoverPrivate *priv = dummy->priv;
+
+  hyscan_dummy_discover_scan_stop (dummy);
+
+  g_list_free_full (priv->devices, (GDestroyNotify) hyscan_discover_info_free);
+
+  g_mutex_clear (&priv->lock);
+  g_cond_clear (&priv->cond);
+
+  G_OBJECT_CLASS (hyscan_dummy_discover_parent_class)->finalize (object);
+}
+
+/* Функция копирования информации об устройстве для g_list_copy_deep. */
+static gpointer
+hyscan_dummy_discover_info_copy (gconstpointer src,
+                                 gpointer      data)
+{
+  return hyscan_discover_info_copy ((HyScanDiscoverInfo *) src);
+}
+
+/* Поток поиска устройств. */
+static gpointer
+hyscan_dummy_discover_scan (gpointer data)
+{
+  HyScanDummyDiscover *dummy = data;
+  HyScanDummyDiscoverPrivate *priv = dummy->priv;
+  HyScanDiscoverInfo *info = NULL;
+  gint64 end_time;
+  gboolean stop;
+
+  g_mutex_lock (&priv->lock);
+
+  end_time = g_get_monotonic_time () + priv->scan_time;
+  while (!priv->stop && g_cond_wait_until (&priv->cond, &priv->lock, end_time));
+
+  stop = priv->stop;
+  if (!stop && priv->available && (priv->devices == NULL))
+    {
+      info = hyscan_discover_info_new ("Dummy", NULL, HYSCAN_DUMMY_DISCOVER_URI, FALSE);
+      priv->devices = g_list_append (priv->devices, hyscan_discover_info_copy (info));
+      priv->generation += 1;
+    }
+
+  g_mutex_unlock (&priv->lock);
+
+  if (stop)
+    return NULL;
+
+  if (info != NULL)
+    g_signal_emit_by_name (dummy, "device-found", info);
+
+  g_signal_emit_by_name (dummy, "completed");
+
+  g_clear_pointer (&info, hyscan_discover_info_free);
+
+  return NULL;
+}
+
+/* Функция останавливает поток поиска устройств. Функция возвращает TRUE,
+ * если поиск был прерван до завершения. */
+static gboolean
+hyscan_dummy_discover_scan_stop (HyScanDummyDiscover *dummy)
+{
+  HyScanDummyDiscoverPrivate *priv = dummy->priv;
+  gboolean active;
+  GThread *scan;
+
+  g_mutex_lock (&priv->lock);
+  scan = priv->scan;
+  priv->scan = NULL;
+  priv->stop = TRUE;
+  g_cond_signal (&priv->cond);
+  g_mutex_unlock (&priv->lock);
+
+  if (scan == NULL)
+    return FALSE;
+
+  active = TRUE;
+  if (scan != g_thread_self ())
+    {
+      g_thread_join (scan);
+    }
+  else
+    {
+      g_thread_unref (scan);
+      active = FALSE;
+    }
+
+  return active;
+}
+
+static void
+hyscan_dummy_discover_start (HyScanDiscover *discover)
+{
+  HyScanDummyDiscover *dummy = HYSCAN_DUMMY_DISCOVER (discover);
+  HyScanDummyDiscoverPrivate *priv = dummy->priv;
+
+  hyscan_dummy_discover_scan_stop (dummy);
+
+  g_mutex_lock (&priv->lock);
+  priv->stop = FALSE;
+  priv->scan = g_thread_new ("dummy-discover", hyscan_dummy_discover_scan, dummy);
+  g_mutex_unlock (&priv->lock);
+}
+
+static void
+hyscan_dummy_discover_stop (HyScanDiscover *discover)
+{
+  HyScanDummyDiscover *dummy = HYSCAN_DUMMY_DISCOVER (discover);
+
+  g_usleep (dummy->priv->call_time);
+
+  /* Прерванный поиск завершается сигналом completed. */
+  if (hyscan_dummy_discover_scan_stop (dummy))
+    g_signal_emit_by_name (dummy, "completed");
+}
+
+static GList *
+hyscan_dummy_discover_list (HyScanDiscover *discover)
+{
+  HyScanDummyDiscover *dummy = HYSCAN_DUMMY_DISCOVER (discover);
+  HyScanDummyDiscoverPrivate *priv = dummy->priv;
+  GList *devices;
+
+  g_usleep (priv->call_time);
+
+  g_mutex_lock (&priv->lock);
+  devices = g_list_copy_deep (priv->devices, hyscan_dummy_discover_info_copy, NULL);
+  g_mutex_unlock (&priv->lock);
+
+  return devices;
+}
+
+static guint
+hyscan_dummy_discover_get_generation (HyScanDiscover *discover)
+{
+  HyScanDummyDiscover *dummy = HYSCAN_DUMMY_DISCOVER (discover);
+  guint generation;
+
+  g_mutex_lock (&dummy->priv->lock);
+  generation = dummy->priv->generation;
+  g_mutex_unlock (&dummy->priv->lock);
+
+  return generation;
+}
+
+static HyScanDataSchema *
+hyscan_dummy_discover_config (HyScanDiscover *discover,
+                              const gchar    *uri)
+{
+  HyScanDataSchemaBuilder *builder;
+  HyScanDataSchema *schema;
+
+  if (g_strcmp0 (uri, HYSCAN_DUMMY_DISCOVER_URI) != 0)
+    return NULL;
+
+  builder = hyscan_data_schema_builder_new ("dummy");
+  hyscan_data_schema_builder_key_integer_create (builder, "/timeout", "Timeout", "Connection timeout",
+                                                 HYSCAN_DUMMY_DISCOVER_TIMEOUT);
+  schema = hyscan_data_schema_builder_get_schema (builder);
+  g_object_unref (builder);
+
+  return schema;
+}
+
+static gboolean
+hyscan_dummy_discover_check (HyScanDiscover  *discover,
+                             const gchar     *uri,
+                             HyScanParamList *params)
+{
+  HyScanDummyDiscover *dummy = HYSCAN_DUMMY_DISCOVER (discover);
+  HyScanDummyDiscoverPrivate *priv = dummy->priv;
+  gboolean available;
+
+  g_usleep (priv->call_time);
+
+  g_mutex_lock (&priv->lock);
+  priv->checks += 1;
+  priv->check_timeout = -1;
+  if ((params != NULL) && hyscan_param_list_contains (params, "/timeout"))
+    priv->check_timeout = hyscan_param_list_get_integer (params, "/timeout");
+  available = priv->available;
+  g_mutex_unlock (&priv->lock);
+
+  return available && (g_strcmp0 (uri, HYSCAN_DUMMY_DISCOVER_URI) == 0);
+}
+
+static HyScanDevice *
+hyscan_dummy_discover_connect (HyScanDiscover  *discover,
+                               const gchar     *uri,
+                               HyScanParamList *params)
+{
+  HyScanDummyDiscover *dummy = HYSCAN_DUMMY_DISCOVER (discover);
+
+  g_usleep (dummy->priv->call_time);
+
+  if (g_strcmp0 (uri, HYSCAN_DUMMY_DISCOVER_URI) != 0)
+    return NULL;
+
+  return HYSCAN_DEVICE (hyscan_dummy_device_new (HYSCAN_SOURCE_SIDE_SCAN_STARBOARD, 0));
 }
 
 HyScanDummyDiscover *
@@ -55,13 +295,63 @@ hyscan_dummy_discover_new (void)
   return g_object_new (HYSCAN_TYPE_DUMMY_DISCOVER, NULL);
 }
 
+/* Функция задаёт время поиска устройств. За это время находится
+ * устройство HYSCAN_DUMMY_DISCOVER_URI. */
+void
+hyscan_dummy_discover_set_scan_time (HyScanDummyDiscover *dummy,
+                                     gint64               scan_time)
+{
+  g_mutex_lock (&dummy->priv->lock);
+  dummy->priv->scan_time = scan_time;
+  g_mutex_unlock (&dummy->priv->lock);
+}
+
+/* Функция задаёт время выполнения функций list, stop, check и connect. */
+void
+hyscan_dummy_discover_set_call_time (HyScanDummyDiscover *dummy,
+                                     gint64               call_time)
+{
+  g_mutex_lock (&dummy->priv->lock);
+  dummy->priv->call_time = call_time;
+  g_mutex_unlock (&dummy->priv->lock);
+}
+
+/* Функция задаёт доступность устройства. Недоступное устройство не
+ * находится при поиске и не проходит проверку. */
+void
+hyscan_dummy_discover_set_available (HyScanDummyDiscover *dummy,
+                                     gboolean             available)
+{
+  g_mutex_lock (&dummy->priv->lock);
+  dummy->priv->available = available;
+  g_mutex_unlock (&dummy->priv->lock);
+}
+
+/* Функция возвращает число проверок устройства и значение параметра
+ * /timeout последней проверки или -1, если параметр не передавался. */
+guint
+hyscan_dummy_discover_get_checks (HyScanDummyDiscover *dummy,
+                                  gint64              *timeout)
+{
+  guint checks;
+
+  g_mutex_lock (&dummy->priv->lock);
+  checks = dummy->priv->checks;
+  if (timeout != NULL)
+    *timeout = dummy->priv->check_timeout;
+  g_mutex_unlock (&dummy->priv->lock);
+
+  return checks;
+}
+
 static void
 hyscan_dummy_discover_interface_init (HyScanDiscoverInterface *iface)
 {
-  iface->start = NULL;
-  iface->stop = NULL;
-  iface->list = NULL;
-  iface->check = NULL;
-  iface->config = NULL;
-  iface->connect = NULL;
+  iface->start = hyscan_dummy_discover_start;
+  iface->stop = hyscan_dummy_discover_stop;
+  iface->list = hyscan_dummy_discover_list;
+  iface->check = hyscan_dummy_discover_check;
+  iface->config = hyscan_dummy_discover_config;
+  iface->connect = hyscan_dummy_discover_connect;
+  iface->get_generation = hyscan_dummy_discover_get_generation;
 }
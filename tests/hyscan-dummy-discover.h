@@ -39,6 +39,9 @@
 
 G_BEGIN_DECLS
 
+#define HYSCAN_DUMMY_DISCOVER_URI              "dummy://device"
+#define HYSCAN_DUMMY_DISCOVER_TIMEOUT          5
+
 #define HYSCAN_TYPE_DUMMY_DISCOVER             (hyscan_dummy_discover_get_type ())
 #define HYSCAN_DUMMY_DISCOVER(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), HYSCAN_TYPE_DUMMY_DISCOVER, HyScanDummyDiscover))
 #define HYSCAN_IS_DUMMY_DISCOVER(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), HYSCAN_TYPE_DUMMY_DISCOVER))
@@ -63,10 +66,26 @@ struct _HyScanDummyDiscoverClass
 };
 
 HYSCAN_API
-GType                          hyscan_dummy_discover_get_type  (void);
+GType                  hyscan_dummy_discover_get_type          (void);
+
+HYSCAN_API
+HyScanDummyDiscover *  hyscan_dummy_discover_new               (void);
+
+HYSCAN_API
+void                   hyscan_dummy_discover_set_scan_time     (HyScanDummyDiscover   *dummy,
+                                                                gint64                 scan_time);
+
+HYSCAN_API
+void                   hyscan_dummy_discover_set_call_time     (HyScanDummyDiscover   *dummy,
+                                                                gint64                 call_time);
+
+HYSCAN_API
+void                   hyscan_dummy_discover_set_available     (HyScanDummyDiscover   *dummy,
+                                                                gboolean               available);
 
 HYSCAN_API
-HyScanDummyDiscover *          hyscan_dummy_discover_new       (void);
+guint                  hyscan_dummy_discover_get_checks        (HyScanDummyDiscover   *dummy,
+                                                                gint64                *timeout);
 
 G_END_DECLS
 
@@ -0,0 +1,134 @@
+/* reload-driver.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/* Тестовый драйвер с поддержкой перезагрузки.
+ *
+ * Все типы драйвера регистрируются в модуле типов, переданном функции
+ * hyscan_driver_reloadable, под названиями, уникальными для каждой
+ * загруженной версии драйвера. Устройства, подключаемые через драйвер,
+ * содержат метку версии драйвера RELOAD в данных объекта "reload". */
+
+#include <hyscan-driver-schema.h>
+#include <hyscan-driver.h>
+#include <gmodule.h>
+
+#define RELOAD_DRIVER_URI      "reload://device"
+
+static GType reload_discover_type = G_TYPE_INVALID;
+static GType reload_device_type = G_TYPE_INVALID;
+
+static gboolean
+reload_discover_check (HyScanDiscover  *discover,
+                       const gchar     *uri,
+                       HyScanParamList *params)
+{
+  return (g_strcmp0 (uri, RELOAD_DRIVER_URI) == 0);
+}
+
+static HyScanDevice *
+reload_discover_connect (HyScanDiscover  *discover,
+                         const gchar     *uri,
+                         HyScanParamList *params)
+{
+  GObject *device;
+
+  if (g_strcmp0 (uri, RELOAD_DRIVER_URI) != 0)
+    return NULL;
+
+  device = g_object_new (reload_device_type, NULL);
+  g_object_set_data (device, "reload", GINT_TO_POINTER (RELOAD));
+
+  return HYSCAN_DEVICE (device);
+}
+
+static void
+reload_discover_interface_init (HyScanDiscoverInterface *iface)
+{
+  iface->start = NULL;
+  iface->stop = NULL;
+  iface->list = NULL;
+  iface->check = reload_discover_check;
+  iface->config = NULL;
+  iface->connect = reload_discover_connect;
+}
+
+G_MODULE_EXPORT void
+hyscan_driver_reloadable (GTypeModule *module)
+{
+  GTypeInfo object_info = { sizeof (GObjectClass), NULL, NULL, NULL, NULL, NULL, sizeof (GObject), 0, NULL, NULL };
+  GInterfaceInfo discover_info = { (GInterfaceInitFunc)(void (*)(void)) reload_discover_interface_init, NULL, NULL };
+  GInterfaceInfo device_info = { NULL, NULL, NULL };
+  gchar *type_name;
+
+  /* Названия типов уникальны для каждой загруженной версии драйвера. */
+  type_name = g_strdup_printf ("HyScanReloadDiscover-%s", module->name);
+  reload_discover_type = g_type_module_register_type (module, G_TYPE_OBJECT, type_name, &object_info, 0);
+  g_type_module_add_interface (module, reload_discover_type, HYSCAN_TYPE_DISCOVER, &discover_info);
+  g_free (type_name);
+
+  type_name = g_strdup_printf ("HyScanReloadDevice-%s", module->name);
+  reload_device_type = g_type_module_register_type (module, G_TYPE_OBJECT, type_name, &object_info, 0);
+  g_type_module_add_interface (module, reload_device_type, HYSCAN_TYPE_DEVICE, &device_info);
+  g_free (type_name);
+}
+
+G_MODULE_EXPORT gpointer
+hyscan_driver_discover (void)
+{
+  if (reload_discover_type == G_TYPE_INVALID)
+    return NULL;
+
+  return g_object_new (reload_discover_type, NULL);
+}
+
+G_MODULE_EXPORT gpointer
+hyscan_driver_info (void)
+{
+  HyScanDriverSchema *schema;
+  HyScanDataSchemaBuilder *builder;
+  HyScanDataSchema *info;
+
+  schema = hyscan_driver_schema_new (HYSCAN_DRIVER_SCHEMA_VERSION);
+  builder = HYSCAN_DATA_SCHEMA_BUILDER (schema);
+
+  hyscan_data_schema_builder_key_integer_create (builder, "/reload",
+                                                 "Reload mark", "Reload mark",
+                                                 RELOAD);
+
+  info = hyscan_data_schema_builder_get_schema (builder);
+
+  g_object_unref (schema);
+
+  return info;
+}
@@ -0,0 +1,317 @@
+/* sonar-configure-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include <hyscan-sonar.h>
+#include <hyscan-sonar-config.h>
+
+#define STARBOARD              HYSCAN_SOURCE_SIDE_SCAN_STARBOARD
+#define PORT                   HYSCAN_SOURCE_SIDE_SCAN_PORT
+
+/* Гидролокатор без пакетной настройки. Выполненные команды записываются
+ * в журнал, команда с именем fail завершается ошибкой. */
+typedef struct
+{
+  GObject                      parent_instance;
+
+  GString                     *log;
+  const gchar                 *fail;
+} TestSonar;
+
+typedef struct
+{
+  GObjectClass                 parent_class;
+} TestSonarClass;
+
+static void    test_sonar_interface_init       (HyScanSonarInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestSonar, test_sonar, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_SONAR, test_sonar_interface_init))
+
+static void
+test_sonar_finalize (GObject *object)
+{
+  TestSonar *sonar = (TestSonar *) object;
+
+  g_string_free (sonar->log, TRUE);
+
+  G_OBJECT_CLASS (test_sonar_parent_class)->finalize (object);
+}
+
+static void
+test_sonar_class_init (TestSonarClass *klass)
+{
+  G_OBJECT_CLASS (klass)->finalize = test_sonar_finalize;
+}
+
+static void
+test_sonar_init (TestSonar *sonar)
+{
+  sonar->log = g_string_new (NULL);
+}
+
+/* Функция возвращает краткое название источника данных для журнала. */
+static const gchar *
+test_sonar_source_name (HyScanSourceType source)
+{
+  switch (source)
+    {
+    case STARBOARD:
+      return "starboard";
+
+    case PORT:
+      return "port";
+
+    case HYSCAN_SOURCE_PROFILER:
+      return "profiler";
+
+    default:
+      return "unknown";
+    }
+}
+
+/* Функция записывает команду в журнал. */
+static gboolean
+test_sonar_command (HyScanSonar      *sonar,
+                    HyScanSourceType  source,
+                    const gchar      *command)
+{
+  TestSonar *test = (TestSonar *) sonar;
+
+  g_string_append_printf (test->log, "%s:%s ", test_sonar_source_name (source), command);
+
+  return g_strcmp0 (test->fail, command) != 0;
+}
+
+static gboolean
+test_sonar_antenna_set_offset (HyScanSonar               *sonar,
+                               HyScanSourceType           source,
+                               const HyScanAntennaOffset *offset)
+{
+  return test_sonar_command (sonar, source, "offset");
+}
+
+static gboolean
+test_sonar_receiver_set_time (HyScanSonar      *sonar,
+                              HyScanSourceType  source,
+                              gdouble           receive_time,
+                              gdouble           wait_time)
+{
+  return test_sonar_command (sonar, source, "receiver-time");
+}
+
+static gboolean
+test_sonar_receiver_set_auto (HyScanSonar      *sonar,
+                              HyScanSourceType  source)
+{
+  return test_sonar_command (sonar, source, "receiver-auto");
+}
+
+static gboolean
+test_sonar_receiver_disable (HyScanSonar      *sonar,
+                             HyScanSourceType  source)
+{
+  return test_sonar_command (sonar, source, "receiver-disable");
+}
+
+static gboolean
+test_sonar_generator_set_preset (HyScanSonar      *sonar,
+                                 HyScanSourceType  source,
+                                 gint64            preset)
+{
+  return test_sonar_command (sonar, source, "generator-preset");
+}
+
+static gboolean
+test_sonar_generator_disable (HyScanSonar      *sonar,
+                              HyScanSourceType  source)
+{
+  return test_sonar_command (sonar, source, "generator-disable");
+}
+
+static gboolean
+test_sonar_tvg_set_auto (HyScanSonar      *sonar,
+                         HyScanSourceType  source,
+                         gdouble           level,
+                         gdouble           sensitivity)
+{
+  return test_sonar_command (sonar, source, "tvg-auto");
+}
+
+static gboolean
+test_sonar_tvg_set_constant (HyScanSonar      *sonar,
+                             HyScanSourceType  source,
+                             gdouble           gain)
+{
+  return test_sonar_command (sonar, source, "tvg-constant");
+}
+
+static gboolean
+test_sonar_tvg_set_linear_db (HyScanSonar      *sonar,
+                              HyScanSourceType  source,
+                              gdouble           gain0,
+                              gdouble           gain_step)
+{
+  return test_sonar_command (sonar, source, "tvg-linear-db");
+}
+
+static gboolean
+test_sonar_tvg_set_logarithmic (HyScanSonar      *sonar,
+                                HyScanSourceType  source,
+                                gdouble           gain0,
+                                gdouble           beta,
+                                gdouble           alpha)
+{
+  return test_sonar_command (sonar, source, "tvg-logarithmic");
+}
+
+static gboolean
+test_sonar_tvg_disable (HyScanSonar      *sonar,
+                        HyScanSourceType  source)
+{
+  return test_sonar_command (sonar, source, "tvg-disable");
+}
+
+static void
+test_sonar_interface_init (HyScanSonarInterface *iface)
+{
+  iface->antenna_set_offset = test_sonar_antenna_set_offset;
+  iface->receiver_set_time = test_sonar_receiver_set_time;
+  iface->receiver_set_auto = test_sonar_receiver_set_auto;
+  iface->receiver_disable = test_sonar_receiver_disable;
+  iface->generator_set_preset = test_sonar_generator_set_preset;
+  iface->generator_disable = test_sonar_generator_disable;
+  iface->tvg_set_auto = test_sonar_tvg_set_auto;
+  iface->tvg_set_constant = test_sonar_tvg_set_constant;
+  iface->tvg_set_linear_db = test_sonar_tvg_set_linear_db;
+  iface->tvg_set_logarithmic = test_sonar_tvg_set_logarithmic;
+  iface->tvg_disable = test_sonar_tvg_disable;
+}
+
+/* Функция применяет параметры и проверяет результат и журнал команд. */
+static void
+check_configure (HyScanSonarConfig *config,
+                 const gchar       *fail,
+                 gboolean           status,
+                 const gchar       *expected,
+                 const gchar       *step)
+{
+  TestSonar *sonar;
+
+  sonar = g_object_new (test_sonar_get_type (), NULL);
+  sonar->fail = fail;
+
+  if (hyscan_sonar_configure (HYSCAN_SONAR (sonar), config) != status)
+    g_error ("%s: wrong configure status", step);
+
+  g_message ("%s: executed %s", step, sonar->log->str);
+
+  if (g_strcmp0 (sonar->log->str, expected) != 0)
+    g_error ("%s: expected %s", step, expected);
+
+  g_object_unref (sonar);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanSonarConfig *config;
+  HyScanAntennaOffset offset = { 0 };
+
+  /* Параметры подсистем задаются в обратном порядке, но применяются
+   * в порядке: смещение антенны, приёмник, генератор, ВАРУ. */
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_tvg_set_constant (config, STARBOARD, 10.0);
+  hyscan_sonar_config_generator_set_preset (config, STARBOARD, 1);
+  hyscan_sonar_config_receiver_set_time (config, STARBOARD, 0.1, 0.0);
+  hyscan_sonar_config_antenna_set_offset (config, STARBOARD, &offset);
+  hyscan_sonar_config_tvg_set_auto (config, PORT, 0.5, 0.5);
+  hyscan_sonar_config_receiver_set_auto (config, PORT);
+
+  check_configure (config, NULL, TRUE,
+                   "starboard:offset starboard:receiver-time "
+                   "starboard:generator-preset starboard:tvg-constant "
+                   "port:receiver-auto port:tvg-auto ",
+                   "order");
+
+  /* Настройка прекращается на первой ошибке, в том числе для следующих
+   * источников данных. */
+  check_configure (config, "offset", FALSE,
+                   "starboard:offset ",
+                   "offset failure");
+  check_configure (config, "receiver-time", FALSE,
+                   "starboard:offset starboard:receiver-time ",
+                   "receiver failure");
+  check_configure (config, "generator-preset", FALSE,
+                   "starboard:offset starboard:receiver-time "
+                   "starboard:generator-preset ",
+                   "generator failure");
+  check_configure (config, "tvg-auto", FALSE,
+                   "starboard:offset starboard:receiver-time "
+                   "starboard:generator-preset starboard:tvg-constant "
+                   "port:receiver-auto port:tvg-auto ",
+                   "tvg failure");
+
+  g_object_unref (config);
+
+  /* Подсистемы, параметры которых не задавались, не настраиваются. */
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_generator_set_preset (config, STARBOARD, 1);
+
+  check_configure (config, NULL, TRUE,
+                   "starboard:generator-preset ",
+                   "generator only");
+
+  g_object_unref (config);
+
+  /* Отключение подсистем и остальные режимы. */
+  config = hyscan_sonar_config_new ();
+  hyscan_sonar_config_receiver_disable (config, STARBOARD);
+  hyscan_sonar_config_generator_disable (config, STARBOARD);
+  hyscan_sonar_config_tvg_disable (config, STARBOARD);
+  hyscan_sonar_config_tvg_set_linear_db (config, PORT, 1.0, 2.0);
+  hyscan_sonar_config_tvg_set_logarithmic (config, HYSCAN_SOURCE_PROFILER, 1.0, 2.0, 3.0);
+
+  check_configure (config, NULL, TRUE,
+                   "starboard:receiver-disable starboard:generator-disable "
+                   "starboard:tvg-disable port:tvg-linear-db "
+                   "profiler:tvg-logarithmic ",
+                   "disable");
+
+  g_object_unref (config);
+
+  g_message ("All done");
+
+  return 0;
+}
@@ -0,0 +1,311 @@
+/* uart-capture-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/* Тест записи и воспроизведения данных UART порта.
+ *
+ * Данные передаются в порт через псевдотерминал порциями с заданным
+ * интервалом и записываются в файл функцией hyscan_uart_capture_start.
+ * Запись включается до открытия порта. Проверяется заголовок файла, данные
+ * и метки времени записей. Затем файл воспроизводится утилитой uart-replay
+ * и проверяются принятые данные и интервалы между порциями. */
+
+#define _GNU_SOURCE
+
+#include <hyscan-uart.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define MODE                   HYSCAN_UART_MODE_115200_8N1
+#define N_CHUNKS               4       /* Число порций данных. */
+#define CHUNK_SIZE             32      /* Размер порции данных. */
+#define CHUNK_INTERVAL         100000  /* Интервал между порциями, мкс. */
+#define INTERVAL_ERROR         30000   /* Допустимая ошибка интервала, мкс. */
+
+/* Функция читает порцию данных из порта и сравнивает её с ожидаемой. */
+static void
+read_chunk (HyScanUART   *uart,
+            HyScanBuffer *buffer,
+            const guint8 *expected,
+            const gchar  *step)
+{
+  guint8 *data;
+  guint32 size;
+
+  if (hyscan_uart_read (uart, buffer, CHUNK_SIZE) != HYSCAN_UART_STATUS_OK)
+    g_error ("%s: read error", step);
+
+  data = hyscan_buffer_get (buffer, NULL, &size);
+  if ((size != CHUNK_SIZE) || (memcmp (data, expected, CHUNK_SIZE) != 0))
+    g_error ("%s: data mismatch", step);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  guint8 chunks[N_CHUNKS][CHUNK_SIZE];
+  gint64 sent[N_CHUNKS];
+  gint64 received[N_CHUNKS];
+  gint64 recorded[N_CHUNKS];
+  gint64 replayed[N_CHUNKS];
+
+  struct termios options;
+  const gchar *pty_path;
+  gint master;
+  gint slave;
+
+  HyScanUART *uart;
+  HyScanBuffer *buffer;
+
+  gchar *capture_file;
+  gchar *capture;
+  gsize capture_size;
+  guint32 version;
+  guint32 mode;
+  gsize offset;
+  gsize total;
+  gint64 last;
+
+  gchar *replay_argv[5];
+  gchar line[1024];
+  gchar *replay_path = NULL;
+  GPid replay_pid;
+  gint replay_stdout;
+  gint replay_status;
+  FILE *replay_out;
+
+  guint i, j;
+
+  if (argc != 2)
+    {
+      g_print ("Usage: uart-capture-test <uart-replay-dir>\n");
+      return -1;
+    }
+
+  for (i = 0; i < N_CHUNKS; i++)
+    for (j = 0; j < CHUNK_SIZE; j++)
+      chunks[i][j] = g_random_int_range (0, 256);
+
+  /* Псевдотерминал. Подчинённая сторона держится открытой всё время теста. */
+  master = posix_openpt (O_RDWR | O_NOCTTY);
+  if ((master < 0) || (grantpt (master) != 0) || (unlockpt (master) != 0))
+    g_error ("can't create pty");
+
+  pty_path = ptsname (master);
+  slave = (pty_path != NULL) ? open (pty_path, O_RDWR | O_NOCTTY) : -1;
+  if (slave < 0)
+    g_error ("can't open pty");
+
+  if (tcgetattr (slave, &options) == 0)
+    {
+      cfmakeraw (&options);
+      tcsetattr (slave, TCSANOW, &options);
+    }
+
+  capture_file = g_build_filename (g_get_tmp_dir (), "uart-capture-test.cap", NULL);
+
+  uart = hyscan_uart_new ();
+  buffer = hyscan_buffer_new ();
+
+  /* Запись включается до открытия порта. */
+  if (!hyscan_uart_capture_start (uart, capture_file))
+    g_error ("can't start capture");
+
+  if (!hyscan_uart_open (uart, pty_path, MODE))
+    g_error ("can't open port '%s'", pty_path);
+
+  hyscan_uart_timeout (uart, 2.0, 2.0);
+
+  for (i = 0; i < N_CHUNKS; i++)
+    {
+      if (i > 0)
+        g_usleep (CHUNK_INTERVAL);
+
+      sent[i] = g_get_monotonic_time ();
+      if (write (master, chunks[i], CHUNK_SIZE) != CHUNK_SIZE)
+        g_error ("pty write error");
+
+      read_chunk (uart, buffer, chunks[i], "capture");
+      received[i] = g_get_monotonic_time ();
+    }
+
+  hyscan_uart_capture_stop (uart);
+  hyscan_uart_close (uart);
+
+  /* Заголовок файла записи. */
+  if (!g_file_get_contents (capture_file, &capture, &capture_size, NULL))
+    g_error ("can't read capture file");
+
+  if ((capture_size < HYSCAN_UART_CAPTURE_HEADER_SIZE) ||
+      (memcmp (capture, HYSCAN_UART_CAPTURE_MAGIC, 4) != 0))
+    {
+      g_error ("capture header mismatch");
+    }
+
+  memcpy (&version, capture + 4, sizeof (version));
+  memcpy (&mode, capture + 8, sizeof (mode));
+  if (GUINT32_FROM_LE (version) != HYSCAN_UART_CAPTURE_VERSION)
+    g_error ("capture version mismatch");
+  if (GUINT32_FROM_LE (mode) != MODE)
+    g_error ("capture mode mismatch: %d", GUINT32_FROM_LE (mode));
+
+  /* Записи. Метка времени каждой записи должна находиться между отправкой
+   * и приёмом соответствующей порции данных. */
+  last = 0;
+  total = 0;
+  for (offset = HYSCAN_UART_CAPTURE_HEADER_SIZE;
+       offset + HYSCAN_UART_CAPTURE_RECORD_SIZE <= capture_size;)
+    {
+      gint64 time;
+      guint32 size;
+      guint chunk;
+
+      memcpy (&time, capture + offset, sizeof (time));
+      memcpy (&size, capture + offset + sizeof (time), sizeof (size));
+      time = GINT64_FROM_LE (time);
+      size = GUINT32_FROM_LE (size);
+      offset += HYSCAN_UART_CAPTURE_RECORD_SIZE;
+
+      if ((size == 0) || (size > capture_size - offset))
+        g_error ("capture record size mismatch");
+
+      /* Порция данных не делится между записями, так как следующая порция
+       * отправляется только после приёма предыдущей. */
+      chunk = total / CHUNK_SIZE;
+      if ((chunk >= N_CHUNKS) || ((total % CHUNK_SIZE) + size > CHUNK_SIZE))
+        g_error ("capture record boundary mismatch");
+
+      if (memcmp (capture + offset, chunks[chunk] + (total % CHUNK_SIZE), size) != 0)
+        g_error ("capture data mismatch");
+
+      if ((time < last) || (time < sent[chunk]) || (time > received[chunk]))
+        g_error ("capture time mismatch");
+
+      if ((total % CHUNK_SIZE) == 0)
+        recorded[chunk] = time;
+
+      last = time;
+      offset += size;
+      total += size;
+    }
+
+  if ((offset != capture_size) || (total != N_CHUNKS * CHUNK_SIZE))
+    g_error ("capture size mismatch");
+
+  g_message ("captured %" G_GSIZE_FORMAT " bytes", total);
+
+  /* Воспроизведение записи. */
+  replay_argv[0] = g_build_filename (argv[1], "uart-replay", NULL);
+  replay_argv[1] = "--delay=0.5";
+  replay_argv[2] = "--speed=1.0";
+  replay_argv[3] = capture_file;
+  replay_argv[4] = NULL;
+
+  if (!g_spawn_async_with_pipes (NULL, replay_argv, NULL, G_SPAWN_DO_NOT_REAP_CHILD,
+                                 NULL, NULL, &replay_pid, NULL, &replay_stdout, NULL, NULL))
+    {
+      g_error ("can't start %s", replay_argv[0]);
+    }
+
+  replay_out = fdopen (replay_stdout, "r");
+  while (fgets (line, sizeof (line), replay_out) != NULL)
+    {
+      if (g_str_has_prefix (line, "replay port: "))
+        {
+          replay_path = g_strstrip (g_strdup (line + strlen ("replay port: ")));
+          break;
+        }
+    }
+
+  if (replay_path == NULL)
+    g_error ("replay port unknown");
+
+  if (!hyscan_uart_open (uart, replay_path, MODE))
+    g_error ("can't open replay port '%s'", replay_path);
+
+  hyscan_uart_timeout (uart, 2.0, 2.0);
+
+  /* Интервалы между порциями данных соответствуют записанным. */
+  for (i = 0; i < N_CHUNKS; i++)
+    {
+      read_chunk (uart, buffer, chunks[i], "replay");
+      replayed[i] = g_get_monotonic_time ();
+
+      if (i == 0)
+        continue;
+
+      if (ABS ((replayed[i] - replayed[i - 1]) - (recorded[i] - recorded[i - 1])) > INTERVAL_ERROR)
+        {
+          g_error ("replay interval mismatch: %" G_GINT64_FORMAT " us instead of %" G_GINT64_FORMAT " us",
+                   replayed[i] - replayed[i - 1], recorded[i] - recorded[i - 1]);
+        }
+    }
+
+  hyscan_uart_close (uart);
+
+  /* Утилита воспроизведения завершается самостоятельно. */
+  while (fgets (line, sizeof (line), replay_out) != NULL);
+  fclose (replay_out);
+
+  if ((waitpid (replay_pid, &replay_status, 0) != replay_pid) ||
+      !WIFEXITED (replay_status) || (WEXITSTATUS (replay_status) != 0))
+    {
+      g_error ("replay failed");
+    }
+
+  g_spawn_close_pid (replay_pid);
+
+  g_unlink (capture_file);
+
+  g_object_unref (buffer);
+  g_object_unref (uart);
+
+  close (slave);
+  close (master);
+
+  g_free (replay_argv[0]);
+  g_free (replay_path);
+  g_free (capture_file);
+  g_free (capture);
+
+  g_message ("All done");
+
+  return 0;
+}
@@ -0,0 +1,623 @@
+/* uart-loopback-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/* Тест UART портов через псевдотерминалы.
+ *
+ * Создаются две пары псевдотерминалов, ведущие стороны которых соединяются
+ * потоком ретрансляции. Ретранслятор передаёт данные со скоростью,
+ * соответствующей режиму работы порта, имитируя физическую линию связи.
+ * Подчинённые стороны открываются через #HyScanUART, после чего для каждого
+ * режима работы проверяется обмен данными функциями hyscan_uart_write /
+ * hyscan_uart_read и hyscan_uart_write_byte / hyscan_uart_read_byte, а также
+ * точность таймаута приёма данных, после чего проверяется накопленная
+ * статистика обмена данными. Отдельно проверяется асинхронная
+ * отправка данных и её завершение при закрытии порта.
+ *
+ * По результатам выводится отчёт со скоростью обмена, числом системных
+ * вызовов чтения и записи на мегабайт данных и ошибкой таймаута. */
+
+#define _GNU_SOURCE
+
+#include <hyscan-uart.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#define RX_TIMEOUT             0.05    /* Таймаут при проверке точности, с. */
+#define RX_TIMEOUT_ERROR       0.5     /* Допустимая ошибка таймаута, с. */
+#define N_ASYNC                64      /* Число сообщений асинхронной отправки. */
+
+typedef struct
+{
+  gint                 master;         /* Ведущая сторона псевдотерминала. */
+  gint                 slave;          /* Открытая подчинённая сторона. */
+  gchar               *path;           /* Путь к подчинённой стороне. */
+} Pty;
+
+typedef struct
+{
+  HyScanUART          *uart;           /* UART порт. */
+  gboolean             single;         /* Побайтовый обмен. */
+  HyScanBuffer        *buffer;         /* Данные для обмена. */
+  guint32              size;           /* Размер данных. */
+  HyScanUARTStatus     status;         /* Статус обмена. */
+  gdouble              elapsed;        /* Время обмена, с. */
+  gint64               syscalls;       /* Число системных вызовов чтения и записи. */
+} Worker;
+
+typedef struct
+{
+  gint                 baud;
+  HyScanUARTMode       mode;
+} Mode;
+
+static Mode modes[] =
+{
+  {   4800, HYSCAN_UART_MODE_4800_8N1 },
+  {   9600, HYSCAN_UART_MODE_9600_8N1 },
+  {  19200, HYSCAN_UART_MODE_19200_8N1 },
+  {  38400, HYSCAN_UART_MODE_38400_8N1 },
+  {  57600, HYSCAN_UART_MODE_57600_8N1 },
+  { 115200, HYSCAN_UART_MODE_115200_8N1 },
+  { 230400, HYSCAN_UART_MODE_230400_8N1 },
+  { 460800, HYSCAN_UART_MODE_460800_8N1 },
+  { 921600, HYSCAN_UART_MODE_921600_8N1 }
+};
+
+gdouble duration = 0.2;
+gint baud_rate = 0;
+gboolean unpaced = FALSE;
+
+gint relay_shutdown = 0;
+gint relay_rate = 0;
+
+gint async_ok = 0;
+gint async_error = 0;
+
+/* Функция создаёт пару псевдотерминалов. */
+static gboolean
+pty_open (Pty *pty)
+{
+  const gchar *path;
+
+  pty->master = posix_openpt (O_RDWR | O_NOCTTY);
+  if (pty->master < 0)
+    return FALSE;
+
+  if ((grantpt (pty->master) != 0) || (unlockpt (pty->master) != 0))
+    return FALSE;
+
+  path = ptsname (pty->master);
+  if (path == NULL)
+    return FALSE;
+
+  /* Подчинённая сторона держится открытой всё время теста, иначе при
+   * закрытии порта ведущая сторона получает сигнал разрыва связи. */
+  pty->path = g_strdup (path);
+  pty->slave = open (pty->path, O_RDWR | O_NOCTTY);
+
+  return (pty->slave >= 0);
+}
+
+static void
+pty_close (Pty *pty)
+{
+  if (pty->slave >= 0)
+    close (pty->slave);
+  if (pty->master >= 0)
+    close (pty->master);
+
+  g_free (pty->path);
+}
+
+/* Функция возвращает число системных вызовов чтения и записи,
+ * выполненных текущим потоком. */
+static gint64
+thread_syscalls (void)
+{
+  gchar *contents = NULL;
+  gchar **lines;
+  gint64 syscalls = 0;
+  guint i;
+
+  if (!g_file_get_contents ("/proc/thread-self/io", &contents, NULL, NULL))
+    return -1;
+
+  lines = g_strsplit (contents, "\n", -1);
+  for (i = 0; lines[i] != NULL; i++)
+    {
+      if (g_str_has_prefix (lines[i], "syscr:") || g_str_has_prefix (lines[i], "syscw:"))
+        syscalls += g_ascii_strtoll (lines[i] + 6, NULL, 10);
+    }
+
+  g_strfreev (lines);
+  g_free (contents);
+
+  return syscalls;
+}
+
+/* Поток ретрансляции данных между ведущими сторонами псевдотерминалов.
+ * Данные передаются со скоростью relay_rate байт в секунду. */
+static gpointer
+relay (gpointer data)
+{
+  Pty *ptys = data;
+  gint64 line_free[2] = {0, 0};
+  guint8 buffer[4096];
+
+  while (!g_atomic_int_get (&relay_shutdown))
+    {
+      struct pollfd fds[2];
+      gint rate;
+      guint chunk;
+      guint i;
+
+      fds[0].fd = ptys[0].master;
+      fds[0].events = POLLIN;
+      fds[1].fd = ptys[1].master;
+      fds[1].events = POLLIN;
+
+      if (poll (fds, 2, 10) <= 0)
+        continue;
+
+      /* За один раз передаём объём данных, принимаемый за 1 мс,
+       * аналогично буферу приёмника UART. */
+      rate = g_atomic_int_get (&relay_rate);
+      chunk = (rate > 0) ? CLAMP (rate / 1000, 1, (gint)sizeof (buffer)) : (gint)sizeof (buffer);
+
+      for (i = 0; i < 2; i++)
+        {
+          gssize size;
+          gint64 now;
+
+          if (!(fds[i].revents & POLLIN))
+            continue;
+
+          size = read (ptys[i].master, buffer, chunk);
+          if (size <= 0)
+            continue;
+
+          /* Имитация времени передачи данных по линии связи. */
+          if (rate > 0)
+            {
+              now = g_get_monotonic_time ();
+              line_free[i] = MAX (line_free[i], now) + (G_USEC_PER_SEC * size) / rate;
+              if (line_free[i] > now)
+                g_usleep (line_free[i] - now);
+            }
+
+          if (write (ptys[(i + 1) % 2].master, buffer, size) != size)
+            g_error ("relay write error");
+        }
+    }
+
+  return NULL;
+}
+
+/* Поток отправки данных. */
+static gpointer
+sender (gpointer data)
+{
+  Worker *worker = data;
+  GTimer *timer = g_timer_new ();
+  gint64 syscalls = thread_syscalls ();
+
+  if (worker->single)
+    {
+      guint8 *buffer;
+      guint32 size;
+      guint32 i;
+
+      buffer = hyscan_buffer_get (worker->buffer, NULL, &size);
+      for (i = 0; i < size; i++)
+        {
+          worker->status = hyscan_uart_write_byte (worker->uart, buffer[i]);
+          if (worker->status != HYSCAN_UART_STATUS_OK)
+            break;
+        }
+    }
+  else
+    {
+      guint32 size;
+
+      worker->status = hyscan_uart_write (worker->uart, worker->buffer, &size);
+    }
+
+  worker->elapsed = g_timer_elapsed (timer, NULL);
+  worker->syscalls = (syscalls < 0) ? -1 : thread_syscalls () - syscalls;
+
+  g_timer_destroy (timer);
+
+  return NULL;
+}
+
+/* Поток приёма данных. */
+static gpointer
+receiver (gpointer data)
+{
+  Worker *worker = data;
+  GTimer *timer = g_timer_new ();
+  gint64 syscalls = thread_syscalls ();
+
+  if (worker->single)
+    {
+      guint8 *buffer;
+      guint32 size;
+      guint32 i;
+
+      hyscan_buffer_set (worker->buffer, HYSCAN_DATA_BLOB, NULL, worker->size);
+      buffer = hyscan_buffer_get (worker->buffer, NULL, &size);
+      for (i = 0; i < size; i++)
+        {
+          worker->status = hyscan_uart_read_byte (worker->uart, &buffer[i]);
+          if (worker->status != HYSCAN_UART_STATUS_OK)
+            break;
+        }
+    }
+  else
+    {
+      worker->status = hyscan_uart_read (worker->uart, worker->buffer, worker->size);
+    }
+
+  worker->elapsed = g_timer_elapsed (timer, NULL);
+  worker->syscalls = (syscalls < 0) ? -1 : thread_syscalls () - syscalls;
+
+  g_timer_destroy (timer);
+
+  return NULL;
+}
+
+/* Функция возвращает объём данных, передаваемый за заданное время. */
+static guint32
+transfer_size (Mode *mode)
+{
+  return MAX (64, duration * mode->baud / 10);
+}
+
+/* Функция проверяет обмен данными и выводит результаты. */
+static void
+test_transfer (HyScanUART *tx,
+               HyScanUART *rx,
+               Mode       *mode,
+               gboolean    single)
+{
+  Worker tx_worker = {0};
+  Worker rx_worker = {0};
+  GThread *tx_thread;
+  GThread *rx_thread;
+
+  guint8 *tx_data;
+  guint8 *rx_data;
+  guint32 tx_size;
+  guint32 rx_size;
+  guint32 size;
+  gdouble mbytes;
+  guint32 i;
+
+  size = transfer_size (mode);
+
+  tx_worker.uart = tx;
+  tx_worker.single = single;
+  tx_worker.buffer = hyscan_buffer_new ();
+  tx_worker.size = size;
+
+  hyscan_buffer_set (tx_worker.buffer, HYSCAN_DATA_BLOB, NULL, size);
+  tx_data = hyscan_buffer_get (tx_worker.buffer, NULL, &tx_size);
+  for (i = 0; i < size; i++)
+    tx_data[i] = g_random_int_range (0, 256);
+
+  rx_worker.uart = rx;
+  rx_worker.single = single;
+  rx_worker.buffer = hyscan_buffer_new ();
+  rx_worker.size = size;
+
+  hyscan_uart_timeout (tx, 1.0, 1.0);
+  hyscan_uart_timeout (rx, 1.0, 1.0);
+
+  rx_thread = g_thread_new ("receiver", receiver, &rx_worker);
+  tx_thread = g_thread_new ("sender", sender, &tx_worker);
+  g_thread_join (tx_thread);
+  g_thread_join (rx_thread);
+
+  if (tx_worker.status != HYSCAN_UART_STATUS_OK)
+    g_error ("%d: %s sender error", mode->baud, single ? "byte" : "block");
+  if (rx_worker.status != HYSCAN_UART_STATUS_OK)
+    g_error ("%d: %s receiver error", mode->baud, single ? "byte" : "block");
+
+  rx_data = hyscan_buffer_get (rx_worker.buffer, NULL, &rx_size);
+  if ((rx_size != tx_size) || (memcmp (tx_data, rx_data, tx_size) != 0))
+    g_error ("%d: %s data error", mode->baud, single ? "byte" : "block");
+
+  mbytes = size / (1024.0 * 1024.0);
+
+  g_print ("%7d  %-22s %8u %8.3f %10.0f %7.1f",
+           mode->baud,
+           single ? "write_byte/read_byte" : "write/read",
+           size, rx_worker.elapsed,
+           size / rx_worker.elapsed,
+           unpaced ? 0.0 : 100.0 * (size / rx_worker.elapsed) / (mode->baud / 10.0));
+
+  if ((tx_worker.syscalls >= 0) && (rx_worker.syscalls >= 0))
+    g_print (" %10.0f %10.0f\n", tx_worker.syscalls / mbytes, rx_worker.syscalls / mbytes);
+  else
+    g_print (" %10s %10s\n", "n/a", "n/a");
+
+  g_object_unref (tx_worker.buffer);
+  g_object_unref (rx_worker.buffer);
+}
+
+/* Функция проверяет точность таймаута приёма данных. */
+static gdouble
+test_timeout (HyScanUART *rx,
+              Mode       *mode)
+{
+  HyScanUARTStatus status;
+  HyScanBuffer *buffer;
+  GTimer *timer;
+  gdouble elapsed;
+
+  buffer = hyscan_buffer_new ();
+  timer = g_timer_new ();
+
+  hyscan_uart_timeout (rx, RX_TIMEOUT, RX_TIMEOUT);
+
+  g_timer_start (timer);
+  status = hyscan_uart_read (rx, buffer, 16);
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  if (status != HYSCAN_UART_STATUS_TIMEOUT)
+    g_error ("%d: timeout status error", mode->baud);
+  if ((elapsed < RX_TIMEOUT) || (elapsed > RX_TIMEOUT + RX_TIMEOUT_ERROR))
+    g_error ("%d: timeout error %.3f s", mode->baud, elapsed - RX_TIMEOUT);
+
+  g_timer_destroy (timer);
+  g_object_unref (buffer);
+
+  return elapsed - RX_TIMEOUT;
+}
+
+/* Функция проверяет статистику обмена данными после двух передач данных
+ * и одного таймаута приёма. */
+static void
+test_stats (HyScanUART *tx,
+            HyScanUART *rx,
+            Mode       *mode)
+{
+  HyScanUARTStats tx_stats;
+  HyScanUARTStats rx_stats;
+  guint64 size = 2 * transfer_size (mode);
+  guint64 intervals = 0;
+  guint i;
+
+  if (!hyscan_uart_get_stats (tx, &tx_stats) || !hyscan_uart_get_stats (rx, &rx_stats))
+    g_error ("%d: can't get stats", mode->baud);
+
+  if ((tx_stats.tx_bytes != size) || (rx_stats.rx_bytes != size) ||
+      (tx_stats.rx_bytes != 0) || (rx_stats.tx_bytes != 0))
+    {
+      g_error ("%d: stats bytes mismatch", mode->baud);
+    }
+
+  /* Побайтовый обмен выполняется отдельным вызовом на каждый байт. */
+  if ((tx_stats.tx_calls < size / 2) || (rx_stats.rx_calls < size / 2))
+    g_error ("%d: stats calls mismatch", mode->baud);
+
+  if ((rx_stats.rx_timeouts != 1) || (tx_stats.tx_timeouts != 0) || (rx_stats.rx_partial != 0))
+    g_error ("%d: stats timeouts mismatch", mode->baud);
+
+  /* Псевдотерминал не сообщает об ошибках линии. */
+  if ((rx_stats.overrun != 0) || (rx_stats.buf_overrun != 0) ||
+      (rx_stats.frame != 0) || (rx_stats.parity != 0) || (rx_stats.brk != 0))
+    {
+      g_error ("%d: stats line errors reported", mode->baud);
+    }
+
+  /* Интервал учитывается для каждого чтения с данными, кроме первого. */
+  for (i = 0; i < HYSCAN_UART_STATS_HISTOGRAM_SIZE; i++)
+    intervals += rx_stats.histogram[i];
+
+  if ((intervals == 0) || (intervals >= rx_stats.rx_calls))
+    g_error ("%d: stats histogram mismatch", mode->baud);
+
+  if ((rx_stats.elapsed <= 0.0) || (rx_stats.rx_load <= 0.0) || (tx_stats.tx_load <= 0.0))
+    g_error ("%d: stats load mismatch", mode->baud);
+
+  /* После сброса статистика пустая. */
+  hyscan_uart_reset_stats (rx);
+  if (!hyscan_uart_get_stats (rx, &rx_stats) || (rx_stats.rx_bytes != 0) || (rx_stats.rx_calls != 0))
+    g_error ("%d: stats reset error", mode->baud);
+}
+
+/* Функция обратного вызова асинхронной отправки. Из первого сообщения
+ * делается попытка закрыть порт, которая должна быть отклонена. */
+static void
+async_sent (HyScanUART       *uart,
+            HyScanUARTStatus  status,
+            gpointer          user_data)
+{
+  if (GPOINTER_TO_INT (user_data) == 0)
+    {
+      hyscan_uart_close (uart);
+      if (hyscan_uart_get_path (uart) == NULL)
+        g_error ("async: port closed from write callback");
+    }
+
+  if (status == HYSCAN_UART_STATUS_OK)
+    g_atomic_int_inc (&async_ok);
+  else
+    g_atomic_int_inc (&async_error);
+}
+
+/* Функция проверяет асинхронную отправку данных. */
+static void
+test_async (HyScanUART  *tx,
+            const gchar *path)
+{
+  HyScanBuffer *buffer;
+  guint8 data[16] = {0};
+  gint i;
+
+  buffer = hyscan_buffer_new ();
+  hyscan_buffer_set (buffer, HYSCAN_DATA_BLOB, data, sizeof (data));
+
+  if (!hyscan_uart_open (tx, path, HYSCAN_UART_MODE_115200_8N1))
+    g_error ("can't open port '%s'", path);
+
+  /* Все сообщения отправляются, закрытие из функции обратного вызова
+   * игнорируется. */
+  for (i = 0; i < N_ASYNC; i++)
+    {
+      if (!hyscan_uart_write_async (tx, buffer, async_sent, GINT_TO_POINTER (i)))
+        g_error ("async: can't queue message");
+    }
+
+  hyscan_uart_write_flush (tx);
+  if ((g_atomic_int_get (&async_ok) != N_ASYNC) || (g_atomic_int_get (&async_error) != 0))
+    g_error ("async: %d sent, %d failed", async_ok, async_error);
+
+  /* При закрытии порта каждое сообщение завершается ровно один раз. */
+  g_atomic_int_set (&async_ok, 0);
+  for (i = 1; i <= N_ASYNC; i++)
+    {
+      if (!hyscan_uart_write_async (tx, buffer, async_sent, GINT_TO_POINTER (i)))
+        g_error ("async: can't queue message");
+    }
+
+  hyscan_uart_close (tx);
+  if (g_atomic_int_get (&async_ok) + g_atomic_int_get (&async_error) != N_ASYNC)
+    g_error ("async: %d sent, %d failed on close", async_ok, async_error);
+
+  /* После закрытия порта сообщения не принимаются. */
+  if (hyscan_uart_write_async (tx, buffer, async_sent, NULL))
+    g_error ("async: message queued to closed port");
+
+  g_print ("%7s  %-22s %d sent, %d failed on close\n", "", "write_async", async_ok, async_error);
+
+  g_object_unref (buffer);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  Pty ptys[2] = {{-1, -1, NULL}, {-1, -1, NULL}};
+  GThread *relay_thread;
+  HyScanUART *tx;
+  HyScanUART *rx;
+  guint i;
+
+  {
+    gchar **args;
+    GError *error = NULL;
+    GOptionContext *context;
+    GOptionEntry entries[] =
+      {
+        { "duration", 'd', 0, G_OPTION_ARG_DOUBLE, &duration, "Transfer duration for each test (default 0.2 s)", NULL },
+        { "baud", 'b', 0, G_OPTION_ARG_INT, &baud_rate, "Test only this baud rate", NULL },
+        { "unpaced", 'u', 0, G_OPTION_ARG_NONE, &unpaced, "Don't emulate line speed", NULL },
+        { NULL }
+      };
+
+    args = g_strdupv (argv);
+
+    context = g_option_context_new ("");
+    g_option_context_set_help_enabled (context, TRUE);
+    g_option_context_add_main_entries (context, entries, NULL);
+    g_option_context_set_ignore_unknown_options (context, FALSE);
+    if (!g_option_context_parse_strv (context, &args, &error))
+      {
+        g_print ("%s\n", error->message);
+        return -1;
+      }
+
+    g_option_context_free (context);
+    g_strfreev (args);
+  }
+
+  duration = CLAMP (duration, 0.01, 60.0);
+
+  /* Псевдотерминалы и поток ретрансляции. */
+  if (!pty_open (&ptys[0]) || !pty_open (&ptys[1]))
+    g_error ("can't create pty pair");
+
+  relay_thread = g_thread_new ("relay", relay, ptys);
+
+  tx = hyscan_uart_new ();
+  rx = hyscan_uart_new ();
+
+  g_print ("%7s  %-22s %8s %8s %10s %7s %10s %10s\n",
+           "baud", "path", "bytes", "time, s", "rate, B/s", "line, %", "tx sc/MB", "rx sc/MB");
+
+  for (i = 0; i < G_N_ELEMENTS (modes); i++)
+    {
+      gdouble timeout_error;
+
+      if ((baud_rate > 0) && (baud_rate != modes[i].baud))
+        continue;
+
+      g_atomic_int_set (&relay_rate, unpaced ? 0 : modes[i].baud / 10);
+
+      if (!hyscan_uart_open (tx, ptys[0].path, modes[i].mode))
+        g_error ("can't open port '%s'", ptys[0].path);
+      if (!hyscan_uart_open (rx, ptys[1].path, modes[i].mode))
+        g_error ("can't open port '%s'", ptys[1].path);
+
+      test_transfer (tx, rx, &modes[i], FALSE);
+      test_transfer (tx, rx, &modes[i], TRUE);
+
+      timeout_error = test_timeout (rx, &modes[i]);
+      g_print ("%7d  %-22s %.3f ms\n", modes[i].baud, "rx timeout error", 1000.0 * timeout_error);
+
+      test_stats (tx, rx, &modes[i]);
+
+      hyscan_uart_close (tx);
+      hyscan_uart_close (rx);
+    }
+
+  g_atomic_int_set (&relay_rate, 0);
+  test_async (tx, ptys[0].path);
+
+  g_atomic_int_set (&relay_shutdown, 1);
+  g_thread_join (relay_thread);
+
+  g_object_unref (tx);
+  g_object_unref (rx);
+
+  pty_close (&ptys[0]);
+  pty_close (&ptys[1]);
+
+  return 0;
+}
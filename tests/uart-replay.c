@@ -0,0 +1,257 @@
+/* uart-replay.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/* Утилита воспроизведения данных, записанных функцией
+ * hyscan_uart_capture_start.
+ *
+ * Утилита создаёт псевдотерминал и выводит путь к его подчинённой стороне,
+ * который необходимо указать драйверу вместо реального UART порта. Через
+ * заданное время данные из файла записи передаются в псевдотерминал с
+ * исходными временными интервалами, ускоренными в заданное число раз, или
+ * без задержек. Данные, отправляемые драйвером в порт, отбрасываются. */
+
+#define _GNU_SOURCE
+
+#include <hyscan-uart.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+gdouble speed = 1.0;
+gdouble delay = 1.0;
+gboolean loop = FALSE;
+
+/* Поток чтения и отбрасывания данных, отправленных драйвером. Поток
+ * завершается при закрытии псевдотерминала или ошибке чтения. */
+static gpointer
+drain (gpointer data)
+{
+  gint master = GPOINTER_TO_INT (data);
+  guint8 buffer[1024];
+
+  while (read (master, buffer, sizeof (buffer)) > 0);
+
+  return NULL;
+}
+
+/* Функция записывает все данные в псевдотерминал. */
+static gboolean
+write_all (gint          master,
+           const guint8 *data,
+           guint32       size)
+{
+  while (size > 0)
+    {
+      gssize written = write (master, data, size);
+
+      if (written <= 0)
+        return FALSE;
+
+      data += written;
+      size -= written;
+    }
+
+  return TRUE;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  gchar *capture_file = NULL;
+  gchar *capture = NULL;
+  gsize capture_size;
+
+  struct termios options;
+  const gchar *path;
+  gint master;
+  gint slave;
+
+  guint32 version;
+  guint32 mode;
+
+  {
+    gchar **args;
+    GError *error = NULL;
+    GOptionContext *context;
+    GOptionEntry entries[] =
+      {
+        { "speed", 's', 0, G_OPTION_ARG_DOUBLE, &speed, "Replay speed factor, 0 - as fast as possible (default 1.0)", NULL },
+        { "delay", 'd', 0, G_OPTION_ARG_DOUBLE, &delay, "Delay before replay (default 1.0 s)", NULL },
+        { "loop", 'l', 0, G_OPTION_ARG_NONE, &loop, "Replay in loop", NULL },
+        { NULL }
+      };
+
+    args = g_strdupv (argv);
+
+    context = g_option_context_new ("<capture-file>");
+    g_option_context_set_help_enabled (context, TRUE);
+    g_option_context_add_main_entries (context, entries, NULL);
+    g_option_context_set_ignore_unknown_options (context, FALSE);
+    if (!g_option_context_parse_strv (context, &args, &error))
+      {
+        g_print ("%s\n", error->message);
+        return -1;
+      }
+
+    if (g_strv_length (args) != 2)
+      {
+        g_print ("%s", g_option_context_get_help (context, FALSE, NULL));
+        return 0;
+      }
+
+    capture_file = g_strdup (args[1]);
+
+    g_option_context_free (context);
+    g_strfreev (args);
+  }
+
+  speed = MAX (speed, 0.0);
+  delay = MAX (delay, 0.0);
+
+  /* Файл записи. */
+  if (!g_file_get_contents (capture_file, &capture, &capture_size, NULL))
+    g_error ("can't read capture file %s", capture_file);
+
+  if ((capture_size < HYSCAN_UART_CAPTURE_HEADER_SIZE) ||
+      (memcmp (capture, HYSCAN_UART_CAPTURE_MAGIC, 4) != 0))
+    {
+      g_error ("unknown capture file format");
+    }
+
+  memcpy (&version, capture + 4, sizeof (version));
+  memcpy (&mode, capture + 8, sizeof (mode));
+  version = GUINT32_FROM_LE (version);
+  mode = GUINT32_FROM_LE (mode);
+
+  /* Версии формата отличаются только часами меток времени, а для
+   * воспроизведения используются только интервалы между записями. */
+  if ((version == 0) || (version > HYSCAN_UART_CAPTURE_VERSION))
+    g_error ("unsupported capture file version %d", version);
+
+  /* Псевдотерминал. Подчинённая сторона держится открытой, иначе при
+   * закрытии порта драйвером ведущая сторона получает сигнал разрыва связи.
+   * Эхо отключается, чтобы данные не возвращались обратно. */
+  master = posix_openpt (O_RDWR | O_NOCTTY);
+  if ((master < 0) || (grantpt (master) != 0) || (unlockpt (master) != 0))
+    g_error ("can't create pty");
+
+  path = ptsname (master);
+  slave = (path != NULL) ? open (path, O_RDWR | O_NOCTTY) : -1;
+  if (slave < 0)
+    g_error ("can't open pty");
+
+  if (tcgetattr (slave, &options) == 0)
+    {
+      cfmakeraw (&options);
+      tcsetattr (slave, TCSANOW, &options);
+    }
+
+  g_thread_unref (g_thread_new ("drain", drain, GINT_TO_POINTER (master)));
+
+  g_print ("replay port: %s\n", path);
+  g_print ("capture mode: %d\n", mode);
+  fflush (stdout);
+
+  g_usleep (delay * G_USEC_PER_SEC);
+
+  do
+    {
+      gint64 start = g_get_monotonic_time ();
+      gint64 first = 0;
+      guint64 records = 0;
+      guint64 bytes = 0;
+      gsize offset;
+      gdouble elapsed;
+
+      for (offset = HYSCAN_UART_CAPTURE_HEADER_SIZE;
+           offset + HYSCAN_UART_CAPTURE_RECORD_SIZE <= capture_size;)
+        {
+          gint64 time;
+          guint32 size;
+
+          memcpy (&time, capture + offset, sizeof (time));
+          memcpy (&size, capture + offset + sizeof (time), sizeof (size));
+          time = GINT64_FROM_LE (time);
+          size = GUINT32_FROM_LE (size);
+          offset += HYSCAN_UART_CAPTURE_RECORD_SIZE;
+
+          if (size > capture_size - offset)
+            {
+              g_print ("truncated record at offset %" G_GSIZE_FORMAT "\n", offset);
+              break;
+            }
+
+          /* Выдерживаем исходный интервал между записями. */
+          if (records == 0)
+            first = time;
+
+          if (speed > 0.0)
+            {
+              gint64 wait = start + (time - first) / speed - g_get_monotonic_time ();
+
+              if (wait > 0)
+                g_usleep (wait);
+            }
+
+          if (!write_all (master, (guint8*)capture + offset, size))
+            g_error ("pty write error");
+
+          offset += size;
+          records += 1;
+          bytes += size;
+        }
+
+      elapsed = (gdouble)(g_get_monotonic_time () - start) / G_USEC_PER_SEC;
+
+      g_print ("replayed %" G_GUINT64_FORMAT " records, %" G_GUINT64_FORMAT " bytes in %.3f s (%.0f B/s)\n",
+               records, bytes, elapsed, (elapsed > 0.0) ? bytes / elapsed : 0.0);
+    }
+  while (loop);
+
+  /* Даём драйверу считать оставшиеся данные. */
+  tcdrain (master);
+  g_usleep (delay * G_USEC_PER_SEC);
+
+  close (slave);
+  close (master);
+
+  g_free (capture_file);
+  g_free (capture);
+
+  return 0;
+}
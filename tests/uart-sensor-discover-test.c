@@ -0,0 +1,171 @@
+/* uart-sensor-discover-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+#include <hyscan-uart-sensor.h>
+#include <hyscan-driver.h>
+#include <hyscan-uart.h>
+
+static guint n_found = 0;
+static guint n_lost = 0;
+static guint n_completed = 0;
+
+static void
+device_found (HyScanDiscover     *discover,
+              HyScanDiscoverInfo *info)
+{
+  if (g_strcmp0 (info->uri, HYSCAN_UART_SENSOR_URI) != 0)
+    g_error ("incorrect found device uri %s", info->uri);
+
+  n_found += 1;
+}
+
+static void
+device_lost (HyScanDiscover     *discover,
+             HyScanDiscoverInfo *info)
+{
+  n_lost += 1;
+}
+
+static void
+completed (HyScanDiscover *discover)
+{
+  n_completed += 1;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanDriver *driver;
+  HyScanDiscover *discover;
+  HyScanDataSchema *config;
+  GList *devices;
+  gboolean present;
+  guint generation;
+
+  /* Путь к драйверам. */
+  if (argv[1] == NULL)
+    {
+      g_print ("Usage: uart-sensor-discover-test <path-to-drivers>\n");
+      return -1;
+    }
+
+  driver = hyscan_driver_new (argv[1], "uartsensor");
+  if (driver == NULL)
+    g_error ("can't load uartsensor driver");
+
+  discover = HYSCAN_DISCOVER (driver);
+
+  g_signal_connect (discover, "device-found", G_CALLBACK (device_found), NULL);
+  g_signal_connect (discover, "device-lost", G_CALLBACK (device_lost), NULL);
+  g_signal_connect (discover, "completed", G_CALLBACK (completed), NULL);
+
+  /* Параметры подключения есть только у адреса датчиков. */
+  config = hyscan_discover_config (discover, HYSCAN_UART_SENSOR_URI);
+  if (config == NULL)
+    g_error ("can't get sensors config");
+  g_object_unref (config);
+
+  config = hyscan_discover_config (discover, "dummy://device");
+  if (config != NULL)
+    g_error ("config for unknown uri");
+
+  if (!hyscan_discover_check (discover, HYSCAN_UART_SENSOR_URI, NULL))
+    g_error ("sensors uri check failed");
+
+  if (hyscan_discover_check (discover, "dummy://device", NULL))
+    g_error ("unknown uri check passed");
+
+  /* До поиска список устройств пуст. */
+  generation = hyscan_discover_get_generation (discover);
+  if (generation != 1)
+    g_error ("incorrect initial generation %d", generation);
+
+  devices = hyscan_discover_list (discover);
+  if (devices != NULL)
+    g_error ("devices list isn't empty before discover");
+
+  /* Наличие портов в системе. */
+  devices = hyscan_uart_list ();
+  present = (devices != NULL);
+  g_list_free_full (devices, (GDestroyNotify)hyscan_uart_device_free);
+
+  g_message ("UART ports %s", present ? "present" : "not present");
+
+  /* Поиск завершается сразу, номер изменения увеличивается только
+   * при появлении портов. */
+  hyscan_discover_start (discover);
+
+  if (n_completed != 1)
+    g_error ("discover not completed");
+
+  generation = hyscan_discover_get_generation (discover);
+  if (generation != (present ? 2 : 1))
+    g_error ("incorrect generation %d after discover", generation);
+
+  if ((n_found != (present ? 1 : 0)) || (n_lost != 0))
+    g_error ("incorrect found/lost signals after discover");
+
+  devices = hyscan_discover_list (discover);
+  if (g_list_length (devices) != (present ? 1 : 0))
+    g_error ("incorrect devices list");
+
+  if (devices != NULL)
+    {
+      HyScanDiscoverInfo *info = devices->data;
+
+      if (g_strcmp0 (info->uri, HYSCAN_UART_SENSOR_URI) != 0)
+        g_error ("incorrect device uri %s", info->uri);
+    }
+
+  g_list_free_full (devices, (GDestroyNotify)hyscan_discover_info_free);
+
+  /* Повторный поиск без изменений не меняет номер и не посылает сигналов. */
+  hyscan_discover_start (discover);
+
+  if (n_completed != 2)
+    g_error ("second discover not completed");
+
+  if (hyscan_discover_get_generation (discover) != generation)
+    g_error ("generation changed without ports change");
+
+  if ((n_found != (present ? 1 : 0)) || (n_lost != 0))
+    g_error ("unexpected found/lost signals");
+
+  g_object_unref (driver);
+
+  g_message ("All done");
+
+  return 0;
+}
@@ -0,0 +1,478 @@
+/* uart-sensor-test.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/* Тест датчиков, подключенных через UART порты.
+ *
+ * Драйвер uartsensor подключается к двум псевдотерминалам: первый порт
+ * работает в режиме разбора NMEA сообщений, второй передаёт двоичные данные
+ * без разбора с типом источника, заданным в параметрах порта. Порт без
+ * разбора, для которого тип источника не задан, не должен использоваться.
+ *
+ * В ведущие стороны псевдотерминалов записываются NMEA сообщения, в том
+ * числе разделённые на части, с неверной контрольной суммой и окружённые
+ * двоичными данными, а также произвольные двоичные данные. Проверяются
+ * данные, типы источников и метки времени сигналов sensor-data, а также
+ * отключение датчика. */
+
+#define _GNU_SOURCE
+
+#include <hyscan-uart-sensor.h>
+#include <hyscan-driver.h>
+#include <hyscan-sensor.h>
+#include <hyscan-param.h>
+#include <hyscan-uart.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define MODE                   HYSCAN_UART_MODE_115200_8N1
+#define RAW_SOURCE             HYSCAN_SOURCE_NMEA
+#define RAW_SIZE               256     /* Объём двоичных данных. */
+#define WAIT_TIMEOUT           2000000 /* Время ожидания данных, мкс. */
+#define TIME_ERROR             100000  /* Допустимая ошибка метки времени, мкс. */
+
+typedef struct
+{
+  gint                 master;         /* Ведущая сторона псевдотерминала. */
+  gint                 slave;          /* Открытая подчинённая сторона. */
+  gchar               *path;           /* Путь к подчинённой стороне. */
+} Pty;
+
+typedef struct
+{
+  gchar               *name;           /* Название датчика. */
+  HyScanSourceType     source;         /* Тип источника данных. */
+  gint64               time;           /* Метка времени данных. */
+  HyScanDataType       type;           /* Тип данных. */
+  GBytes              *data;           /* Данные. */
+} Record;
+
+static GMutex lock;
+static GPtrArray *records;
+
+/* Функция создаёт псевдотерминал. Подчинённая сторона держится открытой
+ * всё время теста. */
+static void
+pty_open (Pty *pty)
+{
+  struct termios options;
+  const gchar *path;
+
+  pty->master = posix_openpt (O_RDWR | O_NOCTTY);
+  if ((pty->master < 0) || (grantpt (pty->master) != 0) || (unlockpt (pty->master) != 0))
+    g_error ("can't create pty");
+
+  path = ptsname (pty->master);
+  if (path == NULL)
+    g_error ("can't get pty path");
+
+  pty->path = g_strdup (path);
+  pty->slave = open (pty->path, O_RDWR | O_NOCTTY);
+  if (pty->slave < 0)
+    g_error ("can't open pty");
+
+  if (tcgetattr (pty->slave, &options) == 0)
+    {
+      cfmakeraw (&options);
+      tcsetattr (pty->slave, TCSANOW, &options);
+    }
+}
+
+static void
+pty_close (Pty *pty)
+{
+  close (pty->slave);
+  close (pty->master);
+  g_free (pty->path);
+}
+
+static void
+pty_write (Pty         *pty,
+           const gchar *data,
+           gsize        size)
+{
+  if (write (pty->master, data, size) != (gssize)size)
+    g_error ("pty write error");
+}
+
+static void
+record_free (gpointer data)
+{
+  Record *record = data;
+
+  g_free (record->name);
+  g_bytes_unref (record->data);
+  g_slice_free (Record, record);
+}
+
+/* Обработчик сигнала sensor-data. Вызывается из потока драйвера. */
+static void
+sensor_data (HyScanSensor *sensor,
+             const gchar  *name,
+             gint          source,
+             gint64        time,
+             HyScanBuffer *data)
+{
+  Record *record;
+  gpointer values;
+  guint32 size;
+
+  record = g_slice_new (Record);
+  record->name = g_strdup (name);
+  record->source = source;
+  record->time = time;
+
+  values = hyscan_buffer_get (data, &record->type, &size);
+  record->data = g_bytes_new (values, size);
+
+  g_mutex_lock (&lock);
+  g_ptr_array_add (records, record);
+  g_mutex_unlock (&lock);
+}
+
+/* Функция возвращает число принятых сообщений датчика. */
+static guint
+count_records (const gchar *name)
+{
+  guint n_records = 0;
+  guint i;
+
+  g_mutex_lock (&lock);
+  for (i = 0; i < records->len; i++)
+    {
+      Record *record = g_ptr_array_index (records, i);
+
+      if (g_strcmp0 (record->name, name) == 0)
+        n_records += 1;
+    }
+  g_mutex_unlock (&lock);
+
+  return n_records;
+}
+
+/* Функция ожидает указанное число сообщений датчика. */
+static void
+wait_records (const gchar *name,
+              guint        n_records,
+              const gchar *step)
+{
+  gint64 end_time = g_get_monotonic_time () + WAIT_TIMEOUT;
+
+  while (count_records (name) < n_records)
+    {
+      if (g_get_monotonic_time () > end_time)
+        g_error ("%s: %d messages instead of %d", step, count_records (name), n_records);
+
+      g_usleep (10000);
+    }
+
+  /* Лишние сообщения. */
+  g_usleep (100000);
+  if (count_records (name) != n_records)
+    g_error ("%s: %d messages instead of %d", step, count_records (name), n_records);
+}
+
+/* Функция ожидает открытия порта драйвером. */
+static void
+wait_port (HyScanParam *param,
+           const gchar *name)
+{
+  HyScanParamList *list = hyscan_param_list_new ();
+  gint64 end_time = g_get_monotonic_time () + WAIT_TIMEOUT;
+  gchar *key = g_strdup_printf ("/state/%s/status", name);
+
+  hyscan_param_list_add (list, key);
+
+  while (TRUE)
+    {
+      if (!hyscan_param_get (param, list))
+        g_error ("%s: can't get port status", name);
+
+      if (hyscan_param_list_get_enum (list, key) == HYSCAN_DEVICE_STATUS_OK)
+        break;
+
+      if (g_get_monotonic_time () > end_time)
+        g_error ("%s: port isn't opened", name);
+
+      g_usleep (10000);
+    }
+
+  g_free (key);
+  g_object_unref (list);
+}
+
+/* Функция формирует NMEA сообщение с контрольной суммой. */
+static gchar *
+nmea_message (const gchar *body,
+              gboolean     valid)
+{
+  guint8 checksum = 0;
+  guint i;
+
+  for (i = 1; body[i] != 0; i++)
+    checksum ^= body[i];
+
+  if (!valid)
+    checksum ^= 1;
+
+  return g_strdup_printf ("%s*%02X", body, checksum);
+}
+
+/* Функция проверяет NMEA сообщение. */
+static gint64
+check_nmea (guint        index,
+            const gchar *expected,
+            gint64       sent,
+            gint64       last)
+{
+  Record *record = NULL;
+  guint n_records = 0;
+  guint i;
+
+  g_mutex_lock (&lock);
+  for (i = 0; i < records->len; i++)
+    {
+      Record *cur = g_ptr_array_index (records, i);
+
+      if ((g_strcmp0 (cur->name, "nmea") == 0) && (n_records++ == index))
+        record = cur;
+    }
+  g_mutex_unlock (&lock);
+
+  if (record == NULL)
+    g_error ("nmea: message %d not received", index);
+
+  if ((record->type != HYSCAN_DATA_STRING) ||
+      (g_strcmp0 (g_bytes_get_data (record->data, NULL), expected) != 0))
+    {
+      g_error ("nmea: message %d mismatch", index);
+    }
+
+  if (record->source != HYSCAN_SOURCE_NMEA)
+    g_error ("nmea: message %d source mismatch", index);
+
+  if ((record->time <= last) || (record->time < sent - TIME_ERROR) ||
+      (record->time > g_get_real_time ()))
+    {
+      g_error ("nmea: message %d time mismatch", index);
+    }
+
+  return record->time;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  HyScanDriver *driver;
+  HyScanDevice *device;
+  HyScanParamList *params;
+  Pty nmea_pty, raw_pty;
+
+  gchar *gga, *zda, *vdm, *bad;
+  gchar raw[RAW_SIZE];
+  GByteArray *raw_received;
+  gint64 sent[4];
+  gint64 last;
+  guint i;
+
+  if (argv[1] == NULL)
+    {
+      g_print ("Usage: uart-sensor-test <path-to-drivers>\n");
+      return -1;
+    }
+
+  records = g_ptr_array_new_with_free_func (record_free);
+
+  pty_open (&nmea_pty);
+  pty_open (&raw_pty);
+
+  driver = hyscan_driver_new (argv[1], "uartsensor");
+  if (driver == NULL)
+    g_error ("can't load uartsensor driver");
+
+  /* Параметры портов. */
+  params = hyscan_param_list_new ();
+  hyscan_param_list_set_enum (params, "/ports/nmea/mode", MODE);
+  hyscan_param_list_set_enum (params, "/ports/nmea/framing", HYSCAN_UART_SENSOR_FRAMING_NMEA);
+  hyscan_param_list_set_string (params, "/ports/nmea/path", nmea_pty.path);
+  hyscan_param_list_set_enum (params, "/ports/raw/mode", MODE);
+  hyscan_param_list_set_enum (params, "/ports/raw/framing", HYSCAN_UART_SENSOR_FRAMING_RAW);
+  hyscan_param_list_set_string (params, "/ports/raw/path", raw_pty.path);
+  hyscan_param_list_set_string (params, "/ports/raw/source", hyscan_source_get_id_by_type (RAW_SOURCE));
+  hyscan_param_list_set_enum (params, "/ports/nosource/mode", MODE);
+  hyscan_param_list_set_enum (params, "/ports/nosource/framing", HYSCAN_UART_SENSOR_FRAMING_RAW);
+  hyscan_param_list_set_string (params, "/ports/nosource/path", raw_pty.path);
+
+  device = hyscan_discover_connect (HYSCAN_DISCOVER (driver), HYSCAN_UART_SENSOR_URI, params);
+  if (device == NULL)
+    g_error ("can't connect to sensors");
+
+  g_signal_connect (device, "sensor-data", G_CALLBACK (sensor_data), NULL);
+
+  /* Порт без разбора данных без типа источника не используется. */
+  if (!hyscan_sensor_set_enable (HYSCAN_SENSOR (device), "nmea", TRUE) ||
+      !hyscan_sensor_set_enable (HYSCAN_SENSOR (device), "raw", TRUE))
+    {
+      g_error ("sensors not found");
+    }
+
+  if (hyscan_sensor_set_enable (HYSCAN_SENSOR (device), "nosource", TRUE))
+    g_error ("raw port without source type is used");
+
+  wait_port (HYSCAN_PARAM (device), "nmea");
+  wait_port (HYSCAN_PARAM (device), "raw");
+
+  /* NMEA сообщения. Двоичные данные вне сообщений и сообщения с неверной
+   * контрольной суммой отбрасываются. */
+  gga = nmea_message ("$GPGGA,120000.00,5545.0000,N,03737.0000,E,1,08,1.0,150.0,M,14.0,M,,", TRUE);
+  zda = g_strdup ("$GPZDA,120000.00,01,01,2020,00,00");
+  vdm = nmea_message ("!AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0", TRUE);
+  bad = nmea_message ("$GPHDT,123.4,T", FALSE);
+
+  sent[0] = g_get_real_time ();
+  pty_write (&nmea_pty, "\x00\xff\x10\x80", 4);
+  pty_write (&nmea_pty, gga, 20);
+  g_usleep (20000);
+  pty_write (&nmea_pty, gga + 20, strlen (gga) - 20);
+  pty_write (&nmea_pty, "\r\n", 2);
+
+  g_usleep (20000);
+  sent[1] = g_get_real_time ();
+  pty_write (&nmea_pty, zda, strlen (zda));
+  pty_write (&nmea_pty, "\r\n\xfe\xfe", 4);
+  pty_write (&nmea_pty, bad, strlen (bad));
+  pty_write (&nmea_pty, "\r\n", 2);
+
+  g_usleep (20000);
+  sent[2] = g_get_real_time ();
+  pty_write (&nmea_pty, vdm, strlen (vdm));
+  pty_write (&nmea_pty, "\n", 1);
+
+  wait_records ("nmea", 3, "nmea");
+
+  last = check_nmea (0, gga, sent[0], 0);
+  last = check_nmea (1, zda, sent[1], last);
+  last = check_nmea (2, vdm, sent[2], last);
+
+  /* Данные отключенного датчика не передаются. */
+  if (!hyscan_sensor_set_enable (HYSCAN_SENSOR (device), "nmea", FALSE))
+    g_error ("can't disable sensor");
+
+  pty_write (&nmea_pty, gga, strlen (gga));
+  pty_write (&nmea_pty, "\r\n", 2);
+  wait_records ("nmea", 3, "disabled nmea");
+
+  if (!hyscan_sensor_set_enable (HYSCAN_SENSOR (device), "nmea", TRUE))
+    g_error ("can't enable sensor");
+
+  sent[3] = g_get_real_time ();
+  pty_write (&nmea_pty, zda, strlen (zda));
+  pty_write (&nmea_pty, "\r\n", 2);
+  wait_records ("nmea", 4, "enabled nmea");
+  check_nmea (3, zda, sent[3], last);
+
+  /* Двоичные данные без разбора, включая символы начала и конца NMEA
+   * сообщений, передаются полностью. */
+  for (i = 0; i < RAW_SIZE; i++)
+    raw[i] = (i % 3 == 0) ? '$' : (i % 5 == 0) ? '\n' : (gchar)g_random_int_range (0, 256);
+
+  pty_write (&raw_pty, raw, RAW_SIZE / 2);
+  g_usleep (20000);
+  pty_write (&raw_pty, raw + RAW_SIZE / 2, RAW_SIZE - RAW_SIZE / 2);
+
+  raw_received = g_byte_array_new ();
+  last = 0;
+  for (i = 0; raw_received->len < RAW_SIZE;)
+    {
+      gint64 end_time = g_get_monotonic_time () + WAIT_TIMEOUT;
+      Record *record = NULL;
+      guint j, n;
+
+      while (record == NULL)
+        {
+          g_mutex_lock (&lock);
+          for (j = 0, n = 0; j < records->len; j++)
+            {
+              Record *cur = g_ptr_array_index (records, j);
+
+              if ((g_strcmp0 (cur->name, "raw") == 0) && (n++ == i))
+                record = cur;
+            }
+          g_mutex_unlock (&lock);
+
+          if (g_get_monotonic_time () > end_time)
+            g_error ("raw: %d bytes instead of %d", raw_received->len, RAW_SIZE);
+
+          if (record == NULL)
+            g_usleep (10000);
+        }
+
+      if ((record->type != HYSCAN_DATA_BLOB) || (record->source != RAW_SOURCE))
+        g_error ("raw: data type or source mismatch");
+
+      if (record->time <= last)
+        g_error ("raw: time mismatch");
+
+      g_byte_array_append (raw_received, g_bytes_get_data (record->data, NULL),
+                           g_bytes_get_size (record->data));
+
+      last = record->time;
+      i += 1;
+    }
+
+  if ((raw_received->len != RAW_SIZE) || (memcmp (raw_received->data, raw, RAW_SIZE) != 0))
+    g_error ("raw: data mismatch");
+
+  g_byte_array_unref (raw_received);
+
+  g_object_unref (device);
+  g_object_unref (params);
+  g_object_unref (driver);
+
+  pty_close (&nmea_pty);
+  pty_close (&raw_pty);
+
+  g_ptr_array_unref (records);
+  g_free (gga);
+  g_free (zda);
+  g_free (vdm);
+  g_free (bad);
+
+  g_message ("All done");
+
+  return 0;
+}
@@ -0,0 +1,225 @@
+/* hyscan-uart-sensor-discover.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-uart-sensor-discover
+ * @Short_description: класс обнаружения датчиков, подключенных через UART порты
+ * @Title: HyScanUARTSensorDiscover
+ *
+ * Класс реализует интерфейс #HyScanDiscover для датчиков, подключенных
+ * через UART порты. Все порты компьютера представляются одним устройством
+ * с путём #HYSCAN_UART_SENSOR_URI. Используемые порты и их режимы работы
+ * задаются параметрами подключения, схему которых возвращает функция
+ * #hyscan_discover_config. При подключении создаётся объект
+ * #HyScanUARTSensor.
+ *
+ * При каждом запуске поиска проверяется наличие портов в системе. При
+ * появлении первого порта посылается сигнал #HyScanDiscover::device-found,
+ * а при пропадании всех портов - #HyScanDiscover::device-lost.
+ */
+
+#include "hyscan-uart-sensor-discover.h"
+#include "hyscan-uart-sensor.h"
+#include <hyscan-uart.h>
+
+struct _HyScanUARTSensorDiscoverPrivate
+{
+  GMutex                       lock;           /* Блокировка. */
+  gboolean                     present;        /* Признак наличия портов. */
+  guint                        generation;     /* Номер изменения списка устройств. */
+};
+
+static void    hyscan_uart_sensor_discover_interface_init     (HyScanDiscoverInterface *iface);
+
+static void    hyscan_uart_sensor_discover_object_finalize    (GObject                 *object);
+
+static gboolean hyscan_uart_sensor_discover_present           (void);
+
+G_DEFINE_TYPE_WITH_CODE (HyScanUARTSensorDiscover, hyscan_uart_sensor_discover, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (HyScanUARTSensorDiscover)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_DISCOVER, hyscan_uart_sensor_discover_interface_init))
+
+static void
+hyscan_uart_sensor_discover_class_init (HyScanUARTSensorDiscoverClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = hyscan_uart_sensor_discover_object_finalize;
+}
+
+static void
+hyscan_uart_sensor_discover_init (HyScanUARTSensorDiscover *discover)
+{
+  discover->priv = hyscan_uart_sensor_discover_get_instance_private (discover);
+
+  g_mutex_init (&discover->priv->lock);
+  discover->priv->generation = 1;
+}
+
+static void
+hyscan_uart_sensor_discover_object_finalize (GObject *object)
+{
+  HyScanUARTSensorDiscover *discover = HYSCAN_UART_SENSOR_DISCOVER (object);
+
+  g_mutex_clear (&discover->priv->lock);
+
+  G_OBJECT_CLASS (hyscan_uart_sensor_discover_parent_class)->finalize (object);
+}
+
+/* Функция проверяет наличие UART портов в системе. */
+static gboolean
+hyscan_uart_sensor_discover_present (void)
+{
+  GList *devices;
+
+  devices = hyscan_uart_list ();
+  if (devices == NULL)
+    return FALSE;
+
+  g_list_free_full (devices, (GDestroyNotify)hyscan_uart_device_free);
+
+  return TRUE;
+}
+
+/* Порты не требуют поиска, поэтому обнаружение завершается сразу. */
+static void
+hyscan_uart_sensor_discover_start (HyScanDiscover *discover)
+{
+  HyScanUARTSensorDiscoverPrivate *priv = HYSCAN_UART_SENSOR_DISCOVER (discover)->priv;
+  gboolean present;
+  gboolean changed;
+
+  present = hyscan_uart_sensor_discover_present ();
+
+  g_mutex_lock (&priv->lock);
+  changed = (present != priv->present);
+  if (changed)
+    {
+      priv->present = present;
+      priv->generation += 1;
+    }
+  g_mutex_unlock (&priv->lock);
+
+  if (changed)
+    {
+      HyScanDiscoverInfo info;
+
+      info.name = "UART sensors";
+      info.info = NULL;
+      info.uri = HYSCAN_UART_SENSOR_URI;
+      info.multi = FALSE;
+
+      g_signal_emit_by_name (discover, present ? "device-found" : "device-lost", &info);
+    }
+
+  g_signal_emit_by_name (discover, "progress", 100.0);
+  g_signal_emit_by_name (discover, "completed");
+}
+
+static GList *
+hyscan_uart_sensor_discover_list (HyScanDiscover *discover)
+{
+  if (!hyscan_uart_sensor_discover_present ())
+    return NULL;
+
+  return g_list_append (NULL, hyscan_discover_info_new ("UART sensors", NULL,
+                                                        HYSCAN_UART_SENSOR_URI, FALSE));
+}
+
+static guint
+hyscan_uart_sensor_discover_get_generation (HyScanDiscover *discover)
+{
+  HyScanUARTSensorDiscoverPrivate *priv = HYSCAN_UART_SENSOR_DISCOVER (discover)->priv;
+  guint generation;
+
+  g_mutex_lock (&priv->lock);
+  generation = priv->generation;
+  g_mutex_unlock (&priv->lock);
+
+  return generation;
+}
+
+static HyScanDataSchema *
+hyscan_uart_sensor_discover_config (HyScanDiscover *discover,
+                                    const gchar    *uri)
+{
+  if (g_strcmp0 (uri, HYSCAN_UART_SENSOR_URI) != 0)
+    return NULL;
+
+  return hyscan_uart_sensor_config ();
+}
+
+static gboolean
+hyscan_uart_sensor_discover_check (HyScanDiscover  *discover,
+                                   const gchar     *uri,
+                                   HyScanParamList *params)
+{
+  return (g_strcmp0 (uri, HYSCAN_UART_SENSOR_URI) == 0);
+}
+
+static HyScanDevice *
+hyscan_uart_sensor_discover_connect (HyScanDiscover  *discover,
+                                     const gchar     *uri,
+                                     HyScanParamList *params)
+{
+  if (g_strcmp0 (uri, HYSCAN_UART_SENSOR_URI) != 0)
+    return NULL;
+
+  return HYSCAN_DEVICE (hyscan_uart_sensor_new (params));
+}
+
+/**
+ * hyscan_uart_sensor_discover_new:
+ *
+ * Функция создаёт новый объект #HyScanUARTSensorDiscover.
+ *
+ * Returns: #HyScanUARTSensorDiscover. Для удаления #g_object_unref.
+ */
+HyScanUARTSensorDiscover *
+hyscan_uart_sensor_discover_new (void)
+{
+  return g_object_new (HYSCAN_TYPE_UART_SENSOR_DISCOVER, NULL);
+}
+
+static void
+hyscan_uart_sensor_discover_interface_init (HyScanDiscoverInterface *iface)
+{
+  iface->start = hyscan_uart_sensor_discover_start;
+  iface->stop = NULL;
+  iface->list = hyscan_uart_sensor_discover_list;
+  iface->config = hyscan_uart_sensor_discover_config;
+  iface->check = hyscan_uart_sensor_discover_check;
+  iface->connect = hyscan_uart_sensor_discover_connect;
+  iface->get_generation = hyscan_uart_sensor_discover_get_generation;
+}
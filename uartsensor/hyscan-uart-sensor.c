@@ -0,0 +1,854 @@
+/* hyscan-uart-sensor.c
+ *
+ * Copyright 2021 Screen LLC, Andrei Fadeev <andrei@webcontrol.ru>
+ *
+ * This file is part of HyScanDriver library.
+ *
+ * HyScanDriver is dual-licensed: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * HyScanDriver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Alternatively, you can license this code under a commercial license.
+ * Contact the Screen LLC in this case - <info@screen-co.ru>.
+ */
+
+/* HyScanDriver имеет двойную лицензию.
+ *
+ * Во-первых, вы можете распространять HyScanDriver на условиях Стандартной
+ * Общественной Лицензии GNU версии 3, либо по любой более поздней версии
+ * лицензии (по вашему выбору). Полные положения лицензии GNU приведены в
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Во-вторых, этот программный код можно использовать по коммерческой
+ * лицензии. Для этого свяжитесь с ООО Экран - <info@screen-co.ru>.
+ */
+
+/**
+ * SECTION: hyscan-uart-sensor
+ * @Short_description: класс датчиков, подключенных через UART порты
+ * @Title: HyScanUARTSensor
+ *
+ * Класс реализует интерфейсы #HyScanParam, #HyScanDevice и #HyScanSensor
+ * для простых датчиков, передающих данные через UART порты, например
+ * NMEA приёмников. Один объект обслуживает произвольное число портов.
+ * Данные из всех портов принимаются одним рабочим потоком, который ожидает
+ * их поступления функцией #hyscan_uart_wait и считывает функцией
+ * #hyscan_uart_read_some все накопленные в порту данные за один вызов.
+ *
+ * Каждому порту соответствует датчик с именем, совпадающим с названием
+ * порта в нижнем регистре, например "com1" или "usbcom1". Данные датчиков
+ * передаются сигналом #HyScanSensor::sensor-data.
+ *
+ * Поток данных порта разбирается в соответствии с #HyScanUARTSensorFraming.
+ * В режиме #HYSCAN_UART_SENSOR_FRAMING_NMEA из потока выделяются отдельные
+ * NMEA сообщения, начинающиеся символом '$' или '!' и заканчивающиеся
+ * символами перевода строки. Сообщения с неверной контрольной суммой
+ * отбрасываются. Каждое сообщение передаётся как строка (#HYSCAN_DATA_STRING)
+ * с меткой времени приёма его первого символа и типом источника
+ * #HYSCAN_SOURCE_NMEA. В режиме #HYSCAN_UART_SENSOR_FRAMING_RAW данные
+ * передаются без разбора в том виде, в котором они были считаны из порта
+ * (#HYSCAN_DATA_BLOB). Формат этих данных драйверу неизвестен, поэтому тип
+ * источника для них задаётся параметром порта. Порты в режиме
+ * #HYSCAN_UART_SENSOR_FRAMING_RAW без корректного типа источника не
+ * используются.
+ *
+ * Параметры портов задаются при создании объекта функцией
+ * #hyscan_uart_sensor_new. Схему этих параметров возвращает функция
+ * #hyscan_uart_sensor_config. Для каждого порта используются параметры:
+ *
+ * - /ports/name/mode - режим работы порта #HyScanUARTMode, тип ENUM;
+ * - /ports/name/framing - способ выделения сообщений, тип ENUM;
+ * - /ports/name/path - путь к порту, тип STRING, необязательный;
+ * - /ports/name/low-latency - режим низкой задержки, тип BOOLEAN, необязательный;
+ * - /ports/name/source - идентификатор типа источника данных в режиме
+ *   #HYSCAN_UART_SENSOR_FRAMING_RAW (#hyscan_source_get_id_by_type), тип STRING.
+ *
+ * Порты с режимом работы #HYSCAN_UART_MODE_DISABLED не используются. Если
+ * путь к порту не задан, он определяется по названию порта из списка
+ * #hyscan_uart_list. Это позволяет подключать в качестве порта, например,
+ * псевдотерминал утилиты uart-replay.
+ *
+ * Состояние порта доступно через параметр "/state/name/status". При ошибке
+ * обмена данными порт закрывается и периодически открывается повторно.
+ */
+
+#include "hyscan-uart-sensor.h"
+#include <hyscan-sensor-schema.h>
+#include <hyscan-sensor-driver.h>
+#include <hyscan-device-driver.h>
+#include <hyscan-param.h>
+#include <hyscan-uart.h>
+#include <string.h>
+
+#define UART_SENSOR_PARAM_NAME(...)  hyscan_param_name_constructor (key_id, \
+                                       (guint)sizeof (key_id), \
+                                       __VA_ARGS__)
+
+#define WAIT_TIMEOUT           0.1     /* Таймаут ожидания данных, с. */
+#define REOPEN_INTERVAL        1000000 /* Интервал повторного открытия порта, мкс. */
+#define READ_SIZE              4096    /* Максимальный размер данных, считываемых за один раз. */
+#define NMEA_MAX_SIZE          1024    /* Максимальная длина NMEA сообщения. */
+
+typedef struct
+{
+  HyScanUARTMode       mode;
+  guint32              baud;
+  const gchar         *id;
+  const gchar         *name;
+} HyScanUARTSensorMode;
+
+typedef struct
+{
+  gchar               *name;           /* Название датчика. */
+  gchar               *path;           /* Путь к UART порту. */
+  HyScanUARTMode       mode;           /* Режим работы порта. */
+  HyScanUARTSensorFraming framing;     /* Способ выделения сообщений. */
+  HyScanSourceType     source;         /* Тип источника данных. */
+  gboolean             low_latency;    /* Режим низкой задержки. */
+  gdouble              byte_time;      /* Время передачи одного байта, мкс. */
+
+  HyScanUART          *uart;           /* UART порт. */
+  gint                 enable;         /* Признак включения датчика. */
+  gint                 status;         /* Состояние порта. */
+  gint64               reopen_time;    /* Время повторного открытия порта. */
+
+  GByteArray          *message;        /* Принимаемое NMEA сообщение. */
+  gint64               message_time;   /* Время начала приёма NMEA сообщения. */
+  gint64               last_time;      /* Время последних отправленных данных. */
+} HyScanUARTSensorPort;
+
+struct _HyScanUARTSensorPrivate
+{
+  HyScanParamList     *params;         /* Параметры портов. */
+  HyScanDataSchema    *schema;         /* Схема устройства. */
+
+  GPtrArray           *ports;          /* Используемые порты. */
+  GThread             *io;             /* Поток приёма данных. */
+  gint                 shutdown;       /* Признак завершения работы. */
+};
+
+static void            hyscan_uart_sensor_param_interface_init  (HyScanParamInterface  *iface);
+static void            hyscan_uart_sensor_device_interface_init (HyScanDeviceInterface *iface);
+static void            hyscan_uart_sensor_sensor_interface_init (HyScanSensorInterface *iface);
+
+static void            hyscan_uart_sensor_set_property          (GObject               *object,
+                                                                 guint                  prop_id,
+                                                                 const GValue          *value,
+                                                                 GParamSpec            *pspec);
+static void            hyscan_uart_sensor_object_constructed    (GObject               *object);
+static void            hyscan_uart_sensor_object_finalize       (GObject               *object);
+
+static void            hyscan_uart_sensor_port_free             (gpointer               data);
+
+static HyScanUARTSensorPort *
+                       hyscan_uart_sensor_get_port              (HyScanUARTSensorPrivate *priv,
+                                                                 const gchar           *name);
+
+static void            hyscan_uart_sensor_set_status            (HyScanUARTSensor      *sensor,
+                                                                 HyScanUARTSensorPort  *port,
+                                                                 HyScanDeviceStatusType status);
+
+static void            hyscan_uart_sensor_send                  (HyScanUARTSensor      *sensor,
+                                                                 HyScanUARTSensorPort  *port,
+                                                                 gint64                 time,
+                                                                 HyScanBuffer          *data);
+
+static gboolean        hyscan_uart_sensor_nmea_check            (GByteArray            *message);
+
+static void            hyscan_uart_sensor_nmea                  (HyScanUARTSensor      *sensor,
+                                                                 HyScanUARTSensorPort  *port,
+                                                                 HyScanBuffer          *buffer,
+                                                                 const guint8          *data,
+                                                                 guint32                size,
+                                                                 gint64                 time);
+
+static gpointer        hyscan_uart_sensor_io                    (gpointer               data);
+
+enum
+{
+  PROP_O,
+  PROP_PARAMS
+};
+
+static HyScanUARTSensorMode hyscan_uart_sensor_modes[] =
+{
+  { HYSCAN_UART_MODE_DISABLED,         0, "disabled", "Disabled" },
+  { HYSCAN_UART_MODE_4800_8N1,      4800, "4800",     "4800 8N1" },
+  { HYSCAN_UART_MODE_9600_8N1,      9600, "9600",     "9600 8N1" },
+  { HYSCAN_UART_MODE_19200_8N1,    19200, "19200",    "19200 8N1" },
+  { HYSCAN_UART_MODE_38400_8N1,    38400, "38400",    "38400 8N1" },
+  { HYSCAN_UART_MODE_57600_8N1,    57600, "57600",    "57600 8N1" },
+  { HYSCAN_UART_MODE_115200_8N1,  115200, "115200",   "115200 8N1" },
+  { HYSCAN_UART_MODE_230400_8N1,  230400, "230400",   "230400 8N1" },
+  { HYSCAN_UART_MODE_460800_8N1,  460800, "460800",   "460800 8N1" },
+  { HYSCAN_UART_MODE_921600_8N1,  921600, "921600",   "921600 8N1" }
+};
+
+G_DEFINE_TYPE_WITH_CODE (HyScanUARTSensor, hyscan_uart_sensor, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (HyScanUARTSensor)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_PARAM, hyscan_uart_sensor_param_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_DEVICE, hyscan_uart_sensor_device_interface_init)
+                         G_IMPLEMENT_INTERFACE (HYSCAN_TYPE_SENSOR, hyscan_uart_sensor_sensor_interface_init))
+
+static void
+hyscan_uart_sensor_class_init (HyScanUARTSensorClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->set_property = hyscan_uart_sensor_set_property;
+
+  object_class->constructed = hyscan_uart_sensor_object_constructed;
+  object_class->finalize = hyscan_uart_sensor_object_finalize;
+
+  g_object_class_install_property (object_class, PROP_PARAMS,
+    g_param_spec_object ("params", "Params", "Ports parameters", HYSCAN_TYPE_PARAM_LIST,
+                         G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+}
+
+static void
+hyscan_uart_sensor_init (HyScanUARTSensor *sensor)
+{
+  sensor->priv = hyscan_uart_sensor_get_instance_private (sensor);
+}
+
+static void
+hyscan_uart_sensor_set_property (GObject      *object,
+                                 guint         prop_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+  HyScanUARTSensor *sensor = HYSCAN_UART_SENSOR (object);
+  HyScanUARTSensorPrivate *priv = sensor->priv;
+
+  switch (prop_id)
+    {
+    case PROP_PARAMS:
+      priv->params = g_value_dup_object (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+hyscan_uart_sensor_object_constructed (GObject *object)
+{
+  HyScanUARTSensor *sensor = HYSCAN_UART_SENSOR (object);
+  HyScanUARTSensorPrivate *priv = sensor->priv;
+
+  HyScanDeviceSchema *device;
+  HyScanSensorSchema *schema;
+  HyScanDataSchemaBuilder *builder;
+  const gchar * const *keys;
+  GList *devices;
+  gchar key_id[128];
+  guint i, j;
+
+  priv->ports = g_ptr_array_new_with_free_func (hyscan_uart_sensor_port_free);
+
+  device = hyscan_device_schema_new (HYSCAN_DEVICE_SCHEMA_VERSION);
+  builder = HYSCAN_DATA_SCHEMA_BUILDER (device);
+  schema = hyscan_sensor_schema_new (device);
+
+  keys = (priv->params != NULL) ? hyscan_param_list_params (priv->params) : NULL;
+  devices = hyscan_uart_list ();
+
+  /* Порты, заданные параметрами "/ports/name/mode". */
+  for (i = 0; (keys != NULL) && (keys[i] != NULL); i++)
+    {
+      HyScanUARTSensorPort *port;
+      gchar **parts;
+
+      parts = g_strsplit (keys[i], "/", -1);
+      if ((g_strv_length (parts) != 4) || (g_strcmp0 (parts[1], "ports") != 0) ||
+          (g_strcmp0 (parts[3], "mode") != 0))
+        {
+          g_strfreev (parts);
+          continue;
+        }
+
+      port = g_slice_new0 (HyScanUARTSensorPort);
+      port->name = g_ascii_strdown (parts[2], -1);
+      port->mode = hyscan_param_list_get_enum (priv->params, keys[i]);
+      port->framing = HYSCAN_UART_SENSOR_FRAMING_NMEA;
+      port->enable = TRUE;
+      port->status = HYSCAN_DEVICE_STATUS_ERROR;
+      port->message = g_byte_array_sized_new (NMEA_MAX_SIZE + 1);
+      g_strfreev (parts);
+
+      for (j = 0; j < G_N_ELEMENTS (hyscan_uart_sensor_modes); j++)
+        {
+          if (hyscan_uart_sensor_modes[j].mode == port->mode)
+            port->byte_time = 10.0 * G_USEC_PER_SEC / MAX (hyscan_uart_sensor_modes[j].baud, 1);
+        }
+
+      if ((port->mode == HYSCAN_UART_MODE_DISABLED) || (port->byte_time == 0.0) ||
+          (hyscan_uart_sensor_get_port (priv, port->name) != NULL))
+        {
+          hyscan_uart_sensor_port_free (port);
+          continue;
+        }
+
+      UART_SENSOR_PARAM_NAME ("ports", port->name, "framing", NULL);
+      if (hyscan_param_list_contains (priv->params, key_id))
+        port->framing = hyscan_param_list_get_enum (priv->params, key_id);
+
+      /* Тип источника данных без разбора задаётся явно. */
+      port->source = HYSCAN_SOURCE_NMEA;
+      if (port->framing == HYSCAN_UART_SENSOR_FRAMING_RAW)
+        {
+          UART_SENSOR_PARAM_NAME ("ports", port->name, "source", NULL);
+          port->source = HYSCAN_SOURCE_INVALID;
+          if (hyscan_param_list_contains (priv->params, key_id))
+            port->source = hyscan_source_get_type_by_id (hyscan_param_list_get_string (priv->params, key_id));
+
+          if (port->source == HYSCAN_SOURCE_INVALID)
+            {
+              g_warning ("HyScanUARTSensor: unknown source type for raw port %s", port->name);
+              hyscan_uart_sensor_port_free (port);
+              continue;
+            }
+        }
+
+      UART_SENSOR_PARAM_NAME ("ports", port->name, "low-latency", NULL);
+      if (hyscan_param_list_contains (priv->params, key_id))
+        port->low_latency = hyscan_param_list_get_boolean (priv->params, key_id);
+
+      UART_SENSOR_PARAM_NAME ("ports", port->name, "path", NULL);
+      if (hyscan_param_list_contains (priv->params, key_id))
+        port->path = g_strdup (hyscan_param_list_get_string (priv->params, key_id));
+
+      /* Путь к порту по его названию. */
+      if ((port->path == NULL) || (port->path[0] == 0))
+        {
+          GList *cur;
+
+          g_clear_pointer (&port->path, g_free);
+          for (cur = devices; cur != NULL; cur = cur->next)
+            {
+              HyScanUARTDevice *uart = cur->data;
+
+              if (g_ascii_strcasecmp (uart->name, port->name) == 0)
+                port->path = g_strdup (uart->path);
+            }
+        }
+
+      if (port->path == NULL)
+        {
+          g_warning ("HyScanUARTSensor: unknown port %s", port->name);
+          hyscan_uart_sensor_port_free (port);
+          continue;
+        }
+
+      port->uart = hyscan_uart_new ();
+      hyscan_uart_set_low_latency (port->uart, port->low_latency);
+
+      /* Описание датчика и его состояния. */
+      hyscan_sensor_schema_add_sensor (schema, port->name, port->name, port->path);
+
+      UART_SENSOR_PARAM_NAME ("state", port->name, "status", NULL);
+      hyscan_data_schema_builder_key_enum_create (builder, key_id, "status", "Port status",
+                                                  HYSCAN_DEVICE_STATUS_ENUM,
+                                                  HYSCAN_DEVICE_STATUS_ERROR);
+      hyscan_data_schema_builder_key_set_access (builder, key_id, HYSCAN_DATA_SCHEMA_ACCESS_READ);
+
+      g_ptr_array_add (priv->ports, port);
+    }
+
+  g_list_free_full (devices, (GDestroyNotify)hyscan_uart_device_free);
+
+  priv->schema = hyscan_data_schema_builder_get_schema (builder);
+
+  g_object_unref (schema);
+  g_object_unref (device);
+
+  /* Поток приёма данных. Порты открываются в нём же. */
+  if (priv->ports->len > 0)
+    priv->io = g_thread_new ("uart-sensor", hyscan_uart_sensor_io, sensor);
+}
+
+static void
+hyscan_uart_sensor_object_finalize (GObject *object)
+{
+  HyScanUARTSensor *sensor = HYSCAN_UART_SENSOR (object);
+  HyScanUARTSensorPrivate *priv = sensor->priv;
+
+  hyscan_device_disconnect (HYSCAN_DEVICE (sensor));
+
+  g_ptr_array_unref (priv->ports);
+  g_clear_object (&priv->schema);
+  g_clear_object (&priv->params);
+
+  G_OBJECT_CLASS (hyscan_uart_sensor_parent_class)->finalize (object);
+}
+
+/* Функция освобождает память, занятую структурой HyScanUARTSensorPort. */
+static void
+hyscan_uart_sensor_port_free (gpointer data)
+{
+  HyScanUARTSensorPort *port = data;
+
+  g_clear_object (&port->uart);
+  g_byte_array_unref (port->message);
+  g_free (port->name);
+  g_free (port->path);
+
+  g_slice_free (HyScanUARTSensorPort, port);
+}
+
+/* Функция ищет порт по названию датчика. */
+static HyScanUARTSensorPort *
+hyscan_uart_sensor_get_port (HyScanUARTSensorPrivate *priv,
+                             const gchar             *name)
+{
+  guint i;
+
+  for (i = 0; i < priv->ports->len; i++)
+    {
+      HyScanUARTSensorPort *port = g_ptr_array_index (priv->ports, i);
+
+      if (g_strcmp0 (port->name, name) == 0)
+        return port;
+    }
+
+  return NULL;
+}
+
+/* Функция изменяет состояние порта. */
+static void
+hyscan_uart_sensor_set_status (HyScanUARTSensor       *sensor,
+                               HyScanUARTSensorPort   *port,
+                               HyScanDeviceStatusType  status)
+{
+  if (g_atomic_int_get (&port->status) == (gint)status)
+    return;
+
+  g_atomic_int_set (&port->status, status);
+  hyscan_device_driver_send_state (sensor, port->name);
+}
+
+/* Функция отправляет данные датчика. */
+static void
+hyscan_uart_sensor_send (HyScanUARTSensor     *sensor,
+                         HyScanUARTSensorPort *port,
+                         gint64                time,
+                         HyScanBuffer         *data)
+{
+  if (!g_atomic_int_get (&port->enable))
+    return;
+
+  /* Метки времени данных датчика должны строго возрастать. */
+  time = MAX (time, port->last_time + 1);
+  port->last_time = time;
+
+  hyscan_sensor_driver_send_data (sensor, port->name, port->source, time, data);
+}
+
+/* Функция проверяет формат и контрольную сумму NMEA сообщения. */
+static gboolean
+hyscan_uart_sensor_nmea_check (GByteArray *message)
+{
+  const gchar *data = (const gchar *)message->data;
+  guint8 checksum = 0;
+  gint high, low;
+  guint i;
+
+  /* Минимальное сообщение содержит признак начала и адресное поле. */
+  if (message->len < 6)
+    return FALSE;
+
+  /* Контрольная сумма необязательна. */
+  if ((message->len < 9) || (data[message->len - 3] != '*'))
+    return (memchr (data, '*', message->len) == NULL);
+
+  for (i = 1; i < message->len - 3; i++)
+    checksum ^= data[i];
+
+  high = g_ascii_xdigit_value (data[message->len - 2]);
+  low = g_ascii_xdigit_value (data[message->len - 1]);
+
+  return (high >= 0) && (low >= 0) && (checksum == ((high << 4) | low));
+}
+
+/* Функция выделяет NMEA сообщения из потока данных. */
+static void
+hyscan_uart_sensor_nmea (HyScanUARTSensor     *sensor,
+                         HyScanUARTSensorPort *port,
+                         HyScanBuffer         *buffer,
+                         const guint8         *data,
+                         guint32               size,
+                         gint64                time)
+{
+  GByteArray *message = port->message;
+  guint32 i;
+
+  for (i = 0; i < size; i++)
+    {
+      guint8 symbol = data[i];
+
+      /* Начало нового сообщения. Данные до него отбрасываются. */
+      if ((symbol == '$') || (symbol == '!'))
+        {
+          g_byte_array_set_size (message, 0);
+          port->message_time = time + (gint64)(i * port->byte_time);
+        }
+      else if (message->len == 0)
+        {
+          continue;
+        }
+
+      /* Конец сообщения. */
+      if ((symbol == '\r') || (symbol == '\n'))
+        {
+          if (hyscan_uart_sensor_nmea_check (message))
+            {
+              g_byte_array_append (message, (const guint8 *)"", 1);
+              hyscan_buffer_wrap (buffer, HYSCAN_DATA_STRING, message->data, message->len);
+              hyscan_uart_sensor_send (sensor, port, port->message_time, buffer);
+            }
+
+          g_byte_array_set_size (message, 0);
+          continue;
+        }
+
+      /* Слишком длинные сообщения отбрасываются. */
+      if (message->len >= NMEA_MAX_SIZE)
+        {
+          g_byte_array_set_size (message, 0);
+          continue;
+        }
+
+      g_byte_array_append (message, &symbol, 1);
+    }
+}
+
+/* Поток приёма данных из всех портов. */
+static gpointer
+hyscan_uart_sensor_io (gpointer data)
+{
+  HyScanUARTSensor *sensor = data;
+  HyScanUARTSensorPrivate *priv = sensor->priv;
+
+  HyScanBuffer *buffer;
+  HyScanBuffer *message;
+  HyScanUART **uarts;
+  gboolean *ready;
+  guint n_ports;
+  guint i;
+
+  n_ports = priv->ports->len;
+  uarts = g_new (HyScanUART *, n_ports);
+  ready = g_new0 (gboolean, n_ports);
+  for (i = 0; i < n_ports; i++)
+    uarts[i] = ((HyScanUARTSensorPort *)g_ptr_array_index (priv->ports, i))->uart;
+
+  buffer = hyscan_buffer_new ();
+  message = hyscan_buffer_new ();
+
+  while (!g_atomic_int_get (&priv->shutdown))
+    {
+      gint64 now = g_get_monotonic_time ();
+
+      /* Открываем закрытые порты. */
+      for (i = 0; i < n_ports; i++)
+        {
+          HyScanUARTSensorPort *port = g_ptr_array_index (priv->ports, i);
+
+          if ((hyscan_uart_get_mode (port->uart) != HYSCAN_UART_MODE_DISABLED) ||
+              (now < port->reopen_time))
+            {
+              continue;
+            }
+
+          if (hyscan_uart_open (port->uart, port->path, port->mode))
+            {
+              g_byte_array_set_size (port->message, 0);
+              hyscan_uart_timeout (port->uart, WAIT_TIMEOUT, WAIT_TIMEOUT);
+              hyscan_uart_sensor_set_status (sensor, port, HYSCAN_DEVICE_STATUS_OK);
+            }
+          else
+            {
+              port->reopen_time = now + REOPEN_INTERVAL;
+              hyscan_uart_sensor_set_status (sensor, port, HYSCAN_DEVICE_STATUS_ERROR);
+            }
+        }
+
+      if (hyscan_uart_wait (uarts, ready, n_ports, WAIT_TIMEOUT) <= 0)
+        continue;
+
+      /* Считываем данные из всех готовых портов. */
+      for (i = 0; i < n_ports; i++)
+        {
+          HyScanUARTSensorPort *port = g_ptr_array_index (priv->ports, i);
+          HyScanUARTStatus status;
+          guint32 size;
+          guint8 *data;
+          gint64 time;
+
+          if (!ready[i])
+            continue;
+
+          status = hyscan_uart_read_some (port->uart, buffer, READ_SIZE, &time);
+          if (status == HYSCAN_UART_STATUS_ERROR)
+            {
+              hyscan_uart_close (port->uart);
+              port->reopen_time = g_get_monotonic_time () + REOPEN_INTERVAL;
+              hyscan_uart_sensor_set_status (sensor, port, HYSCAN_DEVICE_STATUS_ERROR);
+              continue;
+            }
+
+          if (status != HYSCAN_UART_STATUS_OK)
+            continue;
+
+          if (port->framing == HYSCAN_UART_SENSOR_FRAMING_RAW)
+            {
+              hyscan_uart_sensor_send (sensor, port, time, buffer);
+              continue;
+            }
+
+          data = hyscan_buffer_get (buffer, NULL, &size);
+          hyscan_uart_sensor_nmea (sensor, port, message, data, size, time);
+        }
+    }
+
+  for (i = 0; i < n_ports; i++)
+    hyscan_uart_close (uarts[i]);
+
+  g_object_unref (message);
+  g_object_unref (buffer);
+  g_free (ready);
+  g_free (uarts);
+
+  return NULL;
+}
+
+static HyScanDataSchema *
+hyscan_uart_sensor_param_schema (HyScanParam *param)
+{
+  HyScanUARTSensor *sensor = HYSCAN_UART_SENSOR (param);
+
+  return g_object_ref (sensor->priv->schema);
+}
+
+static gboolean
+hyscan_uart_sensor_param_set (HyScanParam     *param,
+                              HyScanParamList *list)
+{
+  /* Изменяемых параметров нет. */
+  return (hyscan_param_list_params (list) == NULL);
+}
+
+static gboolean
+hyscan_uart_sensor_param_get (HyScanParam     *param,
+                              HyScanParamList *list)
+{
+  HyScanUARTSensor *sensor = HYSCAN_UART_SENSOR (param);
+  HyScanUARTSensorPrivate *priv = sensor->priv;
+  const gchar * const *keys;
+  guint i;
+
+  keys = hyscan_param_list_params (list);
+  for (i = 0; (keys != NULL) && (keys[i] != NULL); i++)
+    {
+      HyScanUARTSensorPort *port;
+      gchar **parts;
+
+      /* Поддерживаются только параметры "/state/name/status". */
+      parts = g_strsplit (keys[i], "/", -1);
+      port = NULL;
+      if ((g_strv_length (parts) == 4) && (g_strcmp0 (parts[1], "state") == 0) &&
+          (g_strcmp0 (parts[3], "status") == 0))
+        {
+          port = hyscan_uart_sensor_get_port (priv, parts[2]);
+        }
+      g_strfreev (parts);
+
+      if (port == NULL)
+        return FALSE;
+
+      hyscan_param_list_set_enum (list, keys[i], g_atomic_int_get (&port->status));
+    }
+
+  return TRUE;
+}
+
+static gboolean
+hyscan_uart_sensor_device_sync (HyScanDevice *device)
+{
+  return TRUE;
+}
+
+static gboolean
+hyscan_uart_sensor_device_disconnect (HyScanDevice *device)
+{
+  HyScanUARTSensor *sensor = HYSCAN_UART_SENSOR (device);
+  HyScanUARTSensorPrivate *priv = sensor->priv;
+
+  if (priv->io == NULL)
+    return TRUE;
+
+  g_atomic_int_set (&priv->shutdown, TRUE);
+  g_thread_join (priv->io);
+  priv->io = NULL;
+
+  return TRUE;
+}
+
+static gboolean
+hyscan_uart_sensor_sensor_antenna_set_offset (HyScanSensor              *sensor,
+                                              const gchar               *name,
+                                              const HyScanAntennaOffset *offset)
+{
+  HyScanUARTSensor *uart_sensor = HYSCAN_UART_SENSOR (sensor);
+
+  /* Смещение антенны учитывается потребителем данных. */
+  return (hyscan_uart_sensor_get_port (uart_sensor->priv, name) != NULL);
+}
+
+static gboolean
+hyscan_uart_sensor_sensor_set_enable (HyScanSensor *sensor,
+                                      const gchar  *name,
+                                      gboolean      enable)
+{
+  HyScanUARTSensor *uart_sensor = HYSCAN_UART_SENSOR (sensor);
+  HyScanUARTSensorPort *port;
+
+  port = hyscan_uart_sensor_get_port (uart_sensor->priv, name);
+  if (port == NULL)
+    return FALSE;
+
+  g_atomic_int_set (&port->enable, enable);
+
+  return TRUE;
+}
+
+/**
+ * hyscan_uart_sensor_new:
+ * @params: параметры UART портов
+ *
+ * Функция создаёт новый объект #HyScanUARTSensor и начинает приём данных из
+ * UART портов, указанных в параметрах. Схема параметров приведена в описании
+ * класса и может быть получена функцией #hyscan_uart_sensor_config.
+ *
+ * Returns: #HyScanUARTSensor или NULL если не задано ни одного порта.
+ * Для удаления #g_object_unref.
+ */
+HyScanUARTSensor *
+hyscan_uart_sensor_new (HyScanParamList *params)
+{
+  HyScanUARTSensor *sensor;
+
+  sensor = g_object_new (HYSCAN_TYPE_UART_SENSOR,
+                         "params", params,
+                         NULL);
+
+  if (sensor->priv->ports->len == 0)
+    g_clear_object (&sensor);
+
+  return sensor;
+}
+
+/**
+ * hyscan_uart_sensor_config:
+ *
+ * Функция возвращает схему параметров UART портов для всех портов,
+ * имеющихся в системе. По умолчанию все порты отключены.
+ *
+ * Returns: #HyScanDataSchema. Для удаления #g_object_unref.
+ */
+HyScanDataSchema *
+hyscan_uart_sensor_config (void)
+{
+  HyScanDataSchemaBuilder *builder;
+  HyScanDataSchema *schema;
+  GList *devices, *cur;
+  gchar key_id[128];
+  guint i;
+
+  builder = hyscan_data_schema_builder_new ("uart-sensor");
+
+  hyscan_data_schema_builder_enum_create (builder, "uart-mode");
+  for (i = 0; i < G_N_ELEMENTS (hyscan_uart_sensor_modes); i++)
+    {
+      hyscan_data_schema_builder_enum_value_create (builder, "uart-mode",
+                                                    hyscan_uart_sensor_modes[i].mode,
+                                                    hyscan_uart_sensor_modes[i].id,
+                                                    hyscan_uart_sensor_modes[i].name,
+                                                    NULL);
+    }
+
+  hyscan_data_schema_builder_enum_create (builder, "uart-framing");
+  hyscan_data_schema_builder_enum_value_create (builder, "uart-framing",
+                                                HYSCAN_UART_SENSOR_FRAMING_NMEA,
+                                                "nmea", "NMEA", NULL);
+  hyscan_data_schema_builder_enum_value_create (builder, "uart-framing",
+                                                HYSCAN_UART_SENSOR_FRAMING_RAW,
+                                                "raw", "Raw data", NULL);
+
+  devices = hyscan_uart_list ();
+  for (cur = devices; cur != NULL; cur = cur->next)
+    {
+      HyScanUARTDevice *device = cur->data;
+      gchar *name = g_ascii_strdown (device->name, -1);
+
+      UART_SENSOR_PARAM_NAME ("ports", name, "mode", NULL);
+      hyscan_data_schema_builder_key_enum_create (builder, key_id, "mode", device->name,
+                                                  "uart-mode", HYSCAN_UART_MODE_DISABLED);
+
+      UART_SENSOR_PARAM_NAME ("ports", name, "framing", NULL);
+      hyscan_data_schema_builder_key_enum_create (builder, key_id, "framing", NULL,
+                                                  "uart-framing", HYSCAN_UART_SENSOR_FRAMING_NMEA);
+
+      UART_SENSOR_PARAM_NAME ("ports", name, "path", NULL);
+      hyscan_data_schema_builder_key_string_create (builder, key_id, "path", NULL, device->path);
+
+      UART_SENSOR_PARAM_NAME ("ports", name, "low-latency", NULL);
+      hyscan_data_schema_builder_key_boolean_create (builder, key_id, "low-latency", NULL, FALSE);
+
+      UART_SENSOR_PARAM_NAME ("ports", name, "source", NULL);
+      hyscan_data_schema_builder_key_string_create (builder, key_id, "source", NULL, NULL);
+
+      g_free (name);
+    }
+
+  g_list_free_full (devices, (GDestroyNotify)hyscan_uart_device_free);
+
+  schema = hyscan_data_schema_builder_get_schema (builder);
+  g_object_unref (builder);
+
+  return schema;
+}
+
+static void
+hyscan_uart_sensor_param_interface_init (HyScanParamInterface *iface)
+{
+  iface->schema = hyscan_uart_sensor_param_schema;
+  iface->set = hyscan_uart_sensor_param_set;
+  iface->get = hyscan_uart_sensor_param_get;
+}
+
+static void
+hyscan_uart_sensor_device_interface_init (HyScanDeviceInterface *iface)
+{
+  iface->sync = hyscan_uart_sensor_device_sync;
+  iface->set_sound_velocity = NULL;
+  iface->disconnect = hyscan_uart_sensor_device_disconnect;
+}
+
+static void
+hyscan_uart_sensor_sensor_interface_init (HyScanSensorInterface *iface)
+{
+  iface->antenna_set_offset = hyscan_uart_sensor_sensor_antenna_set_offset;
+  iface->set_enable = hyscan_uart_sensor_sensor_set_enable;
+}